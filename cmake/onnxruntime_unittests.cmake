@@ -125,6 +125,13 @@ file(GLOB_RECURSE onnxruntime_test_providers_cpu_src
   )
 list(APPEND onnxruntime_test_providers_src ${onnxruntime_test_providers_cpu_src})
 
+if(onnxruntime_USE_MKLDNN)
+  file(GLOB_RECURSE onnxruntime_test_providers_mkldnn_src
+    "${TEST_SRC_DIR}/providers/mkldnn/*"
+    )
+  list(APPEND onnxruntime_test_providers_src ${onnxruntime_test_providers_mkldnn_src})
+endif()
+
 # tests from lowest level library up.
 # the order of libraries should be maintained, with higher libraries being added first in the list
 
@@ -423,7 +430,8 @@ install(TARGETS onnx_test_runner
         RUNTIME  DESTINATION ${CMAKE_INSTALL_BINDIR})
 
 if(onnxruntime_BUILD_BENCHMARKS AND (HAS_FILESYSTEM_H OR HAS_EXPERIMENTAL_FILESYSTEM_H))
-  add_executable(onnxruntime_benchmark ${TEST_SRC_DIR}/onnx/microbenchmark/main.cc ${TEST_SRC_DIR}/onnx/microbenchmark/modeltest.cc ${TEST_SRC_DIR}/onnx/microbenchmark/model_init.cc)
+  add_executable(onnxruntime_benchmark ${TEST_SRC_DIR}/onnx/microbenchmark/main.cc ${TEST_SRC_DIR}/onnx/microbenchmark/modeltest.cc ${TEST_SRC_DIR}/onnx/microbenchmark/model_init.cc
+                 ${TEST_SRC_DIR}/onnx/microbenchmark/tfidfvectorizer.cc ${TEST_SRC_DIR}/onnx/microbenchmark/bfc_arena.cc)
   target_include_directories(onnxruntime_benchmark PRIVATE ${ONNXRUNTIME_ROOT} ${onnxruntime_graph_header} benchmark)
   onnxruntime_add_include_to_target(onnxruntime_benchmark gsl)
   if(WIN32)
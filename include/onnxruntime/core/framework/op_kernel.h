@@ -28,6 +28,8 @@ class OpKernel {
  public:
   using DoneCallback = std::function<void()>;
 
+  // With SessionOptions::enable_parallel_initialization the kernels of a session are constructed concurrently.
+  // A constructor may read its node and the initializers, but must synchronize access to any other shared state.
   explicit OpKernel(const OpKernelInfo& info) : op_kernel_info_(info) {}
   virtual ~OpKernel() = default;
 
@@ -94,6 +96,19 @@ class OpKernelContext {
     return p_ml_value ? p_ml_value->GetMutable<T>() : nullptr;
   }
 
+  // Fetch output (non-tensor) with specified index if it was allocated as type T.
+  // Returns nullptr if the output has a different runtime type, which allows a kernel to support an
+  // alternative representation of an output that the execution plan may select.
+  template <typename T>
+  T* TryOutput(int index) {
+    if (index < 0 || index >= OutputCount())
+      return nullptr;
+
+    MLValue* p_ml_value = nullptr;
+    ORT_ENFORCE(GetOrCreateOutputMLValue(index, p_ml_value).IsOK());
+    return p_ml_value && p_ml_value->Type() == DataTypeImpl::GetType<T>() ? p_ml_value->GetMutable<T>() : nullptr;
+  }
+
   // In the case that memory allocation has not been done for an output tensor,
   // The memory allocation will be done on-the-fly with given tensor shape.
   // Return nullptr if the output is an unused optional output.
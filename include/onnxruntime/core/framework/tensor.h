@@ -97,6 +97,12 @@ class Tensor final {
   */
   const OrtAllocatorInfo& Location() const { return alloc_info_; }
 
+  /**
+     Returns true if the tensor releases its buffer when it is destroyed,
+     false if the buffer is owned by someone else and only referenced by the tensor.
+  */
+  bool OwnsBuffer() const noexcept { return buffer_deleter_ != nullptr; }
+
   /**
      May return nullptr if tensor size is zero
   */
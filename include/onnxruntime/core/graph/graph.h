@@ -133,11 +133,13 @@ class Node {
 
   /** Gets a modifiable collection of the Node's input definitions. */
   std::vector<NodeArg*>& MutableInputDefs() noexcept {
+    needs_inference_ = true;
     return definitions_.input_defs;
   }
 
   /** Gets a modifiable collection of the Node's output definitions. */
   std::vector<NodeArg*>& MutableOutputDefs() noexcept {
+    needs_inference_ = true;
     return definitions_.output_defs;
   }
 
@@ -147,7 +149,10 @@ class Node {
   /** Gets a modifiable count of arguments for each of the Node's explicit inputs. 
   @todo This should be removed in favor of a method that updates the input args and the count. 
         Currently these operations are separate which is not a good setup. */
-  std::vector<int>& MutableInputArgsCount() { return definitions_.input_arg_count; }
+  std::vector<int>& MutableInputArgsCount() {
+    needs_inference_ = true;
+    return definitions_.input_arg_count;
+  }
 
   /** Gets the implicit inputs to this Node.  
   If this Node contains a subgraph, these are the NodeArg's that are implicitly consumed by Nodes within that 
@@ -393,6 +398,21 @@ class Node {
   // validate and update the input arg count
   common::Status UpdateInputArgCount();
 
+  // returns true if type and shape inferencing needs to run for the Node given the current version of its inputs
+  bool NeedsInference(uint64_t input_version) const noexcept {
+    return needs_inference_ || op_ == nullptr || !subgraphs_.empty() || input_version != inferred_input_version_;
+  }
+
+  // record that something the Node depends on changed outside of its definitions, e.g. the producer of one of its
+  // inputs was removed, so the next Graph::Resolve validates and infers it again
+  void SetNeedsInference() noexcept { needs_inference_ = true; }
+
+  // record that type and shape inferencing ran for the Node with the given version of its inputs
+  void SetInferred(uint64_t input_version) noexcept {
+    needs_inference_ = false;
+    inferred_input_version_ = input_version;
+  }
+
   // Node index. Default to impossible value rather than 0.
   NodeIndex index_ = std::numeric_limits<NodeIndex>::max();
 
@@ -436,6 +456,13 @@ class Node {
 
   // Graph instances for subgraphs that are owned by this Node
   std::vector<std::unique_ptr<Graph>> subgraphs_;
+
+  // Set when the definitions or attributes of the Node change, so the next Graph::Resolve runs type and shape
+  // inferencing for it. Nodes that are not modified and whose inputs didn't change are not inferred again.
+  bool needs_inference_ = true;
+
+  // Sum of the versions of the input NodeArgs when the Node was last inferred.
+  uint64_t inferred_input_version_ = 0;
 };
 
 /**
@@ -919,6 +946,10 @@ class Graph {
   InitializedTensorSet name_to_initial_tensor_;
   std::vector<int> removed_initializer_indexes_;
 
+  // initializers added or removed since the last Resolve. type and shape inferencing can depend on their values,
+  // so the nodes consuming them are inferred again.
+  std::unordered_set<std::string> modified_initializers_;
+
   Type graph_type_ = Type::Main;
 
   IOnnxRuntimeOpSchemaCollectionPtr schema_registry_;
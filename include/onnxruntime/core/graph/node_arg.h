@@ -91,5 +91,9 @@ class NodeArg {
 
   // Flag indicates whether <*this> node arg exists or not.
   bool exists_;
+
+  // Incremented whenever the type or shape changes. Graph::Resolve compares it with the value seen when the
+  // consumers of this NodeArg were last inferred, to only re-infer the nodes whose inputs changed.
+  uint64_t version_ = 0;
 };
 }  // namespace onnxruntime
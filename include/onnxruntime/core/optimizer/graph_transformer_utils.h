@@ -18,6 +18,7 @@ std::vector<std::unique_ptr<RewriteRule>> GenerateRewriteRules(const Transformer
 
 /* Generates all predefined transformers for this level
 *  If transformers_to_enable is not empty returns intersection of predefined transformers and transformers_to_enable 
+*  Opt-in transformers (ConstantFolding, NchwcTransformer) are only returned when transformers_to_enable names them
 */
 using TransformerProviderSet = std::pair<std::unique_ptr<GraphTransformer>, std::vector<std::string>>;
 std::vector<TransformerProviderSet> GenerateTransformers(const TransformerLevel& level, 
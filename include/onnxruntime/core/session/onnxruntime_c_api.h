@@ -9,6 +9,10 @@
 // This value is used in structures passed to ORT so that a newer version of ORT will still work with
 #define ORT_API_VERSION 1
 
+// Set OrtCustomOp::version to this value to use the OrtCustomOp callbacks added in version 2. Custom ops that set it to
+// ORT_API_VERSION don't read them, so recompiling an existing custom op doesn't make ORT call uninitialized pointers.
+#define ORT_CUSTOM_OP_VERSION_2 2
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -219,6 +223,42 @@ ORT_API(void, OrtDisableMemPattern, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableCpuMemArena, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options);
 
+// Set the options of the CPU memory arena.
+// \param max_bytes upper bound of the memory held by the arena, OrtRun fails with an out of memory error past it.
+//        0 for no bound, the default.
+// \param use_huge_pages back the arena with huge pages if not 0.
+// \param numa_node bind the memory of the arena to this NUMA node. -1, the default, binds it to the node of the CPUs
+//        set with OrtAddSessionInterOpThreadAffinity/OrtAddSessionIntraOpThreadAffinity if they are all on one node,
+//        and doesn't bind it otherwise.
+ORT_API(void, OrtSetCpuMemArenaOptions, _In_ OrtSessionOptions* options, size_t max_bytes, int use_huge_pages,
+        int numa_node);
+
+// Return the seq(map) outputs of ZipMap in a columnar form: the labels are shared and the values are kept dense.
+// OrtGetValueCount and OrtGetValue work on these outputs as usual. The maps returned by OrtGetValue share the
+// columnar storage, and their keys and values are copied on request. Disabled by default.
+ORT_API(void, OrtEnableColumnarMapOutputs, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableColumnarMapOutputs, _In_ OrtSessionOptions* options);
+
+// Deserialize initializers and create kernels on the session thread pool during session creation.
+// Disabled by default.
+ORT_API(void, OrtEnableParallelInitialization, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableParallelInitialization, _In_ OrtSessionOptions* options);
+
+// Let Scan run the entries of a batch concurrently on the session thread pool. Disabled by default.
+ORT_API(void, OrtEnableScanBatchParallelism, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableScanBatchParallelism, _In_ OrtSessionOptions* options);
+
+// Aggregate the kernel latencies by op type and by node, see OrtSessionGetOpStatistics. Disabled by default.
+ORT_API(void, OrtEnableOpStatistics, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableOpStatistics, _In_ OrtSessionOptions* options);
+
+// Share the CPU initializers with the other sessions of the process that have the same initializers, see
+// OrtGetSharedInitializerStatistics. Initializers are matched by content, or by key and initializer name if key is
+// not null or empty, which is faster but requires the sessions using the key to have the same initializers under
+// the same names. Disabled by default.
+ORT_API(void, OrtEnableSharedInitializers, _In_ OrtSessionOptions* options, _In_opt_ const char* key);
+ORT_API(void, OrtDisableSharedInitializers, _In_ OrtSessionOptions* options);
+
 // < logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid);
 
@@ -236,6 +276,21 @@ ORT_API(int, OrtSetSessionGraphOptimizationLevel, _In_ OrtSessionOptions* option
 // How many threads in the session thread pool.
 ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int session_thread_pool_size);
 
+// Add a CPU set for the threads of the session thread pool (inter-op) or for the threads that run the kernels in
+// parallel (intra-op, OpenMP builds only). Thread i runs on the CPUs of the (i % number of sets)-th set, so add one
+// set to confine all the threads to it, or one set per thread to pin each thread.
+// The intra-op affinity applies to the OpenMP threads of the session thread pool and of the threads calling OrtRun.
+// These serve every session the thread runs, so all the live sessions that set an intra-op affinity must set the
+// same one, or session initialization fails.
+// Returns -1 if cpus is empty or has a negative CPU index, 0 otherwise.
+ORT_API(int, OrtAddSessionInterOpThreadAffinity, _In_ OrtSessionOptions* options, _In_ const int* cpus,
+        size_t num_cpus);
+ORT_API(int, OrtAddSessionIntraOpThreadAffinity, _In_ OrtSessionOptions* options, _In_ const int* cpus,
+        size_t num_cpus);
+
+// How many times an idle thread of the session thread pool checks for work before blocking. 0 by default.
+ORT_API(int, OrtSetSessionThreadPoolSpinCount, _In_ OrtSessionOptions* options, int spin_count);
+
 /**
   * To use additional providers, you must build ORT with the extra providers enabled. Then call one of these
   * functions to enable them in the session:
@@ -268,6 +323,23 @@ ORT_API_STATUS(OrtSessionGetInputName, _In_ const OrtSession* sess, size_t index
 ORT_API_STATUS(OrtSessionGetOutputName, _In_ const OrtSession* sess, size_t index,
                _Inout_ OrtAllocator* allocator, _Out_ char** value);
 
+/**
+ * Get the kernel latencies aggregated by the session, see OrtEnableOpStatistics. This can be called at any time,
+ * including while other threads call OrtRun, and doesn't end the profiling enabled by OrtEnableProfiling.
+ * \param reset If non-zero, the statistics are cleared so the next call only covers the runs that follow.
+ * \param value is set to a null terminated JSON string allocated using 'allocator'. The caller is responsible
+ *        in freeing it.
+ */
+ORT_API_STATUS(OrtSessionGetOpStatistics, _In_ OrtSession* sess, int reset,
+               _Inout_ OrtAllocator* allocator, _Out_ char** value);
+
+/**
+ * Get the memory used by the initializers shared by the sessions of the process, see OrtEnableSharedInitializers.
+ * \param bytes is set to the size of the distinct shared initializers.
+ * \param bytes_saved is set to the memory the sessions would use in addition if each had its own copy.
+ */
+ORT_API_STATUS(OrtGetSharedInitializerStatistics, _Out_ size_t* bytes, _Out_ size_t* bytes_saved);
+
 /**
  * \return A pointer to the newly created object. The pointer should be freed by OrtReleaseRunOptions after use
  */
@@ -316,6 +388,19 @@ ORT_API(int, OrtIsTensor, _In_ const OrtValue* value);
  * \param s_len length of s
  */
 ORT_API_STATUS(OrtFillStringTensor, _In_ OrtValue* value, _In_ const char* const* s, size_t s_len);
+
+/**
+ * Fill a string tensor from strings stored in a single buffer, in the layout produced by OrtGetStringTensorContent.
+ * This avoids creating a null terminated copy of each string.
+ * \param value A tensor created from OrtCreateTensor... function.
+ * \param s string contents. Each string is NOT null-terminated.
+ * \param s_len total data length
+ * \param offsets offset of each string in s. A string ends where the next string starts, or at s_len.
+ * \param offsets_len number of offsets, which must be the number of elements in the tensor.
+ */
+ORT_API_STATUS(OrtFillStringTensorContent, _In_ OrtValue* value, _In_ const void* s, size_t s_len,
+               _In_ const size_t* offsets, size_t offsets_len);
+
 /**
  * \param value A tensor created from OrtCreateTensor... function.
  * \param len total data length, not including the trailing '\0' chars.
@@ -503,6 +588,9 @@ ORT_ALL_ARGS_NONNULL;
    * separately. Use index=0 to retrieve keys and index=1 to retrieve values.
    * If input OrtValue represents a sequence, use index to retrieve the index'th element
    * of the sequence.
+   * If the sequence is a columnar sequence of maps (see OrtEnableColumnarMapOutputs) the returned map
+   * shares the storage of the sequence and keeps it alive. The keys and values retrieved from that map are
+   * copied with 'allocator' and sorted by key, as for any other map.
    */
 ORT_API_STATUS(OrtGetValue, const OrtValue* value, int index, OrtAllocator* allocator, OrtValue** out);
 
@@ -534,6 +622,8 @@ ORT_API_STATUS(OrtCreateValue, OrtValue** const in, int num_values, enum ONNXTyp
 */
 struct OrtKernelInfo;
 typedef struct OrtKernelInfo OrtKernelInfo;
+struct OrtKernelContext;
+typedef struct OrtKernelContext OrtKernelContext;
 
 /*
  * These allow reading node attributes during kernel creation
@@ -541,12 +631,27 @@ typedef struct OrtKernelInfo OrtKernelInfo;
 ORT_API_STATUS(OrtKernelInfoGetAttribute_float, _In_ OrtKernelInfo* info, _In_ const char* name, _Out_ float* out);
 ORT_API_STATUS(OrtKernelInfoGetAttribute_int64, _In_ OrtKernelInfo* info, _In_ const char* name, _Out_ int64_t* out);
 
+/*
+ * These can be called from KernelComputeWithContext while the kernel runs.
+ *
+ * OrtKernelContextGetScratchAllocator returns an allocator for temporary buffers of the kernel. The allocator is owned
+ * by the context and must not be used after KernelComputeWithContext returns.
+ *
+ * OrtKernelContextParallelFor calls fn(user_data, i) for each i in [0, count) on the session thread pool, with the
+ * calling thread processing items as well, and returns when all the items are processed. The items run on the calling
+ * thread if the session has no thread pool, which is the case when sequential execution is enabled and neither
+ * parallel initialization nor Scan batch parallelism (OrtEnableScanBatchParallelism) is.
+*/
+ORT_API_STATUS(OrtKernelContextGetScratchAllocator, _In_ OrtKernelContext* context, _Out_ OrtAllocator** out);
+ORT_API_STATUS(OrtKernelContextParallelFor, _In_ OrtKernelContext* context, size_t count,
+               _In_ void(ORT_API_CALL* fn)(_In_opt_ void* user_data, size_t index), _In_opt_ void* user_data);
+
 /*
  * The OrtCustomOp structure defines a custom op's schema and its kernel callbacks. The callbacks are filled in by
  * the implementor of the custom op.
 */
 struct OrtCustomOp {
-  uint32_t version;  // Initialize to ORT_API_VERSION
+  uint32_t version;  // Initialize to ORT_API_VERSION, or to ORT_CUSTOM_OP_VERSION_2 to use the version 2 callbacks
 
   // This callback creates the kernel, which is a user defined parameter that is passed to the Kernel* callbacks below.
   void(ORT_API_CALL* CreateKernel)(_In_ struct OrtCustomOp* op, _In_ OrtKernelInfo* info, _Out_ void** op_kernel);
@@ -564,6 +669,21 @@ struct OrtCustomOp {
   void(ORT_API_CALL* KernelGetOutputShape)(_In_ void* op_kernel, _In_ OrtValue** inputs, _In_ size_t input_count, _In_ size_t output_index, _In_ OrtTensorTypeAndShapeInfo* output);
   void(ORT_API_CALL* KernelCompute)(_In_ void* op_kernel, _In_ OrtValue** inputs, _In_ size_t input_count, _In_ OrtValue** outputs, _In_ size_t output_count);
   void(ORT_API_CALL* KernelDestroy)(_In_ void* op_kernel);
+
+  // The callbacks below were added in version 2 and are only read when version is ORT_CUSTOM_OP_VERSION_2 or more.
+  // All of them must then be initialized, to null for the ones the op doesn't use.
+
+  // Called instead of KernelCompute when set. The context can be passed to the OrtKernelContext* functions.
+  void(ORT_API_CALL* KernelComputeWithContext)(_In_ void* op_kernel, _In_ OrtKernelContext* context, _In_ OrtValue** inputs, _In_ size_t input_count, _In_ OrtValue** outputs, _In_ size_t output_count);
+
+  // Return the index of the input whose buffer the output may reuse, or -1. The kernel must then handle the output
+  // sharing the input buffer (MayInplace), or always sharing it (Alias).
+  int(ORT_API_CALL* GetMayInplaceInput)(_In_ struct OrtCustomOp* op, _In_ size_t output_index);
+  int(ORT_API_CALL* GetAliasInput)(_In_ struct OrtCustomOp* op, _In_ size_t output_index);
+
+  // Called once after CreateKernel for each input that is a constant initializer, so the kernel can transform it
+  // (e.g. re-layout weights) ahead of the first KernelCompute. The value is only valid during the call.
+  void(ORT_API_CALL* KernelPrePackConstantInput)(_In_ void* op_kernel, _In_ size_t input_index, _In_ const OrtValue* value);
 };
 typedef struct OrtCustomOp OrtCustomOp;
 
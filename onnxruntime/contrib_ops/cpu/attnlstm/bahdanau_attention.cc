@@ -3,6 +3,7 @@
 
 #include "bahdanau_attention.h"
 #include "core/providers/cpu/rnn/rnn_helpers.h"
+#include "core/mlas/inc/mlas.h"
 
 #include <stdexcept>
 #include <memory.h>
@@ -79,30 +80,6 @@ void BahdanauAttention<T>::PrepareMemory(
                                keys_.data(), attn_depth_, &CPUMathUtil::Instance());
 }
 
-template <typename T>
-static void SoftmaxInplace(const gsl::span<T>& alignments) {
-  T* x = alignments.data();
-  size_t len = alignments.size();
-
-  double sum = 0.0;
-
-  for (size_t i = 0; i < len; i++) {
-    T e = exp(x[i]);
-    sum += e;
-    x[i] = e;
-  }
-
-  if (sum == 0.0) {
-    for (size_t i = 0; i < len; i++) {
-      x[i] = static_cast<T>(1.0 / len);
-    }
-  } else {
-    for (size_t i = 0; i < len; i++) {
-      x[i] = static_cast<T>(x[i] / sum);
-    }
-  }
-}
-
 /**
   * Args:
   *     queries: Tensor, shape `[batch_size_, query_depth_]` to compare to keys.
@@ -141,7 +118,8 @@ void BahdanauAttention<T>::Compute(
       }
     }
 
-    SoftmaxInplace(gsl::span<T>{alignments, mem_steps});
+    // the row max is subtracted before exponentiation, so the sum of the exponentials is at least 1
+    MlasComputeSoftmax(alignments, alignments, 1, static_cast<size_t>(mem_steps), false);
 
     // Calculate the context
     auto outspan = output.subspan(b * memory_depth_);
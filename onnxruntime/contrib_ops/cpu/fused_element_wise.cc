@@ -0,0 +1,400 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/fused_element_wise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math_cpuonly.h"
+#include <unsupported/Eigen/SpecialFunctions>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    FusedElementWise,
+    1,
+    float,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    FusedElementWise);
+
+namespace {
+
+// Number of elements evaluated by each step of the chain before moving to the next step. The results of the
+// steps for a tile are kept in the cache.
+constexpr size_t kTileSize = 1024;
+
+float DefaultAlpha(FusedElementWise::Operation operation) {
+  switch (operation) {
+    case FusedElementWise::Operation::LeakyRelu:
+      return 0.01f;
+    case FusedElementWise::Operation::Elu:
+      return 1.0f;
+    case FusedElementWise::Operation::Selu:
+      return 1.67326319217681884765625f;
+    case FusedElementWise::Operation::HardSigmoid:
+      return 0.2f;
+    default:
+      return 0.0f;
+  }
+}
+
+float DefaultBeta(FusedElementWise::Operation operation) {
+  switch (operation) {
+    case FusedElementWise::Operation::Selu:
+      return 1.05070102214813232421875f;
+    case FusedElementWise::Operation::HardSigmoid:
+      return 0.5f;
+    default:
+      return 0.0f;
+  }
+}
+
+template <typename Op>
+void ComputeBinary(const FusedElementWise::Operand& a, const FusedElementWise::Operand& b,
+                   float* output, size_t count, Op op) {
+  if (a.broadcast) {
+    const float a_value = a.data[0];
+    for (size_t i = 0; i < count; i++) {
+      output[i] = op(a_value, b.data[i]);
+    }
+  } else if (b.broadcast) {
+    const float b_value = b.data[0];
+    for (size_t i = 0; i < count; i++) {
+      output[i] = op(a.data[i], b_value);
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      output[i] = op(a.data[i], b.data[i]);
+    }
+  }
+}
+
+}  // namespace
+
+FusedElementWise::FusedElementWise(const OpKernelInfo& info) : OpKernel(info) {
+  static const std::unordered_map<std::string, Operation> operations = {
+      {"Add", Operation::Add},
+      {"Sub", Operation::Sub},
+      {"Mul", Operation::Mul},
+      {"Div", Operation::Div},
+      {"Pow", Operation::Pow},
+      {"Max", Operation::Max},
+      {"Min", Operation::Min},
+      {"PRelu", Operation::PRelu},
+      {"Neg", Operation::Neg},
+      {"Abs", Operation::Abs},
+      {"Reciprocal", Operation::Reciprocal},
+      {"Floor", Operation::Floor},
+      {"Ceil", Operation::Ceil},
+      {"Sqrt", Operation::Sqrt},
+      {"Exp", Operation::Exp},
+      {"Log", Operation::Log},
+      {"Erf", Operation::Erf},
+      {"Relu", Operation::Relu},
+      {"LeakyRelu", Operation::LeakyRelu},
+      {"Sigmoid", Operation::Sigmoid},
+      {"Tanh", Operation::Tanh},
+      {"Elu", Operation::Elu},
+      {"Selu", Operation::Selu},
+      {"HardSigmoid", Operation::HardSigmoid},
+      {"Softsign", Operation::Softsign},
+      {"Softplus", Operation::Softplus},
+  };
+
+  std::vector<std::string> ops;
+  std::vector<int64_t> operands;
+  ORT_ENFORCE(info.GetAttrs<std::string>("ops", ops).IsOK());
+  ORT_ENFORCE(info.GetAttrs<int64_t>("operands", operands).IsOK());
+  ORT_ENFORCE(!ops.empty() && operands.size() == 2 * ops.size(), "invalid operands for ", ops.size(), " steps");
+  std::vector<float> alphas = info.GetAttrsOrDefault<float>("alphas");
+  std::vector<float> betas = info.GetAttrsOrDefault<float>("betas");
+  ORT_ENFORCE(alphas.empty() || alphas.size() == ops.size(), "invalid alphas for ", ops.size(), " steps");
+  ORT_ENFORCE(betas.empty() || betas.size() == ops.size(), "invalid betas for ", ops.size(), " steps");
+
+  const int64_t input_count = static_cast<int64_t>(info.node().InputDefs().size());
+
+  steps_.reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); i++) {
+    auto it = operations.find(ops[i]);
+    ORT_ENFORCE(it != operations.end(), "unsupported operator in fused element-wise chain: ", ops[i]);
+
+    Step step;
+    step.operation = it->second;
+    step.binary = step.operation <= Operation::PRelu;
+    step.operands[0] = operands[2 * i];
+    step.operands[1] = operands[2 * i + 1];
+    step.alpha = alphas.empty() ? DefaultAlpha(step.operation) : alphas[i];
+    step.beta = betas.empty() ? DefaultBeta(step.operation) : betas[i];
+
+    // Operands refer to an input or to the result of a previous step.
+    const int64_t operand_limit = input_count + static_cast<int64_t>(i);
+    ORT_ENFORCE(step.operands[0] >= 0 && step.operands[0] < operand_limit, "invalid operand for step ", i);
+    if (step.binary) {
+      ORT_ENFORCE(step.operands[1] >= 0 && step.operands[1] < operand_limit, "invalid operand for step ", i);
+    } else {
+      ORT_ENFORCE(step.operands[1] == -1, "unary step ", i, " has a second operand");
+    }
+
+    steps_.push_back(step);
+  }
+}
+
+FusedElementWise::Operand FusedElementWise::ComputeStep(const Step& step, const Operand* operands,
+                                                        float* output, size_t count) const {
+  const Operand& a = operands[0];
+
+  if (!step.binary) {
+    // A broadcast operand produces a broadcast result.
+    const size_t n = a.broadcast ? 1 : count;
+    auto x = ConstEigenVectorArrayMap<float>(a.data, n);
+    auto y = EigenVectorArrayMap<float>(output, n);
+
+    switch (step.operation) {
+      case Operation::Neg:
+        y = -x;
+        break;
+      case Operation::Abs:
+        y = x.abs();
+        break;
+      case Operation::Reciprocal:
+        y = x.inverse();
+        break;
+      case Operation::Floor:
+        y = x.floor();
+        break;
+      case Operation::Ceil:
+        y = x.ceil();
+        break;
+      case Operation::Sqrt:
+        y = x.sqrt();
+        break;
+      case Operation::Exp:
+        MlasComputeExp(a.data, output, n);
+        break;
+      case Operation::Log:
+        y = x.log();
+        break;
+      case Operation::Erf:
+        y = x.erf();
+        break;
+      case Operation::Relu:
+        y = x.cwiseMax(0.0f);
+        break;
+      case Operation::LeakyRelu:
+        y = (x >= 0).select(x, step.alpha * x);
+        break;
+      case Operation::Sigmoid:
+        MlasComputeLogistic(a.data, output, n);
+        break;
+      case Operation::Tanh:
+        MlasComputeTanh(a.data, output, n);
+        break;
+      case Operation::Elu:
+        y = (x >= 0).select(x, step.alpha * (x.exp() - 1.0f));
+        break;
+      case Operation::Selu:
+        y = step.beta * (x.cwiseMax(0.0f) + (step.alpha * (x.exp() - 1.0f)).cwiseMin(0.0f));
+        break;
+      case Operation::HardSigmoid:
+        y = (step.alpha * x + step.beta).cwiseMin(1.0f).cwiseMax(0.0f);
+        break;
+      case Operation::Softsign:
+        y = (1.0f + x.abs()).inverse() * x;
+        break;
+      case Operation::Softplus:
+        y = (x > 0).select(x + ((-x).exp() + 1.0f).log(), (x.exp() + 1.0f).log());
+        break;
+      default:
+        ORT_THROW("unexpected unary operation");
+    }
+
+    return {output, a.broadcast};
+  }
+
+  const Operand& b = operands[1];
+  const bool broadcast = a.broadcast && b.broadcast;
+  const size_t n = broadcast ? 1 : count;
+
+  switch (step.operation) {
+    case Operation::Add:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return x + y; });
+      break;
+    case Operation::Sub:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return x - y; });
+      break;
+    case Operation::Mul:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return x * y; });
+      break;
+    case Operation::Div:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return x / y; });
+      break;
+    case Operation::Pow:
+      // Squaring is common in normalization layers and does not need the general power function.
+      if (b.broadcast && b.data[0] == 2.0f) {
+        ComputeBinary(a, b, output, n, [](float x, float) { return x * x; });
+      } else {
+        ComputeBinary(a, b, output, n, [](float x, float y) { return std::pow(x, y); });
+      }
+      break;
+    case Operation::Max:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return std::max(x, y); });
+      break;
+    case Operation::Min:
+      ComputeBinary(a, b, output, n, [](float x, float y) { return std::min(x, y); });
+      break;
+    case Operation::PRelu:
+      ComputeBinary(a, b, output, n, [](float x, float slope) { return x > 0 ? x : slope * x; });
+      break;
+    default:
+      ORT_THROW("unexpected binary operation");
+  }
+
+  return {output, broadcast};
+}
+
+Status FusedElementWise::Compute(OpKernelContext* context) const {
+  const int input_count = context->InputCount();
+
+  // The output has the multidirectional broadcast shape of the inputs.
+  size_t rank = 0;
+  for (int i = 0; i < input_count; i++) {
+    rank = std::max(rank, context->Input<Tensor>(i)->Shape().NumDimensions());
+  }
+  std::vector<int64_t> output_dims(rank, 1);
+  for (int i = 0; i < input_count; i++) {
+    const auto& input_dims = context->Input<Tensor>(i)->Shape().GetDims();
+    const size_t offset = rank - input_dims.size();
+    for (size_t d = 0; d < input_dims.size(); d++) {
+      int64_t& output_dim = output_dims[offset + d];
+      if (input_dims[d] != output_dim) {
+        if (output_dim == 1) {
+          output_dim = input_dims[d];
+        } else if (input_dims[d] != 1) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "FusedElementWise: input ", i,
+                                 " cannot be broadcast to the shape of the other inputs");
+        }
+      }
+    }
+  }
+
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  // Describe each input by its stride along the dimensions of the output, with a zero stride for the
+  // dimensions that are broadcast. Adjacent dimensions that are traversed contiguously by every input are
+  // coalesced, so that the innermost dimension is as long as possible.
+  std::vector<std::vector<int64_t>> input_strides(input_count, std::vector<int64_t>(rank, 0));
+  for (int i = 0; i < input_count; i++) {
+    const auto& input_dims = context->Input<Tensor>(i)->Shape().GetDims();
+    const size_t offset = rank - input_dims.size();
+    int64_t pitch = 1;
+    for (size_t d = input_dims.size(); d-- > 0;) {
+      input_strides[i][offset + d] = input_dims[d] == 1 ? 0 : pitch;
+      pitch *= input_dims[d];
+    }
+  }
+
+  std::vector<int64_t> dims;
+  std::vector<std::vector<int64_t>> strides(input_count);
+  for (size_t d = 0; d < rank; d++) {
+    if (output_dims[d] == 1) {
+      continue;
+    }
+    bool coalesce = !dims.empty();
+    for (int i = 0; coalesce && i < input_count; i++) {
+      coalesce = strides[i].back() == input_strides[i][d] * output_dims[d];
+    }
+    if (coalesce) {
+      dims.back() *= output_dims[d];
+      for (int i = 0; i < input_count; i++) {
+        strides[i].back() = input_strides[i][d];
+      }
+    } else {
+      dims.push_back(output_dims[d]);
+      for (int i = 0; i < input_count; i++) {
+        strides[i].push_back(input_strides[i][d]);
+      }
+    }
+  }
+  if (dims.empty()) {
+    dims.push_back(1);
+    for (int i = 0; i < input_count; i++) {
+      strides[i].push_back(0);
+    }
+  }
+
+  const size_t outer_rank = dims.size() - 1;
+  const int64_t row_size = dims.back();
+  const int64_t row_count = Y->Shape().Size() / row_size;
+
+  std::vector<const float*> input_data(input_count);
+  for (int i = 0; i < input_count; i++) {
+    input_data[i] = context->Input<Tensor>(i)->template Data<float>();
+  }
+  float* y_data = Y->template MutableData<float>();
+
+  // The final step writes the output directly, the other steps write to a tile of the scratch buffer.
+  const size_t tile_size = std::min(kTileSize, static_cast<size_t>(row_size));
+  std::vector<float> scratch(tile_size * (steps_.size() - 1));
+
+  std::vector<Operand> values(input_count + steps_.size());
+  std::vector<int64_t> input_offsets(input_count, 0);
+  std::vector<int64_t> counters(outer_rank, 0);
+
+  for (int64_t row = 0; row < row_count; row++) {
+    float* y_row = y_data + row * row_size;
+
+    for (int64_t start = 0; start < row_size; start += static_cast<int64_t>(tile_size)) {
+      const size_t count = static_cast<size_t>(std::min(row_size - start, static_cast<int64_t>(tile_size)));
+
+      for (int i = 0; i < input_count; i++) {
+        const int64_t inner_stride = strides[i].back();
+        values[i].data = input_data[i] + input_offsets[i] + inner_stride * start;
+        values[i].broadcast = inner_stride == 0;
+      }
+
+      for (size_t s = 0; s < steps_.size(); s++) {
+        const Step& step = steps_[s];
+        const bool is_last = s + 1 == steps_.size();
+        float* output = is_last ? y_row + start : scratch.data() + s * tile_size;
+
+        Operand operands[2];
+        operands[0] = values[step.operands[0]];
+        if (step.binary) {
+          operands[1] = values[step.operands[1]];
+        }
+
+        Operand result = ComputeStep(step, operands, output, count);
+        if (is_last && result.broadcast) {
+          const float value = result.data[0];
+          std::fill_n(output, count, value);
+        }
+        values[input_count + s] = result;
+      }
+    }
+
+    // Advance the input offsets to the next row.
+    for (size_t d = outer_rank; d-- > 0;) {
+      for (int i = 0; i < input_count; i++) {
+        input_offsets[i] += strides[i][d];
+      }
+      if (++counters[d] < dims[d]) {
+        break;
+      }
+      counters[d] = 0;
+      for (int i = 0; i < input_count; i++) {
+        input_offsets[i] -= strides[i][d] * dims[d];
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Evaluates a chain of element-wise operators fused by the ElementWiseFusion transformer. The output is computed
+// one tile at a time and every step of the chain is applied to the tile before moving to the next one, so the
+// intermediate values of the chain stay in the cache instead of being written to full size tensors.
+class FusedElementWise final : public OpKernel {
+ public:
+  FusedElementWise(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  enum class Operation {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Pow,
+    Max,
+    Min,
+    PRelu,
+    Neg,
+    Abs,
+    Reciprocal,
+    Floor,
+    Ceil,
+    Sqrt,
+    Exp,
+    Log,
+    Erf,
+    Relu,
+    LeakyRelu,
+    Sigmoid,
+    Tanh,
+    Elu,
+    Selu,
+    HardSigmoid,
+    Softsign,
+    Softplus,
+  };
+
+  // Operand of a step for the current tile. A broadcast operand has the same value for every element of the tile.
+  struct Operand {
+    const float* data;
+    bool broadcast;
+  };
+
+ private:
+  struct Step {
+    Operation operation;
+    bool binary;
+    // Index of an input of the node or, offset by the input count, of the result of a previous step.
+    int64_t operands[2];
+    float alpha;
+    float beta;
+  };
+
+  Operand ComputeStep(const Step& step, const Operand* operands, float* output, size_t count) const;
+
+  std::vector<Step> steps_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
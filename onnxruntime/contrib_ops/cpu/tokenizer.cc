@@ -10,8 +10,7 @@
 #include "core/common/utf8_util.h"
 #include "re2/re2.h"
 
-#include <codecvt>
-#include <locale>
+#include <set>
 
 namespace onnxruntime {
 namespace contrib {
@@ -60,16 +59,14 @@ namespace tokenizer_details {
 const char start_text = 0x2;
 const char end_text = 0x3;
 
-const std::string conv_error("Conversion Error");
-const std::wstring wconv_error(L"Conversion Error");
-
 // Use a Trie like structure for searching multiple strings
 // at once but convert it to a ternary tree for saving space.
 // We insert separators in the same order they are specified.
 // Template parameter is a CharT which can be a char/wchar_t
 // or anything else that supports operator ><,== as long as
-// this is not a variable length sequence. We convert utf8 to utf16
-// before inserting.
+// this is not a variable length sequence. Separators are inserted
+// as utf8 bytes, which match the same characters as long as the
+// search only starts at character boundaries.
 // Value is a supplementary information useful for search hit
 // and is present in the nodes that terminate the whole search pattern
 template <class CharT, class Value>
@@ -212,19 +209,29 @@ class TernarySearchTree {
 // Ternary Tree. This allows us to cut out the length of the matching
 // separator from the original string.
 struct SearchValue {
-  size_t w_len;
+  size_t len;  // in bytes
   int priority_;
   bool operator<(const SearchValue& o) const {
     return priority_ < o.priority_;
   }
 };
 
+// Number of characters in a valid utf8 string,
+// which are the bytes that are not continuation bytes.
+inline size_t Utf8Chars(const char* s, size_t len) {
+  size_t chars = 0;
+  for (size_t i = 0; i < len; ++i) {
+    chars += (static_cast<unsigned char>(s[i]) & 0xC0u) != 0x80u;
+  }
+  return chars;
+}
+
 }  // namespace tokenizer_details
 
 using namespace tokenizer_details;
 
 struct Tokenizer::SearchData {
-  TernarySearchTree<wchar_t, SearchValue> tst_;
+  TernarySearchTree<char, SearchValue> tst_;
 };
 
 Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
@@ -262,13 +269,13 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
   if (!char_tokenezation_) {
     if (!separators.empty()) {
       std::unique_ptr<SearchData> sd(std::make_unique<SearchData>());
-      std::wstring_convert<std::codecvt_utf8<wchar_t>> converter(conv_error, wconv_error);
       int priority = 0;  // earlier search patterns get priority
       for (const auto& sep : separators) {
         ORT_ENFORCE(!sep.empty(), "No empty separators allowed");
-        std::wstring wsep = converter.from_bytes(sep);
-        ORT_ENFORCE(wsep != wconv_error, "Separator strings contains invalid utf8 chars");
-        bool result = sd->tst_.put(wsep.c_str(), wsep.length(), {wsep.length(), priority});
+        size_t utf8_chars = 0;
+        ORT_ENFORCE(utf8_validate(reinterpret_cast<const unsigned char*>(sep.data()), sep.size(), utf8_chars),
+                    "Separator strings contains invalid utf8 chars");
+        bool result = sd->tst_.put(sep.data(), sep.size(), {sep.size(), priority});
         ORT_ENFORCE(result, "duplicate separator detected");
         ++priority;
       }
@@ -341,7 +348,7 @@ Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
       assert(result);
       (void)result;
       assert(token_idx + tlen <= str_len);
-      *(output_data + output_index) = s.substr(token_idx, tlen);
+      (output_data + output_index)->assign(s.data() + token_idx, tlen);
       ++output_index;
       token_idx += tlen;
       ++tokens;
@@ -377,65 +384,67 @@ Status Tokenizer::SeparatorTokenize(OpKernelContext* ctx,
     }
   };
 
-  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter(conv_error, wconv_error);
   // Scan all strings and attempt to find separators in them
-  // collect all the output tokens here
+  // collect all the output tokens here. A token refers to the utf8 chars of the input
+  // string it was found in, so it is not copied until it is written to the output.
+  // The strings are searched as utf8 bytes, one character boundary at a time, so
+  // matches and tokens are in bytes.
   size_t max_tokens = 0;
-  std::vector<std::vector<std::wstring>> tokenized_strings;
-  tokenized_strings.reserve(N * C);
+  std::vector<re2::StringPiece> tokens;
+  std::vector<size_t> row_sizes;
+  row_sizes.reserve(N * C);
   auto X = ctx->Input<Tensor>(0);
   auto const input_data = X->template Data<std::string>();
   auto curr_input = input_data;
   auto const last = input_data + N * C;
   while (curr_input != last) {
     const auto& s = *curr_input;
-    std::wstring wstr = converter.from_bytes(s);
-    if (wstr == wconv_error) {
+    size_t utf8_chars = 0;
+    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(), utf8_chars)) {
       return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
                     "Invalid utf8 chars in the input: " + s);
     }
 
     std::set<Match> matches;
-    const wchar_t* ws = wstr.c_str();
-    size_t len_remaining = wstr.length();
+    const size_t str_len = s.size();
     size_t offset = 0;
-    while (len_remaining > 0) {
-      const auto* val = search_data_->tst_.get(ws, len_remaining);
+    while (offset < str_len) {
+      const auto* val = search_data_->tst_.get(s.data() + offset, str_len - offset);
       if (val != nullptr) {
-        auto p = matches.insert({val->priority_, offset, val->w_len});
+        auto p = matches.insert({val->priority_, offset, val->len});
         while (!p.second && val->priority_ < p.first->priority_) {
           // if overlapping matches of the same pattern(priority), then
           // the earlier match naturally wins
           matches.erase(p.first);
-          p = matches.insert({val->priority_, offset, val->w_len});
+          p = matches.insert({val->priority_, offset, val->len});
         }
       }
-      ++ws;
-      ++offset;
-      --len_remaining;
+      size_t char_len = 0;
+      bool result = utf8_bytes(static_cast<unsigned char>(s[offset]), char_len);
+      assert(result);
+      (void)result;
+      offset += char_len;
     }
 
     // Tokenize
-    tokenized_strings.emplace_back();
-    auto& row_tokens = tokenized_strings.back();
-    row_tokens.reserve(matches.size() + 1);
-    ws = wstr.c_str();
+    const size_t row_start = tokens.size();
     offset = 0;
     for (const auto& m : matches) {
       assert(m.offset_ >= offset);
       size_t sz = (m.offset_ - offset);
-      if (sz > 0 && sz >= size_t(mincharnum_)) {
-        row_tokens.emplace_back(ws, sz);
+      // mincharnum is in characters
+      if (sz > 0 && Utf8Chars(s.data() + offset, sz) >= size_t(mincharnum_)) {
+        tokens.emplace_back(s.data() + offset, sz);
       }
       offset = m.offset_ + m.size_;
-      ws = wstr.c_str() + offset;
     }
-    assert(offset <= wstr.length());
-    if (offset < wstr.length()) {
-      row_tokens.emplace_back(ws, wstr.length() - offset);
+    assert(offset <= str_len);
+    if (offset < str_len) {
+      tokens.emplace_back(s.data() + offset, str_len - offset);
     }
 
-    max_tokens = std::max(max_tokens, row_tokens.size());
+    row_sizes.push_back(tokens.size() - row_start);
+    max_tokens = std::max(max_tokens, row_sizes.back());
     ++curr_input;
   }
 
@@ -463,7 +472,8 @@ Status Tokenizer::SeparatorTokenize(OpKernelContext* ctx,
   const size_t max_output_index = N * C * max_tokens;
 #endif
   size_t output_index = 0;
-  for (auto& row : tokenized_strings) {
+  auto token = tokens.cbegin();
+  for (auto row_size : row_sizes) {
 #ifdef _DEBUG
     size_t c_idx = output_index;
 #endif
@@ -472,15 +482,15 @@ Status Tokenizer::SeparatorTokenize(OpKernelContext* ctx,
       ++output_index;
     }
     // Output tokens for this row
-    for (auto& token : row) {
-      *(output_data + output_index) = converter.to_bytes(token);
+    for (size_t t = 0; t < row_size; ++t, ++token) {
+      (output_data + output_index)->assign(token->data(), token->length());
       ++output_index;
     }
     if (mark_) {
       (output_data + output_index)->assign(&end_text, 1);
       ++output_index;
     }
-    const size_t pads = max_tokens - (mark_ * 2) - row.size();
+    const size_t pads = max_tokens - (mark_ * 2) - row_size;
     for (size_t p = 0; p < pads; ++p) {
       *(output_data + output_index) = pad_value_;
       ++output_index;
@@ -497,10 +507,11 @@ Status Tokenizer::ExpressionTokenize(OpKernelContext* ctx,
                                      size_t N, size_t C,
                                      const std::vector<int64_t>& input_dims) const {
   using namespace re2;
-  // Represents a token that will be output after
-  // first is the index, second is the size;
-  std::vector<std::vector<StringPiece>> tokens;
-  tokens.reserve(N * C);
+  // The tokens of all the rows, referring to the chars of the input strings.
+  // The number of tokens of each row is in row_sizes.
+  std::vector<StringPiece> tokens;
+  std::vector<size_t> row_sizes;
+  row_sizes.reserve(N * C);
 
   size_t max_tokens = 0;
   auto X = ctx->Input<Tensor>(0);
@@ -514,8 +525,7 @@ Status Tokenizer::ExpressionTokenize(OpKernelContext* ctx,
 
   while (curr_input != last) {
     const auto& s = *curr_input;
-    tokens.emplace_back();
-    auto& row = tokens.back();
+    const size_t row_start = tokens.size();
 
     StringPiece text(s);
     const auto end_pos = s.length();
@@ -534,14 +544,15 @@ Status Tokenizer::ExpressionTokenize(OpKernelContext* ctx,
         // sure we make progress either way
         auto token_len = submatch.length();
         if (token_len > 0) {
-          row.push_back(submatch);
+          tokens.push_back(submatch);
           start_pos = match_pos + token_len;
         } else {
           start_pos = match_pos + 1;
         }
       }
     } while (match);
-    max_tokens = std::max(max_tokens, row.size());
+    row_sizes.push_back(tokens.size() - row_start);
+    max_tokens = std::max(max_tokens, row_sizes.back());
     ++curr_input;
   }
 
@@ -571,7 +582,8 @@ Status Tokenizer::ExpressionTokenize(OpKernelContext* ctx,
 #endif
   curr_input = input_data;
   size_t output_index = 0;
-  for (const auto& row : tokens) {
+  auto token = tokens.cbegin();
+  for (auto row_size : row_sizes) {
     assert(curr_input != last);
 #ifdef _DEBUG
     size_t c_idx = output_index;
@@ -581,15 +593,15 @@ Status Tokenizer::ExpressionTokenize(OpKernelContext* ctx,
       ++output_index;
     }
     // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.length());
+    for (size_t t = 0; t < row_size; ++t, ++token) {
+      (output_data + output_index)->assign(token->data(), token->length());
       ++output_index;
     }
     if (mark_) {
       (output_data + output_index)->assign(&end_text, 1);
       ++output_index;
     }
-    const size_t pads = max_tokens - (mark_ * 2) - row.size();
+    const size_t pads = max_tokens - (mark_ * 2) - row_size;
     for (size_t p = 0; p < pads; ++p) {
       *(output_data + output_index) = pad_value_;
       ++output_index;
@@ -3,10 +3,198 @@
 
 #include "profiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
 namespace onnxruntime {
 namespace profiling {
 using namespace std::chrono;
 
+void LatencyStatistics::Add(long long duration) {
+  ++count;
+  total += duration;
+  min = std::min(min, duration);
+  max = std::max(max, duration);
+
+  size_t bucket = 0;
+  for (auto d = static_cast<unsigned long long>(std::max(duration, 0LL)); d != 0 && bucket < kNumBuckets - 1;
+       d >>= 1) {
+    ++bucket;
+  }
+  ++histogram[bucket];
+}
+
+static void WriteJsonString(std::ostream& out, const std::string& str) {
+  out << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+static void WriteJson(std::ostream& out, const std::map<std::string, LatencyStatistics>& statistics) {
+  out << "{";
+  bool is_first = true;
+  for (const auto& entry : statistics) {
+    const LatencyStatistics& stats = entry.second;
+    if (!is_first) out << ",";
+    is_first = false;
+
+    WriteJsonString(out, entry.first);
+    out << " : {\"count\" : " << stats.count
+        << ", \"total_us\" : " << stats.total
+        << ", \"min_us\" : " << (stats.count == 0 ? 0 : stats.min)
+        << ", \"max_us\" : " << stats.max
+        << ", \"histogram\" : [";
+
+    size_t num_buckets = stats.histogram.size();
+    while (num_buckets > 0 && stats.histogram[num_buckets - 1] == 0) {
+      --num_buckets;
+    }
+    for (size_t i = 0; i < num_buckets; ++i) {
+      if (i != 0) out << ",";
+      out << stats.histogram[i];
+    }
+    out << "]}";
+  }
+  out << "}";
+}
+
+std::string OpStatistics::ToJson() const {
+  std::ostringstream out;
+  out << "{\"op_types\" : ";
+  WriteJson(out, op_types);
+  out << ", \"nodes\" : ";
+  WriteJson(out, nodes);
+  out << "}";
+  return out.str();
+}
+
+/*
+Single producer, single consumer ring buffer of the kernel times recorded by one thread.
+The thread that owns the buffer is the producer. Consumers hold op_statistics_mutex_ of the profiler,
+so there is only one consumer at a time.
+*/
+class Profiler::ThreadBuffer {
+ public:
+  // Try to add a record. Returns false if the buffer is full.
+  bool TryPush(const KernelTimeRecord& record) noexcept {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+
+    records_[head & (kCapacity - 1)] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename TFunc>
+  void Consume(TFunc func) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    for (size_t i = tail; i != head; ++i) {
+      func(records_[i & (kCapacity - 1)]);
+    }
+    tail_.store(head, std::memory_order_release);
+  }
+
+ private:
+  static constexpr size_t kCapacity = 1024;  // must be a power of 2
+
+  std::array<KernelTimeRecord, kCapacity> records_;
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+uint64_t Profiler::NextProfilerId() {
+  static std::atomic<uint64_t> next_id{0};
+  return next_id++;
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer() {
+  // the buffers of the profilers this thread has recorded to. a thread usually runs a handful of sessions,
+  // so a linear search is faster than a map.
+  thread_local std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+  for (const auto& entry : buffers) {
+    if (entry.first == id_) {
+      return *entry.second;
+    }
+  }
+
+  // drop the buffers of the profilers that were destroyed
+  buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                               [](const std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>& entry) {
+                                 return entry.second.use_count() == 1;
+                               }),
+                buffers.end());
+
+  auto buffer = std::make_shared<ThreadBuffer>();
+  {
+    std::lock_guard<OrtMutex> lock(op_statistics_mutex_);
+    // a new thread is a good time to drop the buffers of the threads that exited, so callers that use a thread
+    // per request don't accumulate them even if they never get the statistics.
+    MoveToOpStatistics();
+    thread_buffers_.push_back(buffer);
+  }
+  buffers.emplace_back(id_, buffer);
+  return *buffer;
+}
+
+void Profiler::MoveToOpStatistics(ThreadBuffer& buffer) {
+  buffer.Consume([this](const KernelTimeRecord& record) {
+    op_statistics_.op_types[*record.op_type].Add(record.duration);
+    op_statistics_.nodes[*record.node_name].Add(record.duration);
+  });
+}
+
+void Profiler::MoveToOpStatistics() {
+  // a buffer only referenced here belongs to a thread that exited, so it won't get new records once drained.
+  // the fence makes the records pushed before the thread released its reference visible to Consume.
+  std::vector<bool> exited(thread_buffers_.size());
+  for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+    exited[i] = thread_buffers_[i].use_count() == 1;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  size_t num_kept = 0;
+  for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+    MoveToOpStatistics(*thread_buffers_[i]);
+    if (!exited[i]) {
+      thread_buffers_[num_kept++] = std::move(thread_buffers_[i]);
+    }
+  }
+  thread_buffers_.resize(num_kept);
+}
+
+void Profiler::RecordKernelTime(const std::string& node_name, const std::string& op_type,
+                                const TimePoint& start_time) {
+  const KernelTimeRecord record{&node_name, &op_type, TimeDiffMicroSeconds(start_time)};
+  ThreadBuffer& buffer = GetThreadBuffer();
+  while (!buffer.TryPush(record)) {
+    // the buffer is full. move its records to the statistics, which takes the lock once per buffer size kernels.
+    std::lock_guard<OrtMutex> lock(op_statistics_mutex_);
+    MoveToOpStatistics(buffer);
+  }
+}
+
+OpStatistics Profiler::GetOpStatistics(bool reset) {
+  std::lock_guard<OrtMutex> lock(op_statistics_mutex_);
+  MoveToOpStatistics();
+
+  if (!reset) {
+    return op_statistics_;
+  }
+
+  OpStatistics statistics;
+  std::swap(statistics, op_statistics_);
+  return statistics;
+}
+
 ::onnxruntime::TimePoint profiling::Profiler::StartTime() const {
   return std::chrono::high_resolution_clock::now();
 }
@@ -2,8 +2,12 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <array>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <tuple>
 #include <initializer_list>
 #include "core/platform/ort_mutex.h"
@@ -13,6 +17,36 @@ namespace onnxruntime {
 
 namespace profiling {
 
+/**
+ * Latency statistics of a node or an op type, in microseconds.
+ * histogram[0] counts the runs that took less than 1us, and histogram[i] the runs that took at least 2^(i-1)us
+ * and less than 2^i us. The last bucket also counts all longer runs.
+ */
+struct LatencyStatistics {
+  static constexpr size_t kNumBuckets = 32;
+
+  uint64_t count{0};
+  long long total{0};
+  long long min{std::numeric_limits<long long>::max()};
+  long long max{0};
+  std::array<uint64_t, kNumBuckets> histogram{};
+
+  void Add(long long duration);
+};
+
+/**
+ * Kernel latencies aggregated by op type and by node name.
+ */
+struct OpStatistics {
+  std::map<std::string, LatencyStatistics> op_types;
+  std::map<std::string, LatencyStatistics> nodes;
+
+  // {"op_types" : {"<op type>" : {"count" : n, "total_us" : n, "min_us" : n, "max_us" : n, "histogram" : [...]}, ...},
+  //  "nodes" : {...}}
+  // Trailing empty buckets are omitted from the histograms.
+  std::string ToJson() const;
+};
+
 /**
  * Main class for profiling. It continues to accumulate events and produce
  * a corresponding "complete event (X)" in "chrome tracing" format.
@@ -64,9 +98,48 @@ class Profiler {
   */
   std::string EndProfiling();
 
+  /*
+  Start aggregating kernel latencies. Unlike the events above, recording a kernel time doesn't allocate
+  or take a lock: each thread writes to its own ring buffer, which is only read when the buffer is full
+  or GetOpStatistics is called. The statistics are kept until the profiler is destroyed, so this can be
+  left on in production.
+  */
+  void EnableOpStatistics() { op_statistics_enabled_ = true; }
+
+  bool FOpStatisticsEnabled() const {
+    return op_statistics_enabled_;
+  }
+
+  /*
+  Record the time a kernel took from start_time till the call of this function.
+  The strings are not copied and must outlive the profiler, as the names of the nodes of the graph do.
+  */
+  void RecordKernelTime(const std::string& node_name, const std::string& op_type, const TimePoint& start_time);
+
+  /*
+  Get the kernel latencies recorded so far by all threads. If reset is true the statistics are cleared,
+  so the next call only covers the kernels run after this one.
+  */
+  OpStatistics GetOpStatistics(bool reset = false);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Profiler);
 
+  struct KernelTimeRecord {
+    const std::string* node_name;
+    const std::string* op_type;
+    long long duration;
+  };
+
+  class ThreadBuffer;
+
+  static uint64_t NextProfilerId();
+  ThreadBuffer& GetThreadBuffer();
+  // op_statistics_mutex_ must be held.
+  void MoveToOpStatistics(ThreadBuffer& buffer);
+  // Move the records of all the buffers and drop those of the threads that exited. op_statistics_mutex_ must be held.
+  void MoveToOpStatistics();
+
   // Mutex controlling access to profiler data
   OrtMutex mutex_;
   bool enabled_{false};
@@ -79,6 +152,15 @@ class Profiler {
   bool max_events_reached{false};
   static constexpr size_t max_num_events_ = 1000000;
   bool profile_with_logger_{false};
+
+  // Identifies this profiler in the buffers cached by each thread. Unlike the address of the profiler,
+  // the id is not reused by a profiler that is created after this one is destroyed.
+  const uint64_t id_{NextProfilerId()};
+  bool op_statistics_enabled_{false};
+  // Controls access to the statistics, and to the consuming end of the thread buffers.
+  OrtMutex op_statistics_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers_;
+  OpStatistics op_statistics_;
 };
 
 }  // namespace profiling
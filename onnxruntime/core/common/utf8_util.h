@@ -125,5 +125,45 @@ inline bool utf8_validate(const unsigned char* s, size_t len, size_t& utf8_chars
   return true;
 }
 
+// Returns the code point of the utf8 character of 'len' bytes
+// that starts at 's'. The character must be valid.
+inline char32_t utf8_decode(const unsigned char* s, size_t len) {
+  switch (len) {
+    case 1:
+      return s[0];
+    case 2:
+      return ((s[0] & 0x1Fu) << 6) | (s[1] & 0x3Fu);
+    case 3:
+      return ((s[0] & 0x0Fu) << 12) | ((s[1] & 0x3Fu) << 6) | (s[2] & 0x3Fu);
+    default:
+      return ((s[0] & 0x07u) << 18) | ((s[1] & 0x3Fu) << 12) | ((s[2] & 0x3Fu) << 6) | (s[3] & 0x3Fu);
+  }
+}
+
+// Writes the utf8 encoding of a valid code point to 'out'
+// and returns the number of bytes written, which is at most 4.
+inline size_t utf8_encode(char32_t cp, char* out) {
+  if (cp < 0x80u) {
+    out[0] = static_cast<char>(cp);
+    return 1;
+  }
+  if (cp < 0x800u) {
+    out[0] = static_cast<char>(0xC0u | (cp >> 6));
+    out[1] = static_cast<char>(0x80u | (cp & 0x3Fu));
+    return 2;
+  }
+  if (cp < 0x10000u) {
+    out[0] = static_cast<char>(0xE0u | (cp >> 12));
+    out[1] = static_cast<char>(0x80u | ((cp >> 6) & 0x3Fu));
+    out[2] = static_cast<char>(0x80u | (cp & 0x3Fu));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xF0u | (cp >> 18));
+  out[1] = static_cast<char>(0x80u | ((cp >> 12) & 0x3Fu));
+  out[2] = static_cast<char>(0x80u | ((cp >> 6) & 0x3Fu));
+  out[3] = static_cast<char>(0x80u | (cp & 0x3Fu));
+  return 4;
+}
+
 }  // namespace utf8_util
 }  // namespace onnxruntime
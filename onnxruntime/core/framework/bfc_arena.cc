@@ -3,6 +3,8 @@
 
 #include "core/framework/bfc_arena.h"
 
+#include <new>
+
 namespace onnxruntime {
 BFCArena::BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator,
                    size_t total_memory)
@@ -73,9 +75,18 @@ bool BFCArena::Extend(size_t rounded_bytes) {
     increased_allocation = true;
   }
 
+  // CPUAllocator throws when it's out of memory, treat it like a null result so a smaller region can be tried
+  auto try_alloc = [this](size_t size) -> void* {
+    try {
+      return device_allocator_->Alloc(size);
+    } catch (const std::bad_alloc&) {
+      return nullptr;
+    }
+  };
+
   // Try allocating.
   size_t bytes = std::min(curr_region_allocation_bytes_, available_bytes);
-  void* mem_addr = device_allocator_->Alloc(bytes);
+  void* mem_addr = try_alloc(bytes);
   if (mem_addr == nullptr && !started_backpedal_) {
     // Only backpedal once.
     started_backpedal_ = true;
@@ -86,7 +97,7 @@ bool BFCArena::Extend(size_t rounded_bytes) {
     while (mem_addr == nullptr) {
       bytes = RoundedBytes(static_cast<size_t>(bytes * kBackpedalFactor));
       if (bytes < rounded_bytes) break;
-      mem_addr = device_allocator_->Alloc(bytes);
+      mem_addr = try_alloc(bytes);
     }
   }
 
@@ -168,7 +179,12 @@ void* BFCArena::Reserve(size_t size) {
     return nullptr;
 
   std::lock_guard<OrtMutex> lock(lock_);
-  void* ptr = device_allocator_->Alloc(size);
+  // reserved memory counts toward the memory limit
+  void* ptr = size <= memory_limit_ - stats_.total_allocated_bytes ? device_allocator_->Alloc(size) : nullptr;
+  if (ptr == nullptr) {
+    ORT_THROW("Out of memory: failed to reserve ", size, " bytes from ", info_.name, ", ",
+              stats_.total_allocated_bytes, " of the ", memory_limit_, " bytes of the arena are allocated.");
+  }
   ORT_ENFORCE(reserved_chunks_.find(ptr) == reserved_chunks_.end());
   reserved_chunks_.insert(std::pair<void*, size_t>(ptr, size));
   stats_.bytes_in_use += size;
@@ -232,7 +248,9 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
                           << ".  Current allocation summary follows.";
     DumpMemoryLog(rounded_bytes);
   }
-  return nullptr;
+  // fail like the device allocators do rather than returning null, which the callers don't check
+  ORT_THROW("Out of memory: failed to allocate ", num_bytes, " bytes from ", info_.name, ", ",
+            stats_.total_allocated_bytes, " of the ", memory_limit_, " bytes of the arena are allocated.");
 }
 
 void BFCArena::GetStats(AllocatorStats* stats) {
@@ -90,6 +90,7 @@ class BFCArena : public IArenaAllocator {
   //If size is 0, then this function returns either NULL,
   //or a unique pointer value that can later be successfully
   //passed to free(). Whatever, do not dereference that pointer
+  //Throws if the memory can't be allocated, e.g. when the arena reached its memory limit.
   void* Alloc(size_t size) override;
 
   //If p is NULL, no operation is performed.
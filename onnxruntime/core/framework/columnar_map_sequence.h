@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/data_types.h"
+
+namespace onnxruntime {
+
+/**
+ * Columnar representation of a sequence of maps that all share the same keys, e.g. the output of ZipMap.
+ * The keys are stored once and shared with the producer, and the values are stored as a dense
+ * [number of maps, number of keys] row-major matrix. std::map instances are only built on request.
+ */
+template <typename TKey, typename TVal>
+class ColumnarMapSequence {
+ public:
+  using key_type = TKey;
+  using mapped_type = TVal;
+  using map_type = std::map<TKey, TVal>;
+
+  ColumnarMapSequence() = default;
+
+  /**
+   * Reset the sequence to contain num_maps maps with the given keys, copying the values from 'values'.
+   * 'values' must contain num_maps * keys->size() elements.
+   */
+  void Assign(std::shared_ptr<const std::vector<TKey>> keys, const TVal* values, size_t num_maps) {
+    ORT_ENFORCE(keys != nullptr);
+    keys_ = std::move(keys);
+    num_maps_ = num_maps;
+    // allocate new storage rather than resizing as views of the previous values may still be alive
+    values_ = std::make_shared<std::vector<TVal>>(values, values + num_maps * keys_->size());
+  }
+
+  // number of maps in the sequence
+  size_t size() const noexcept { return num_maps_; }
+
+  size_t NumKeys() const noexcept { return keys_ ? keys_->size() : 0; }
+
+  const std::vector<TKey>& Keys() const {
+    ORT_ENFORCE(keys_ != nullptr, "Sequence has not been assigned.");
+    return *keys_;
+  }
+
+  // Values of the index'th map, in the same order as Keys()
+  const TVal* Values(size_t index) const {
+    ORT_ENFORCE(index < num_maps_, "Index ", index, " is out of range. Sequence size is ", num_maps_);
+    return values_->data() + index * keys_->size();
+  }
+
+  const std::shared_ptr<const std::vector<TKey>>& SharedKeys() const noexcept { return keys_; }
+  const std::shared_ptr<std::vector<TVal>>& SharedValues() const noexcept { return values_; }
+
+  // Materialize the index'th map.
+  // If a key is repeated the last value wins, which matches assigning the entries to a std::map in order.
+  map_type GetMap(size_t index) const {
+    const TVal* values = Values(index);
+    map_type result;
+    for (size_t i = 0, end = keys_->size(); i < end; ++i) {
+      result[(*keys_)[i]] = values[i];
+    }
+    return result;
+  }
+
+  // Materialize the whole sequence.
+  std::vector<map_type> ToMaps() const {
+    std::vector<map_type> result;
+    result.reserve(num_maps_);
+    for (size_t i = 0; i < num_maps_; ++i) {
+      result.push_back(GetMap(i));
+    }
+    return result;
+  }
+
+ private:
+  std::shared_ptr<const std::vector<TKey>> keys_;
+  std::shared_ptr<std::vector<TVal>> values_;
+  size_t num_maps_ = 0;
+};
+
+/**
+ * A single map of a ColumnarMapSequence. It shares the storage of the sequence it was created from
+ * so creating it does not copy any keys or values.
+ */
+template <typename TKey, typename TVal>
+class ColumnarMapView {
+ public:
+  using key_type = TKey;
+  using mapped_type = TVal;
+
+  ColumnarMapView() = default;
+
+  ColumnarMapView(const ColumnarMapSequence<TKey, TVal>& sequence, size_t index)
+      : keys_{sequence.SharedKeys()},
+        values_{sequence.SharedValues()},
+        offset_{index * sequence.NumKeys()} {
+    ORT_ENFORCE(index < sequence.size(), "Index ", index, " is out of range. Sequence size is ", sequence.size());
+  }
+
+  size_t size() const noexcept { return keys_ ? keys_->size() : 0; }
+
+  const TKey* Keys() const { return keys_->data(); }
+  const TVal* Values() const { return values_->data() + offset_; }
+
+  // Materialize the map, with the same handling of repeated keys as ColumnarMapSequence::GetMap.
+  std::map<TKey, TVal> ToMap() const {
+    std::map<TKey, TVal> result;
+    const TVal* values = Values();
+    for (size_t i = 0, end = size(); i < end; ++i) {
+      result[(*keys_)[i]] = values[i];
+    }
+    return result;
+  }
+
+ private:
+  std::shared_ptr<const std::vector<TKey>> keys_;
+  std::shared_ptr<std::vector<TVal>> values_;
+  size_t offset_ = 0;
+};
+
+using ColumnarMapStringToFloat = ColumnarMapSequence<std::string, float>;
+using ColumnarMapInt64ToFloat = ColumnarMapSequence<int64_t, float>;
+using ColumnarMapViewStringToFloat = ColumnarMapView<std::string, float>;
+using ColumnarMapViewInt64ToFloat = ColumnarMapView<int64_t, float>;
+
+/**
+ * \brief Runtime type of a ColumnarMapSequence. It has the TypeProto of the equivalent
+ *        seq(map(key, value)) type but is not registered for it, so it is only used
+ *        when explicitly selected by the execution plan.
+ */
+template <typename CPPType>
+class ColumnarMapSequenceType : public NonTensorType<CPPType> {
+ public:
+  static MLDataType Type();
+
+  bool IsCompatible(const ONNX_NAMESPACE::TypeProto& type_proto) const override {
+    return this->IsSequenceCompatible(type_proto);
+  }
+
+ private:
+  ColumnarMapSequenceType() {
+    data_types_internal::SetSequenceType<std::map<typename CPPType::key_type, typename CPPType::mapped_type>>::Set(
+        this->mutable_type_proto());
+  }
+};
+
+/**
+ * \brief Runtime type of a ColumnarMapView. It has the TypeProto of the equivalent map(key, value) type.
+ */
+template <typename CPPType>
+class ColumnarMapViewType : public NonTensorType<CPPType> {
+ public:
+  static MLDataType Type();
+
+  bool IsCompatible(const ONNX_NAMESPACE::TypeProto& type_proto) const override {
+    return this->IsMapCompatible(type_proto);
+  }
+
+ private:
+  ColumnarMapViewType() {
+    data_types_internal::SetMapTypes<typename CPPType::key_type, typename CPPType::mapped_type>::Set(
+        this->mutable_type_proto());
+  }
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/cpu_region_allocator.h"
+
+#include <new>
+
+namespace onnxruntime {
+
+namespace {
+// Huge pages are usually 2MB. Rounding the regions up to a multiple lets them use reserved huge pages, and avoids
+// a partially used huge page at the end of a region.
+constexpr size_t kHugePageAlignment = 2 * 1024 * 1024;
+}  // namespace
+
+CPURegionAllocator::CPURegionAllocator(const MemoryRegionOptions& options) : options_(options) {}
+
+void* CPURegionAllocator::Alloc(size_t size) {
+  if (size < kMinRegionSize) {
+    try {
+      return small_allocator_.Alloc(size);
+    } catch (const std::bad_alloc&) {
+      return nullptr;
+    }
+  }
+
+  if (options_.use_huge_pages) {
+    size = (size + kHugePageAlignment - 1) / kHugePageAlignment * kHugePageAlignment;
+  }
+  void* p = Env::Default().AllocateMemoryRegion(size, options_);
+  if (p != nullptr) {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    region_sizes_[p] = size;
+  }
+  return p;
+}
+
+void CPURegionAllocator::Free(void* p) {
+  size_t size = 0;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto it = region_sizes_.find(p);
+    if (it != region_sizes_.end()) {
+      size = it->second;
+      region_sizes_.erase(it);
+    }
+  }
+  if (size == 0) {
+    small_allocator_.Free(p);
+  } else {
+    Env::Default().FreeMemoryRegion(p, size);
+  }
+}
+
+const OrtAllocatorInfo& CPURegionAllocator::Info() const {
+  return small_allocator_.Info();
+}
+
+}  // namespace onnxruntime
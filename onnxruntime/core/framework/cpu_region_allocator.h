@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <unordered_map>
+
+#include "core/framework/allocator.h"
+#include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+@class CPURegionAllocator
+
+CPU device allocator that takes large buffers, like the regions of an arena, directly from the operating system
+so they can be backed by huge pages and bound to a NUMA node, see Env::AllocateMemoryRegion.
+Small buffers are allocated like CPUAllocator does.
+Unlike CPUAllocator, Alloc returns nullptr when the memory can't be allocated, so an arena can retry with a
+smaller region.
+*/
+class CPURegionAllocator : public IDeviceAllocator {
+ public:
+  // buffers from this size are allocated as regions
+  static constexpr size_t kMinRegionSize = 64 * 1024;
+
+  explicit CPURegionAllocator(const MemoryRegionOptions& options);
+
+  void* Alloc(size_t size) override;
+  void Free(void* p) override;
+  const OrtAllocatorInfo& Info() const override;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(CPURegionAllocator);
+
+  const MemoryRegionOptions options_;
+  CPUAllocator small_allocator_;
+
+  // size of each region, needed to free it
+  std::unordered_map<void*, size_t> region_sizes_;  // protected by mutex_
+  OrtMutex mutex_;
+};
+
+}  // namespace onnxruntime
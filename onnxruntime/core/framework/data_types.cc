@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/framework/data_types.h"
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/tensor.h"
 #include "core/graph/onnx_protobuf.h"
 
@@ -460,6 +461,31 @@ ORT_REGISTER_SEQ(VectorDouble);
 ORT_REGISTER_SEQ(VectorMapStringToFloat);
 ORT_REGISTER_SEQ(VectorMapInt64ToFloat);
 
+// Columnar alternatives to VectorMap*. These are not registered with the TypeProto based registry
+// as the ONNX type is already mapped to the corresponding VectorMap* type.
+#define ORT_REGISTER_COLUMNAR_MAP_SEQ(SEQ_TYPE, VIEW_TYPE)       \
+  template <>                                                   \
+  MLDataType ColumnarMapSequenceType<SEQ_TYPE>::Type() {        \
+    static ColumnarMapSequenceType<SEQ_TYPE> sequence_type;     \
+    return &sequence_type;                                      \
+  }                                                             \
+  template <>                                                   \
+  MLDataType DataTypeImpl::GetType<SEQ_TYPE>() {                \
+    return ColumnarMapSequenceType<SEQ_TYPE>::Type();           \
+  }                                                             \
+  template <>                                                   \
+  MLDataType ColumnarMapViewType<VIEW_TYPE>::Type() {           \
+    static ColumnarMapViewType<VIEW_TYPE> view_type;            \
+    return &view_type;                                          \
+  }                                                             \
+  template <>                                                   \
+  MLDataType DataTypeImpl::GetType<VIEW_TYPE>() {               \
+    return ColumnarMapViewType<VIEW_TYPE>::Type();              \
+  }
+
+ORT_REGISTER_COLUMNAR_MAP_SEQ(ColumnarMapStringToFloat, ColumnarMapViewStringToFloat);
+ORT_REGISTER_COLUMNAR_MAP_SEQ(ColumnarMapInt64ToFloat, ColumnarMapViewInt64ToFloat);
+
 // Used for Tensor Proto registrations
 #define REGISTER_TENSOR_PROTO(TYPE, reg_fn)                  \
   {                                                          \
@@ -27,9 +27,10 @@ Status Environment::Initialize() {
   auto status = Status::OK();
 
   try {
-    // Register Microsoft domain with min/max op_set version as 1/1.
+    // Register Microsoft domains with min/max op_set version as 1/1.
     std::call_once(schemaRegistrationOnceFlag, []() {
       ONNX_NAMESPACE::OpSchemaRegistry::DomainToVersionRange::Instance().AddDomainToVersion(onnxruntime::kMSDomain, 1, 1);
+      ONNX_NAMESPACE::OpSchemaRegistry::DomainToVersionRange::Instance().AddDomainToVersion(onnxruntime::kMSNchwcDomain, 1, 1);
       // Register contributed schemas.
       // The corresponding kernels are registered inside the appropriate execution provider.
       contrib::RegisterContribSchemas();
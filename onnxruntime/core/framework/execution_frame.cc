@@ -3,6 +3,7 @@
 
 #include "core/framework/execution_frame.h"
 
+#include <atomic>
 #include <sstream>
 
 #include "core/framework/mem_pattern_planner.h"
@@ -102,8 +103,8 @@ void IExecutionFrame::Init(const std::vector<int>& feed_mlvalue_idxs,
                            const std::vector<int>& fetch_mlvalue_idxs,
                            const std::vector<MLValue>& fetches,
                            const MLValueNameIdxMap& mlvalue_idx_map) {
-  // 1. resize the all_value_ vector
-  all_values_.resize(mlvalue_idx_map.MaxIdx() + 1);
+  // 1. size the all_value_ vector. all the existing values are cleared if the frame is being reset.
+  all_values_.assign(mlvalue_idx_map.MaxIdx() + 1, MLValue());
 
   // 2. Handle non-empty output vector
   if (!fetches.empty()) {
@@ -160,6 +161,17 @@ bool IExecutionFrame::IsOutput(int mlvalue_idx) const {
   return std::find(fetch_mlvalue_idxs_.begin(), fetch_mlvalue_idxs_.end(), mlvalue_idx) != fetch_mlvalue_idxs_.end();
 }
 
+void IExecutionFrame::Reset(const std::vector<int>& feed_mlvalue_idxs,
+                            const std::vector<MLValue>& feeds,
+                            const std::unordered_map<int, MLValue>& initializers,
+                            const std::vector<MLValue>& fetches,
+                            const MLValueNameIdxMap& mlvalue_idx_map) {
+  ORT_ENFORCE(feeds.size() == feed_mlvalue_idxs.size());
+  ORT_ENFORCE(fetches.empty() || fetches.size() == fetch_mlvalue_idxs_.size());
+
+  Init(feed_mlvalue_idxs, feeds, initializers, fetch_mlvalue_idxs_, fetches, mlvalue_idx_map);
+}
+
 ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
                                const std::vector<MLValue>& feeds,
                                const std::vector<int>& fetch_mlvalue_idxs,
@@ -171,17 +183,7 @@ ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
       session_state_{session_state},
       mem_patterns_{nullptr},
       planner_{nullptr} {
-  // map the custom allocators to mlvalue_idx entries
-  if (!fetch_allocators.empty()) {
-    for (size_t idx = 0, end = fetch_mlvalue_idxs.size(); idx < end; ++idx) {
-      int mlvalue_idx = fetch_mlvalue_idxs[idx];
-
-      auto custom_alloc_entry = fetch_allocators.find(idx);
-      if (custom_alloc_entry != fetch_allocators.cend()) {
-        custom_allocators_[mlvalue_idx] = custom_alloc_entry->second;
-      }
-    }
-  }
+  SetCustomAllocators(fetch_mlvalue_idxs, fetch_allocators);
 
   // If the session enable memory pattern optimization
   // and we have execution plan generated, try to setup
@@ -205,14 +207,32 @@ ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
       if (!mem_patterns_) {
         planner_ = std::make_unique<MLValuePatternPlanner>(*session_state.GetExecutionPlan());
       } else {
+        mem_patterns_input_shapes_ = std::move(input_shapes);
+
         // pre-allocate the big chunk requested in memory pattern.
         // all the internal kernel's input/output tensors will be allocated on these buffer.
         for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
           ORT_ENFORCE(buffers_.find(mem_patterns_->locations[i]) == buffers_.end());
           AllocatorPtr alloc = GetAllocator(mem_patterns_->locations[i]);
-          void* buffer = mem_patterns_->patterns[i].PeakSize() > 0
-                             ? alloc->Alloc(mem_patterns_->patterns[i].PeakSize())
-                             : nullptr;
+          void* buffer = nullptr;
+          if (mem_patterns_->patterns[i].PeakSize() > 0) {
+            try {
+              buffer = alloc->Alloc(mem_patterns_->patterns[i].PeakSize());
+            } catch (const std::exception& ex) {
+              // if the arena reached its memory limit, the tensors are allocated one by one instead. this happens on
+              // every Run once the limit is reached, so only the first failure is a warning.
+              static std::atomic_flag warned = ATOMIC_FLAG_INIT;
+              if (!warned.test_and_set()) {
+                LOGS_DEFAULT(WARNING) << "Failed to allocate " << mem_patterns_->patterns[i].PeakSize()
+                                      << " bytes for the memory pattern in " << mem_patterns_->locations[i].name
+                                      << ", fall back to default allocation behavior: " << ex.what();
+              } else {
+                VLOGS_DEFAULT(1) << "Failed to allocate the memory pattern in " << mem_patterns_->locations[i].name
+                                 << ": " << ex.what();
+              }
+              continue;
+            }
+          }
           buffers_[mem_patterns_->locations[i]] = BufferUniquePtr(buffer, alloc);
         }
       }
@@ -222,6 +242,51 @@ ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
 
 ExecutionFrame::~ExecutionFrame() = default;
 
+void ExecutionFrame::SetCustomAllocators(const std::vector<int>& fetch_mlvalue_idxs,
+                                         const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
+  custom_allocators_.clear();
+
+  // map the custom allocators to mlvalue_idx entries
+  for (const auto& entry : fetch_allocators) {
+    if (entry.first < fetch_mlvalue_idxs.size()) {
+      custom_allocators_[fetch_mlvalue_idxs[entry.first]] = entry.second;
+    }
+  }
+}
+
+bool ExecutionFrame::TryReset(const std::vector<int>& feed_mlvalue_idxs,
+                              const std::vector<MLValue>& feeds,
+                              const std::vector<int>& fetch_mlvalue_idxs,
+                              const std::vector<MLValue>& fetches,
+                              const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                              const SessionState& session_state) {
+  // a frame that traced its allocations to generate a memory pattern is not reused, so that the next frame
+  // picks up the new pattern.
+  if (&session_state != &session_state_ || planner_ != nullptr || !HasFetchMLValueIdxs(fetch_mlvalue_idxs) ||
+      feeds.size() != feed_mlvalue_idxs.size() || !(fetches.empty() || fetches.size() == fetch_mlvalue_idxs.size())) {
+    return false;
+  }
+
+  // the buffers of the memory pattern are only valid for the input shapes the pattern was generated for
+  if (mem_patterns_ != nullptr) {
+    if (feeds.size() != mem_patterns_input_shapes_.size()) {
+      return false;
+    }
+
+    for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+      if (!feeds[i].IsTensor() || feeds[i].Get<Tensor>().Shape() != mem_patterns_input_shapes_[i]) {
+        return false;
+      }
+    }
+  }
+
+  Reset(feed_mlvalue_idxs, feeds, session_state_.GetInitializedTensors(), fetches,
+        session_state_.GetMLValueNameIdxMap());
+  SetCustomAllocators(fetch_mlvalue_idxs, fetch_allocators);
+
+  return true;
+}
+
 Status ExecutionFrame::AllocateMLValueTensorSelfOwnBuffer(MLValue& mlvalue,
                                                           int mlvalue_index,
                                                           MLDataType element_type,
@@ -74,6 +74,18 @@ class IExecutionFrame {
   // returns true if the mlvalue_idx is an output from the graph
   bool IsOutput(int mlvalue_idx) const;
 
+  bool HasFetchMLValueIdxs(const std::vector<int>& fetch_mlvalue_idxs) const {
+    return fetch_mlvalue_idxs_ == fetch_mlvalue_idxs;
+  }
+
+  // Clear all values and set the feeds, fetches and initializers for another execution with the same fetch indexes.
+  // The storage for the values is reused.
+  void Reset(const std::vector<int>& feed_mlvalue_idxs,
+             const std::vector<MLValue>& feeds,
+             const std::unordered_map<int, MLValue>& initializers,
+             const std::vector<MLValue>& fetches,
+             const MLValueNameIdxMap& mlvalue_idx_map);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(IExecutionFrame);
 
@@ -136,9 +148,23 @@ class ExecutionFrame final : public IExecutionFrame {
     return planner_ != nullptr;
   }
 
+  // Prepare the frame for another execution of the same graph, so the frame and the buffers of its memory pattern
+  // can be reused by callers that execute a graph repeatedly, e.g. the subgraph of a Scan node.
+  // Returns false if the frame can't be used with the given feeds and fetches, in which case a new ExecutionFrame
+  // must be created.
+  bool TryReset(const std::vector<int>& feed_mlvalue_idxs,
+                const std::vector<MLValue>& feeds,
+                const std::vector<int>& fetch_mlvalue_idxs,
+                const std::vector<MLValue>& fetches,
+                const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                const SessionState& session_state);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
+  void SetCustomAllocators(const std::vector<int>& fetch_mlvalue_idxs,
+                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
+
   AllocatorPtr GetAllocatorImpl(const OrtAllocatorInfo& info) const override;
   Status ReleaseMLValueImpl(int mlvalue_idx) override;
   Status CreateNodeOutputMLValueImpl(MLValue& mlvalue, int mlvalue_idx, const TensorShape* shape) override;
@@ -175,6 +201,9 @@ class ExecutionFrame final : public IExecutionFrame {
   // kernel's input/output tensors.
   const MemoryPatternGroup* mem_patterns_;
 
+  // shapes of the feeds that mem_patterns_ was selected for
+  std::vector<TensorShape> mem_patterns_input_shapes_;
+
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
   std::unique_ptr<MLValuePatternPlanner> planner_;
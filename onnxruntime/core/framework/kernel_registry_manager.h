@@ -74,6 +74,11 @@ class KernelRegistryManager {
     return result;
   }
 
+  // Whether kernels from RegisterKernelRegistry (e.g. custom ops) may be created by this manager
+  bool HasCustomKernelRegistries() const {
+    return !custom_kernel_registries_.empty();
+  }
+
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(KernelRegistryManager);
 
  private:
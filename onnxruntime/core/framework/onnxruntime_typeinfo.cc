@@ -5,6 +5,7 @@
 
 #include <cassert>
 #include "onnxruntime_typeinfo.h"
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/tensor.h"
 #include "core/graph/onnx_protobuf.h"
 
@@ -53,6 +54,14 @@ OrtStatus* OrtTypeInfo::FromDataTypeImpl(const onnxruntime::DataTypeImpl* input,
     *out = new OrtTypeInfo(ONNX_TYPE_MAP, nullptr);
     return nullptr;
   }
+  if (input == DataTypeImpl::GetType<onnxruntime::ColumnarMapViewStringToFloat>() || input == DataTypeImpl::GetType<onnxruntime::ColumnarMapViewInt64ToFloat>()) {
+    *out = new OrtTypeInfo(ONNX_TYPE_MAP, nullptr);
+    return nullptr;
+  }
+  if (input == DataTypeImpl::GetType<onnxruntime::ColumnarMapStringToFloat>() || input == DataTypeImpl::GetType<onnxruntime::ColumnarMapInt64ToFloat>()) {
+    *out = new OrtTypeInfo(ONNX_TYPE_SEQUENCE, nullptr);
+    return nullptr;
+  }
   if (input == DataTypeImpl::GetType<onnxruntime::VectorString>() || input == DataTypeImpl::GetType<onnxruntime::VectorFloat>() || input == DataTypeImpl::GetType<onnxruntime::VectorInt64>() || input == DataTypeImpl::GetType<onnxruntime::VectorDouble>() || input == DataTypeImpl::GetType<onnxruntime::VectorMapStringToFloat>() || input == DataTypeImpl::GetType<onnxruntime::VectorMapInt64ToFloat>()) {
     *out = new OrtTypeInfo(ONNX_TYPE_SEQUENCE, nullptr);
     return nullptr;
@@ -27,6 +27,8 @@ class OpKernelContextInternal : public OpKernelContext {
         terminate_flag_{terminate_flag} {
   }
 
+  const SessionState& GetSessionState() const { return session_state_; }
+
   const SessionState* SubgraphSessionState(const std::string& attribute_name) {
     return session_state_.GetSubgraphSessionState(GetNodeIndex(), attribute_name);
   }
@@ -3,8 +3,11 @@
 
 #include "core/framework/parallel_executor.h"
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 #include "core/common/common.h"
@@ -23,9 +26,9 @@
 namespace onnxruntime {
 
 ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
-    : out_standings_(0), terminate_flag_{terminate_flag} {
+    : node_priorities_(session_state.GetNodePriorities()), terminate_flag_{terminate_flag} {
   auto graph_viewer = session_state.GetGraphViewer();
-  node_refs_.resize(graph_viewer->MaxNodeIndex());
+  node_refs_.reset(new std::atomic<size_t>[graph_viewer->MaxNodeIndex()]);
   for (auto& node : graph_viewer->Nodes()) {
     node_refs_[node.Index()] = node.GetInputEdgesCount();
   }
@@ -46,14 +49,25 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
 
   root_frame_ = std::make_unique<ExecutionFrame>(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches,
                                                  fetch_allocators, session_state);
-  //std::cout << "start nodes:" << std::endl;
+  if (!node_priorities_) {
+    node_priorities_ = std::make_shared<const std::vector<int64_t>>();
+  }
+
+  // Enqueue the root nodes with the longest critical path first. Count them all as outstanding before any of them
+  // is scheduled, so a fast node can't bring the count to zero while the others are still being enqueued.
+  std::vector<std::pair<int64_t, NodeIndex>> root_nodes;
   for (auto node_index : session_state.GetGraphViewer()->GetRootNodes()) {
     auto p_op_kernel = session_state.GetKernel(node_index);
     if (!p_op_kernel)
       continue;
 
-    //std::cout << "\t" << p_op_kernel->Node().Name() << std::endl;
-    EnqueueNode(node_index, session_state, logger);
+    root_nodes.emplace_back(GetPriority(node_index), node_index);
+  }
+  std::sort(root_nodes.begin(), root_nodes.end(), std::greater<std::pair<int64_t, NodeIndex>>());
+
+  out_standings_ += static_cast<int>(root_nodes.size());
+  for (const auto& root_node : root_nodes) {
+    EnqueueNode(root_node.second, session_state, logger);
   }
 
   // Wait for finish.
@@ -62,6 +76,12 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
     while (out_standings_ > 0) complete_cv_.wait(lock);
   }
 
+  VLOGS(logger, 1) << "Ran " << nodes_run_ << " nodes, " << nodes_run_inline_
+                   << " inline and " << nodes_enqueued_ << " through the thread pool, with at most "
+                   << max_ready_nodes_ << " nodes waiting for a thread.";
+
+  ORT_RETURN_IF_ERROR(error_status_);
+
   VLOGS(logger, 1) << "Fetching output.";
   // ExecutionFrame::Finalize will update 'fetches' with the final output
   ORT_RETURN_IF_ERROR(root_frame_->GetOutputs(fetches));
@@ -87,48 +107,64 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
   }
 
   if (f_profiler_enabled) {
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp);
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp,
+                                                   {{"nodes_run_inline", std::to_string(nodes_run_inline_)},
+                                                    {"nodes_enqueued", std::to_string(nodes_enqueued_)},
+                                                    {"max_ready_nodes", std::to_string(max_ready_nodes_)}});
   }
   return Status::OK();
 }
 
-void ParallelExecutor::RunNodeAsync(size_t p_node_index,
+void ParallelExecutor::RunNodeAsync(NodeIndex p_node_index,
                                     const SessionState& session_state,
                                     const logging::Logger& logger) {
+  Status status;
   try {
-    RunNodeAsyncInternal(p_node_index, session_state, logger);
+    status = RunNodeAsyncInternal(p_node_index, session_state, logger);
+  } catch (const std::exception& ex) {
+    status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
   } catch (...) {
-    FinishNodeRun();
-    throw;
+    status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, "Unknown exception while running a node.");
+  }
+
+  if (!status.IsOK()) {
+    LOGS(logger, ERROR) << status.ErrorMessage();
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    if (error_status_.IsOK()) {
+      error_status_ = status;
+    }
   }
+
+  FinishNodeRun();
 }
 
-void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
-                                            const SessionState& session_state,
-                                            const logging::Logger& logger) {
+Status ParallelExecutor::RunNodeAsyncInternal(NodeIndex p_node_index,
+                                              const SessionState& session_state,
+                                              const logging::Logger& logger) {
   LOGS(logger, INFO) << "Begin execution";
 
-  size_t node_index = p_node_index;
+  NodeIndex node_index = p_node_index;
   bool keep_running = true;
   auto graph_viewer = session_state.GetGraphViewer();
   TimePoint sync_time_begin;
   TimePoint kernel_begin_time;
   bool f_profiler_enabled = session_state.Profiler().FEnabled();
+  bool f_op_statistics_enabled = session_state.Profiler().FOpStatisticsEnabled();
   // Avoid context switching if possible.
   while (keep_running) {
     // TODO: Convert RunNodeAsync return Status.
     // to also handle exception propagation
     if (terminate_flag_) {
       LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
-      ORT_THROW("Exiting due to terminate flag being set to true.");
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
 
     auto p_op_kernel = session_state.GetKernel(node_index);
 
     // if a kernel has been added in the session state, it better be NON-null.
     if (p_op_kernel == nullptr) {
-      ORT_THROW("Got nullptr from GetKernel for node: ",
-                graph_viewer->GetNode(node_index)->Name());
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Got nullptr from GetKernel for node: ",
+                             graph_viewer->GetNode(node_index)->Name());
     }
 
     OpKernelContextInternal op_kernel_context(session_state, *root_frame_, *p_op_kernel, logger,
@@ -175,7 +211,9 @@ void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
                                                      p_op_kernel->Node().Name() + "_fence_before",
                                                      sync_time_begin,
                                                      {{"op_name", p_op_kernel->KernelDef().OpName()}});
+    }
 
+    if (f_profiler_enabled || f_op_statistics_enabled) {
       kernel_begin_time = session_state.Profiler().StartTime();
     }
 
@@ -185,7 +223,13 @@ void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
     // Execute the kernel.
     auto status = p_op_kernel->Compute(&op_kernel_context);
     if (!status.IsOK()) {
-      ORT_THROW("Compute failed for node: ", graph_viewer->GetNode(node_index)->Name());
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Compute failed for node: ", graph_viewer->GetNode(node_index)->Name(),
+                             ". ", status.ErrorMessage());
+    }
+    ++nodes_run_;
+    if (f_op_statistics_enabled) {
+      session_state.Profiler().RecordKernelTime(p_op_kernel->Node().Name(), p_op_kernel->Node().OpType(),
+                                                kernel_begin_time);
     }
     if (f_profiler_enabled) {
       session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
@@ -222,54 +266,73 @@ void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
                                                      sync_time_begin,
                                                      {{"op_name", p_op_kernel->KernelDef().OpName()}});
     }
-    //std::cout << "Run async node finish: " << p_node_index << std::endl;
-
     keep_running = false;
 
-    // Checking which output nodes ready for running.
-    {
-      auto begin = p_op_kernel->Node().OutputEdgesBegin();
-      auto end = p_op_kernel->Node().OutputEdgesEnd();
-
-      std::lock_guard<OrtMutex> lock(ref_mutex_);
-      for (auto it = begin; it != end; it++) {
-        auto idx = (*it).GetNode().Index();
-        if ((--node_refs_[idx]) == 0) {
-          if (!keep_running) {
-            node_index = idx;
-            keep_running = true;
-          } else {
-            EnqueueNode(idx, session_state, logger);
-          }
-        }
+    // Decrement the references of the output nodes. Of the nodes that become ready, keep the one with the longest
+    // critical path to run on this thread and hand the others to the thread pool.
+    bool has_next_node = false;
+    NodeIndex next_node_index = 0;
+    int64_t next_node_priority = 0;
+    for (auto it = p_op_kernel->Node().OutputEdgesBegin(), end = p_op_kernel->Node().OutputEdgesEnd(); it != end; ++it) {
+      auto idx = (*it).GetNode().Index();
+      if (--node_refs_[idx] != 0) {
+        continue;
+      }
 
-        // std::cout << "handle output, current name: " << p_op_kernel->Node().Name() << ", current index: "
-        // << p_node_index << ", output name: " << (*it)->GetNode().Name() << ", output index: "
-        // << (*it)->GetNode().Index() << ", after -- output ref: " << node_refs_[idx] << std::endl;
+      int64_t priority = GetPriority(idx);
+      if (has_next_node && priority <= next_node_priority) {
+        ++out_standings_;
+        EnqueueNode(idx, session_state, logger);
+        continue;
       }
+      if (has_next_node) {
+        ++out_standings_;
+        EnqueueNode(next_node_index, session_state, logger);
+      }
+      has_next_node = true;
+      next_node_index = idx;
+      next_node_priority = priority;
+    }
+
+    if (has_next_node) {
+      node_index = next_node_index;
+      keep_running = true;
+      ++nodes_run_inline_;
     }
   }
 
-  FinishNodeRun();
+  return Status::OK();
 }
 
-void ParallelExecutor::EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger) {
+void ParallelExecutor::EnqueueNode(NodeIndex p_node_index, const SessionState& session_state,
+                                   const logging::Logger& logger) {
   {
-    std::unique_lock<OrtMutex> lock(complete_mutex_);
-    out_standings_++;
+    std::lock_guard<OrtMutex> lock(ready_mutex_);
+    ready_nodes_.emplace(GetPriority(p_node_index), p_node_index);
+    max_ready_nodes_ = std::max(max_ready_nodes_, ready_nodes_.size());
   }
+  ++nodes_enqueued_;
 
 #ifdef USE_EIGEN_THREADPOOL
-  session_state.GetThreadPool()->Schedule([this, p_node_index, &session_state, &logger]() {
-    try {
-      ParallelExecutor::RunNodeAsync(p_node_index, std::cref(session_state), std::cref(logger));
-    } catch (...) {
-      // catch node processing failure exceptions here to prevent app crash.
-    }
+  session_state.GetThreadPool()->Schedule([this, &session_state, &logger]() {
+    ParallelExecutor::RunReadyNode(session_state, logger);
   });
 #else
-  std::packaged_task<void()> task{std::bind(&ParallelExecutor::RunNodeAsync, this, p_node_index, std::cref(session_state), std::cref(logger))};
+  std::packaged_task<void()> task{std::bind(&ParallelExecutor::RunReadyNode, this, std::cref(session_state), std::cref(logger))};
   session_state.GetThreadPool()->RunTask(std::move(task));
 #endif
 }
+
+void ParallelExecutor::RunReadyNode(const SessionState& session_state, const logging::Logger& logger) {
+  // Every task is scheduled together with one node, so the queue isn't empty. The node this task runs is the one
+  // with the highest priority at the time it starts, not necessarily the one it was scheduled with.
+  NodeIndex node_index;
+  {
+    std::lock_guard<OrtMutex> lock(ready_mutex_);
+    node_index = ready_nodes_.top().second;
+    ready_nodes_.pop();
+  }
+
+  RunNodeAsync(node_index, session_state, logger);
+}
 }  // namespace onnxruntime
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <utility>
 #include <vector>
 #include <condition_variable>
 #include "core/common/common.h"
@@ -35,31 +39,53 @@ class ParallelExecutor : public IExecutor {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelExecutor);
 
-  void RunNodeAsync(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
-  void RunNodeAsyncInternal(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
+  void RunNodeAsync(NodeIndex p_node_index, const SessionState& session_state, const logging::Logger& logger);
+  Status RunNodeAsyncInternal(NodeIndex p_node_index, const SessionState& session_state,
+                              const logging::Logger& logger);
 
-  void EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
+  // Add a node to the ready queue and schedule a thread pool task to run the node with the highest priority.
+  void EnqueueNode(NodeIndex p_node_index, const SessionState& session_state, const logging::Logger& logger);
+  void RunReadyNode(const SessionState& session_state, const logging::Logger& logger);
+
+  int64_t GetPriority(NodeIndex node_index) const {
+    return node_index < node_priorities_->size() ? (*node_priorities_)[node_index] : 0;
+  }
 
   void FinishNodeRun() {
-    bool finished = false;
-    {
-      //Because we have a mutex here, it's not possible another thread is doing the test("while (out_standings_ > 0)"
-      std::lock_guard<OrtMutex> lock(complete_mutex_);
-      finished = --out_standings_ == 0;
-    }
-    if (finished) {
-      //std::cout << "all out standing nodes are completed." << std::endl;
+    // Decrement and notify under the lock. Execute returns, and the executor is destroyed, as soon as it sees
+    // out_standings_ reach 0, so this thread must be done with complete_mutex_ and complete_cv_ by then.
+    std::lock_guard<OrtMutex> lock(complete_mutex_);
+    if (--out_standings_ == 0) {
       complete_cv_.notify_all();
     }
   }
 
   std::unique_ptr<ExecutionFrame> root_frame_;
-  std::vector<size_t> node_refs_;
-  OrtMutex ref_mutex_;
-  int out_standings_;  //protected by complete_mutex_
+  // number of input edges of each node from nodes that haven't run yet, indexed by NodeIndex
+  std::unique_ptr<std::atomic<size_t>[]> node_refs_;
+  std::shared_ptr<const std::vector<int64_t>> node_priorities_;
+
+  // (priority, node index) of the nodes waiting for a thread pool task
+  std::priority_queue<std::pair<int64_t, NodeIndex>> ready_nodes_;  // protected by ready_mutex_
+  OrtMutex ready_mutex_;
+
+  std::atomic<int> out_standings_{0};
   OrtMutex complete_mutex_;
   OrtCondVar complete_cv_;
 
+  // first failure of a node, later failures are only logged
+  Status error_status_;  // protected by error_mutex_
+  OrtMutex error_mutex_;
+
+  // How the nodes were scheduled. Logged at verbose level and attached to the profiling event of Execute.
+  std::atomic<size_t> nodes_run_{0};
+  // nodes run by the thread that computed their last input, without going through the thread pool
+  std::atomic<size_t> nodes_run_inline_{0};
+  // nodes handed to the thread pool
+  std::atomic<size_t> nodes_enqueued_{0};
+  // largest number of nodes that were waiting for a thread at the same time
+  size_t max_ready_nodes_{0};  // protected by ready_mutex_
+
   const bool& terminate_flag_;
 };
 }  // namespace onnxruntime
@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "core/platform/ort_mutex.h"
+
+#ifndef USE_EIGEN_THREADPOOL
+#include "core/common/task_thread_pool.h"
+#endif
+
+namespace onnxruntime {
+
+// The caller only waits for the items to be processed and not for the thread pool tasks to run, as it may be
+// executing on a thread pool thread itself and every other thread may be busy. A task that runs after all the items
+// were processed only touches the shared state it holds a reference to.
+Status ParallelFor(SessionThreadPool* thread_pool, size_t count, const std::function<Status(size_t)>& fn) {
+  auto run_item = [&fn](size_t i) {
+    try {
+      return fn(i);
+    } catch (const std::exception& ex) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ex.what());
+    }
+  };
+
+  if (thread_pool == nullptr || count < 2) {
+    for (size_t i = 0; i < count; ++i) {
+      ORT_RETURN_IF_ERROR(run_item(i));
+    }
+    return Status::OK();
+  }
+
+  struct SharedState {
+    std::atomic<size_t> next_item{0};
+    size_t items_processed{0};  // protected by mutex
+    OrtMutex mutex;
+    OrtCondVar items_processed_cv;
+  };
+
+  auto state = std::make_shared<SharedState>();
+  std::vector<Status> statuses(count);
+
+  auto process_items = [state, count, &run_item, &statuses]() {
+    for (size_t i = state->next_item++; i < count; i = state->next_item++) {
+      statuses[i] = run_item(i);
+
+      std::lock_guard<OrtMutex> lock(state->mutex);
+      if (++state->items_processed == count) {
+        state->items_processed_cv.notify_all();
+      }
+    }
+  };
+
+  // Tasks that run after all the items are taken return immediately.
+  const size_t num_tasks = std::min(static_cast<size_t>(thread_pool->NumThreads()), count - 1);
+#ifdef USE_EIGEN_THREADPOOL
+  for (size_t i = 0; i < num_tasks; ++i) {
+    thread_pool->Schedule(process_items);
+  }
+#else
+  for (size_t i = 0; i < num_tasks; ++i) {
+    std::packaged_task<void()> task{process_items};
+    thread_pool->RunTask(std::move(task));
+  }
+#endif
+
+  process_items();
+
+  {
+    std::unique_lock<OrtMutex> lock(state->mutex);
+    state->items_processed_cv.wait(lock, [&state, count]() { return state->items_processed == count; });
+  }
+
+  for (const auto& status : statuses) {
+    ORT_RETURN_IF_ERROR(status);
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+
+#include "core/common/status.h"
+
+#ifdef USE_EIGEN_THREADPOOL
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#endif
+
+namespace onnxruntime {
+
+#ifdef USE_EIGEN_THREADPOOL
+using SessionThreadPool = Eigen::NonBlockingThreadPool;
+#else
+class TaskThreadPool;
+using SessionThreadPool = TaskThreadPool;
+#endif
+
+/**
+Call fn(i) for each i in [0, count) using the session thread pool, with the calling thread processing items as well.
+Items are handed out through a shared counter so a few expensive items don't hold up the rest. The items run on the
+calling thread if thread_pool is null. This can be called from a kernel that is itself running on a thread pool
+thread.
+@returns The status of the first item that failed, in item order. An exception thrown by fn fails its item.
+*/
+common::Status ParallelFor(SessionThreadPool* thread_pool, size_t count,
+                           const std::function<common::Status(size_t)>& fn);
+
+}  // namespace onnxruntime
@@ -16,6 +16,7 @@ namespace onnxruntime {
 using MLValueIndex = int;
 using MLValueName = std::string;
 
+class OpKernel;
 class SessionState;
 
 // AllocPlanPerValue: (a simplified form of AllocationPlanPerValue above)
@@ -69,6 +70,20 @@ struct SequentialExecutionPlan {
   std::vector<MLValueIndex> to_be_freed;
 };
 
+// NodeExecutionRecord: the per node data the SequentialExecutor needs on every run, resolved once from the
+// execution plan and the session kernels so the executor does not have to look it up for each node.
+struct NodeExecutionRecord {
+  const OpKernel* kernel{nullptr};
+  onnxruntime::NodeIndex node_index{0};
+
+  // execution queue of the kernel, used to synchronize fences
+  int queue_id{0};
+
+  // ml-values to be freed after node execution, as in SequentialExecutionPlan::NodeExecutionPlan
+  int free_from_index{1};
+  int free_to_index{0};
+};
+
 // Output details of an execution plan:
 std::ostream& operator<<(std::ostream& out, std::pair<const SequentialExecutionPlan*, const SessionState*> planinfo);
 }  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #include "core/framework/sequential_executor.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <vector>
@@ -18,9 +19,18 @@ namespace onnxruntime {
 
 static Status ReleaseNodeMLValues(ExecutionFrame& frame,
                                   const SequentialExecutionPlan& seq_exec_plan,
-                                  const SequentialExecutionPlan::NodeExecutionPlan& node_exec_plan,
+                                  const NodeExecutionRecord& node_record,
                                   const logging::Logger& logger);
 
+static void SyncBeforeCompute(const NodeExecutionRecord& node_record, const OpKernelContextInternal& op_kernel_context);
+static void SyncAfterCompute(const NodeExecutionRecord& node_record, const OpKernelContextInternal& op_kernel_context);
+
+static bool HasFence(const std::vector<MLValue>& values) {
+  return std::any_of(values.cbegin(), values.cend(), [](const MLValue& value) { return value.Fence() != nullptr; });
+}
+
+SequentialExecutor::~SequentialExecutor() = default;
+
 Status SequentialExecutor::Execute(const SessionState& session_state,
                                    const std::vector<int>& feed_mlvalue_idxs,
                                    const std::vector<MLValue>& feeds,
@@ -29,6 +39,7 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
                                    const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
                                    const logging::Logger& logger) {
   bool f_profiler_enabled = session_state.Profiler().FEnabled();
+  bool f_op_statistics_enabled = session_state.Profiler().FOpStatisticsEnabled();
   TimePoint tp;
   TimePoint sync_time_begin;
   TimePoint kernel_begin_time;
@@ -37,29 +48,40 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     tp = session_state.Profiler().StartTime();
   }
 
-  ExecutionFrame frame{feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, fetch_allocators, session_state};
+  std::unique_ptr<ExecutionFrame> p_frame = std::move(frame_);
+  if (!p_frame ||
+      !p_frame->TryReset(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, fetch_allocators, session_state)) {
+    p_frame = std::make_unique<ExecutionFrame>(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches,
+                                               fetch_allocators, session_state);
+  }
+  ExecutionFrame& frame = *p_frame;
 
   LOGS(logger, INFO) << "Begin execution";
   const SequentialExecutionPlan& seq_exec_plan = *session_state.GetExecutionPlan();
-  const auto& exec_plan_vec = seq_exec_plan.execution_plan;
-  VLOGS(logger, 1) << "Size of execution plan vector: " << exec_plan_vec.size();
+  const auto& node_records = session_state.GetNodeExecutionRecords();
+  ORT_ENFORCE(node_records.size() == seq_exec_plan.execution_plan.size(),
+              "CalculateNodeIndexInfo must be called after the execution plan is created.");
+  VLOGS(logger, 1) << "Size of execution plan vector: " << node_records.size();
 
   // uncomment the line below to dump execution plan
   //std::cout << std::make_pair(p_seq_exec_plan, &session_state) << "\n";
 
-  for (const auto& node_exec_plan : exec_plan_vec) {
+  // Fences are only created by providers with asynchronous execution queues. The feeds and fetches may also come
+  // from an outer graph that uses them, e.g. when executing the subgraph of a control flow node.
+  const bool use_fences = session_state.ExecutionPlanUsesFences() || HasFence(feeds) || HasFence(fetches);
+
+  for (const auto& node_record : node_records) {
     if (terminate_flag_) {
       LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
 
-    auto node_index = node_exec_plan.node_index;
-    auto p_op_kernel = session_state.GetKernel(node_index);
+    const OpKernel* p_op_kernel = node_record.kernel;
 
     // if a kernel has been added in the session state, it better be NON-null.
     if (p_op_kernel == nullptr)
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Got nullptr from GetKernel for node: ",
-                             session_state.GetGraphViewer()->GetNode(node_index)->Name());
+                             session_state.GetGraphViewer()->GetNode(node_record.node_index)->Name());
 
     // construct OpKernelContext
     // TODO: log kernel inputs?
@@ -71,34 +93,8 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     }
 
     // sync before compute
-    int queue_id = p_op_kernel->KernelDef().ExecQueueId();
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
-        }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
-      }
-    }
-
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
-        }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
-      }
-    }
-
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+    if (use_fences) {
+      SyncBeforeCompute(node_record, op_kernel_context);
     }
 
     if (f_profiler_enabled) {
@@ -109,11 +105,18 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
 
       // call compute on the kernel
       VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+    }
 
+    if (f_profiler_enabled || f_op_statistics_enabled) {
       kernel_begin_time = session_state.Profiler().StartTime();
     }
     ORT_RETURN_IF_ERROR(p_op_kernel->Compute(&op_kernel_context));
 
+    if (f_op_statistics_enabled) {
+      session_state.Profiler().RecordKernelTime(p_op_kernel->Node().Name(), p_op_kernel->Node().OpType(),
+                                                kernel_begin_time);
+    }
+
     if (f_profiler_enabled) {
       session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
                                                      p_op_kernel->Node().Name() + "_kernel_time",
@@ -124,25 +127,8 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     }
 
     // sync after compute for outputs
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
-    }
-
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
-    }
-
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->AfterUsedAsOutput(queue_id);
-      }
+    if (use_fences) {
+      SyncAfterCompute(node_record, op_kernel_context);
     }
 
     if (f_profiler_enabled) {
@@ -153,8 +139,10 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     }
 
     // free ml-values corresponding to this node
-    VLOGS(logger, 1) << "Releasing node ML values after computing kernel: " << p_op_kernel->Node().Name();
-    ORT_RETURN_IF_ERROR(ReleaseNodeMLValues(frame, seq_exec_plan, node_exec_plan, logger));
+    if (node_record.free_from_index <= node_record.free_to_index) {
+      VLOGS(logger, 1) << "Releasing node ML values after computing kernel: " << p_op_kernel->Node().Name();
+      ORT_RETURN_IF_ERROR(ReleaseNodeMLValues(frame, seq_exec_plan, node_record, logger));
+    }
   }
 
   VLOGS(logger, 1) << "Fetching output.";
@@ -181,6 +169,10 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     }
   }
 
+  if (reuse_frame_) {
+    frame_ = std::move(p_frame);
+  }
+
   if (f_profiler_enabled) {
     session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "SequentialExecutor::Execute", tp);
   }
@@ -188,11 +180,68 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   return Status::OK();
 }
 
+static void SyncBeforeCompute(const NodeExecutionRecord& node_record, const OpKernelContextInternal& op_kernel_context) {
+  const OpKernel& op_kernel = *node_record.kernel;
+  int queue_id = node_record.queue_id;
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = op_kernel.Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == op_kernel.KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = op_kernel.Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == op_kernel.KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->BeforeUsingAsOutput(op_kernel.Node().GetExecutionProviderType(), queue_id);
+    }
+  }
+}
+
+static void SyncAfterCompute(const NodeExecutionRecord& node_record, const OpKernelContextInternal& op_kernel_context) {
+  int queue_id = node_record.queue_id;
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->AfterUsedAsOutput(queue_id);
+    }
+  }
+}
+
 static Status ReleaseNodeMLValues(ExecutionFrame& frame,
                                   const SequentialExecutionPlan& seq_exec_plan,
-                                  const SequentialExecutionPlan::NodeExecutionPlan& node_exec_plan,
+                                  const NodeExecutionRecord& node_record,
                                   const logging::Logger& logger) {
-  for (auto i = node_exec_plan.free_from_index; i <= node_exec_plan.free_to_index; ++i) {
+  for (auto i = node_record.free_from_index; i <= node_record.free_to_index; ++i) {
     auto mlvalue_idx = seq_exec_plan.to_be_freed[i];
     VLOGS(logger, 1) << "Releasing mlvalue with index: " << mlvalue_idx;
     ORT_RETURN_IF_ERROR(frame.ReleaseMLValue(mlvalue_idx));
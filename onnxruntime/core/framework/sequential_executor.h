@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include "core/common/common.h"
 #include "core/common/status.h"
@@ -14,9 +15,17 @@
 #include "core/graph/graph_viewer.h"
 
 namespace onnxruntime {
+class ExecutionFrame;
+
 class SequentialExecutor : public IExecutor {
  public:
-  SequentialExecutor(const bool& terminate_flag = false) : terminate_flag_{terminate_flag} {}
+  // If reuse_frame is true the ExecutionFrame is kept between calls to Execute and reset for the next call when
+  // possible. Use this when the same graph is executed repeatedly with feeds of the same shape, e.g. for each
+  // iteration of a Scan subgraph.
+  SequentialExecutor(const bool& terminate_flag = false, bool reuse_frame = false)
+      : terminate_flag_{terminate_flag}, reuse_frame_{reuse_frame} {}
+
+  ~SequentialExecutor() override;
 
   common::Status Execute(const SessionState& session_state,
                          const std::vector<int>& feed_mlvalue_idxs,
@@ -29,5 +38,7 @@ class SequentialExecutor : public IExecutor {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SequentialExecutor);
   const bool& terminate_flag_;
+  const bool reuse_frame_;
+  std::unique_ptr<ExecutionFrame> frame_;
 };
 }  // namespace onnxruntime
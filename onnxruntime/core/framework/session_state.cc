@@ -3,6 +3,9 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <sstream>
 
 #include "core/common/logging/logging.h"
@@ -196,10 +199,78 @@ const SessionState* SessionState::GetSubgraphSessionState(onnxruntime::NodeIndex
   return const_cast<SessionState*>(this)->GetMutableSubgraphSessionState(index, attribute_name);
 }
 
+// Critical path length of each node, walking the graph backwards from its outputs.
+static std::vector<int64_t> CalculateCriticalPaths(const GraphViewer& graph_viewer,
+                                                   const std::function<int64_t(const Node&)>& node_cost) {
+  std::vector<int64_t> critical_paths(graph_viewer.MaxNodeIndex(), 0);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const Node& node = *graph_viewer.GetNode(*it);
+    int64_t successor_path = 0;
+    for (auto output = node.OutputNodesBegin(); output != node.OutputNodesEnd(); ++output) {
+      successor_path = std::max(successor_path, critical_paths[output->Index()]);
+    }
+    critical_paths[*it] = node_cost(node) + successor_path;
+  }
+  return critical_paths;
+}
+
+std::shared_ptr<const std::vector<int64_t>> SessionState::GetNodePriorities() const {
+  return std::atomic_load(&node_priorities_);
+}
+
+void SessionState::UpdateNodePriorities(const profiling::OpStatistics& op_statistics) {
+  ORT_ENFORCE(graph_viewer_);
+  auto priorities = CalculateCriticalPaths(*graph_viewer_, [&op_statistics](const Node& node) -> int64_t {
+    auto it = op_statistics.nodes.find(node.Name());
+    if (it == op_statistics.nodes.end() || it->second.count == 0) {
+      return 1;
+    }
+    // the latencies are in microseconds, treat anything faster as the unit cost of an unmeasured node
+    return std::max<int64_t>(1, it->second.total / static_cast<int64_t>(it->second.count));
+  });
+  std::atomic_store(&node_priorities_,
+                    std::shared_ptr<const std::vector<int64_t>>(
+                        std::make_shared<std::vector<int64_t>>(std::move(priorities))));
+
+  for (auto& node_to_map_pair : subgraph_session_states_) {
+    for (auto& attr_name_to_subgraph : node_to_map_pair.second) {
+      attr_name_to_subgraph.second->UpdateNodePriorities(op_statistics);
+    }
+  }
+}
+
 void SessionState::CalculateNodeIndexInfo() {
   ORT_ENFORCE(graph_viewer_);
   node_index_info_ = std::make_unique<NodeIndexInfo>(*graph_viewer_, mlvalue_name_idx_map_);
 
+  std::atomic_store(&node_priorities_,
+                    std::shared_ptr<const std::vector<int64_t>>(std::make_shared<std::vector<int64_t>>(
+                        CalculateCriticalPaths(*graph_viewer_, [](const Node&) -> int64_t { return 1; }))));
+
+  node_execution_records_.clear();
+  execution_plan_uses_fences_ = true;
+  if (p_seq_exec_plan_) {
+    execution_plan_uses_fences_ = false;
+    for (const auto& alloc_plan : p_seq_exec_plan_->allocation_plan) {
+      if (alloc_plan.create_fence_if_async) {
+        execution_plan_uses_fences_ = true;
+        break;
+      }
+    }
+
+    node_execution_records_.reserve(p_seq_exec_plan_->execution_plan.size());
+    for (const auto& node_exec_plan : p_seq_exec_plan_->execution_plan) {
+      NodeExecutionRecord record;
+      record.kernel = GetKernel(node_exec_plan.node_index);
+      record.node_index = node_exec_plan.node_index;
+      record.queue_id = record.kernel != nullptr ? record.kernel->KernelDef().ExecQueueId() : 0;
+      record.free_from_index = node_exec_plan.free_from_index;
+      record.free_to_index = node_exec_plan.free_to_index;
+      node_execution_records_.push_back(record);
+    }
+  }
+
   for (auto& node_to_map_pair : subgraph_session_states_) {
     for (auto& attr_name_to_subgraph : node_to_map_pair.second) {
       attr_name_to_subgraph.second->CalculateNodeIndexInfo();
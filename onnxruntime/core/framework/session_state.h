@@ -179,6 +179,11 @@ class SessionState {
   bool ExportDll() const { return export_fused_dll_; }
   void SetExportDllFlag(bool flag) { export_fused_dll_ = flag; }
 
+  // Whether Scan may run the entries of a batch concurrently on the thread pool.
+  // See SessionOptions::enable_scan_batch_parallelism.
+  bool ScanBatchParallelismEnabled() const { return enable_scan_batch_parallelism_; }
+  void SetScanBatchParallelismFlag(bool flag) { enable_scan_batch_parallelism_ = flag; }
+
   const FuncManager& GetFuncMgr() const { return fused_funcs_mgr_; }
   FuncManager& GetMutableFuncMgr() { return fused_funcs_mgr_; }
 
@@ -187,6 +192,23 @@ class SessionState {
   void CalculateNodeIndexInfo();
   const NodeIndexInfo& GetNodeIndexInfo() const;
 
+  // Execution records for the nodes of the execution plan, in execution order.
+  // Calculated by CalculateNodeIndexInfo once the execution plan and the kernels have been created.
+  const std::vector<NodeExecutionRecord>& GetNodeExecutionRecords() const { return node_execution_records_; }
+
+  // Returns true if a value of the execution plan may be created with a fence, which is the case when a kernel
+  // runs on an asynchronous execution queue. Without fences the executor skips all synchronization.
+  bool ExecutionPlanUsesFences() const { return execution_plan_uses_fences_; }
+
+  // Length of the longest path from each node to the end of the graph, indexed by NodeIndex. The ParallelExecutor
+  // runs the ready nodes with the largest value first so the critical path is not delayed by cheap side branches.
+  // Every node costs 1 until UpdateNodePriorities provides measured latencies.
+  std::shared_ptr<const std::vector<int64_t>> GetNodePriorities() const;
+
+  // Recalculate the node priorities, including those of the subgraphs, using the mean kernel latencies in
+  // op_statistics as the node costs. May be called while the session is running.
+  void UpdateNodePriorities(const profiling::OpStatistics& op_statistics);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SessionState);
 
@@ -230,9 +252,14 @@ class SessionState {
 #endif
 
   bool export_fused_dll_ = false;
+  bool enable_scan_batch_parallelism_ = false;
   FuncManager fused_funcs_mgr_;
 
   std::unique_ptr<NodeIndexInfo> node_index_info_;
+  std::vector<NodeExecutionRecord> node_execution_records_;
+  bool execution_plan_uses_fences_ = true;
+  // replaced atomically by UpdateNodePriorities, so an executor keeps a consistent snapshot
+  std::shared_ptr<const std::vector<int64_t>> node_priorities_;
   std::multimap<int, std::unique_ptr<FeedsFetchesManager>> cached_feeds_fetches_managers_;
 };
 
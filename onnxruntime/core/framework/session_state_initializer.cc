@@ -4,6 +4,8 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/framework/session_state_initializer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <limits>
 #include <core/common/status.h>
@@ -12,12 +14,15 @@
 #include "core/common/logging/logging.h"
 
 #include "core/graph/graph_viewer.h"
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/graph_partitioner.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/ml_value_patterns_planner.h"
 #include "core/framework/mlvalue_name_idx_map.h"
+#include "core/framework/parallel_for.h"
 #include "core/framework/sequential_execution_plan.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/framework/mem_buffer.h"
@@ -36,11 +41,14 @@ static common::Status SaveInitializedTensors(const Env& env, const std::basic_st
                                              const ExecutionProviders& exec_providers,
                                              const MLValueNameIdxMap& mlvalue_name_idx_map,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
-                                             const T& save_tensor_func, const logging::Logger& logger);
+                                             const T& save_tensor_func, SessionThreadPool* thread_pool,
+                                             const std::string* shared_initializers_key,
+                                             const logging::Logger& logger);
 
 static common::Status SaveKernels(const ExecutionProviders& execution_providers,
                                   SessionState& session_state,
                                   const KernelRegistryManager& custom_registry_manager,
+                                  SessionThreadPool* thread_pool,
                                   const logging::Logger& logger);
 
 static common::Status SaveInputOutputNamesToNodeMapping(const onnxruntime::Graph& graph,
@@ -59,9 +67,36 @@ SessionStateInitializer::SessionStateInitializer(const std::basic_string<PATH_CH
       kernel_registry_manager_{kernel_registry_manager},
       logger_{session_state.Logger()} {}
 
+// Switch the seq(map) graph outputs of ZipMap nodes that are not consumed by other nodes to the columnar
+// representation. ZipMap checks the runtime type of its output and writes whichever representation was planned.
+static void UseColumnarMapOutputs(const onnxruntime::Graph& graph, const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                  SequentialExecutionPlan& exec_plan) {
+  const auto& graph_outputs = graph.GetOutputs();
+  for (const auto& node : graph.Nodes()) {
+    if (node.OpType() != "ZipMap" || node.Domain() != kMLDomain || node.GetOutputEdgesCount() != 0) {
+      continue;
+    }
+
+    const NodeArg* output = node.OutputDefs()[0];
+    int idx;
+    if (std::find(graph_outputs.cbegin(), graph_outputs.cend(), output) == graph_outputs.cend() ||
+        !mlvalue_name_idx_map.GetIdx(output->Name(), idx).IsOK()) {
+      continue;
+    }
+
+    auto& value_plan = exec_plan.allocation_plan[idx];
+    if (value_plan.value_type == DataTypeImpl::GetType<VectorMapStringToFloat>()) {
+      value_plan.value_type = DataTypeImpl::GetType<ColumnarMapStringToFloat>();
+    } else if (value_plan.value_type == DataTypeImpl::GetType<VectorMapInt64ToFloat>()) {
+      value_plan.value_type = DataTypeImpl::GetType<ColumnarMapInt64ToFloat>();
+    }
+  }
+}
+
 common::Status SessionStateInitializer::CreatePlan(const Node* parent_node,
                                                    const std::vector<NodeArg*>& outer_scope_node_args,
-                                                   bool enable_sequential_execution) {
+                                                   bool enable_sequential_execution,
+                                                   bool enable_columnar_map_outputs) {
   auto graph_viewer = std::make_unique<onnxruntime::GraphViewer>(graph_);
 
   // populate the SessionState MLValueNameIdxMap
@@ -86,29 +121,33 @@ common::Status SessionStateInitializer::CreatePlan(const Node* parent_node,
     ORT_RETURN_IF_ERROR(
         SequentialPlanner::CreatePlan(parent_node, *graph_viewer, valid_outer_scope_node_args, execution_providers_,
                                       kernel_registry_manager_, mlvalue_name_idx_map, exec_plan));
-
-    session_state_.SetExecutionPlan(std::move(exec_plan));
   } else {
     // Parallel execution still uses same allocation plan, but has limitation of memory buffer reuse.
     SequentialPlannerContext context(true /* enable parallel execution */);
     ORT_RETURN_IF_ERROR(
         SequentialPlanner::CreatePlan(parent_node, *graph_viewer, valid_outer_scope_node_args, execution_providers_,
                                       kernel_registry_manager_, mlvalue_name_idx_map, context, exec_plan));
+  }
 
-    session_state_.SetExecutionPlan(std::move(exec_plan));
+  if (enable_columnar_map_outputs && parent_node == nullptr) {
+    UseColumnarMapOutputs(graph_, mlvalue_name_idx_map, *exec_plan);
   }
 
+  session_state_.SetExecutionPlan(std::move(exec_plan));
+
   session_state_.SetGraphViewer(std::move(graph_viewer));
 
   return Status::OK();
 }
 
-common::Status SessionStateInitializer::InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs) {
+common::Status SessionStateInitializer::InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs,
+                                                          bool enable_parallel_initialization) {
   const auto* exec_plan_ptr = session_state_.GetExecutionPlan();
   ORT_ENFORCE(exec_plan_ptr, "Execution plan was not found in SessionState. CreatePlan must be called first.");
 
   const auto& exec_plan{*exec_plan_ptr};
   const auto& mlvalue_name_idx_map{session_state_.GetMLValueNameIdxMap()};
+  SessionThreadPool* thread_pool = enable_parallel_initialization ? session_state_.GetThreadPool() : nullptr;
 
   // lambda to save initialized tensors into SessionState directly
   const Env& env = Env::Default();
@@ -119,13 +158,14 @@ common::Status SessionStateInitializer::InitializeAndSave(const std::vector<Node
           [this](int idx, const onnxruntime::MLValue& value, const OrtCallback& d) -> Status {
             return session_state_.AddInitializedTensor(idx, value, &d);
           },
-          logger_));
+          thread_pool, share_initializers_ ? &shared_initializers_key_ : nullptr, logger_));
   // remove weights from the graph now to save memory but in many cases it won't save memory, if the tensor was
   // preallocated with the some other tensors in a single 'allocate' call, which is very common.
   // TODO: make it better
   graph_.CleanAllInitializedTensors();
 
-  ORT_RETURN_IF_ERROR(SaveKernels(execution_providers_, session_state_, kernel_registry_manager_, logger_));
+  ORT_RETURN_IF_ERROR(SaveKernels(execution_providers_, session_state_, kernel_registry_manager_, thread_pool,
+                                  logger_));
   ORT_RETURN_IF_ERROR(SaveInputOutputNamesToNodeMapping(graph_, kernel_registry_manager_, session_state_,
                                                         implicit_inputs));
 
@@ -186,11 +226,16 @@ common::Status SaveMLValueNameIndexMapping(const GraphViewer& graph_viewer,
   return Status::OK();
 }
 
+// Initializers in CPU accessible memory are deserialized directly into their preallocated buffer.
+static bool DeserializesToCpu(const OrtAllocatorInfo& alloc_info) {
+  return strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput;
+}
+
 static common::Status DeserializeTensorProto(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
                                              const ONNX_NAMESPACE::TensorProto& tensor_proto, const MemBuffer& m,
                                              const ExecutionProviders& exec_providers, MLValue& mlvalue, OrtCallback& deleter) {
   const OrtAllocatorInfo& alloc_info = m.GetAllocInfo();
-  if (strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput) {
+  if (DeserializesToCpu(alloc_info)) {
     // deserialize directly to CPU tensor
     return utils::TensorProtoToMLValue(env, proto_path.c_str(), tensor_proto, m, mlvalue, deleter);
   }
@@ -245,6 +290,118 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
   return common::Status::OK();
 }
 
+// Initializers smaller than this are not shared, they are cheaper to keep in the weights buffer of the session.
+static constexpr size_t kMinSharedInitializerBytes = 1024;
+
+static common::Status IsShareable(const ONNX_NAMESPACE::TensorProto& tensor_proto, const OrtAllocatorInfo& location,
+                                  bool& is_shareable) {
+  is_shareable = false;
+  if (strcmp(location.name, CPU) != 0 || location.mem_type != OrtMemTypeDefault ||
+      tensor_proto.data_type() == ONNX_NAMESPACE::TensorProto_DataType_STRING) {
+    return Status::OK();
+  }
+  size_t len;
+  ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<0>(tensor_proto, &len));
+  is_shareable = len >= kMinSharedInitializerBytes;
+  return Status::OK();
+}
+
+// Deserializes an initializer into a buffer of its own, so it can outlive the session.
+static common::Status DeserializeSharedTensor(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
+                                              const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                              std::shared_ptr<const Tensor>& tensor) {
+  struct SharedTensor {
+    ~SharedTensor() {
+      if (deleter.f != nullptr) deleter.f(deleter.param);
+    }
+    BufferUniquePtr buffer;
+    MLValue mlvalue;
+    OrtCallback deleter{nullptr, nullptr};
+  };
+
+  static const AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  size_t len;
+  ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<0>(tensor_proto, &len));
+  auto shared_tensor = std::make_shared<SharedTensor>();
+  shared_tensor->buffer = BufferUniquePtr(allocator->Alloc(len), BufferDeleter(allocator));
+  ORT_RETURN_IF_ERROR(utils::TensorProtoToMLValue(env, proto_path.c_str(), tensor_proto,
+                                                  MemBuffer(shared_tensor->buffer.get(), len, allocator->Info()),
+                                                  shared_tensor->mlvalue, shared_tensor->deleter));
+  tensor = std::shared_ptr<const Tensor>(shared_tensor, &shared_tensor->mlvalue.Get<Tensor>());
+  return Status::OK();
+}
+
+static void ORT_API_CALL ReleaseSharedTensor(void* param) noexcept {
+  delete static_cast<std::shared_ptr<const Tensor>*>(param);
+}
+
+// Checks that the tensor stored under a shared initializers key has the content of the initializer of the model.
+// Initializers with raw data are compared without deserializing them, otherwise the deserialized copy is returned
+// in own_tensor so it can be used if the content differs.
+static common::Status HasSameContent(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
+                                     const ONNX_NAMESPACE::TensorProto& tensor_proto, const Tensor& stored,
+                                     std::shared_ptr<const Tensor>& own_tensor, bool& same_content) {
+  if (tensor_proto.has_raw_data() &&
+      tensor_proto.data_location() != ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL) {
+    const std::string& raw_data = tensor_proto.raw_data();
+    same_content = raw_data.size() == stored.Size() && memcmp(raw_data.data(), stored.DataRaw(), stored.Size()) == 0;
+    return Status::OK();
+  }
+  ORT_RETURN_IF_ERROR(DeserializeSharedTensor(env, proto_path, tensor_proto, own_tensor));
+  same_content = memcmp(own_tensor->DataRaw(), stored.DataRaw(), stored.Size()) == 0;
+  return Status::OK();
+}
+
+// Gets the initializer from SharedInitializerStore, adding it if it's not there yet. The MLValue of the session
+// refers to the stored tensor, which the deleter keeps alive until the session is released.
+static common::Status GetSharedTensor(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
+                                      const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                      const OrtAllocatorInfo& location, const std::string& shared_initializers_key,
+                                      MLValue& mlvalue, OrtCallback& deleter, const logging::Logger& logger) {
+  auto& store = SharedInitializerStore::Instance();
+  const std::string key = shared_initializers_key.empty() ? "" : shared_initializers_key + "/" + tensor_proto.name();
+
+  std::shared_ptr<const Tensor> tensor;
+  bool stored_by_session = false;
+  if (!key.empty()) {
+    tensor = store.Find(key);
+  }
+  if (tensor == nullptr) {
+    std::shared_ptr<const Tensor> new_tensor;
+    ORT_RETURN_IF_ERROR(DeserializeSharedTensor(env, proto_path, tensor_proto, new_tensor));
+    tensor = store.Insert(key, new_tensor);
+    stored_by_session = tensor == new_tensor;
+  }
+
+  // a tensor stored under the key by another session may come from a model with a different initializer of the same
+  // name, which must not be shared. the session then uses its own copy.
+  if (!key.empty() && !stored_by_session) {
+    const TensorShape shape(std::vector<int64_t>(tensor_proto.dims().begin(), tensor_proto.dims().end()));
+    const auto* type = DataTypeImpl::TensorTypeFromONNXEnum(tensor_proto.data_type())->GetElementType();
+    std::shared_ptr<const Tensor> own_tensor;
+    bool same_content = tensor->DataType() == type && tensor->Shape() == shape;
+    if (same_content) {
+      ORT_RETURN_IF_ERROR(HasSameContent(env, proto_path, tensor_proto, *tensor, own_tensor, same_content));
+    }
+    if (!same_content) {
+      LOGS(logger, WARNING) << "Shared initializer " << key << " with shape " << shape << " differs from the tensor "
+                            << "with shape " << tensor->Shape() << " stored under the same key by another session "
+                            << "and is not shared. Sessions that use the same shared initializers key must have the "
+                            << "same initializers.";
+      if (own_tensor == nullptr) {
+        ORT_RETURN_IF_ERROR(DeserializeSharedTensor(env, proto_path, tensor_proto, own_tensor));
+      }
+      tensor = std::move(own_tensor);
+    }
+  }
+
+  mlvalue.Init(new Tensor(tensor->DataType(), tensor->Shape(), const_cast<void*>(tensor->DataRaw()), location),
+               DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+  deleter.f = ReleaseSharedTensor;
+  deleter.param = new std::shared_ptr<const Tensor>(std::move(tensor));
+  return Status::OK();
+}
+
 static common::Status AllocatePlannedBuffers(const MemoryPatternGroup& mem_patterns,
                                              const ExecutionProviders& exec_providers,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers) {
@@ -311,7 +468,9 @@ common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PA
                                       const ExecutionProviders& exec_providers,
                                       const MLValueNameIdxMap& mlvalue_name_idx_map,
                                       std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
-                                      const T& save_tensor_func, const logging::Logger& logger) {
+                                      const T& save_tensor_func, SessionThreadPool* thread_pool,
+                                      const std::string* shared_initializers_key,
+                                      const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
   static constexpr int alignment = 256;
   ORT_ENFORCE(mlvalue_name_idx_map.MaxIdx() > 0, "MLValue indexes should have been populated.");
@@ -321,11 +480,18 @@ common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PA
   //1. first plan the memory
   const onnxruntime::InitializedTensorSet& initialized_tensor_set = graph.GetAllInitializedTensors();
   std::unordered_map<int, const ONNX_NAMESPACE::TensorProto*> id_to_initialized_tensor;
+  std::unordered_map<int, const ONNX_NAMESPACE::TensorProto*> id_to_shared_tensor;
   for (const auto& entry : initialized_tensor_set) {
     int mlvalue_index;
     ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(entry.first, mlvalue_index));
-    id_to_initialized_tensor[mlvalue_index] = entry.second;
+    bool is_shared = false;
+    if (shared_initializers_key != nullptr) {
+      ORT_RETURN_IF_ERROR(IsShareable(*entry.second, execution_plan.allocation_plan[mlvalue_index].location,
+                                      is_shared));
+    }
+    (is_shared ? id_to_shared_tensor : id_to_initialized_tensor)[mlvalue_index] = entry.second;
   }
+  // the shared initializers are not part of the weights buffer of the session
   for (const auto& entry : id_to_initialized_tensor) {
     size_t len;
     ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<alignment>(*entry.second, &len));
@@ -336,12 +502,26 @@ common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PA
   MemoryPatternGroup mem_patterns;
   ORT_RETURN_IF_ERROR(planner.GeneratePatterns(&mem_patterns));
   ORT_RETURN_IF_ERROR(AllocatePlannedBuffers(mem_patterns, exec_providers, weights_buffers));
-  OrtCallback deleter;
-  //3. create weight tensors based on weights buffer
+  //3. find the preallocated buffer of each weight
+  struct InitializerToSave {
+    int mlvalue_index;
+    const ONNX_NAMESPACE::TensorProto* tensor_proto;
+    const OrtAllocatorInfo* location;
+    void* buffer;
+    size_t len;
+    bool is_shared;
+    MLValue mlvalue;
+    OrtCallback deleter;
+  };
+
+  std::vector<InitializerToSave> initializers;
+  initializers.reserve(id_to_initialized_tensor.size() + id_to_shared_tensor.size());
+  std::vector<size_t> cpu_initializers;
+  std::vector<size_t> device_initializers;
+
   for (const auto& entry : id_to_initialized_tensor) {
     int mlvalue_index = entry.first;
     const char* name = entry.second->has_name() ? entry.second->name().c_str() : "";
-    const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
 
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
     void* buffer = nullptr;
@@ -353,18 +533,74 @@ common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PA
     ORT_ENFORCE(buffer != nullptr || len == 0);
 #endif
 
-    MemBuffer m(buffer, len, location);
-    MLValue mlvalue;
-    Status st = DeserializeTensorProto(env, graph_loc, tensor_proto, m, exec_providers, mlvalue, deleter);
+    (DeserializesToCpu(location) ? cpu_initializers : device_initializers).push_back(initializers.size());
+    initializers.push_back({mlvalue_index, entry.second, &location, buffer, len, false, MLValue(),
+                            OrtCallback{nullptr, nullptr}});
+  }
+
+  for (const auto& entry : id_to_shared_tensor) {
+    int mlvalue_index = entry.first;
+    auto& location = execution_plan.allocation_plan[mlvalue_index].location;
+    cpu_initializers.push_back(initializers.size());
+    initializers.push_back({mlvalue_index, entry.second, &location, nullptr, 0, true, MLValue(),
+                            OrtCallback{nullptr, nullptr}});
+  }
+
+  //4. create weight tensors based on weights buffer
+  auto deserialize = [&](size_t i) -> Status {
+    auto& initializer = initializers[i];
+    const ONNX_NAMESPACE::TensorProto& tensor_proto = *initializer.tensor_proto;
+    Status st;
+    if (initializer.is_shared) {
+      st = GetSharedTensor(env, graph_loc, tensor_proto, *initializer.location, *shared_initializers_key,
+                           initializer.mlvalue, initializer.deleter, logger);
+    } else {
+      MemBuffer m(initializer.buffer, initializer.len, *initializer.location);
+      st = DeserializeTensorProto(env, graph_loc, tensor_proto, m, exec_providers, initializer.mlvalue,
+                                  initializer.deleter);
+    }
     if (!st.IsOK()) {
       std::ostringstream oss;
-      oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
+      oss << "Deserialize tensor " << (tensor_proto.has_name() ? tensor_proto.name() : "") << " failed."
+          << st.ErrorMessage();
       return Status(st.Category(), st.Code(), oss.str());
     }
+    return Status::OK();
+  };
+
+  // each weight is deserialized into its own part of the weights buffer, so the weights in CPU memory can be
+  // deserialized in parallel. the copies to other devices are done by the calling thread.
+  Status status = ParallelFor(thread_pool, cpu_initializers.size(),
+                              [&](size_t i) { return deserialize(cpu_initializers[i]); });
+  for (size_t i = 0; status.IsOK() && i < device_initializers.size(); ++i) {
+    status = deserialize(device_initializers[i]);
+  }
+
+  if (!status.IsOK()) {
+    for (auto& initializer : initializers) {
+      if (initializer.deleter.f != nullptr) {
+        initializer.deleter.f(initializer.deleter.param);
+      }
+    }
+    return status;
+  }
 
-    ORT_RETURN_IF_ERROR(save_tensor_func(mlvalue_index, mlvalue, deleter));
+  //5. save them in the same order as the weights were planned
+  for (size_t i = 0; i < initializers.size(); ++i) {
+    auto& initializer = initializers[i];
+    status = save_tensor_func(initializer.mlvalue_index, initializer.mlvalue, initializer.deleter);
+    if (!status.IsOK()) {
+      // the weights that were not saved yet are not owned by anything
+      for (size_t j = i + 1; j < initializers.size(); ++j) {
+        if (initializers[j].deleter.f != nullptr) {
+          initializers[j].deleter.f(initializers[j].deleter.param);
+        }
+      }
+      return status;
+    }
 
-    VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
+    VLOGS(logger, 1) << "Added weight with name : " << initializer.tensor_proto->name()
+                     << " with index: " << initializer.mlvalue_index;
   }
 
   LOGS(logger, INFO) << "Done saving initialized tensors";
@@ -396,14 +632,30 @@ static common::Status CreateOpKernel(const onnxruntime::Node& node, const Execut
 common::Status SaveKernels(const ExecutionProviders& execution_providers,
                            SessionState& session_state,
                            const KernelRegistryManager& custom_registry_manager,
+                           SessionThreadPool* thread_pool,
                            const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving kernels.";
 
+  std::vector<const Node*> nodes;
   for (auto& node : session_state.GetGraphViewer()->Nodes()) {
-    // construct and save the kernels
-    std::unique_ptr<OpKernel> op_kernel;
-    ORT_RETURN_IF_ERROR(CreateOpKernel(node, execution_providers, session_state, custom_registry_manager, op_kernel));
-    session_state.AddKernel(node.Index(), std::move(op_kernel));
+    nodes.push_back(&node);
+  }
+
+  // construct the kernels. a kernel only reads the node and the initializers while it's being constructed,
+  // so the kernels can be constructed in parallel. the kernels of custom registries come from user code that
+  // doesn't promise this, so they are all constructed on the calling thread.
+  if (custom_registry_manager.HasCustomKernelRegistries()) {
+    thread_pool = nullptr;
+  }
+
+  std::vector<std::unique_ptr<OpKernel>> op_kernels(nodes.size());
+  ORT_RETURN_IF_ERROR(ParallelFor(thread_pool, nodes.size(), [&](size_t i) {
+    return CreateOpKernel(*nodes[i], execution_providers, session_state, custom_registry_manager, op_kernels[i]);
+  }));
+
+  // save the kernels
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    session_state.AddKernel(nodes[i]->Index(), std::move(op_kernels[i]));
   }
 
   LOGS(logger, INFO) << "Done saving kernels.";
@@ -3,6 +3,7 @@
 
 #pragma once
 #include <map>
+#include <string>
 
 #include "core/framework/allocator.h"
 #include "core/framework/tensor.h"
@@ -34,13 +35,26 @@ class SessionStateInitializer {
                           KernelRegistryManager& kernel_registry_manager);
 
   // First perform any transformations and create the execution plan
+  // \param enable_columnar_map_outputs Allocate seq(map) graph outputs of ZipMap nodes as ColumnarMapSequence.
+  //        Only applies to the main graph.
   common::Status CreatePlan(const Node* parent_node,
                             const std::vector<NodeArg*>& outer_scope_node_args,
-                            bool enable_sequential_execution);
+                            bool enable_sequential_execution,
+                            bool enable_columnar_map_outputs = false);
 
   // initialize tensors, and save. save kernels and input/output node mappings
   // \param implicit_inputs could be NULL
-  common::Status InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs);
+  // \param enable_parallel_initialization Deserialize the initializers and create the kernels on the thread pool
+  //        of the SessionState. Ignored if the SessionState has no thread pool.
+  common::Status InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs,
+                                   bool enable_parallel_initialization = false);
+
+  // Make InitializeAndSave use the CPU initializers of SharedInitializerStore, so they are shared with other
+  // sessions. They are matched by content, or by key and initializer name if key is not empty.
+  void EnableSharedInitializers(const std::string& key) {
+    share_initializers_ = true;
+    shared_initializers_key_ = key;
+  }
 
  private:
   const std::basic_string<PATH_CHAR_TYPE>& graph_loc_;
@@ -50,5 +64,8 @@ class SessionStateInitializer {
   const ExecutionProviders& execution_providers_;
   KernelRegistryManager& kernel_registry_manager_;
   const logging::Logger& logger_;
+
+  bool share_initializers_ = false;
+  std::string shared_initializers_key_;
 };
 }  // namespace onnxruntime
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_initializer_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace onnxruntime {
+
+namespace {
+
+// Hashes 8 bytes at a time, as the content of every initializer is hashed when it's matched by content.
+size_t HashContent(const Tensor& tensor) {
+  const auto* data = static_cast<const unsigned char*>(tensor.DataRaw());
+  const size_t size = tensor.Size();
+
+  uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+  auto mix = [&hash](uint64_t word) {
+    hash ^= word;
+    hash *= 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 32;
+  };
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    mix(word);
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data + i, size - i);
+  mix(tail);
+
+  for (auto dim : tensor.Shape().GetDims()) {
+    mix(static_cast<uint64_t>(dim));
+  }
+  mix(static_cast<uint64_t>(std::hash<const void*>()(tensor.DataType())));
+  return static_cast<size_t>(hash);
+}
+
+bool HaveSameContent(const Tensor& tensor1, const Tensor& tensor2) {
+  return tensor1.DataType() == tensor2.DataType() && tensor1.Shape() == tensor2.Shape() &&
+         memcmp(tensor1.DataRaw(), tensor2.DataRaw(), tensor1.Size()) == 0;
+}
+
+}  // namespace
+
+SharedInitializerStore& SharedInitializerStore::Instance() {
+  static SharedInitializerStore store;
+  return store;
+}
+
+std::shared_ptr<const Tensor> SharedInitializerStore::Find(const std::string& key) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto it = tensors_by_key_.find(key);
+  return it != tensors_by_key_.end() ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<const Tensor> SharedInitializerStore::Insert(const std::string& key,
+                                                             std::shared_ptr<const Tensor> tensor) {
+  // hash outside of the lock, it reads the whole tensor
+  const size_t hash = key.empty() ? HashContent(*tensor) : 0;
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  // the entries of released tensors are dropped once the store has doubled in size, so inserting stays O(1)
+  if (tensors_by_key_.size() + tensors_by_content_.size() >= 2 * entries_after_cleanup_) {
+    RemoveExpiredEntries();
+  }
+
+  if (!key.empty()) {
+    auto& entry = tensors_by_key_[key];
+    auto stored = entry.lock();
+    if (stored == nullptr) {
+      entry = tensor;
+      return tensor;
+    }
+    // keep the first tensor stored under the key, the caller uses its own copy if the content differs
+    return HaveSameContent(*stored, *tensor) ? stored : tensor;
+  }
+
+  auto range = tensors_by_content_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto stored = it->second.lock();
+    if (stored != nullptr && HaveSameContent(*stored, *tensor)) {
+      return stored;
+    }
+  }
+  tensors_by_content_.emplace(hash, tensor);
+  return tensor;
+}
+
+SharedInitializerStore::Statistics SharedInitializerStore::GetStatistics() {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  RemoveExpiredEntries();
+
+  Statistics statistics;
+  auto add = [&statistics](const std::weak_ptr<const Tensor>& entry) {
+    auto tensor = entry.lock();
+    if (tensor == nullptr) {
+      return;
+    }
+    // the use count includes the reference taken here
+    const size_t users = static_cast<size_t>(tensor.use_count()) - 1;
+    statistics.tensors++;
+    statistics.bytes += tensor->Size();
+    statistics.bytes_saved += (users > 1 ? users - 1 : 0) * tensor->Size();
+  };
+  for (const auto& entry : tensors_by_key_) {
+    add(entry.second);
+  }
+  for (const auto& entry : tensors_by_content_) {
+    add(entry.second);
+  }
+  return statistics;
+}
+
+void SharedInitializerStore::RemoveExpiredEntries() {
+  for (auto it = tensors_by_key_.begin(); it != tensors_by_key_.end();) {
+    it = it->second.expired() ? tensors_by_key_.erase(it) : std::next(it);
+  }
+  for (auto it = tensors_by_content_.begin(); it != tensors_by_content_.end();) {
+    it = it->second.expired() ? tensors_by_content_.erase(it) : std::next(it);
+  }
+  entries_after_cleanup_ = std::max<size_t>(tensors_by_key_.size() + tensors_by_content_.size(), 64);
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "core/common/common.h"
+#include "core/framework/tensor.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+@class SharedInitializerStore
+
+Process wide store of the CPU initializers shared by sessions, see SessionOptions::enable_shared_initializers.
+A session that finds an initializer with the same type, shape and content in the store uses the stored tensor
+instead of deserializing its own copy. Tensors are matched by content, or by a key chosen by the user, and the
+store only holds weak references, so a tensor is released with the last session that uses it.
+The stored tensors are read-only.
+*/
+class SharedInitializerStore {
+ public:
+  struct Statistics {
+    // number of distinct tensors held by sessions
+    size_t tensors{0};
+    // bytes of the distinct tensors
+    size_t bytes{0};
+    // bytes that would be used in addition if every user of a tensor had its own copy
+    size_t bytes_saved{0};
+  };
+
+  static SharedInitializerStore& Instance();
+
+  // Returns the tensor stored under key, or null if there is none.
+  std::shared_ptr<const Tensor> Find(const std::string& key);
+
+  // Stores tensor under key, or under its content if key is empty. If a tensor with the same key, type, shape and
+  // content is already stored, that tensor is returned and the given one is released. Otherwise the given tensor
+  // is returned, which is shared by later sessions unless a different tensor is stored under the same key.
+  std::shared_ptr<const Tensor> Insert(const std::string& key, std::shared_ptr<const Tensor> tensor);
+
+  Statistics GetStatistics();
+
+ private:
+  SharedInitializerStore() = default;
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedInitializerStore);
+
+  // drop the entries of the tensors that were released. called with mutex_ held.
+  void RemoveExpiredEntries();
+
+  OrtMutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<const Tensor>> tensors_by_key_;
+  // keyed by content hash, a hash can have several tensors with different contents.
+  std::unordered_multimap<size_t, std::weak_ptr<const Tensor>> tensors_by_content_;
+  size_t entries_after_cleanup_{64};
+};
+
+}  // namespace onnxruntime
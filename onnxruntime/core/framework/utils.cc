@@ -449,15 +449,20 @@ common::Status ExecuteGraphWithCachedInfo(const SessionState& session_state,
                                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                                           bool sequential_execution,
                                           const bool& terminate_flag,
-                                          const logging::Logger& logger) {
+                                          const logging::Logger& logger,
+                                          IExecutor* executor) {
   const auto& feeds_fetches_info = feeds_fetches_manager.GetFeedsFetchesInfo();
   auto device_copy_checks = feeds_fetches_manager.GetDeviceCopyChecks();
 
-  std::unique_ptr<IExecutor> p_exec;
-  if (sequential_execution) {
-    p_exec = std::unique_ptr<IExecutor>(new SequentialExecutor(terminate_flag));
-  } else {
-    p_exec = std::unique_ptr<IExecutor>(new ParallelExecutor(session_state, terminate_flag));
+  std::unique_ptr<IExecutor> new_exec;
+  IExecutor* p_exec = executor;
+  if (!p_exec) {
+    if (sequential_execution) {
+      new_exec = std::unique_ptr<IExecutor>(new SequentialExecutor(terminate_flag));
+    } else {
+      new_exec = std::unique_ptr<IExecutor>(new ParallelExecutor(session_state, terminate_flag));
+    }
+    p_exec = new_exec.get();
   }
 
   if (device_copy_checks.status == DeviceCopyCheck::NoCopy) {
@@ -56,6 +56,8 @@ common::Status ExecuteGraph(const SessionState& session_state,
                             bool cache_copy_info = true);
 
 // ExecuteGraph used the cached information in feeds_fetches_manager.
+// If executor is provided it is used instead of creating a new executor, and sequential_execution is ignored.
+// This allows a caller that executes the graph repeatedly to keep state such as the ExecutionFrame between calls.
 common::Status ExecuteGraphWithCachedInfo(const SessionState& session_state,
                                           const FeedsFetchesManager& feeds_fetches_manager,
                                           const std::vector<MLValue>& feeds,
@@ -63,7 +65,8 @@ common::Status ExecuteGraphWithCachedInfo(const SessionState& session_state,
                                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                                           bool sequential_execution,
                                           const bool& terminate_flag,
-                                          const logging::Logger& logger);
+                                          const logging::Logger& logger,
+                                          IExecutor* executor = nullptr);
 
 #define DispatchOnTensorType(tensor_type, function, ...)      \
   if (tensor_type == DataTypeImpl::GetType<float>())          \
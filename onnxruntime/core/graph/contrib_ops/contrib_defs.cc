@@ -220,7 +220,147 @@ void convPoolShapeInference(
   }
 }
 
+// The operators of the NCHWc domain are inserted by the NchwcTransformer. Their tensors use the channel blocked
+// NCHWc layout: the logical shape is [N, C, H, W] where C is padded to a multiple of the block size of the CPU
+// kernels, and the channels of a block are stored contiguously for each spatial position.
+static void RegisterNchwcSchemas() {
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderInput)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Reorders a NCHW tensor to the NCHWc layout. The channels are padded with zeros.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        if (!hasInputShape(ctx, 0)) {
+          return;
+        }
+        // the padded channel count depends on the block size of the kernels
+        auto& input_shape = getInputShape(ctx, 0);
+        auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+        for (int i = 0; i < input_shape.dim_size(); ++i) {
+          auto* dim = output_shape->add_dim();
+          if (i != 1) {
+            *dim = input_shape.dim(i);
+          }
+        }
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderOutput)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Reorders a NCHWc tensor to the NCHW layout. The padding channels are dropped.)DOC")
+      .Attr("channels", "Number of channels of the NCHW output", AttributeProto::INT)
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        if (!hasInputShape(ctx, 0)) {
+          return;
+        }
+        auto& input_shape = getInputShape(ctx, 0);
+        if (input_shape.dim_size() < 2) {
+          fail_shape_inference("Input tensor must have at least 2 dimensions");
+        }
+        auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+        *output_shape = input_shape;
+        output_shape->mutable_dim(1)->set_dim_value(getAttribute(ctx, "channels", 0));
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(Conv)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(
+Convolution of a NCHWc tensor. The filter W and the optional bias B are reordered for the NCHWc kernels and
+padded to the channel counts of the NCHWc input and output. The attributes are the same as FusedConv.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("dilations", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("group", "", AttributeProto::INT, static_cast<int64_t>(1))
+      .Attr("activation", "", AttributeProto::STRING, OPTIONAL)
+      .Attr("alpha", "", AttributeProto::FLOAT, OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Input(1, "W", "", "T")
+      .Input(2, "B", "", "T", OpSchema::Optional)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, true, false);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(MaxPool)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Maximum pooling of a NCHWc tensor. The attributes are the same as MaxPool.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(AveragePool)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Average pooling of a NCHWc tensor. The attributes are the same as AveragePool.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("count_include_pad", "", AttributeProto::INT, static_cast<int64_t>(0))
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  auto global_pool_shape_inference = [](ONNX_NAMESPACE::InferenceContext& ctx) {
+    propagateElemTypeFromInputToOutput(ctx, 0, 0);
+    if (!hasInputShape(ctx, 0)) {
+      return;
+    }
+    auto& input_shape = getInputShape(ctx, 0);
+    if (input_shape.dim_size() < 2) {
+      return;
+    }
+    auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+    *output_shape->add_dim() = input_shape.dim(0);
+    *output_shape->add_dim() = input_shape.dim(1);
+    for (int i = 2; i < input_shape.dim_size(); ++i) {
+      output_shape->add_dim()->set_dim_value(1);
+    }
+  };
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GlobalMaxPool)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Global maximum pooling of a NCHWc tensor.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(global_pool_shape_inference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GlobalAveragePool)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Global average pooling of a NCHWc tensor.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(global_pool_shape_inference);
+}
+
 void RegisterContribSchemas() {
+  RegisterNchwcSchemas();
 
   // ONNX exp ops(Affine, Crop, ParametricSoftplus, ImageScaler) old version history maintainance
   static const char* Affine_ver1_doc = R"DOC(
@@ -450,6 +590,54 @@ activation.)DOC")
         ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
       });
 
+  ONNX_CONTRIB_OPERATOR_SCHEMA(FusedElementWise)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(
+A chain of element-wise operators fused by the ElementWiseFusion transformer. Step i applies the operator ops[i]
+to the operands operands[2*i] and operands[2*i+1]. An operand k refers to input k if k is less than the number of
+inputs, or otherwise to the result of step k minus the number of inputs. The second operand of a unary operator
+is -1. The optional alphas and betas supply the float attributes of the operators, such as the alpha of LeakyRelu
+or the alpha and beta of HardSigmoid. The inputs are broadcast to a common shape and the output is the result of
+the last step.)DOC")
+      .Attr("ops", "", AttributeProto::STRINGS)
+      .Attr("operands", "", AttributeProto::INTS)
+      .Attr("alphas", "", AttributeProto::FLOATS, OPTIONAL)
+      .Attr("betas", "", AttributeProto::FLOATS, OPTIONAL)
+      .Input(0, "inputs", "", "T", OpSchema::Variadic)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        int rank = 0;
+        for (size_t i = 0; i < ctx.getNumInputs(); ++i) {
+          if (!hasInputShape(ctx, i)) {
+            return;
+          }
+          if (getInputShape(ctx, i).dim_size() > rank) {
+            rank = getInputShape(ctx, i).dim_size();
+          }
+        }
+        // Each dimension is taken from an input that is not broadcast along it.
+        auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+        for (int d = 0; d < rank; ++d) {
+          auto* output_dim = output_shape->add_dim();
+          output_dim->set_dim_value(1);
+          for (size_t i = 0; i < ctx.getNumInputs(); ++i) {
+            auto& input_shape = getInputShape(ctx, i);
+            int input_d = d - (rank - input_shape.dim_size());
+            if (input_d < 0) {
+              continue;
+            }
+            auto& input_dim = input_shape.dim(input_d);
+            if (!input_dim.has_dim_value() || input_dim.dim_value() != 1) {
+              *output_dim = input_dim;
+              break;
+            }
+          }
+        }
+      });
+
   ONNX_CONTRIB_OPERATOR_SCHEMA(FusedGemm)
       .SetDomain(kMSDomain)
       .SinceVersion(1)
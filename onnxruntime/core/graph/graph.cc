@@ -6,6 +6,7 @@
 #pragma warning(disable : 4244)
 #endif
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <numeric>
@@ -45,6 +46,24 @@ static Status MergeShapeInfo(const std::string& output_name,
   return Status::OK();
 }
 
+static bool IsSameShape(const TensorShapeProto& shape1, const TensorShapeProto& shape2) {
+  if (shape1.dim_size() != shape2.dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape1.dim_size(); ++i) {
+    const auto& dim1 = shape1.dim(i);
+    const auto& dim2 = shape2.dim(i);
+    if (dim1.value_case() != dim2.value_case() || dim1.denotation() != dim2.denotation()) {
+      return false;
+    }
+    if (dim1.has_dim_value() ? dim1.dim_value() != dim2.dim_value()
+                             : dim1.has_dim_param() && dim1.dim_param() != dim2.dim_param()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static bool GraphLoadedFromModelFile(const GraphProto* graph_proto) {
   return graph_proto && (graph_proto->input_size() != 0 ||
                          graph_proto->output_size() != 0 ||
@@ -112,13 +131,20 @@ void NodeArg::SetShape(const TensorShapeProto& shape) {
     return;
   }
 
+  const TensorShapeProto* current_shape = Shape();
+  if (current_shape != nullptr && IsSameShape(*current_shape, shape)) {
+    return;
+  }
+
   const auto type_case = node_arg_info_.type().value_case();
   switch (type_case) {
     case TypeProto::kTensorType:
       *(node_arg_info_.mutable_type()->mutable_tensor_type()->mutable_shape()) = shape;
+      ++version_;
       break;
     case TypeProto::kSparseTensorType:
       *(node_arg_info_.mutable_type()->mutable_sparse_tensor_type()->mutable_shape()) = shape;
+      ++version_;
       break;
     case TypeProto::kSequenceType:
     case TypeProto::kMapType:
@@ -133,6 +159,7 @@ common::Status NodeArg::UpdateTypeAndShape(const ONNX_NAMESPACE::TypeProto& inpu
   if (!node_arg_info_.has_type()) {
     *node_arg_info_.mutable_type() = input_type;
     type_ = DataTypeUtils::ToType(node_arg_info_.type());
+    ++version_;
     return Status::OK();
   }
 
@@ -158,9 +185,14 @@ common::Status NodeArg::UpdateTypeAndShape(const ONNX_NAMESPACE::TypeProto& inpu
       if (input_tensor_type.has_shape()) {
         auto& current_tensor_type = *current_type.mutable_tensor_type();
         if (current_tensor_type.has_shape()) {
+          const TensorShapeProto previous_shape = current_tensor_type.shape();
           ORT_RETURN_IF_ERROR(MergeShapeInfo(Name(), input_tensor_type, current_tensor_type));
+          if (!IsSameShape(previous_shape, current_tensor_type.shape())) {
+            ++version_;
+          }
         } else {
           current_tensor_type = input_tensor_type;
+          ++version_;
         }
       }
 
@@ -183,6 +215,7 @@ common::Status NodeArg::UpdateTypeAndShape(const ONNX_NAMESPACE::TypeProto& inpu
           // mergeInShapeInfo(input_tensor_type, current_tensor_type);
         } else {
           current_tensor_type = input_tensor_type;
+          ++version_;
         }
       }
     } break;
@@ -212,11 +245,13 @@ void NodeArg::SetType(DataType p_type) {
 
   type_ = p_type;
   *(node_arg_info_.mutable_type()) = DataTypeUtils::ToTypeProto(p_type);
+  ++version_;
 }
 
 void NodeArg::SetType(const TypeProto& type_proto) {
   type_ = DataTypeUtils::ToType(type_proto);
   *(node_arg_info_.mutable_type()) = type_proto;
+  ++version_;
 }
 
 bool NodeArg::Exists() const noexcept {
@@ -385,6 +420,7 @@ Node::Definitions& Node::MutableDefinitions() noexcept {
   // someone fetching these is going to change something
   graph_->SetGraphResolveNeeded();
   graph_->SetGraphProtoSyncNeeded();
+  needs_inference_ = true;
   return definitions_;
 }
 
@@ -409,6 +445,7 @@ void Node::CreateSubgraph(const std::string& attr_name) {
 void Node::AddAttribute(const std::string& attr_name, const AttributeProto& value) {
   graph_->SetGraphResolveNeeded();
   graph_->SetGraphProtoSyncNeeded();
+  needs_inference_ = true;
   attributes_[attr_name] = value;
 }
 
@@ -416,6 +453,7 @@ void Node::AddAttribute(const std::string& attr_name, const AttributeProto& valu
   void Node::AddAttribute(const std::string& attr_name, const type& value) { \
     graph_->SetGraphResolveNeeded();                                         \
     graph_->SetGraphProtoSyncNeeded();                                       \
+    needs_inference_ = true;                                                 \
     AttributeProto a;                                                        \
     a.set_name(attr_name);                                                   \
     a.set_type(enumType);                                                    \
@@ -427,6 +465,7 @@ void Node::AddAttribute(const std::string& attr_name, const AttributeProto& valu
   void Node::AddAttribute(const std::string& attr_name, const type& value) { \
     graph_->SetGraphResolveNeeded();                                         \
     graph_->SetGraphProtoSyncNeeded();                                       \
+    needs_inference_ = true;                                                 \
     AttributeProto a;                                                        \
     a.set_name(attr_name);                                                   \
     a.set_type(enumType);                                                    \
@@ -439,6 +478,7 @@ void Node::AddAttribute(const std::string& attr_name, const AttributeProto& valu
                           const std::vector<type>& values) { \
     graph_->SetGraphResolveNeeded();                         \
     graph_->SetGraphProtoSyncNeeded();                       \
+    needs_inference_ = true;                                 \
     AttributeProto a;                                        \
     a.set_name(attr_name);                                   \
     a.set_type(enumType);                                    \
@@ -451,6 +491,7 @@ void Node::AddAttribute(const std::string& attr_name, const AttributeProto& valu
 void Node::AddAttribute(const std::string& attr_name, const GraphProto& value) {
   graph_->SetGraphResolveNeeded();
   graph_->SetGraphProtoSyncNeeded();
+  needs_inference_ = true;
   AttributeProto a;
   a.set_name(attr_name);
   a.set_type(AttributeProto_AttributeType::AttributeProto_AttributeType_GRAPH);
@@ -473,6 +514,7 @@ ADD_LIST_ATTR_IMPL(GraphProto, AttributeProto_AttributeType::AttributeProto_Attr
 bool Node::ClearAttribute(const std::string& attr_name) {
   graph_->SetGraphResolveNeeded();
   graph_->SetGraphProtoSyncNeeded();
+  needs_inference_ = true;
   return attributes_.erase(attr_name) > 0;
 }
 
@@ -801,26 +843,23 @@ void Graph::AddEdge(NodeIndex src_node_index, NodeIndex dst_node_index, int src_
     ORT_THROW("Invalid node indexes specified when adding edge.");
   }
 
+  // the definitions are only fetched as mutable if the destination NodeArg needs to be replaced, as that marks the
+  // destination node as needing type and shape inferencing again.
   NodeArg *src_arg = nullptr, *dst_arg = nullptr;
-  if (nodes_[src_node_index]->MutableDefinitions().output_defs.size() > src_arg_slot) {
-    src_arg = nodes_[src_node_index]->MutableDefinitions().output_defs[src_arg_slot];
+  if (nodes_[src_node_index]->GetDefinitions().output_defs.size() > src_arg_slot) {
+    src_arg = nodes_[src_node_index]->GetDefinitions().output_defs[src_arg_slot];
   }
 
   if (nullptr == src_arg) {
     ORT_THROW("Invalid source node arg slot specified when adding edge.");
   }
 
-  auto& dst_node_defs = nodes_[dst_node_index]->MutableDefinitions();
-  NodeArg** dst_arg_pointer = nullptr;
-  if (dst_node_defs.input_defs.size() > dst_arg_slot) {
-    dst_arg_pointer = &dst_node_defs.input_defs[dst_arg_slot];
-    dst_arg = *dst_arg_pointer;
-  } else {
-    auto num_of_explicit_inputs = dst_node_defs.input_defs.size();
-    if (num_of_explicit_inputs + dst_node_defs.implicit_input_defs.size() > dst_arg_slot) {
-      dst_arg_pointer = &dst_node_defs.implicit_input_defs[dst_arg_slot - num_of_explicit_inputs];
-      dst_arg = *dst_arg_pointer;
-    }
+  const auto& dst_node_defs = nodes_[dst_node_index]->GetDefinitions();
+  const auto num_of_explicit_inputs = dst_node_defs.input_defs.size();
+  if (num_of_explicit_inputs > dst_arg_slot) {
+    dst_arg = dst_node_defs.input_defs[dst_arg_slot];
+  } else if (num_of_explicit_inputs + dst_node_defs.implicit_input_defs.size() > dst_arg_slot) {
+    dst_arg = dst_node_defs.implicit_input_defs[dst_arg_slot - num_of_explicit_inputs];
   }
   if (nullptr == dst_arg) {
     ORT_THROW("Invalid destination node arg slot specified when adding edge.");
@@ -831,7 +870,12 @@ void Graph::AddEdge(NodeIndex src_node_index, NodeIndex dst_node_index, int src_
       // The output type of source node arg does not match the input type of destination node arg.
       ORT_THROW("Argument type mismatch when adding edge.");
     } else {
-      *dst_arg_pointer = src_arg;
+      auto& mutable_dst_node_defs = nodes_[dst_node_index]->MutableDefinitions();
+      if (num_of_explicit_inputs > dst_arg_slot) {
+        mutable_dst_node_defs.input_defs[dst_arg_slot] = src_arg;
+      } else {
+        mutable_dst_node_defs.implicit_input_defs[dst_arg_slot - num_of_explicit_inputs] = src_arg;
+      }
     }
   }
 
@@ -877,6 +921,9 @@ void Graph::RemoveEdge(NodeIndex src_node_index, NodeIndex dst_node_index, int s
 
   nodes_[dst_node_index]->MutableRelationships().input_edges.erase(Node::EdgeEnd(*nodes_[src_node_index], src_arg_slot, dst_arg_slot));
   nodes_[src_node_index]->MutableRelationships().output_edges.erase(Node::EdgeEnd(*nodes_[dst_node_index], src_arg_slot, dst_arg_slot));
+
+  // the input may no longer be produced by anything, so the destination must be validated again
+  nodes_[dst_node_index]->SetNeedsInference();
 }
 
 GSL_SUPPRESS(es .84)  // ignoring return value from unordered_map::insert causes noisy complaint
@@ -945,8 +992,8 @@ Status Graph::BuildConnections(std::vector<std::string>& outer_scope_node_args_c
 
   // now build connections within this Graph instance
   for (auto& node : Nodes()) {
-    // Need mutable input defs to be able to set any outer scope NodeArg implicit inputs
-    auto& input_args = node.MutableInputDefs();
+    // the input defs are only read here. fetching them as mutable would mark every node as needing inferencing.
+    const auto& input_args = node.InputDefs();
 
     if (input_args.size() > 0) {
       // This node needs inputs.
@@ -1011,7 +1058,7 @@ void Graph::ReverseDFSFrom(const std::vector<const Node*>& from,
     stack[i] = WorkEntry(from[i], false);
   }
 
-  std::vector<bool> visited(MaxNodeIndex(), false);
+  std::vector<bool> visited(nodes_.size(), false);
   while (!stack.empty()) {
     const WorkEntry last_entry = stack.back();
     stack.pop_back();
@@ -1056,10 +1103,12 @@ void Graph::ReverseDFSFrom(const std::vector<const Node*>& from,
 GSL_SUPPRESS(es .84)  // noisy warning about ignoring return value from insert(...)
 Status Graph::PerformTopologicalSortAndCheckIsAcyclic() {
   nodes_in_topological_order_.clear();
+  nodes_in_topological_order_.reserve(nodes_.size());
+  // per node flags indexed by NodeIndex, which is cheaper than hashing the indexes for large graphs.
   // nodes that have been processed and added to nodes_in_topological_order.
-  std::unordered_set<NodeIndex> processed_nodes;
-  std::unordered_set<NodeIndex> output_nodes;
-  std::unordered_set<NodeIndex> nodes_added_for_processing;
+  std::vector<bool> processed_nodes(nodes_.size(), false);
+  std::vector<bool> output_nodes(nodes_.size(), false);
+  std::vector<bool> nodes_added_for_processing(nodes_.size(), false);
   std::stack<NodeIndex> stack;
 
   // push the top level nodes into nodes_in_topological_order in the order they were added
@@ -1072,7 +1121,7 @@ Status Graph::PerformTopologicalSortAndCheckIsAcyclic() {
                   // find the top level nodes in the graph.
                   // need to also consider nodes that only have Constants as inputs as top level nodes,
                   // as the constant will get replaced by an initializer.
-                  auto input_edges = node.GetRelationships().input_edges;
+                  const auto& input_edges = node.GetRelationships().input_edges;
                   auto has_inputs = std::any_of(input_edges.cbegin(), input_edges.cend(), [](const Node::EdgeEnd& edge) {
                     return edge.GetNode().OpType() != kConstant;
                   });
@@ -1080,10 +1129,10 @@ Status Graph::PerformTopologicalSortAndCheckIsAcyclic() {
                   if (!has_inputs) {
                     // add to the topological list, and ensure we skip these nodes when walking the graph
                     nodes_in_topological_order_.push_back(index);
-                    processed_nodes.insert(index);
+                    processed_nodes[index] = true;
 
                     // mark this as added as we've fully processed it and don't need to do it again later
-                    nodes_added_for_processing.insert(index);
+                    nodes_added_for_processing[index] = true;
                   }
                 });
 
@@ -1099,16 +1148,16 @@ Status Graph::PerformTopologicalSortAndCheckIsAcyclic() {
     const NodeIndex current = stack.top();
     stack.pop();
 
-    if (processed_nodes.find(current) != processed_nodes.end()) {
+    if (processed_nodes[current]) {
       continue;
     }
 
-    if (nodes_added_for_processing.find(current) != nodes_added_for_processing.end()) {
+    if (nodes_added_for_processing[current]) {
       // we popped the stack and are back to a node that was added previously,
       // so we know all the upstream nodes from it have been fully processed,
       nodes_in_topological_order_.push_back(current);
-      processed_nodes.insert(current);
-      output_nodes.erase(current);
+      processed_nodes[current] = true;
+      output_nodes[current] = false;
       continue;
     }
 
@@ -1118,22 +1167,22 @@ Status Graph::PerformTopologicalSortAndCheckIsAcyclic() {
     }
 
     stack.push(current);
-    output_nodes.insert(current);
+    output_nodes[current] = true;
 
     for (auto iter = node->InputNodesBegin(); iter != node->InputNodesEnd(); ++iter) {
       const NodeIndex idx = (*iter).Index();
-      if (output_nodes.find(idx) != output_nodes.end()) {
+      if (output_nodes[idx]) {
         Status status(ONNXRUNTIME, FAIL, "Error: the graph is not acyclic.");
         return status;
       }
 
       // avoid re-processing nodes
-      if (nodes_added_for_processing.find(idx) == nodes_added_for_processing.end()) {
+      if (!nodes_added_for_processing[idx]) {
         stack.push(idx);
       }
     }
 
-    nodes_added_for_processing.insert(current);
+    nodes_added_for_processing[current] = true;
   }
 
   if (num_of_nodes_ >= 0 && static_cast<size_t>(num_of_nodes_) == nodes_in_topological_order_.size()) {
@@ -1629,10 +1678,52 @@ Status Graph::VerifyNodeAndOpMatch() {
   // and need to call Resolve
   lsc.output_names.insert(outer_scope_node_arg_names_.cbegin(), outer_scope_node_arg_names_.cend());
 
+  // A node only needs to be inferred again if it was modified, an input changed type or shape, or an initializer it
+  // consumes was replaced since the last Resolve. Nodes with subgraphs and the nodes of subgraphs are always inferred
+  // as their results depend on the outer scope.
+  auto input_version = [](const Node& node) {
+    uint64_t version = 0;
+    for (const auto* input_def : node.GetDefinitions().input_defs) {
+      version += input_def->version_;
+    }
+    for (const auto* input_def : node.GetDefinitions().implicit_input_defs) {
+      version += input_def->version_;
+    }
+    return version;
+  };
+  auto consumes_modified_initializer = [this](const Node& node) {
+    return !modified_initializers_.empty() &&
+           std::any_of(node.InputDefs().cbegin(), node.InputDefs().cend(), [this](const NodeArg* input_def) {
+             return modified_initializers_.count(input_def->Name()) != 0;
+           });
+  };
+
+  // check_node only runs for the nodes that don't have an Op yet, so make sure every input of the other nodes that
+  // are verified again is still defined. e.g. the node producing it may have been removed.
+  auto check_inputs_defined = [&lsc](const Node& node) -> Status {
+    for (const auto* input_def : node.InputDefs()) {
+      if (input_def->Exists() && lsc.output_names.count(input_def->Name()) == 0) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_GRAPH, "Node:", node.Name(), " input '", input_def->Name(),
+                               "' is not a graph input, initializer, or output of a previous node.");
+      }
+    }
+    return Status::OK();
+  };
+
   for (auto node_index : nodes_in_topological_order_) {
     // Node verification.
     auto& node = *GetNode(node_index);
 
+    if (parent_graph_ == nullptr && !node.NeedsInference(input_version(node)) &&
+        !consumes_modified_initializer(node)) {
+      for (const auto* output_def : node.OutputDefs()) {
+        if (output_def->Exists()) {
+          lsc.output_names.insert(output_def->Name());
+        }
+      }
+      continue;
+    }
+
     NodeProto node_proto;
     node.ToProto(node_proto);
     auto& node_name = node.Name();
@@ -1646,7 +1737,9 @@ Status Graph::VerifyNodeAndOpMatch() {
       node.SetFunctionBody(*function_container_.back());
     }
 
-    if (!node.Op()) {
+    if (node.Op()) {
+      ORT_RETURN_IF_ERROR(check_inputs_defined(node));
+    } else {
       try {
         checker::check_node(node_proto, ctx, lsc);
       } catch (const std::exception& ex) {
@@ -1682,8 +1775,8 @@ Status Graph::VerifyNodeAndOpMatch() {
     // Attribute verification and fill node attribute with
     // default value defined in operator definition if needed.
     // Fill node attribute with default value specified in operator definition if any.
-    auto node_attributes = node.GetAttributes();
-    for (auto attr_def : p_op->attributes()) {
+    const auto& node_attributes = node.GetAttributes();
+    for (const auto& attr_def : p_op->attributes()) {
       auto node_attr_iter = node_attributes.find(attr_def.first);
       if (node_attributes.end() == node_attr_iter) {
         // The attribute was not specified in the node.
@@ -1704,12 +1797,16 @@ Status Graph::VerifyNodeAndOpMatch() {
 
     NO_CHANGE_ON_SYNC_FLAG(ORT_RETURN_IF_ERROR(InferAndVerifyTypeMatch(node, *p_op)));
 
+    node.SetInferred(input_version(node));
+
     // Accumulate output names of the iterated Node
     for (auto& output_name : node_proto.output()) {
       lsc.output_names.insert(output_name);
     }
   }
 
+  modified_initializers_.clear();
+
   return Status::OK();
 }
 
@@ -1751,7 +1848,9 @@ Status Graph::InitInputsInitializersOutputs() {
   // same applies to the implicit input defs as they are built from any subgraphs within this graph.
   for (auto& node : Nodes()) {
     node.MutableRelationships().Clear();
-    node.MutableDefinitions().implicit_input_defs.clear();
+    if (!node.GetDefinitions().implicit_input_defs.empty()) {
+      node.MutableDefinitions().implicit_input_defs.clear();
+    }
   }
 
   // add the subgraph pointers to the resolve context.
@@ -1891,6 +1990,7 @@ void Graph::AddInitializedTensor(const TensorProto& tensor) {
   const gsl::not_null<TensorProto*> tensor_added{graph_proto_->add_initializer()};
   *(tensor_added) = tensor;
   name_to_initial_tensor_[tensor.name()] = tensor_added;
+  modified_initializers_.insert(tensor.name());
 
   if (!GraphLoadedFromModelFile(graph_proto_)) {
     // make sure there is a NodeArg for the initializer as SetGraphInputsOutputs will add it to the graph inputs
@@ -1911,6 +2011,7 @@ void Graph::RemoveInitializedTensor(const std::string& tensor_name) {
   auto iter = name_to_initial_tensor_.find(tensor_name);
   if (name_to_initial_tensor_.end() != iter) {
     name_to_initial_tensor_.erase(tensor_name);
+    modified_initializers_.insert(tensor_name);
     SetGraphProtoSyncNeeded();
     SetGraphResolveNeeded();
   }
@@ -2075,6 +2176,12 @@ bool Graph::RemoveNode(NodeIndex p_index) {
   for (auto& input_edge : input_edges) {
     RemoveEdge(input_edge.GetNode().Index(), p_index, input_edge.GetSrcArgIndex(), input_edge.GetDstArgIndex());
   }
+
+  // the consumers of the outputs lose their producer, so they must be validated again by the next Resolve
+  for (auto& output_edge : node->GetRelationships().output_edges) {
+    nodes_[output_edge.GetNode().Index()]->SetNeedsInference();
+  }
+
   return ReleaseNode(p_index);
 }
 
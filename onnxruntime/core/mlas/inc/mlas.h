@@ -94,6 +94,61 @@ MlasSgemm(
     size_t ldc
     );
 
+//
+// Reduced precision floating-point types. Each holds the raw 16-bit encoding
+// of an IEEE half-precision value or a bfloat16 value.
+//
+
+struct MLAS_FP16 {
+    unsigned short Value;
+};
+
+struct MLAS_BF16 {
+    unsigned short Value;
+};
+
+//
+// Single precision matrix/matrix multiply routines with a reduced precision
+// matrix B. The elements of matrix B are converted to single precision as
+// panels of matrix B are packed, so matrix B is never expanded in memory.
+//
+
+void
+MLASCALL
+MlasSgemm(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const MLAS_FP16* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    size_t ldc
+    );
+
+void
+MLASCALL
+MlasSgemm(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const MLAS_BF16* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    size_t ldc
+    );
+
 //
 // Convolution routines.
 //
@@ -102,6 +157,8 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmDepthwise,
+    MlasConvAlgorithmWinograd,
 };
 
 struct MLAS_CONV_PARAMETERS {
@@ -129,6 +186,15 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            size_t TargetThreadCount;
+        } Depthwise;
+        struct {
+            size_t TargetThreadCount;
+            size_t TileBlockCount;
+            size_t FilterSize;
+            const float* TransformedFilter;
+        } Winograd;
     } u;
 };
 
@@ -162,6 +228,14 @@ MlasConv(
     float* Output
     );
 
+void
+MLASCALL
+MlasConvTransformFilter(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Filter,
+    float* TransformedFilter
+    );
+
 //
 // Pooling routines.
 //
@@ -186,6 +260,78 @@ MlasPool(
     float* Output
     );
 
+//
+// NCHWc (channel blocked) layout routines.
+//
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    );
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation
+    );
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    );
+
 //
 // Miscellaneous compute routines.
 //
@@ -206,6 +352,24 @@ MlasComputeTanh(
     size_t N
     );
 
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    );
+
 //
 // Half-precision floating-point routines.
 //
@@ -218,3 +382,11 @@ MlasConvertHalfToFloatBuffer(
     float* Destination,
     size_t Count
     );
+
+void
+MLASCALL
+MlasConvertBFloat16ToFloatBuffer(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    );
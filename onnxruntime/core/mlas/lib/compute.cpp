@@ -0,0 +1,638 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute.cpp
+
+Abstract:
+
+    This module implements routines to compute the exponential function and
+    the softmax and log softmax functions.
+
+    The exponential function reduces the argument to the range [-ln2/2, ln2/2]
+    and evaluates a polynomial, then scales the result by a power of two built
+    directly in the exponent bits. The softmax routines use it to fuse the
+    exponentiation with the summation of each row, so that a row is read three
+    times: to find the maximum, to compute and sum the exponentials, and to
+    produce the normalized output.
+
+--*/
+
+#include "mlasi.h"
+#include <cmath>
+
+//
+// Bundles the floating point constants for use by the exponential function.
+//
+
+static const struct {
+    float LowerRange;
+    float UpperRange;
+    float RoundingBias;
+    float Log2Reciprocal;
+    float Log2High;
+    float Log2Low;
+    float MinimumExponent;
+    float MaximumExponent;
+    float poly_0;
+    float poly_1;
+    float poly_2;
+    float poly_3;
+    float poly_4;
+    float poly_56;
+} MlasExpConstants = {
+    -103.9720840454f,
+    88.7762626647950f,
+    12582912.0f,
+    1.44269504088896341f,
+    -6.93145752e-1f,
+    -1.42860677e-6f,
+    -126.0f,
+    127.0f,
+    1.38888889e-3f,
+    8.33333333e-3f,
+    4.16666667e-2f,
+    1.66666667e-1f,
+    0.5f,
+    1.0f,
+};
+
+//
+// Define the minimum number of elements to process per thread when the
+// softmax rows are partitioned across threads.
+//
+
+#define MLAS_SOFTMAX_THREAD_COMPLEXITY              (64 * 1024)
+
+inline
+MLAS_FLOAT32X4
+MlasComputeExpFloat32x4(
+    MLAS_FLOAT32X4 Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a vector of elements.
+
+Arguments:
+
+    Value - Supplies the input vector.
+
+Return Value:
+
+    Returns the exponential of each element.
+
+--*/
+{
+    Value = MlasMaximumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.LowerRange), Value);
+    Value = MlasMinimumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.UpperRange), Value);
+
+    //
+    // Reduce the argument: Value = m * ln2 + r where m is integral. Adding and
+    // subtracting the rounding bias rounds Value / ln2 to the nearest integer.
+    // The constant ln2 is split in two parts so that the products with m are
+    // exact.
+    //
+
+    MLAS_FLOAT32X4 RoundingBias = MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias);
+    MLAS_FLOAT32X4 m = MlasMultiplyAddFloat32x4(Value, MlasBroadcastFloat32x4(MlasExpConstants.Log2Reciprocal), RoundingBias);
+    m = MlasSubtractFloat32x4(m, RoundingBias);
+
+    Value = MlasMultiplyAddFloat32x4(m, MlasBroadcastFloat32x4(MlasExpConstants.Log2High), Value);
+    Value = MlasMultiplyAddFloat32x4(m, MlasBroadcastFloat32x4(MlasExpConstants.Log2Low), Value);
+
+    //
+    // Compute 2^m as the product of two powers of two, so that results in
+    // the denormal range are also produced.
+    //
+
+    MLAS_FLOAT32X4 NormalExponent = MlasMinimumFloat32x4(m, MlasBroadcastFloat32x4(MlasExpConstants.MaximumExponent));
+    NormalExponent = MlasMaximumFloat32x4(NormalExponent, MlasBroadcastFloat32x4(MlasExpConstants.MinimumExponent));
+    MLAS_FLOAT32X4 OverflowExponent = MlasSubtractFloat32x4(m, NormalExponent);
+
+    //
+    // Evaluate the polynomial approximation of exp(r).
+    //
+
+    MLAS_FLOAT32X4 p = MlasBroadcastFloat32x4(MlasExpConstants.poly_0);
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_1));
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_2));
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_3));
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_4));
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_56));
+    p = MlasMultiplyAddFloat32x4(p, Value, MlasBroadcastFloat32x4(MlasExpConstants.poly_56));
+
+    p = MlasMultiplyFloat32x4(p, MlasPowerOf2Float32x4(OverflowExponent));
+    p = MlasMultiplyFloat32x4(p, MlasPowerOf2Float32x4(NormalExponent));
+
+    return p;
+}
+
+inline
+MLAS_FLOAT32X4
+MlasLoadPartialFloat32x4(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine loads fewer than four elements into a vector. The remaining
+    elements are set to zero.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to load, which is less than four.
+
+Return Value:
+
+    Returns the loaded vector.
+
+--*/
+{
+    float Buffer[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for (size_t i = 0; i < N; i++) {
+        Buffer[i] = Input[i];
+    }
+
+    return MlasLoadFloat32x4(Buffer);
+}
+
+inline
+void
+MlasStorePartialFloat32x4(
+    float* Output,
+    MLAS_FLOAT32X4 Vector,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine stores the first N elements of a vector, where N is less
+    than four.
+
+Arguments:
+
+    Output - Supplies the output buffer.
+
+    Vector - Supplies the vector to store.
+
+    N - Supplies the number of elements to store.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float Buffer[4];
+
+    MlasStoreFloat32x4(Buffer, Vector);
+
+    for (size_t i = 0; i < N; i++) {
+        Output[i] = Buffer[i];
+    }
+}
+
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasComputeExpFloat32x4(MlasLoadFloat32x4(Input)));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    if (N > 0) {
+        MlasStorePartialFloat32x4(Output, MlasComputeExpFloat32x4(MlasLoadPartialFloat32x4(Input, N)), N);
+    }
+}
+
+float
+MlasReduceMaximumKernel(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine finds the maximum element of a buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum element.
+
+--*/
+{
+    float Maximum = std::numeric_limits<float>::lowest();
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 MaximumVector = MlasLoadFloat32x4(Input);
+
+        Input += 4;
+        N -= 4;
+
+        while (N >= 4) {
+
+            MaximumVector = MlasMaximumFloat32x4(MaximumVector, MlasLoadFloat32x4(Input));
+
+            Input += 4;
+            N -= 4;
+        }
+
+        Maximum = MlasReduceMaximumFloat32x4(MaximumVector);
+    }
+
+    while (N > 0) {
+
+        Maximum = (std::max)(Maximum, *Input++);
+
+        N -= 1;
+    }
+
+    return Maximum;
+}
+
+float
+MlasComputeSumExpKernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential of each element after adding the
+    negated maximum of the buffer and returns the sum of the exponentials.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Optionally supplies the output buffer to receive the
+        exponentials. If nullptr, only the sum is computed.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the negated maximum element of the buffer.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    MLAS_FLOAT32X4 NegativeMaximumVector = MlasBroadcastFloat32x4(NegativeMaximum);
+    MLAS_FLOAT32X4 Accumulator = MlasZeroFloat32x4();
+
+    while (N >= 4) {
+
+        MLAS_FLOAT32X4 Vector = MlasAddFloat32x4(MlasLoadFloat32x4(Input), NegativeMaximumVector);
+        Vector = MlasComputeExpFloat32x4(Vector);
+
+        if (Output != nullptr) {
+            MlasStoreFloat32x4(Output, Vector);
+            Output += 4;
+        }
+
+        Accumulator = MlasAddFloat32x4(Accumulator, Vector);
+
+        Input += 4;
+        N -= 4;
+    }
+
+    float Accumulation = MlasReduceAddFloat32x4(Accumulator);
+
+    if (N > 0) {
+
+        float Buffer[4];
+
+        MLAS_FLOAT32X4 Vector = MlasAddFloat32x4(MlasLoadPartialFloat32x4(Input, N), NegativeMaximumVector);
+        MlasStoreFloat32x4(Buffer, MlasComputeExpFloat32x4(Vector));
+
+        for (size_t i = 0; i < N; i++) {
+
+            if (Output != nullptr) {
+                Output[i] = Buffer[i];
+            }
+
+            Accumulation += Buffer[i];
+        }
+    }
+
+    return Accumulation;
+}
+
+void
+MlasComputeSoftmaxOutputKernel(
+    float* Output,
+    size_t N,
+    float Scale
+    )
+/*++
+
+Routine Description:
+
+    This routine scales the exponentials of a row to produce the softmax
+    output.
+
+Arguments:
+
+    Output - Supplies the buffer of exponentials, which is updated in place.
+
+    N - Supplies the number of elements to process.
+
+    Scale - Supplies the reciprocal of the sum of the exponentials.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasMultiplyFloat32x4(MlasLoadFloat32x4(Output), ScaleVector));
+
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output = *Output * Scale;
+
+        Output += 1;
+        N -= 1;
+    }
+}
+
+void
+MlasComputeLogSoftmaxOutputKernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine produces the log softmax output of a row.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+    Bias - Supplies the negated sum of the maximum of the row and the
+        logarithm of the sum of the exponentials.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 BiasVector = MlasBroadcastFloat32x4(Bias);
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasAddFloat32x4(MlasLoadFloat32x4(Input), BiasVector));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output++ = *Input++ + Bias;
+
+        N -= 1;
+    }
+}
+
+//
+// Define the parameters to execute segments of a softmax operation on worker
+// threads.
+//
+
+struct MLAS_SOFTMAX_WORK_BLOCK {
+    int32_t ThreadCountN;
+    bool LogSoftmax;
+    const float* Input;
+    float* Output;
+    size_t N;
+    size_t D;
+};
+
+void
+MlasComputeSoftmaxThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    softmax or log softmax operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_SOFTMAX_WORK_BLOCK*)Context;
+
+    //
+    // Partition the operation along the N dimension.
+    //
+
+    const size_t N = WorkBlock->N;
+    const size_t D = WorkBlock->D;
+    const size_t ThreadCountN = size_t(WorkBlock->ThreadCountN);
+
+    const size_t WorkPerThread = N / ThreadCountN;
+    const size_t WorkPerThreadExtra = N % ThreadCountN;
+
+    size_t n;
+    size_t CountN;
+
+    if (size_t(Index) < WorkPerThreadExtra) {
+        CountN = WorkPerThread + 1;
+        n = size_t(Index) * CountN;
+    } else {
+        CountN = WorkPerThread;
+        n = size_t(Index) * WorkPerThread + WorkPerThreadExtra;
+    }
+
+    const float* Input = WorkBlock->Input + n * D;
+    float* Output = WorkBlock->Output + n * D;
+
+    while (CountN > 0) {
+
+        const float Maximum = MlasReduceMaximumKernel(Input, D);
+
+        if (WorkBlock->LogSoftmax) {
+
+            const float Accumulation = MlasComputeSumExpKernel(Input, nullptr, D, -Maximum);
+
+            MlasComputeLogSoftmaxOutputKernel(Input, Output, D, -Maximum - std::log(Accumulation));
+
+        } else {
+
+            const float Accumulation = MlasComputeSumExpKernel(Input, Output, D, -Maximum);
+
+            MlasComputeSoftmaxOutputKernel(Output, D, 1.0f / Accumulation);
+        }
+
+        Input += D;
+        Output += D;
+        CountN--;
+    }
+}
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the softmax or log softmax function of each row of
+    the input. The maximum of the row is subtracted before exponentiation, so
+    large inputs do not overflow.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer. The output buffer may be the same as
+        the input buffer.
+
+    N - Supplies the number of rows to process.
+
+    D - Supplies the number of columns of each row.
+
+    LogSoftmax - Supplies true if the log softmax function should be computed,
+        else false if the softmax function should be computed.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (N == 0 || D == 0) {
+        return;
+    }
+
+    MLAS_SOFTMAX_WORK_BLOCK WorkBlock;
+
+    //
+    // Capture the softmax parameters to the work block.
+    //
+
+    WorkBlock.LogSoftmax = LogSoftmax;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.N = N;
+    WorkBlock.D = D;
+
+    //
+    // Compute the number of target threads given the complexity of the softmax
+    // operation. Limit the number of threads to the number of rows and try to
+    // keep each thread busy with a minimum number of elements.
+    //
+
+    const double Complexity = double(N) * double(D);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SOFTMAX_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SOFTMAX_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= N) {
+        TargetThreadCount = int32_t(N);
+    }
+
+    WorkBlock.ThreadCountN = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasComputeSoftmaxThreaded, &WorkBlock, TargetThreadCount);
+}
@@ -736,6 +736,62 @@ Return Value:
     }
 }
 
+void
+MlasConvDepthwiseThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    depthwise convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_WORK_BLOCK* WorkBlock = (MLAS_CONV_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    //
+    // Compute the range of output rows to use for this thread. The rows span
+    // the channels and the output height, so both are split across threads.
+    //
+
+    const size_t TotalRows = Parameters->BatchCount * Parameters->GroupCount *
+        Parameters->OutputShape[0];
+
+    const size_t TargetThreadCount = WorkBlock->TargetThreadCount;
+
+    const size_t RowsPerThread = TotalRows / TargetThreadCount;
+    const size_t RowsPerThreadExtra = TotalRows % TargetThreadCount;
+
+    size_t RowStart;
+    size_t RowCount;
+
+    if (uint32_t(Index) < RowsPerThreadExtra) {
+        RowCount = RowsPerThread + 1;
+        RowStart = RowCount * Index;
+    } else {
+        RowCount = RowsPerThread;
+        RowStart = RowsPerThread * Index + RowsPerThreadExtra;
+    }
+
+    MlasConvDepthwise(Parameters, WorkBlock->Input, WorkBlock->Filter,
+        WorkBlock->Bias, WorkBlock->Output, RowStart, RowCount);
+}
+
 inline
 bool
 MlasConvTryMultithread(
@@ -894,6 +950,47 @@ Return Value:
 
     const MLAS_CONV_ALGORITHM Algorithm = Parameters->Algorithm;
 
+    //
+    // Winograd convolutions are split across threads by blocks of output tiles.
+    //
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        MlasConvWinograd(Parameters, Input, Filter, Bias, WorkingBuffer, Output);
+        return;
+    }
+
+    //
+    // Depthwise convolutions are computed directly and split across threads by
+    // output rows of all channels.
+    //
+
+    if (Algorithm == MlasConvAlgorithmDepthwise) {
+
+        const size_t TotalRows = BatchCount * GroupCount * Parameters->OutputShape[0];
+        int32_t TargetThreadCount = int32_t(Parameters->u.Depthwise.TargetThreadCount);
+
+        if (TargetThreadCount > 1) {
+
+            MLAS_CONV_WORK_BLOCK WorkBlock;
+
+            WorkBlock.Parameters = Parameters;
+            WorkBlock.Input = Input;
+            WorkBlock.Filter = Filter;
+            WorkBlock.Bias = Bias;
+            WorkBlock.WorkingBuffer = nullptr;
+            WorkBlock.Output = Output;
+            WorkBlock.TargetThreadCount = TargetThreadCount;
+
+            MlasExecuteThreaded(MlasConvDepthwiseThreaded, &WorkBlock, TargetThreadCount);
+
+        } else {
+
+            MlasConvDepthwise(Parameters, Input, Filter, Bias, Output, 0, TotalRows);
+        }
+
+        return;
+    }
+
 #if defined(MLAS_HAS_THREADING_SUPPORT)
 
     //
@@ -1005,6 +1102,17 @@ Return Value:
 
                     break;
                 }
+
+                case MlasConvAlgorithmDepthwise:
+                case MlasConvAlgorithmWinograd:
+                {
+                    //
+                    // Depthwise and Winograd convolutions are dispatched for all batches
+                    // and groups above.
+                    //
+
+                    break;
+                }
             }
 
             //
@@ -1136,6 +1244,58 @@ Return Value:
 
     *WorkingBufferSize = 0;
 
+    //
+    // Detect a depthwise convolution with a 3x3 or 5x5 kernel and a stride of
+    // one or two, which is computed directly instead of expanding each group.
+    //
+
+    if (Dimensions == 2 && InputChannels == 1 && FilterCount == 1 && GroupCount > 1 &&
+        Parameters->KernelShape[0] == Parameters->KernelShape[1] &&
+        (Parameters->KernelShape[1] == 3 || Parameters->KernelShape[1] == 5) &&
+        Parameters->StrideShape[1] <= 2) {
+
+        //
+        // Compute the number of target threads given the complexity of the
+        // convolution operation. The number of threads is limited to the number
+        // of output rows of all channels.
+        //
+
+        const size_t TotalRows = BatchCount * GroupCount * Parameters->OutputShape[0];
+
+        int32_t TargetThreadCount;
+        double Complexity = double(BatchCount) * double(GroupCount) * double(OutputSize) * double(K);
+
+        if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+            TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+        } else {
+            TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+        }
+
+        int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+        if (TargetThreadCount >= MaximumThreadCount) {
+            TargetThreadCount = MaximumThreadCount;
+        }
+
+        if (size_t(TargetThreadCount) >= TotalRows) {
+            TargetThreadCount = int32_t(TotalRows);
+        }
+
+        Parameters->Algorithm = MlasConvAlgorithmDepthwise;
+        Parameters->u.Depthwise.TargetThreadCount = size_t(TargetThreadCount);
+
+        return;
+    }
+
+    //
+    // Detect a 3x3 convolution with unit strides and dilations that has enough
+    // channels to amortize the Winograd transforms.
+    //
+
+    if (MlasConvWinogradPrepare(Parameters, WorkingBufferSize)) {
+        return;
+    }
+
     if (AllStridesAreOne && AllPaddingIsZero) {
 
         //
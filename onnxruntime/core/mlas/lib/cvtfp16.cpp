@@ -0,0 +1,302 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    cvtfp16.cpp
+
+Abstract:
+
+    This module implements routines to convert buffers of half-precision and
+    bfloat16 floats to single-precision floats.
+
+    The SSE2 half-precision conversion is implemented in assembly for Windows
+    x64 targets and is implemented here for all other targets.
+
+--*/
+
+#include "mlasi.h"
+
+#if defined(MLAS_TARGET_AMD64) && !defined(_WIN32)
+#define MLAS_F16C_TARGET __attribute__((target("avx,f16c")))
+#else
+#define MLAS_F16C_TARGET
+#endif
+
+inline
+float
+MlasConvertHalfToFloat(
+    unsigned short Value
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a half-precision float to a single-precision float.
+
+Arguments:
+
+    Value - Supplies the half-precision float.
+
+Return Value:
+
+    Returns the single-precision float.
+
+--*/
+{
+    union {
+        uint32_t u;
+        float f;
+    } Result, MagicDenormal;
+
+    const uint32_t Sign = uint32_t(Value & 0x8000) << 16;
+    const uint32_t ExponentMantissa = uint32_t(Value & 0x7FFF);
+
+    if (ExponentMantissa >= 0x7C00) {
+
+        //
+        // Infinity or NaN: rebias the exponent to the maximum value.
+        //
+
+        Result.u = (ExponentMantissa << 13) + 0x70000000;
+
+    } else if (ExponentMantissa < 0x0400) {
+
+        //
+        // Zero or denormal: renormalize using a floating point subtraction.
+        //
+
+        MagicDenormal.u = 0x38800000;
+        Result.u = (ExponentMantissa << 13) + 0x38800000;
+        Result.f -= MagicDenormal.f;
+
+    } else {
+
+        Result.u = (ExponentMantissa << 13) + 0x38000000;
+    }
+
+    Result.u |= Sign;
+
+    return Result.f;
+}
+
+#if !defined(_M_AMD64)
+
+extern "C"
+void
+MLASCALL
+MlasConvertHalfToFloatBuffer(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts the source buffer of half-precision floats to the
+    destination buffer of single-precision floats.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of half-precision
+        floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_SSE2_INTRINSICS)
+
+    const __m128i MaskSign = _mm_set1_epi32(0x00007FFF);
+    const __m128i CompareInfinity = _mm_set1_epi32(0x00007C00);
+    const __m128i CompareSmallest = _mm_set1_epi32(0x00000400);
+    const __m128i AdjustExponent = _mm_set1_epi32(0x38000000);
+    const __m128i MagicDenormal = _mm_set1_epi32(0x38800000);
+
+    while (Count >= 4) {
+
+        __m128i Value = _mm_loadl_epi64((const __m128i*)Source);
+        Value = _mm_unpacklo_epi16(Value, Value);
+
+        __m128i ExponentMantissa = _mm_and_si128(Value, MaskSign);
+        __m128i Sign = _mm_slli_epi32(_mm_xor_si128(Value, ExponentMantissa), 16);
+
+        __m128i InfinityAdjust = _mm_andnot_si128(_mm_cmpgt_epi32(CompareInfinity, ExponentMantissa), AdjustExponent);
+        __m128i DenormalMask = _mm_cmpgt_epi32(CompareSmallest, ExponentMantissa);
+
+        ExponentMantissa = _mm_slli_epi32(ExponentMantissa, 13);
+
+        __m128i Normal = _mm_add_epi32(_mm_add_epi32(ExponentMantissa, AdjustExponent), InfinityAdjust);
+        __m128 Denormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(ExponentMantissa, MagicDenormal)),
+            _mm_castsi128_ps(MagicDenormal));
+
+        __m128i Result = _mm_or_si128(_mm_and_si128(_mm_castps_si128(Denormal), DenormalMask),
+            _mm_andnot_si128(DenormalMask, Normal));
+
+        _mm_storeu_ps(Destination, _mm_castsi128_ps(_mm_or_si128(Result, Sign)));
+
+        Source += 4;
+        Destination += 4;
+        Count -= 4;
+    }
+
+#endif
+
+    while (Count > 0) {
+
+        *Destination++ = MlasConvertHalfToFloat(*Source++);
+        Count--;
+    }
+}
+
+#endif
+
+#if defined(MLAS_TARGET_AMD64)
+
+MLAS_F16C_TARGET
+void
+MLASCALL
+MlasConvertHalfToFloatBufferF16C(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts the source buffer of half-precision floats to the
+    destination buffer of single-precision floats.
+
+    This implementation uses F16C instructions.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of half-precision
+        floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (Count >= 8) {
+
+        __m128i Value = _mm_loadu_si128((const __m128i*)Source);
+        _mm256_storeu_ps(Destination, _mm256_cvtph_ps(Value));
+
+        Source += 8;
+        Destination += 8;
+        Count -= 8;
+    }
+
+    if (Count >= 4) {
+
+        __m128i Value = _mm_loadl_epi64((const __m128i*)Source);
+        _mm_storeu_ps(Destination, _mm_cvtph_ps(Value));
+
+        Source += 4;
+        Destination += 4;
+        Count -= 4;
+    }
+
+    while (Count > 0) {
+
+        *Destination++ = MlasConvertHalfToFloat(*Source++);
+        Count--;
+    }
+}
+
+#endif
+
+void
+MLASCALL
+MlasConvertBFloat16ToFloatBuffer(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts the source buffer of bfloat16 floats to the
+    destination buffer of single-precision floats.
+
+    A bfloat16 float is the upper half of a single-precision float, so the
+    conversion is exact.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of bfloat16 floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_SSE2_INTRINSICS)
+
+    const __m128i ZeroInt32x4 = _mm_setzero_si128();
+
+    while (Count >= 8) {
+
+        __m128i Value = _mm_loadu_si128((const __m128i*)Source);
+
+        _mm_storeu_ps(Destination, _mm_castsi128_ps(_mm_unpacklo_epi16(ZeroInt32x4, Value)));
+        _mm_storeu_ps(Destination + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(ZeroInt32x4, Value)));
+
+        Source += 8;
+        Destination += 8;
+        Count -= 8;
+    }
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+    while (Count >= 4) {
+
+        uint32x4_t Value = vshll_n_u16(vld1_u16(Source), 16);
+        vst1q_f32(Destination, vreinterpretq_f32_u32(Value));
+
+        Source += 4;
+        Destination += 4;
+        Count -= 4;
+    }
+
+#endif
+
+    while (Count > 0) {
+
+        union {
+            uint32_t u;
+            float f;
+        } Result;
+
+        Result.u = uint32_t(*Source++) << 16;
+        *Destination++ = Result.f;
+        Count--;
+    }
+}
@@ -0,0 +1,278 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    dwconv.cpp
+
+Abstract:
+
+    This module implements the direct depthwise convolution operation.
+
+    A depthwise convolution has a single input channel and a single filter per
+    group. Rather than expanding each group with im2col and invoking a GEMM
+    with a single row, each output row is computed directly from the rows of
+    the input plane with the filter held in registers.
+
+--*/
+
+#include "mlasi.h"
+
+template<size_t KernelSize, size_t StrideWidth>
+void
+MlasConvDepthwiseKernel(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float Bias,
+    float* Output,
+    size_t oh
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output row of a depthwise convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input plane of the channel.
+
+    Filter - Supplies the filter of the channel.
+
+    Bias - Supplies the bias of the channel.
+
+    Output - Supplies the output row.
+
+    oh - Supplies the index of the output row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+
+    const size_t DilationHeight = Parameters->DilationShape[0];
+    const size_t DilationWidth = Parameters->DilationShape[1];
+    const size_t PaddingLeftY = Parameters->Padding[0];
+    const size_t PaddingLeftX = Parameters->Padding[1];
+    const size_t StrideHeight = Parameters->StrideShape[0];
+
+    //
+    // Collect the input rows that are inside the input plane. Rows in the
+    // padding region contribute nothing to the output.
+    //
+
+    const float* InputRows[KernelSize];
+    const float* FilterRows[KernelSize];
+    size_t ValidRows = 0;
+
+    const size_t ihStart = oh * StrideHeight - PaddingLeftY;
+
+    for (size_t kh = 0; kh < KernelSize; kh++) {
+
+        const size_t ih = ihStart + kh * DilationHeight;
+
+        //
+        // N.B. The input row is outside the input plane if the unsigned
+        // arithmetic wrapped around for the leading padding rows.
+        //
+
+        if (ih < InputHeight) {
+            InputRows[ValidRows] = Input + ih * InputWidth;
+            FilterRows[ValidRows] = Filter + kh * KernelSize;
+            ValidRows++;
+        }
+    }
+
+    //
+    // Compute the range of output columns that can start a vector of four
+    // output columns with all the taps inside the input row.
+    //
+
+    const size_t SpanWidth = (KernelSize - 1) * DilationWidth + 4 * StrideWidth;
+
+    size_t owVectorStart = (PaddingLeftX + StrideWidth - 1) / StrideWidth;
+    size_t owVectorLimit = 0;
+
+    if (InputWidth + PaddingLeftX >= SpanWidth) {
+        owVectorLimit = (InputWidth + PaddingLeftX - SpanWidth) / StrideWidth + 1;
+    }
+
+    if (owVectorStart > OutputWidth) {
+        owVectorStart = OutputWidth;
+    }
+
+    //
+    // Compute a single output column with bounds checks on each tap.
+    //
+
+    auto ComputeSingleColumn = [&](size_t ow) {
+
+        const size_t iwStart = ow * StrideWidth - PaddingLeftX;
+        float Accumulator = Bias;
+
+        for (size_t row = 0; row < ValidRows; row++) {
+
+            for (size_t kw = 0; kw < KernelSize; kw++) {
+
+                const size_t iw = iwStart + kw * DilationWidth;
+
+                if (iw < InputWidth) {
+                    Accumulator += InputRows[row][iw] * FilterRows[row][kw];
+                }
+            }
+        }
+
+        Output[ow] = Accumulator;
+    };
+
+    size_t ow = 0;
+
+    for (; ow < owVectorStart; ow++) {
+        ComputeSingleColumn(ow);
+    }
+
+    //
+    // Compute four output columns at a time for the interior of the row.
+    //
+
+    if (ow < owVectorLimit && ow + 4 <= OutputWidth) {
+
+        MLAS_FLOAT32X4 FilterVectors[KernelSize][KernelSize];
+
+        for (size_t row = 0; row < ValidRows; row++) {
+            for (size_t kw = 0; kw < KernelSize; kw++) {
+                FilterVectors[row][kw] = MlasBroadcastFloat32x4(FilterRows[row][kw]);
+            }
+        }
+
+        const MLAS_FLOAT32X4 BiasVector = MlasBroadcastFloat32x4(Bias);
+
+        for (; ow < owVectorLimit && ow + 4 <= OutputWidth; ow += 4) {
+
+            const size_t iwStart = ow * StrideWidth - PaddingLeftX;
+            MLAS_FLOAT32X4 Accumulator = BiasVector;
+
+            for (size_t row = 0; row < ValidRows; row++) {
+
+                const float* InputRow = InputRows[row] + iwStart;
+
+                for (size_t kw = 0; kw < KernelSize; kw++) {
+
+                    MLAS_FLOAT32X4 InputVector;
+
+                    if (StrideWidth == 1) {
+                        InputVector = MlasLoadFloat32x4(InputRow + kw * DilationWidth);
+                    } else {
+                        InputVector = MlasLoadStride2Float32x4(InputRow + kw * DilationWidth);
+                    }
+
+                    Accumulator = MlasMultiplyAddFloat32x4(InputVector, FilterVectors[row][kw], Accumulator);
+                }
+            }
+
+            MlasStoreFloat32x4(Output + ow, Accumulator);
+        }
+    }
+
+    for (; ow < OutputWidth; ow++) {
+        ComputeSingleColumn(ow);
+    }
+}
+
+void
+MlasConvDepthwise(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t RowStart,
+    size_t RowCount
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a segment of a depthwise convolution. The rows of
+    the operation are the output rows of every batch and group.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor.
+
+    Bias - Optionally supplies the bias vector.
+
+    Output - Supplies the output tensor.
+
+    RowStart - Supplies the first row to compute.
+
+    RowCount - Supplies the number of rows to compute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputSize = Parameters->InputSize;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t K = Parameters->K;
+
+    const size_t KernelSize = Parameters->KernelShape[1];
+    const size_t StrideWidth = Parameters->StrideShape[1];
+
+    for (size_t row = RowStart; row < RowStart + RowCount; row++) {
+
+        const size_t bg = row / OutputHeight;
+        const size_t oh = row % OutputHeight;
+        const size_t group = bg % GroupCount;
+
+        const float* input = Input + bg * InputSize;
+        const float* filter = Filter + group * K;
+        const float bias = (Bias != nullptr) ? Bias[group] : 0.0f;
+        float* output = Output + bg * OutputSize + oh * OutputWidth;
+
+        if (KernelSize == 3) {
+            if (StrideWidth == 1) {
+                MlasConvDepthwiseKernel<3, 1>(Parameters, input, filter, bias, output, oh);
+            } else {
+                MlasConvDepthwiseKernel<3, 2>(Parameters, input, filter, bias, output, oh);
+            }
+        } else {
+            if (StrideWidth == 1) {
+                MlasConvDepthwiseKernel<5, 1>(Parameters, input, filter, bias, output, oh);
+            } else {
+                MlasConvDepthwiseKernel<5, 2>(Parameters, input, filter, bias, output, oh);
+            }
+        }
+
+        //
+        // Apply the activation. The bias has already been added.
+        //
+
+        if (Parameters->Activation->ActivationKind != MlasIdentityActivation) {
+            MlasActivation(Parameters->Activation, output, nullptr, 1, output,
+                OutputWidth, OutputWidth);
+        }
+    }
+}
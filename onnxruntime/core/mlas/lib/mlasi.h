@@ -173,6 +173,16 @@ void
 
 typedef MLAS_TANH_KERNEL_ROUTINE* PMLAS_TANH_KERNEL_ROUTINE;
 
+typedef
+void
+(MLASCALL MLAS_CONVERT_HALF_TO_FLOAT_ROUTINE)(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    );
+
+typedef MLAS_CONVERT_HALF_TO_FLOAT_ROUTINE* PMLAS_CONVERT_HALF_TO_FLOAT_ROUTINE;
+
 extern "C" {
 
     MLAS_SGEMM_KERNEL_ROUTINE MlasSgemmKernelZero;
@@ -209,6 +219,10 @@ extern "C" {
 
 }
 
+#if defined(MLAS_TARGET_AMD64)
+MLAS_CONVERT_HALF_TO_FLOAT_ROUTINE MlasConvertHalfToFloatBufferF16C;
+#endif
+
 //
 // Define the target number of per-thread multiplies before using another
 // thread to perform additional work.
@@ -229,9 +243,11 @@ extern "C" {
 #endif
 
 //
-// Single-threaded single precision matrix/matrix multiply operation.
+// Single-threaded single precision matrix/matrix multiply operation. Matrix B
+// is single precision or one of the reduced precision types.
 //
 
+template<typename ElementB>
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -242,13 +258,48 @@ MlasSgemmOperation(
     float alpha,
     const float* A,
     size_t lda,
-    const float* B,
+    const ElementB* B,
     size_t ldb,
     float beta,
     float* C,
     size_t ldc
     );
 
+//
+// Single-threaded direct depthwise convolution operation.
+//
+
+void
+MlasConvDepthwise(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t RowStart,
+    size_t RowCount
+    );
+
+//
+// Winograd convolution operation.
+//
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    );
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output
+    );
+
 //
 // Environment information class.
 //
@@ -268,6 +319,7 @@ struct MLAS_PLATFORM {
     PMLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE TransposePackB16x4Routine;
     PMLAS_LOGISTIC_KERNEL_ROUTINE LogisticKernelRoutine;
     PMLAS_TANH_KERNEL_ROUTINE TanhKernelRoutine;
+    PMLAS_CONVERT_HALF_TO_FLOAT_ROUTINE ConvertHalfToFloatRoutine;
 #endif
 
 #if defined(MLAS_USE_WIN32_THREADPOOL)
@@ -456,6 +508,21 @@ MlasExtractLaneFloat32x4<0>(MLAS_FLOAT32X4 Vector)
 
 #endif
 
+//
+// Loads the even elements of the eight elements starting at the buffer.
+//
+
+inline
+MLAS_FLOAT32X4
+MlasLoadStride2Float32x4(const float* Buffer)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vld2q_f32(Buffer).val[0];
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_shuffle_ps(_mm_loadu_ps(Buffer), _mm_loadu_ps(Buffer + 4), _MM_SHUFFLE(2, 0, 2, 0));
+#endif
+}
+
 inline
 MLAS_FLOAT32X4
 MlasBroadcastFloat32x4(float Value)
@@ -563,6 +630,61 @@ MlasMinimumFloat32x4(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
 #endif
 }
 
+inline
+float
+MlasReduceAddFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    return vaddvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    float32x2_t VectorLow = vget_low_f32(Vector);
+    float32x2_t VectorHigh = vget_high_f32(Vector);
+    VectorLow = vpadd_f32(VectorLow, VectorHigh);
+    VectorLow = vpadd_f32(VectorLow, VectorHigh);
+    return vget_lane_f32(VectorLow, 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+    Vector = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
+inline
+float
+MlasReduceMaximumFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    return vmaxvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    float32x2_t VectorLow = vget_low_f32(Vector);
+    float32x2_t VectorHigh = vget_high_f32(Vector);
+    VectorLow = vpmax_f32(VectorLow, VectorHigh);
+    VectorLow = vpmax_f32(VectorLow, VectorHigh);
+    return vget_lane_f32(VectorLow, 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_max_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+    Vector = _mm_max_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
+//
+// Returns 2^Exponent for integral values of Exponent in the range [-126, 127].
+//
+
+inline
+MLAS_FLOAT32X4
+MlasPowerOf2Float32x4(MLAS_FLOAT32X4 Exponent)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    int32x4_t BiasedExponent = vaddq_s32(vcvtq_s32_f32(Exponent), vdupq_n_s32(127));
+    return vreinterpretq_f32_s32(vshlq_n_s32(BiasedExponent, 23));
+#elif defined(MLAS_SSE2_INTRINSICS)
+    __m128i BiasedExponent = _mm_add_epi32(_mm_cvttps_epi32(Exponent), _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(BiasedExponent, 23));
+#endif
+}
+
 //
 // Reads a platform specific time stamp counter.
 //
@@ -90,6 +90,7 @@ Return Value:
     this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Sse;
     this->LogisticKernelRoutine = MlasLogisticKernel;
     this->TanhKernelRoutine = MlasTanhKernel;
+    this->ConvertHalfToFloatRoutine = MlasConvertHalfToFloatBuffer;
 #endif
 
     //
@@ -155,6 +156,14 @@ Return Value:
             this->KernelM1TransposeBRoutine = MlasSgemmKernelM1TransposeBAvx;
             this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Avx;
 
+            //
+            // Check if the processor supports the F16C feature.
+            //
+
+            if ((Cpuid1[2] & 0x20000000) != 0) {
+                this->ConvertHalfToFloatRoutine = MlasConvertHalfToFloatBufferF16C;
+            }
+
 #endif
 
         }
@@ -31,6 +31,7 @@ Abstract:
 // threads.
 //
 
+template<typename ElementB>
 struct MLAS_SGEMM_WORK_BLOCK {
     CBLAS_TRANSPOSE TransA;
     CBLAS_TRANSPOSE TransB;
@@ -44,7 +45,7 @@ struct MLAS_SGEMM_WORK_BLOCK {
         size_t M;
         size_t N;
         const float* A;
-        const float* B;
+        const ElementB* B;
         float* C;
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
@@ -772,6 +773,247 @@ Return Value:
     }
 }
 
+inline
+void
+MlasSgemmConvertToFloat(
+    const MLAS_FP16* Source,
+    float* Destination,
+    size_t Count
+    )
+{
+    const unsigned short* s = reinterpret_cast<const unsigned short*>(Source);
+
+#if defined(MLAS_TARGET_AMD64)
+    MlasPlatform.ConvertHalfToFloatRoutine(s, Destination, Count);
+#else
+    MlasConvertHalfToFloatBuffer(s, Destination, Count);
+#endif
+}
+
+inline
+void
+MlasSgemmConvertToFloat(
+    const MLAS_BF16* Source,
+    float* Destination,
+    size_t Count
+    )
+{
+    MlasConvertBFloat16ToFloatBuffer(reinterpret_cast<const unsigned short*>(Source), Destination, Count);
+}
+
+inline
+void
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    float* D,
+    const float* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK
+    )
+/*++
+
+Routine Description:
+
+    This routine copies or transposes a panel of the single precision source
+    matrix to the destination packed buffer.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the panel of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the panel.
+
+    CountK - Supplies the number of rows of the panel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (TransB == CblasNoTrans) {
+        MlasSgemmCopyPackB(D, B, ldb, CountN, CountK);
+    } else {
+        MlasSgemmTransposePackB(D, B, ldb, CountN, CountK);
+    }
+}
+
+template<typename ElementB>
+void
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    float* D,
+    const ElementB* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a panel of the reduced precision source matrix to
+    single precision and then copies or transposes the panel to the
+    destination packed buffer.
+
+    The panel is converted to a local buffer the size of the packed buffer, so
+    only the panel is ever expanded to single precision.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the panel of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the panel.
+
+    CountK - Supplies the number of rows of the panel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float PanelConverted[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK];
+
+    if (TransB == CblasNoTrans) {
+
+        for (size_t k = 0; k < CountK; k++) {
+            MlasSgemmConvertToFloat(B + k * ldb, PanelConverted + k * CountN, CountN);
+        }
+
+        MlasSgemmCopyPackB(D, PanelConverted, CountN, CountN, CountK);
+
+    } else {
+
+        for (size_t n = 0; n < CountN; n++) {
+            MlasSgemmConvertToFloat(B + n * ldb, PanelConverted + n * CountK, CountK);
+        }
+
+        MlasSgemmTransposePackB(D, PanelConverted, CountK, CountN, CountK);
+    }
+}
+
+inline
+bool
+MlasSgemmTryKernelM1(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* A,
+    const float* B,
+    size_t ldb,
+    float beta,
+    float* C
+    )
+/*++
+
+Routine Description:
+
+    This routine attempts to compute a single row of the output matrix using
+    a kernel that reads matrix B directly rather than through a packed buffer.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+Return Value:
+
+    Returns true if the operation was completed, else false if the operation
+    should use the packed path.
+
+--*/
+{
+#if defined(MLAS_TARGET_AMD64)
+
+    PMLAS_SGEMM_KERNEL_M1_ROUTINE SgemmKernelM1Routine;
+
+    if (TransB == CblasNoTrans) {
+        SgemmKernelM1Routine = MlasPlatform.KernelM1Routine;
+    } else {
+        SgemmKernelM1Routine = MlasPlatform.KernelM1TransposeBRoutine;
+    }
+
+    if (SgemmKernelM1Routine != nullptr) {
+        SgemmKernelM1Routine(A, B, C, K, N, ldb, beta);
+        return true;
+    }
+
+#else
+
+    MLAS_UNREFERENCED_PARAMETER(TransB);
+    MLAS_UNREFERENCED_PARAMETER(N);
+    MLAS_UNREFERENCED_PARAMETER(K);
+    MLAS_UNREFERENCED_PARAMETER(A);
+    MLAS_UNREFERENCED_PARAMETER(B);
+    MLAS_UNREFERENCED_PARAMETER(ldb);
+    MLAS_UNREFERENCED_PARAMETER(beta);
+    MLAS_UNREFERENCED_PARAMETER(C);
+
+#endif
+
+    return false;
+}
+
+template<typename ElementB>
+inline
+bool
+MlasSgemmTryKernelM1(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* A,
+    const ElementB* B,
+    size_t ldb,
+    float beta,
+    float* C
+    )
+{
+    //
+    // The M1 kernels read matrix B directly, so a reduced precision matrix B
+    // always uses the packed path.
+    //
+
+    MLAS_UNREFERENCED_PARAMETER(TransB);
+    MLAS_UNREFERENCED_PARAMETER(N);
+    MLAS_UNREFERENCED_PARAMETER(K);
+    MLAS_UNREFERENCED_PARAMETER(A);
+    MLAS_UNREFERENCED_PARAMETER(B);
+    MLAS_UNREFERENCED_PARAMETER(ldb);
+    MLAS_UNREFERENCED_PARAMETER(beta);
+    MLAS_UNREFERENCED_PARAMETER(C);
+
+    return false;
+}
+
+template<typename ElementB>
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -782,7 +1024,7 @@ MlasSgemmOperation(
     float alpha,
     const float* A,
     size_t lda,
-    const float* B,
+    const ElementB* B,
     size_t ldb,
     float beta,
     float* C,
@@ -841,23 +1083,9 @@ Return Value:
 
     if (M == 1 && TransA == CblasNoTrans && alpha == 1.0f && (beta == 0.0f || beta == 1.0f)) {
 
-#if defined(MLAS_TARGET_AMD64)
-
-        PMLAS_SGEMM_KERNEL_M1_ROUTINE SgemmKernelM1Routine;
-
-        if (TransB == CblasNoTrans) {
-            SgemmKernelM1Routine = MlasPlatform.KernelM1Routine;
-        } else {
-            SgemmKernelM1Routine = MlasPlatform.KernelM1TransposeBRoutine;
-        }
-
-        if (SgemmKernelM1Routine != nullptr) {
-            SgemmKernelM1Routine(A, B, C, K, N, ldb, beta);
+        if (MlasSgemmTryKernelM1(TransB, N, K, A, B, ldb, beta, C)) {
             return;
         }
-
-#endif
-
     }
 
     //
@@ -926,9 +1154,9 @@ Return Value:
             //
 
             if (TransB == CblasNoTrans) {
-                MlasSgemmCopyPackB(PanelB, B + n + k * ldb, ldb, CountN, CountK);
+                MlasSgemmPackB(TransB, PanelB, B + n + k * ldb, ldb, CountN, CountK);
             } else {
-                MlasSgemmTransposePackB(PanelB, B + k + n * ldb, ldb, CountN, CountK);
+                MlasSgemmPackB(TransB, PanelB, B + k + n * ldb, ldb, CountN, CountK);
             }
 
             //
@@ -1031,6 +1259,7 @@ Return Value:
     }
 }
 
+template<typename ElementB>
 void
 MlasSgemmOperationThreaded(
     void* Context,
@@ -1055,9 +1284,9 @@ Return Value:
 
 --*/
 {
-    MLAS_SGEMM_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_WORK_BLOCK*)Context;
+    MLAS_SGEMM_WORK_BLOCK<ElementB>* WorkBlock = (MLAS_SGEMM_WORK_BLOCK<ElementB>*)Context;
 
-    MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
+    typename MLAS_SGEMM_WORK_BLOCK<ElementB>::SEGMENT* Segment = &WorkBlock->Segments[Index];
 
     MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
         Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
@@ -1065,6 +1294,7 @@ Return Value:
         WorkBlock->ldc);
 }
 
+template<typename ElementB>
 inline
 bool
 MlasSgemmTryMultithread(
@@ -1076,7 +1306,7 @@ MlasSgemmTryMultithread(
     float alpha,
     const float* A,
     size_t lda,
-    const float* B,
+    const ElementB* B,
     size_t ldb,
     float beta,
     float* C,
@@ -1128,7 +1358,7 @@ Return Value:
 
 #if defined(MLAS_HAS_THREADING_SUPPORT)
 
-    MLAS_SGEMM_WORK_BLOCK WorkBlock;
+    MLAS_SGEMM_WORK_BLOCK<ElementB> WorkBlock;
     int32_t TargetThreadCount;
 
     //
@@ -1231,7 +1461,7 @@ Return Value:
         }
     }
 
-    MlasExecuteThreaded(MlasSgemmOperationThreaded, &WorkBlock, Index);
+    MlasExecuteThreaded(MlasSgemmOperationThreaded<ElementB>, &WorkBlock, Index);
 
     return true;
 
@@ -1329,3 +1559,153 @@ Return Value:
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+void
+MLASCALL
+MlasSgemm(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const MLAS_FP16* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a half precision matrix B.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    B - Supplies the address of the half precision matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+        MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+}
+
+void
+MLASCALL
+MlasSgemm(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const MLAS_BF16* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a bfloat16 matrix B.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    B - Supplies the address of the bfloat16 matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+        MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+}
+
+//
+// Instantiate the single-threaded operation for the callers in other modules.
+//
+
+template
+void
+MlasSgemmOperation<float>(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    size_t ldc
+    );
@@ -0,0 +1,1113 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    snchwc.cpp
+
+Abstract:
+
+    This module implements the single precision operations using the NCHWc
+    blocking format.
+
+    The NCHWc format stores the channels of a tensor in blocks of
+    MLAS_NCHWC_BLOCK_SIZE channels, where the channels of a block are the
+    innermost dimension: a tensor of shape [N, C, H, W] is stored as
+    [N, C/Bc, H, W, Bc]. The channel count is padded to a multiple of the
+    block size with zeros. A block of channels of one spatial position is
+    then a contiguous vector, so the convolution and pooling kernels can
+    operate directly on the input tensor without the im2col expansion used
+    by the NCHW convolution.
+
+    Filters are reordered once to match the blocking of the input and output
+    tensors: OIHWBiBo for the regular and grouped convolutions and OIHWBo for
+    the depthwise convolution.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of channels in a block of a NCHWc tensor. The kernels
+// below process a block as two vectors of four elements.
+//
+
+#define MLAS_NCHWC_BLOCK_SIZE                       8
+
+//
+// Define the number of output columns that are produced at once by the
+// convolution kernel, so that each filter vector that is loaded is used
+// several times.
+//
+
+#define MLAS_NCHWC_CONV_COLUMN_COUNT                4
+
+//
+// Define the minimum number of multiply/accumulate operations that are
+// assigned to a thread.
+//
+
+#define MLAS_NCHWC_THREAD_COMPLEXITY                (64 * 1024)
+
+//
+// Define the parameters to execute segments of a NCHWc convolution operation
+// on worker threads.
+//
+
+struct MLAS_NCHWC_CONV_WORK_BLOCK {
+    int32_t ThreadCount;
+    size_t BatchCount;
+    size_t GroupCount;
+    size_t InputChannels;
+    size_t InputShape[2];
+    size_t InputSize;
+    size_t OutputChannels;
+    size_t OutputShape[2];
+    size_t OutputSize;
+    size_t KernelShape[2];
+    size_t DilationShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    bool Depthwise;
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* Output;
+    const MLAS_ACTIVATION* Activation;
+};
+
+//
+// Define the parameters to execute segments of a NCHWc pooling operation on
+// worker threads.
+//
+
+struct MLAS_NCHWC_POOL_WORK_BLOCK {
+    int32_t ThreadCount;
+    MLAS_POOLING_KIND PoolingKind;
+    size_t TotalChannelCount;
+    size_t InputShape[2];
+    size_t InputSize;
+    size_t OutputShape[2];
+    size_t OutputSize;
+    size_t KernelShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    const float* Input;
+    float* Output;
+};
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of channels in a block of a NCHWc tensor.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the NCHWc block size.
+
+--*/
+{
+    return MLAS_NCHWC_BLOCK_SIZE;
+}
+
+inline
+void
+MlasPartitionRows(
+    int32_t Index,
+    int32_t ThreadCount,
+    size_t TotalRows,
+    size_t* RowStart,
+    size_t* RowCount
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of rows to be processed by the worker
+    thread with the supplied index.
+
+Arguments:
+
+    Index - Supplies the current index of the threaded operation.
+
+    ThreadCount - Supplies the number of threads of the operation.
+
+    TotalRows - Supplies the total number of rows to process.
+
+    RowStart - Receives the first row to process.
+
+    RowCount - Receives the number of rows to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t RowsPerThread = TotalRows / size_t(ThreadCount);
+    const size_t RowsPerThreadExtra = TotalRows % size_t(ThreadCount);
+
+    if (size_t(Index) < RowsPerThreadExtra) {
+        *RowCount = RowsPerThread + 1;
+        *RowStart = size_t(Index) * *RowCount;
+    } else {
+        *RowCount = RowsPerThread;
+        *RowStart = size_t(Index) * RowsPerThread + RowsPerThreadExtra;
+    }
+}
+
+int32_t
+MlasNchwcGetThreadCount(
+    double Complexity,
+    size_t TotalRows
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of threads to use for an operation given
+    its complexity. The number of threads is limited to the number of rows and
+    each thread is kept busy with a minimum amount of work.
+
+Arguments:
+
+    Complexity - Supplies the number of operations to execute.
+
+    TotalRows - Supplies the number of rows that can be distributed to the
+        threads.
+
+Return Value:
+
+    Returns the number of threads to use.
+
+--*/
+{
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_NCHWC_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_NCHWC_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TotalRows) {
+        TargetThreadCount = int32_t(TotalRows);
+    }
+
+    return TargetThreadCount;
+}
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a NCHW tensor to the NCHWc format. The channels are
+    padded with zeros to a multiple of the block size.
+
+Arguments:
+
+    InputShape - Supplies the NCHW shape of the source tensor.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BatchCount = size_t(InputShape[0]);
+    const size_t InputChannels = size_t(InputShape[1]);
+    const size_t InputSize = size_t(InputShape[2]) * size_t(InputShape[3]);
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < InputChannels; c += MLAS_NCHWC_BLOCK_SIZE) {
+
+            const size_t ChannelsThisBlock = (std::min)(InputChannels - c, size_t(MLAS_NCHWC_BLOCK_SIZE));
+
+            for (size_t i = 0; i < InputSize; i++) {
+
+                const float* s = S + i;
+                size_t bc = 0;
+
+                for (; bc < ChannelsThisBlock; bc++) {
+                    D[bc] = *s;
+                    s += InputSize;
+                }
+
+                for (; bc < MLAS_NCHWC_BLOCK_SIZE; bc++) {
+                    D[bc] = 0.0f;
+                }
+
+                D += MLAS_NCHWC_BLOCK_SIZE;
+            }
+
+            S += ChannelsThisBlock * InputSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a NCHWc tensor to the NCHW format. The channels that
+    pad the source tensor to a multiple of the block size are dropped.
+
+Arguments:
+
+    OutputShape - Supplies the NCHW shape of the destination tensor.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BatchCount = size_t(OutputShape[0]);
+    const size_t OutputChannels = size_t(OutputShape[1]);
+    const size_t OutputSize = size_t(OutputShape[2]) * size_t(OutputShape[3]);
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < OutputChannels; c += MLAS_NCHWC_BLOCK_SIZE) {
+
+            const size_t ChannelsThisBlock = (std::min)(OutputChannels - c, size_t(MLAS_NCHWC_BLOCK_SIZE));
+
+            for (size_t bc = 0; bc < ChannelsThisBlock; bc++) {
+
+                const float* s = S + bc;
+
+                for (size_t i = 0; i < OutputSize; i++) {
+                    D[i] = *s;
+                    s += MLAS_NCHWC_BLOCK_SIZE;
+                }
+
+                D += OutputSize;
+            }
+
+            S += MLAS_NCHWC_BLOCK_SIZE * OutputSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter from the OIHW format to the OIHWBiBo format
+    used by the regular and grouped NCHWc convolutions. The output and input
+    channels are padded with zeros to a multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the OIHW shape of the source filter.
+
+    S - Supplies the address of the source filter.
+
+    D - Supplies the address of the destination filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += MLAS_NCHWC_BLOCK_SIZE) {
+
+        for (size_t i = 0; i < InputChannels; i += MLAS_NCHWC_BLOCK_SIZE) {
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bi = 0; bi < MLAS_NCHWC_BLOCK_SIZE; bi++) {
+
+                    for (size_t bo = 0; bo < MLAS_NCHWC_BLOCK_SIZE; bo++) {
+
+                        if (o + bo < OutputChannels && i + bi < InputChannels) {
+                            *D = S[((o + bo) * InputChannels + (i + bi)) * KernelSize + k];
+                        } else {
+                            *D = 0.0f;
+                        }
+
+                        D++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter from the OIHW format to the OIHWBo format
+    used by the depthwise NCHWc convolution. The output channels are padded
+    with zeros to a multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the OIHW shape of the source filter.
+
+    S - Supplies the address of the source filter.
+
+    D - Supplies the address of the destination filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += MLAS_NCHWC_BLOCK_SIZE) {
+
+        for (size_t i = 0; i < InputChannels; i++) {
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bo = 0; bo < MLAS_NCHWC_BLOCK_SIZE; bo++) {
+
+                    if (o + bo < OutputChannels) {
+                        *D = S[((o + bo) * InputChannels + i) * KernelSize + k];
+                    } else {
+                        *D = 0.0f;
+                    }
+
+                    D++;
+                }
+            }
+        }
+    }
+}
+
+template<size_t ColumnCount>
+void
+MlasNchwcConvKernel(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t oh,
+    size_t ow
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a block of output channels for a set of adjacent
+    output columns of a regular or grouped NCHWc convolution.
+
+    Each filter vector that is loaded is multiplied with the input of each of
+    the output columns, so that the filter is read once per set of columns.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the first input channel block of the group.
+
+    Filter - Supplies the filter for the output channel block.
+
+    Bias - Supplies the optional bias for the output channel block.
+
+    Output - Supplies the output row of the output channel block.
+
+    oh - Supplies the index of the output row.
+
+    ow - Supplies the index of the first output column.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+    const size_t DilationWidth = WorkBlock->DilationShape[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const size_t PaddingTop = WorkBlock->Padding[0];
+    const size_t PaddingLeft = WorkBlock->Padding[1];
+
+    const size_t InputBlockStride = WorkBlock->InputSize * MLAS_NCHWC_BLOCK_SIZE;
+    const size_t FilterKernelStride = MLAS_NCHWC_BLOCK_SIZE * MLAS_NCHWC_BLOCK_SIZE;
+
+    MLAS_FLOAT32X4 Accumulator0[ColumnCount];
+    MLAS_FLOAT32X4 Accumulator1[ColumnCount];
+
+    for (size_t c = 0; c < ColumnCount; c++) {
+        if (Bias != nullptr) {
+            Accumulator0[c] = MlasLoadFloat32x4(Bias);
+            Accumulator1[c] = MlasLoadFloat32x4(Bias + 4);
+        } else {
+            Accumulator0[c] = MlasZeroFloat32x4();
+            Accumulator1[c] = MlasZeroFloat32x4();
+        }
+    }
+
+    const size_t InputChannelBlocks = WorkBlock->InputChannels / MLAS_NCHWC_BLOCK_SIZE;
+
+    for (size_t icb = 0; icb < InputChannelBlocks; icb++) {
+
+        for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+            //
+            // Rows above or below the input tensor are padding. The unsigned
+            // arithmetic maps the rows above the input to large values.
+            //
+
+            const size_t ih = oh * StrideHeight + kh * DilationHeight - PaddingTop;
+
+            if (ih >= InputHeight) {
+                continue;
+            }
+
+            const float* InputRow = Input + ih * InputWidth * MLAS_NCHWC_BLOCK_SIZE;
+            const float* FilterRow = Filter + kh * KernelWidth * FilterKernelStride;
+
+            for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                const float* InputColumn[ColumnCount];
+                bool AllColumnsValid = true;
+
+                for (size_t c = 0; c < ColumnCount; c++) {
+
+                    const size_t iw = (ow + c) * StrideWidth + kw * DilationWidth - PaddingLeft;
+
+                    if (iw < InputWidth) {
+                        InputColumn[c] = InputRow + iw * MLAS_NCHWC_BLOCK_SIZE;
+                    } else {
+                        InputColumn[c] = nullptr;
+                        AllColumnsValid = false;
+                    }
+                }
+
+                const float* f = FilterRow + kw * FilterKernelStride;
+
+                for (size_t bi = 0; bi < MLAS_NCHWC_BLOCK_SIZE; bi++) {
+
+                    MLAS_FLOAT32X4 FilterVector0 = MlasLoadFloat32x4(f);
+                    MLAS_FLOAT32X4 FilterVector1 = MlasLoadFloat32x4(f + 4);
+
+                    for (size_t c = 0; c < ColumnCount; c++) {
+
+                        if (AllColumnsValid || InputColumn[c] != nullptr) {
+
+                            MLAS_FLOAT32X4 InputVector = MlasBroadcastFloat32x4(InputColumn[c] + bi);
+
+                            Accumulator0[c] = MlasMultiplyAddFloat32x4(InputVector, FilterVector0, Accumulator0[c]);
+                            Accumulator1[c] = MlasMultiplyAddFloat32x4(InputVector, FilterVector1, Accumulator1[c]);
+                        }
+                    }
+
+                    f += MLAS_NCHWC_BLOCK_SIZE;
+                }
+            }
+        }
+
+        Input += InputBlockStride;
+        Filter += KernelHeight * KernelWidth * FilterKernelStride;
+    }
+
+    for (size_t c = 0; c < ColumnCount; c++) {
+        MlasStoreFloat32x4(Output + c * MLAS_NCHWC_BLOCK_SIZE, Accumulator0[c]);
+        MlasStoreFloat32x4(Output + c * MLAS_NCHWC_BLOCK_SIZE + 4, Accumulator1[c]);
+    }
+}
+
+void
+MlasNchwcConvDepthwiseKernel(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t oh
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a channel block of a depthwise
+    NCHWc convolution. Each channel of the block is convolved with its own
+    filter, so the channel block is processed as a vector.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel block.
+
+    Filter - Supplies the filter for the channel block.
+
+    Bias - Supplies the optional bias for the channel block.
+
+    Output - Supplies the output row of the channel block.
+
+    oh - Supplies the index of the output row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+    const size_t DilationWidth = WorkBlock->DilationShape[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const size_t PaddingTop = WorkBlock->Padding[0];
+    const size_t PaddingLeft = WorkBlock->Padding[1];
+
+    MLAS_FLOAT32X4 BiasVector0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 BiasVector1 = MlasZeroFloat32x4();
+
+    if (Bias != nullptr) {
+        BiasVector0 = MlasLoadFloat32x4(Bias);
+        BiasVector1 = MlasLoadFloat32x4(Bias + 4);
+    }
+
+    for (size_t ow = 0; ow < OutputWidth; ow++) {
+
+        MLAS_FLOAT32X4 Accumulator0 = BiasVector0;
+        MLAS_FLOAT32X4 Accumulator1 = BiasVector1;
+
+        for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+            const size_t ih = oh * StrideHeight + kh * DilationHeight - PaddingTop;
+
+            if (ih >= InputHeight) {
+                continue;
+            }
+
+            const float* InputRow = Input + ih * InputWidth * MLAS_NCHWC_BLOCK_SIZE;
+            const float* f = Filter + kh * KernelWidth * MLAS_NCHWC_BLOCK_SIZE;
+
+            for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                const size_t iw = ow * StrideWidth + kw * DilationWidth - PaddingLeft;
+
+                if (iw < InputWidth) {
+
+                    const float* i = InputRow + iw * MLAS_NCHWC_BLOCK_SIZE;
+
+                    Accumulator0 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(i), MlasLoadFloat32x4(f), Accumulator0);
+                    Accumulator1 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(i + 4), MlasLoadFloat32x4(f + 4), Accumulator1);
+                }
+
+                f += MLAS_NCHWC_BLOCK_SIZE;
+            }
+        }
+
+        MlasStoreFloat32x4(Output, Accumulator0);
+        MlasStoreFloat32x4(Output + 4, Accumulator1);
+
+        Output += MLAS_NCHWC_BLOCK_SIZE;
+    }
+}
+
+void
+MlasNchwcConvThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc convolution operation.
+
+    The operation is partitioned by output rows, where a row is identified by
+    the batch, the output channel block and the output height index, so that
+    the work is evenly distributed for any batch count or channel count.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_NCHWC_CONV_WORK_BLOCK*)Context;
+
+    const size_t GroupCount = WorkBlock->GroupCount;
+    const size_t InputChannels = WorkBlock->InputChannels;
+    const size_t OutputChannels = WorkBlock->OutputChannels;
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t OutputSize = WorkBlock->OutputSize;
+    const size_t KernelSize = WorkBlock->KernelShape[0] * WorkBlock->KernelShape[1];
+
+    const size_t TotalInputChannels = GroupCount * InputChannels;
+    const size_t TotalOutputChannels = GroupCount * OutputChannels;
+    const size_t OutputChannelBlocks = TotalOutputChannels / MLAS_NCHWC_BLOCK_SIZE;
+    const size_t TotalRows = WorkBlock->BatchCount * OutputChannelBlocks * OutputHeight;
+
+    size_t RowStart;
+    size_t RowCount;
+
+    MlasPartitionRows(Index, WorkBlock->ThreadCount, TotalRows, &RowStart, &RowCount);
+
+    for (size_t row = RowStart; row < RowStart + RowCount; row++) {
+
+        const size_t oh = row % OutputHeight;
+        const size_t ocb = (row / OutputHeight) % OutputChannelBlocks;
+        const size_t n = row / (OutputHeight * OutputChannelBlocks);
+
+        const float* Bias = WorkBlock->Bias;
+
+        if (Bias != nullptr) {
+            Bias += ocb * MLAS_NCHWC_BLOCK_SIZE;
+        }
+
+        float* Output = WorkBlock->Output + (n * TotalOutputChannels + ocb * MLAS_NCHWC_BLOCK_SIZE) * OutputSize +
+            oh * OutputWidth * MLAS_NCHWC_BLOCK_SIZE;
+
+        if (WorkBlock->Depthwise) {
+
+            const float* Input = WorkBlock->Input + (n * TotalInputChannels + ocb * MLAS_NCHWC_BLOCK_SIZE) * InputSize;
+            const float* Filter = WorkBlock->Filter + ocb * KernelSize * MLAS_NCHWC_BLOCK_SIZE;
+
+            MlasNchwcConvDepthwiseKernel(WorkBlock, Input, Filter, Bias, Output, oh);
+
+        } else {
+
+            const size_t Group = ocb / (OutputChannels / MLAS_NCHWC_BLOCK_SIZE);
+
+            const float* Input = WorkBlock->Input + (n * TotalInputChannels + Group * InputChannels) * InputSize;
+            const float* Filter = WorkBlock->Filter + ocb * InputChannels * KernelSize * MLAS_NCHWC_BLOCK_SIZE;
+
+            size_t ow = 0;
+
+            for (; ow + MLAS_NCHWC_CONV_COLUMN_COUNT <= OutputWidth; ow += MLAS_NCHWC_CONV_COLUMN_COUNT) {
+                MlasNchwcConvKernel<MLAS_NCHWC_CONV_COLUMN_COUNT>(WorkBlock, Input, Filter, Bias,
+                    Output + ow * MLAS_NCHWC_BLOCK_SIZE, oh, ow);
+            }
+
+            for (; ow < OutputWidth; ow++) {
+                MlasNchwcConvKernel<1>(WorkBlock, Input, Filter, Bias, Output + ow * MLAS_NCHWC_BLOCK_SIZE, oh, ow);
+            }
+        }
+
+        //
+        // Apply the activation to the output row. The bias has already been
+        // added by the kernel.
+        //
+
+        const size_t RowSize = OutputWidth * MLAS_NCHWC_BLOCK_SIZE;
+
+        MlasActivation(WorkBlock->Activation, Output, nullptr, 1, Output, RowSize, RowSize);
+    }
+}
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the two dimensional convolution operation using
+    the NCHWc format.
+
+    The convolution is depthwise if each group has a single input channel and
+    a single output channel; the filter is then in the OIHWBo format. Otherwise
+    the number of input channels and output channels of each group must be a
+    multiple of the block size and the filter is in the OIHWBiBo format.
+
+Arguments:
+
+    InputShape - Supplies the shape of the input tensor, where the channel
+        count is a multiple of the block size.
+
+    KernelShape - Supplies the shape of the kernel transform.
+
+    DilationShape - Supplies the shape of the dilation.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor, where the channel
+        count is a multiple of the block size.
+
+    GroupCount - Supplies the number of channel groups.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the reordered filter tensor.
+
+    Bias - Supplies the optional bias vector, padded to the output channel
+        count.
+
+    Output - Supplies the output tensor.
+
+    Activation - Supplies the parameters for the activation to apply to the
+        convolution output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_NCHWC_CONV_WORK_BLOCK WorkBlock;
+
+    //
+    // Capture the convolution parameters to the work block.
+    //
+
+    WorkBlock.BatchCount = size_t(InputShape[0]);
+    WorkBlock.GroupCount = GroupCount;
+    WorkBlock.InputChannels = size_t(InputShape[1]) / GroupCount;
+    WorkBlock.OutputChannels = size_t(OutputShape[1]) / GroupCount;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+        WorkBlock.KernelShape[dim] = size_t(KernelShape[dim]);
+        WorkBlock.DilationShape[dim] = size_t(DilationShape[dim]);
+        WorkBlock.Padding[dim] = size_t(Padding[dim]);
+        WorkBlock.Padding[dim + 2] = size_t(Padding[dim + 2]);
+        WorkBlock.StrideShape[dim] = size_t(StrideShape[dim]);
+    }
+
+    WorkBlock.InputSize = WorkBlock.InputShape[0] * WorkBlock.InputShape[1];
+    WorkBlock.OutputSize = WorkBlock.OutputShape[0] * WorkBlock.OutputShape[1];
+    WorkBlock.Depthwise = (WorkBlock.InputChannels == 1 && WorkBlock.OutputChannels == 1);
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.Output = Output;
+    WorkBlock.Activation = Activation;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // convolution operation.
+    //
+
+    const size_t TotalOutputChannels = size_t(OutputShape[1]);
+    const size_t TotalRows = WorkBlock.BatchCount * (TotalOutputChannels / MLAS_NCHWC_BLOCK_SIZE) *
+        WorkBlock.OutputShape[0];
+
+    if (TotalRows == 0) {
+        return;
+    }
+
+    const double Complexity = double(WorkBlock.BatchCount) * double(TotalOutputChannels) *
+        double(WorkBlock.OutputSize) * double(WorkBlock.InputChannels) *
+        double(WorkBlock.KernelShape[0] * WorkBlock.KernelShape[1]);
+
+    WorkBlock.ThreadCount = MlasNchwcGetThreadCount(Complexity, TotalRows);
+
+    MlasExecuteThreaded(MlasNchwcConvThreaded, &WorkBlock, WorkBlock.ThreadCount);
+}
+
+void
+MlasNchwcPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc pooling operation. The operation is partitioned by output rows of
+    the channel blocks.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_NCHWC_POOL_WORK_BLOCK*)Context;
+
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const int64_t PaddingTop = int64_t(WorkBlock->Padding[0]);
+    const int64_t PaddingLeft = int64_t(WorkBlock->Padding[1]);
+    const int64_t PaddedHeight = int64_t(InputHeight + WorkBlock->Padding[2]);
+    const int64_t PaddedWidth = int64_t(InputWidth + WorkBlock->Padding[3]);
+
+    const MLAS_POOLING_KIND PoolingKind = WorkBlock->PoolingKind;
+
+    const size_t TotalRows = (WorkBlock->TotalChannelCount / MLAS_NCHWC_BLOCK_SIZE) * OutputHeight;
+
+    size_t RowStart;
+    size_t RowCount;
+
+    MlasPartitionRows(Index, WorkBlock->ThreadCount, TotalRows, &RowStart, &RowCount);
+
+    for (size_t row = RowStart; row < RowStart + RowCount; row++) {
+
+        const size_t oh = row % OutputHeight;
+        const size_t cb = row / OutputHeight;
+
+        const float* Input = WorkBlock->Input + cb * WorkBlock->InputSize * MLAS_NCHWC_BLOCK_SIZE;
+        float* Output = WorkBlock->Output + (cb * WorkBlock->OutputSize + oh * OutputWidth) * MLAS_NCHWC_BLOCK_SIZE;
+
+        const int64_t ihStart = int64_t(oh * StrideHeight) - PaddingTop;
+        const int64_t ihEnd = (std::min)(ihStart + int64_t(KernelHeight), PaddedHeight);
+        const size_t ihStartClamped = size_t((std::max)(ihStart, int64_t(0)));
+        const size_t ihEndClamped = size_t((std::min)(ihEnd, int64_t(InputHeight)));
+
+        for (size_t ow = 0; ow < OutputWidth; ow++) {
+
+            const int64_t iwStart = int64_t(ow * StrideWidth) - PaddingLeft;
+            const int64_t iwEnd = (std::min)(iwStart + int64_t(KernelWidth), PaddedWidth);
+            const size_t iwStartClamped = size_t((std::max)(iwStart, int64_t(0)));
+            const size_t iwEndClamped = size_t((std::min)(iwEnd, int64_t(InputWidth)));
+
+            MLAS_FLOAT32X4 Reduction0;
+            MLAS_FLOAT32X4 Reduction1;
+
+            if (PoolingKind == MlasMaximumPooling) {
+                Reduction0 = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+            } else {
+                Reduction0 = MlasZeroFloat32x4();
+            }
+
+            Reduction1 = Reduction0;
+
+            for (size_t ih = ihStartClamped; ih < ihEndClamped; ih++) {
+
+                const float* i = Input + (ih * InputWidth + iwStartClamped) * MLAS_NCHWC_BLOCK_SIZE;
+
+                for (size_t iw = iwStartClamped; iw < iwEndClamped; iw++) {
+
+                    MLAS_FLOAT32X4 InputVector0 = MlasLoadFloat32x4(i);
+                    MLAS_FLOAT32X4 InputVector1 = MlasLoadFloat32x4(i + 4);
+
+                    if (PoolingKind == MlasMaximumPooling) {
+                        Reduction0 = MlasMaximumFloat32x4(Reduction0, InputVector0);
+                        Reduction1 = MlasMaximumFloat32x4(Reduction1, InputVector1);
+                    } else {
+                        Reduction0 = MlasAddFloat32x4(Reduction0, InputVector0);
+                        Reduction1 = MlasAddFloat32x4(Reduction1, InputVector1);
+                    }
+
+                    i += MLAS_NCHWC_BLOCK_SIZE;
+                }
+            }
+
+            if (PoolingKind != MlasMaximumPooling) {
+
+                size_t PoolSize;
+
+                if (PoolingKind == MlasAveragePoolingIncludePad) {
+                    PoolSize = size_t(ihEnd - ihStart) * size_t(iwEnd - iwStart);
+                } else {
+                    PoolSize = (ihEndClamped - ihStartClamped) * (iwEndClamped - iwStartClamped);
+                }
+
+                MLAS_FLOAT32X4 Divisor = MlasBroadcastFloat32x4(float(PoolSize));
+
+                Reduction0 = MlasDivideFloat32x4(Reduction0, Divisor);
+                Reduction1 = MlasDivideFloat32x4(Reduction1, Divisor);
+            }
+
+            MlasStoreFloat32x4(Output, Reduction0);
+            MlasStoreFloat32x4(Output + 4, Reduction1);
+
+            Output += MLAS_NCHWC_BLOCK_SIZE;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the two dimensional pooling operation using the
+    NCHWc format.
+
+Arguments:
+
+    PoolingKind - Supplies the kind of pooling operation to perform.
+
+    InputShape - Supplies the shape of the input tensor, where the channel
+        count is a multiple of the block size.
+
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, the
+        kernel covers the input tensor (global pooling).
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. If nullptr, no padding is applied.
+
+    StrideShape - Supplies the shape of the stride. If nullptr, the stride is
+        one.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_NCHWC_POOL_WORK_BLOCK WorkBlock;
+
+    //
+    // Capture the pooling parameters to the work block.
+    //
+
+    WorkBlock.PoolingKind = PoolingKind;
+    WorkBlock.TotalChannelCount = size_t(InputShape[0]) * size_t(InputShape[1]);
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+        WorkBlock.KernelShape[dim] = (KernelShape != nullptr) ? size_t(KernelShape[dim]) : WorkBlock.InputShape[dim];
+        WorkBlock.Padding[dim] = (Padding != nullptr) ? size_t(Padding[dim]) : 0;
+        WorkBlock.Padding[dim + 2] = (Padding != nullptr) ? size_t(Padding[dim + 2]) : 0;
+        WorkBlock.StrideShape[dim] = (StrideShape != nullptr) ? size_t(StrideShape[dim]) : 1;
+    }
+
+    WorkBlock.InputSize = WorkBlock.InputShape[0] * WorkBlock.InputShape[1];
+    WorkBlock.OutputSize = WorkBlock.OutputShape[0] * WorkBlock.OutputShape[1];
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // pooling operation.
+    //
+
+    const size_t TotalRows = (WorkBlock.TotalChannelCount / MLAS_NCHWC_BLOCK_SIZE) * WorkBlock.OutputShape[0];
+
+    if (TotalRows == 0) {
+        return;
+    }
+
+    const double Complexity = double(WorkBlock.TotalChannelCount) * double(WorkBlock.OutputSize) *
+        double(WorkBlock.KernelShape[0] * WorkBlock.KernelShape[1]);
+
+    WorkBlock.ThreadCount = MlasNchwcGetThreadCount(Complexity, TotalRows);
+
+    MlasExecuteThreaded(MlasNchwcPoolThreaded, &WorkBlock, WorkBlock.ThreadCount);
+}
@@ -0,0 +1,623 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    winograd.cpp
+
+Abstract:
+
+    This module implements the Winograd F(2x2, 3x3) convolution operation.
+
+    The output is computed in tiles of 2x2 elements from overlapping 4x4 input
+    tiles. Each 4x4 input tile and each 3x3 filter is transformed to a 4x4
+    matrix, after which the convolution reduces to 16 independent matrix
+    multiplications (one per element of the transformed tiles) that sum over
+    the input channels. The 16 multiplications replace the 36 multiplications
+    of the direct or im2col algorithm for each output tile.
+
+    The filter transform only depends on the filter tensor, so it can be
+    computed once for a constant filter with MlasConvTransformFilter.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of elements of a transformed tile.
+//
+
+#define MLAS_WINOGRAD_TILE_ELEMENTS                 16
+
+//
+// Define the number of working buffer elements targeted per thread for the
+// transformed input and the products of a block of tiles.
+//
+
+#define MLAS_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD    (256 * 1024)
+
+//
+// Define the minimum number of input channels and filters for which the
+// Winograd algorithm is selected. Smaller convolutions are dominated by the
+// cost of the transforms.
+//
+
+#define MLAS_WINOGRAD_MINIMUM_CHANNELS              16
+
+//
+// Define the parameters to execute blocks of tiles on worker threads.
+//
+
+struct MLAS_WINOGRAD_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* Filter;
+    float* WorkingBuffer;
+    float* Output;
+    int32_t TargetThreadCount;
+};
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether a convolution can be computed with the
+    Winograd algorithm and, if so, computes the parameters of the operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the convolution operation.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+Return Value:
+
+    Returns true if the Winograd algorithm was selected, else false.
+
+--*/
+{
+    if (Parameters->Dimensions != 2 ||
+        Parameters->KernelShape[0] != 3 || Parameters->KernelShape[1] != 3 ||
+        Parameters->StrideShape[0] != 1 || Parameters->StrideShape[1] != 1 ||
+        Parameters->DilationShape[0] != 1 || Parameters->DilationShape[1] != 1) {
+        return false;
+    }
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+
+    if (InputChannels < MLAS_WINOGRAD_MINIMUM_CHANNELS ||
+        FilterCount < MLAS_WINOGRAD_MINIMUM_CHANNELS ||
+        Parameters->OutputShape[0] < 2 || Parameters->OutputShape[1] < 2) {
+        return false;
+    }
+
+    const size_t TileCount = ((Parameters->OutputShape[0] + 1) / 2) *
+        ((Parameters->OutputShape[1] + 1) / 2);
+
+    //
+    // Compute the number of tiles to process per block so that the
+    // transformed input and the products of the block fit the per thread
+    // working buffer.
+    //
+
+    size_t TileBlockCount = MLAS_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD /
+        (MLAS_WINOGRAD_TILE_ELEMENTS * (InputChannels + FilterCount));
+
+    if (TileBlockCount < 8) {
+        TileBlockCount = 8;
+    }
+
+    if (TileBlockCount > TileCount) {
+        TileBlockCount = TileCount;
+    }
+
+    const size_t TileBlocks = (TileCount + TileBlockCount - 1) / TileBlockCount;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // convolution operation.
+    //
+
+    int32_t TargetThreadCount;
+    double Complexity = double(MLAS_WINOGRAD_TILE_ELEMENTS) * double(FilterCount) *
+        double(InputChannels) * double(TileCount);
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TileBlocks) {
+        TargetThreadCount = int32_t(TileBlocks);
+    }
+
+    const size_t FilterSize = Parameters->GroupCount * MLAS_WINOGRAD_TILE_ELEMENTS *
+        FilterCount * InputChannels;
+
+    Parameters->Algorithm = MlasConvAlgorithmWinograd;
+    Parameters->u.Winograd.TargetThreadCount = size_t(TargetThreadCount);
+    Parameters->u.Winograd.TileBlockCount = TileBlockCount;
+    Parameters->u.Winograd.FilterSize = FilterSize;
+    Parameters->u.Winograd.TransformedFilter = nullptr;
+
+    //
+    // The working buffer holds the buffers of each thread followed by the
+    // transformed filter. The caller may omit the trailing FilterSize elements
+    // if it supplies the transformed filter in the parameters.
+    //
+
+    *WorkingBufferSize = size_t(TargetThreadCount) * MLAS_WINOGRAD_TILE_ELEMENTS *
+        (InputChannels + FilterCount) * TileBlockCount + FilterSize;
+
+    return true;
+}
+
+void
+MLASCALL
+MlasConvTransformFilter(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Filter,
+    float* TransformedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the filter of a convolution operation that uses
+    the Winograd algorithm. The transformed filter has the number of elements
+    returned in Parameters->u.Winograd.FilterSize by MlasConvPrepare.
+
+    The transformed filter is stored as 16 matrices of FilterCount rows and
+    InputChannels columns for each group.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Filter - Supplies the filter tensor.
+
+    TransformedFilter - Supplies the buffer to receive the transformed filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t InputChannels = Parameters->InputChannels;
+
+    const size_t MatrixSize = FilterCount * InputChannels;
+
+    for (size_t group = 0; group < GroupCount; group++) {
+
+        for (size_t f = 0; f < FilterCount; f++) {
+
+            for (size_t c = 0; c < InputChannels; c++) {
+
+                //
+                // Compute G * g * G^T for the 3x3 filter g.
+                //
+
+                const float* g = Filter + (f * InputChannels + c) * 9;
+                float Gg[4][3];
+
+                for (size_t kw = 0; kw < 3; kw++) {
+                    Gg[0][kw] = g[kw];
+                    Gg[1][kw] = 0.5f * (g[kw] + g[3 + kw] + g[6 + kw]);
+                    Gg[2][kw] = 0.5f * (g[kw] - g[3 + kw] + g[6 + kw]);
+                    Gg[3][kw] = g[6 + kw];
+                }
+
+                float* u = TransformedFilter + f * InputChannels + c;
+
+                for (size_t i = 0; i < 4; i++) {
+                    u[(i * 4 + 0) * MatrixSize] = Gg[i][0];
+                    u[(i * 4 + 1) * MatrixSize] = 0.5f * (Gg[i][0] + Gg[i][1] + Gg[i][2]);
+                    u[(i * 4 + 2) * MatrixSize] = 0.5f * (Gg[i][0] - Gg[i][1] + Gg[i][2]);
+                    u[(i * 4 + 3) * MatrixSize] = Gg[i][2];
+                }
+            }
+        }
+
+        Filter += FilterCount * InputChannels * 9;
+        TransformedFilter += MLAS_WINOGRAD_TILE_ELEMENTS * MatrixSize;
+    }
+}
+
+void
+MlasConvWinogradTransformInput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    float* TransformedInput,
+    size_t TileStart,
+    size_t TileCount
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the input tiles of a block of output tiles.
+
+    The transformed input is stored as 16 matrices of InputChannels rows and
+    TileBlockCount columns.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor of the group.
+
+    TransformedInput - Supplies the buffer to receive the transformed input.
+
+    TileStart - Supplies the index of the first tile of the block.
+
+    TileCount - Supplies the number of tiles of the block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t PaddingLeftY = Parameters->Padding[0];
+    const size_t PaddingLeftX = Parameters->Padding[1];
+
+    const size_t TilesWidth = (Parameters->OutputShape[1] + 1) / 2;
+    const size_t TileBlockCount = Parameters->u.Winograd.TileBlockCount;
+    const size_t MatrixSize = InputChannels * TileBlockCount;
+
+    for (size_t c = 0; c < InputChannels; c++) {
+
+        const float* input = Input + c * InputSize;
+        float* v = TransformedInput + c * TileBlockCount;
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const size_t tile = TileStart + t;
+            const size_t ihStart = (tile / TilesWidth) * 2 - PaddingLeftY;
+            const size_t iwStart = (tile % TilesWidth) * 2 - PaddingLeftX;
+
+            //
+            // Gather the 4x4 input tile with zero padding at the edges and
+            // compute B^T * d.
+            //
+            // N.B. Elements in the leading padding region wrap around to large
+            // unsigned values.
+            //
+
+            float d[4][4];
+
+            for (size_t i = 0; i < 4; i++) {
+
+                const size_t ih = ihStart + i;
+
+                for (size_t j = 0; j < 4; j++) {
+
+                    const size_t iw = iwStart + j;
+
+                    d[i][j] = (ih < InputHeight && iw < InputWidth) ? input[ih * InputWidth + iw] : 0.0f;
+                }
+            }
+
+            float BTd[4][4];
+
+            for (size_t j = 0; j < 4; j++) {
+                BTd[0][j] = d[0][j] - d[2][j];
+                BTd[1][j] = d[1][j] + d[2][j];
+                BTd[2][j] = d[2][j] - d[1][j];
+                BTd[3][j] = d[1][j] - d[3][j];
+            }
+
+            //
+            // Compute (B^T * d) * B.
+            //
+
+            for (size_t i = 0; i < 4; i++) {
+                v[(i * 4 + 0) * MatrixSize + t] = BTd[i][0] - BTd[i][2];
+                v[(i * 4 + 1) * MatrixSize + t] = BTd[i][1] + BTd[i][2];
+                v[(i * 4 + 2) * MatrixSize + t] = BTd[i][2] - BTd[i][1];
+                v[(i * 4 + 3) * MatrixSize + t] = BTd[i][1] - BTd[i][3];
+            }
+        }
+    }
+}
+
+void
+MlasConvWinogradTransformOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Products,
+    float* Output,
+    size_t TileStart,
+    size_t TileCount
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the products of a block of tiles to the output
+    tiles.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Products - Supplies the 16 product matrices of FilterCount rows and
+        TileBlockCount columns.
+
+    Output - Supplies the output tensor of the group.
+
+    TileStart - Supplies the index of the first tile of the block.
+
+    TileCount - Supplies the number of tiles of the block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+
+    const size_t TilesWidth = (OutputWidth + 1) / 2;
+    const size_t TileBlockCount = Parameters->u.Winograd.TileBlockCount;
+    const size_t MatrixSize = FilterCount * TileBlockCount;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        const float* m = Products + f * TileBlockCount;
+        float* output = Output + f * OutputSize;
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const size_t tile = TileStart + t;
+            const size_t oh = (tile / TilesWidth) * 2;
+            const size_t ow = (tile % TilesWidth) * 2;
+
+            //
+            // Compute A^T * m * A for the 4x4 product tile m.
+            //
+
+            float mA[4][2];
+
+            for (size_t i = 0; i < 4; i++) {
+
+                const float m0 = m[(i * 4 + 0) * MatrixSize + t];
+                const float m1 = m[(i * 4 + 1) * MatrixSize + t];
+                const float m2 = m[(i * 4 + 2) * MatrixSize + t];
+                const float m3 = m[(i * 4 + 3) * MatrixSize + t];
+
+                mA[i][0] = m0 + m1 + m2;
+                mA[i][1] = m1 - m2 - m3;
+            }
+
+            float y[2][2];
+
+            for (size_t j = 0; j < 2; j++) {
+                y[0][j] = mA[0][j] + mA[1][j] + mA[2][j];
+                y[1][j] = mA[1][j] - mA[2][j] - mA[3][j];
+            }
+
+            //
+            // Store the output tile, which may be clipped at the bottom and
+            // right edges of the output.
+            //
+
+            output[oh * OutputWidth + ow] = y[0][0];
+
+            if (ow + 1 < OutputWidth) {
+                output[oh * OutputWidth + ow + 1] = y[0][1];
+            }
+
+            if (oh + 1 < OutputHeight) {
+
+                output[(oh + 1) * OutputWidth + ow] = y[1][0];
+
+                if (ow + 1 < OutputWidth) {
+                    output[(oh + 1) * OutputWidth + ow + 1] = y[1][1];
+                }
+            }
+        }
+    }
+}
+
+void
+MlasConvWinogradThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute the blocks of
+    tiles assigned to the thread for one batch and group.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_WINOGRAD_WORK_BLOCK* WorkBlock = (MLAS_WINOGRAD_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t TileBlockCount = Parameters->u.Winograd.TileBlockCount;
+
+    const size_t TileCount = ((Parameters->OutputShape[0] + 1) / 2) *
+        ((Parameters->OutputShape[1] + 1) / 2);
+
+    float* TransformedInput = WorkBlock->WorkingBuffer + size_t(Index) *
+        MLAS_WINOGRAD_TILE_ELEMENTS * (InputChannels + FilterCount) * TileBlockCount;
+    float* Products = TransformedInput + MLAS_WINOGRAD_TILE_ELEMENTS * InputChannels * TileBlockCount;
+
+    const size_t TileStride = size_t(WorkBlock->TargetThreadCount) * TileBlockCount;
+
+    for (size_t TileStart = size_t(Index) * TileBlockCount; TileStart < TileCount; TileStart += TileStride) {
+
+        size_t TileCountThisBlock = TileCount - TileStart;
+
+        if (TileCountThisBlock > TileBlockCount) {
+            TileCountThisBlock = TileBlockCount;
+        }
+
+        MlasConvWinogradTransformInput(Parameters, WorkBlock->Input, TransformedInput,
+            TileStart, TileCountThisBlock);
+
+        //
+        // Multiply each of the 16 transformed filter matrices by the matching
+        // transformed input matrix.
+        //
+
+        for (size_t xi = 0; xi < MLAS_WINOGRAD_TILE_ELEMENTS; xi++) {
+
+            MlasSgemmOperation(CblasNoTrans, CblasNoTrans, FilterCount, TileCountThisBlock,
+                InputChannels, 1.0f, WorkBlock->Filter + xi * FilterCount * InputChannels,
+                InputChannels, TransformedInput + xi * InputChannels * TileBlockCount,
+                TileBlockCount, 0.0f, Products + xi * FilterCount * TileBlockCount,
+                TileBlockCount);
+        }
+
+        MlasConvWinogradTransformOutput(Parameters, Products, WorkBlock->Output,
+            TileStart, TileCountThisBlock);
+    }
+}
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the convolution operation with the Winograd
+    algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor. The filter is ignored if the
+        transformed filter has been supplied in the parameters.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t OutputSize = Parameters->OutputSize;
+
+    const size_t InputGroupSize = InputChannels * Parameters->InputSize;
+    const size_t OutputGroupSize = FilterCount * OutputSize;
+    const size_t FilterGroupSize = MLAS_WINOGRAD_TILE_ELEMENTS * FilterCount * InputChannels;
+
+    //
+    // Transform the filter to the working buffer if the caller has not
+    // supplied the transformed filter.
+    //
+
+    const size_t TargetThreadCount = Parameters->u.Winograd.TargetThreadCount;
+    const float* TransformedFilter = Parameters->u.Winograd.TransformedFilter;
+
+    if (TransformedFilter == nullptr) {
+
+        float* FilterBuffer = WorkingBuffer + TargetThreadCount * MLAS_WINOGRAD_TILE_ELEMENTS *
+            (InputChannels + FilterCount) * Parameters->u.Winograd.TileBlockCount;
+
+        MlasConvTransformFilter(Parameters, Filter, FilterBuffer);
+        TransformedFilter = FilterBuffer;
+    }
+
+    MLAS_WINOGRAD_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.TargetThreadCount = int32_t(TargetThreadCount);
+
+    for (size_t batch = 0; batch < Parameters->BatchCount; batch++) {
+
+        const float* filter = TransformedFilter;
+        const float* bias = Bias;
+
+        for (size_t group = 0; group < Parameters->GroupCount; group++) {
+
+            WorkBlock.Input = Input;
+            WorkBlock.Filter = filter;
+            WorkBlock.Output = Output;
+
+            MlasExecuteThreaded(MlasConvWinogradThreaded, &WorkBlock, WorkBlock.TargetThreadCount);
+
+            //
+            // Apply the activation with optional bias.
+            //
+
+            MlasActivation(Parameters->Activation, Output, bias, FilterCount, Output,
+                OutputSize, OutputSize);
+
+            if (bias != nullptr) {
+                bias += FilterCount;
+            }
+
+            filter += FilterGroupSize;
+            Input += InputGroupSize;
+            Output += OutputGroupSize;
+        }
+    }
+}
@@ -3,65 +3,168 @@
 
 #include "core/optimizer/constant_folding.h"
 #include "core/graph/graph_utils.h"
+#include "core/graph/graph_viewer.h"
 #include "core/optimizer/optimizer_execution_frame.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/ml_value.h"
 
 namespace onnxruntime {
 
-Status ConstantFolding::Apply(Graph& graph, Node& node, bool& modified, bool& deleted) {
-  // TODO Check if we need default transformers any more. I dont think we do...
-
-  // Create execution frame for executing constant nodes.
-  OptimizerExecutionFrame::Info info({&node}, graph.GetAllInitializedTensors());
+static bool IsInitializer(const Graph& graph, const std::string& name) {
+  const ONNX_NAMESPACE::TensorProto* initializer = nullptr;
+  return graph.GetInitializedTensor(name, initializer);
+}
 
-  std::vector<int> fetch_mlvalue_idxs;
-  for (const auto* node_out : node.OutputDefs()) {
-    fetch_mlvalue_idxs.push_back(info.GetMLValueIndex(node_out->Name()));
+Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  // Find the constant nodes. As the nodes are visited in topological order, the outputs of a constant node
+  // are known to be constant before any of their consumers is visited.
+  std::unordered_set<std::string> constant_values;
+  std::vector<const Node*> constant_nodes;
+
+  for (auto index : order) {
+    auto* node = graph.GetNode(index);
+    if (!node) {
+      continue;
+    }
+
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+
+    if (!CanFold(graph, *node, constant_values)) {
+      continue;
+    }
+
+    constant_nodes.push_back(node);
+    for (const auto* output_def : node->OutputDefs()) {
+      if (output_def->Exists()) {
+        constant_values.insert(output_def->Name());
+      }
+    }
   }
 
-  OptimizerExecutionFrame frame(info, fetch_mlvalue_idxs);
+  if (constant_nodes.empty()) {
+    return Status::OK();
+  }
 
-  auto* kernel = info.GetKernel(node.Index());
-  OpKernelContext op_kernel_context(&frame, kernel, ::onnxruntime::logging::LoggingManager::DefaultLogger());
+  // Create a single execution frame for all the constant nodes. Each initializer they use is converted to an
+  // MLValue once, and the outputs of a node stay in the frame to be used as inputs by the nodes that follow it.
+  OptimizerExecutionFrame::Info info(constant_nodes, graph.GetAllInitializedTensors());
+  OptimizerExecutionFrame frame(info, std::vector<int>());
+  const auto& logger = ::onnxruntime::logging::LoggingManager::DefaultLogger();
+
+  // A node may still not be computable, e.g. if the CPU execution provider has no kernel for it.
+  // Its outputs are then not constant, and neither are the outputs of the nodes consuming them.
+  std::unordered_set<std::string> computed_values;
+  std::unordered_set<NodeIndex> computed_nodes;
+  std::vector<const Node*> nodes_to_remove;
+
+  for (const auto* node : constant_nodes) {
+    bool inputs_available = true;
+    for (const auto* input_def : node->InputDefs()) {
+      if (input_def->Exists() && !IsInitializer(graph, input_def->Name()) &&
+          computed_values.find(input_def->Name()) == computed_values.cend()) {
+        inputs_available = false;
+        break;
+      }
+    }
+
+    const auto* kernel = info.GetKernel(node->Index());
+    if (!inputs_available || kernel == nullptr) {
+      continue;
+    }
+
+    OpKernelContext op_kernel_context(&frame, kernel, logger);
+    if (!kernel->Compute(&op_kernel_context).IsOK()) {
+      continue;
+    }
+
+    for (const auto* output_def : node->OutputDefs()) {
+      if (output_def->Exists()) {
+        computed_values.insert(output_def->Name());
+      }
+    }
+
+    computed_nodes.insert(node->Index());
+    nodes_to_remove.push_back(node);
+  }
 
-  kernel->Compute(&op_kernel_context);
+  // Add an initializer for each computed value that is used by a node that remains in the graph.
+  // Values that are only used inside the folded subgraph are dropped.
+  for (const auto* node : nodes_to_remove) {
+    std::unordered_set<int> used_outputs;
+    for (auto it = node->OutputEdgesBegin(), end = node->OutputEdgesEnd(); it != end; ++it) {
+      if (computed_nodes.find(it->GetNode().Index()) == computed_nodes.cend()) {
+        used_outputs.insert(it->GetSrcArgIndex());
+      }
+    }
+
+    const int output_offset = frame.GetNodeOffset(node->Index()) +
+                              static_cast<int>(node->InputDefs().size() + node->ImplicitInputDefs().size());
+
+    for (int output_idx : used_outputs) {
+      const MLValue* mlvalue = frame.GetNodeInputOrOutputMLValue(output_offset + output_idx);
+      ORT_ENFORCE(mlvalue != nullptr && mlvalue->IsAllocated());
+
+      // Build the TensorProto that corresponds to the computed MLValue and add it as initializer to the graph.
+      ONNX_NAMESPACE::TensorProto out_tensorproto;
+      BuildTensorProtoForInitializer(*mlvalue, *node->OutputDefs()[output_idx], out_tensorproto);
+
+      graph.AddInitializedTensor(out_tensorproto);
+    }
+  }
 
-  std::vector<MLValue> fetches;
-  frame.GetOutputs(fetches);
+  // Remove the folded nodes. Removing them in topological order means the input edges of each node
+  // were already removed along with the output edges of its producers.
+  for (const auto* node : nodes_to_remove) {
+    auto node_index = node->Index();
+    graph_utils::RemoveNodeOutputEdges(graph, *graph.GetNode(node_index));
+    graph.RemoveNode(node_index);
+  }
 
-  // Go over all output node args and substitute them with the newly computed tensors, which will be
-  // added to the graph as initializers.
-  ORT_ENFORCE(fetches.size() == node.OutputDefs().size());
-  for (int fetch_idx = 0; fetch_idx < fetches.size(); ++fetch_idx) {
-    MLValue& mlvalue = fetches[fetch_idx];
+  // The consumers already have the right input arg, since we used the same name in the initializer.
+  // We could remove unused graph initializers here, but Graph::Resolve() will take care of it.
+  if (!nodes_to_remove.empty()) {
+    modified = true;
+  }
 
-    // Build the TensorProto that corresponds to the computed MLValue and add it as initializer to the graph.
-    ONNX_NAMESPACE::TensorProto out_tensorproto;
-    const auto* constant_arg_out = node.OutputDefs()[fetch_idx];
-    BuildTensorProtoForInitializer(mlvalue, *constant_arg_out, out_tensorproto);
+  return Status::OK();
+}
 
-    graph.AddInitializedTensor(out_tensorproto);
+bool ConstantFolding::CanFold(Graph& graph, Node& node, const std::unordered_set<std::string>& constant_values) const {
+  if (excluded_op_types_.find(node.OpType()) != excluded_op_types_.end()) {
+    return false;
   }
 
-  // Remove the output edges of the constant node and then remove the node itself.
-  graph_utils::RemoveNodeOutputEdges(graph, node);
-  graph.RemoveNode(node.Index());
-
-  // The output nodes already have the right input arg, since we used the same name in the initializer.
-  // We could remove unused graph initializers here, but Graph::Resolve() will take care of it.
+  // control flow nodes read values from the outer scope, which the optimizer execution frame does not provide,
+  // and a graph output has to stay the output of a node.
+  if (!node.GetAttributeNameToMutableSubgraphMap().empty() || !node.ImplicitInputDefs().empty() ||
+      graph.IsNodeOutputsInGraphOutputs(node)) {
+    return false;
+  }
 
-  modified = deleted = true;
+  for (const auto* input_def : node.InputDefs()) {
+    if (!input_def->Exists() || constant_values.find(input_def->Name()) != constant_values.cend()) {
+      continue;
+    }
 
-  return Status::OK();
-}  // namespace onnxruntime
+    // Important note: when an initializer appears in the graph's input, this input will not be considered constant,
+    // because it can be overriden by the user at runtime.
+    if (!IsInitializer(graph, input_def->Name()) || graph_utils::HasGraphInput(graph, input_def)) {
+      return false;
+    }
+  }
 
-bool ConstantFolding::SatisfyCondition(const Graph& graph, const Node& node) {
-  return OpTypeCondition(node) && graph_utils::IsConstantInputsNode(graph, node);
-}
+  // only tensors can be stored as initializers
+  for (const auto* output_def : node.OutputDefs()) {
+    if (output_def->Exists() &&
+        (output_def->TypeAsProto() == nullptr || !output_def->TypeAsProto()->has_tensor_type())) {
+      return false;
+    }
+  }
 
-bool ConstantFolding::OpTypeCondition(const Node& node) {
-  return excluded_op_types_.find(node.OpType()) == excluded_op_types_.end();
+  return true;
 }
 
 void ConstantFolding::BuildTensorProtoForInitializer(const MLValue& mlvalue,
@@ -80,6 +183,16 @@ void ConstantFolding::BuildTensorProtoForInitializer(const MLValue& mlvalue,
 
   tensorproto.set_data_type(tensorproto_type);
   auto tensor_shape_size = out_tensor.Shape().Size();
+
+  // strings can't be stored as raw data
+  if (out_tensor.DataType() == DataTypeImpl::GetType<std::string>()) {
+    const auto* strings = out_tensor.Data<std::string>();
+    for (int64_t i = 0; i < tensor_shape_size; ++i) {
+      tensorproto.add_string_data(strings[i]);
+    }
+    return;
+  }
+
   auto data_size = out_tensor.DataType()->Size() * tensor_shape_size;
   tensorproto.set_raw_data(out_tensor.DataRaw(out_tensor.DataType()), data_size);
 }
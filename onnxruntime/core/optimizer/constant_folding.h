@@ -3,7 +3,9 @@
 
 #pragma once
 
-#include "core/optimizer/rewrite_rule.h"
+#include <unordered_set>
+
+#include "core/optimizer/graph_transformer.h"
 #include "core/framework/ml_value.h"
 
 namespace onnxruntime {
@@ -11,13 +13,15 @@ namespace onnxruntime {
 /**
 @class ConstantFolding
 
-Rewrite rule that performs constant folding to the graph.
-The rule gets applied to nodes that have only initializers as inputs. It statically computes these 
-nodes and replaces their output with an initializer that corresponds to the result of the computation.
+Transformer that performs constant folding to the graph.
+A node is constant if all its inputs are initializers or outputs of other constant nodes, so whole constant
+subgraphs are folded. The constant nodes are computed in topological order in a single execution frame that
+is shared by all of them, and the outputs that are still consumed by the rest of the graph are replaced with
+initializers holding the result of the computation.
 */
-class ConstantFolding : public RewriteRule {
+class ConstantFolding : public GraphTransformer {
  public:
-  ConstantFolding() noexcept : RewriteRule("ConstantFolding", "Constant folding") {}
+  ConstantFolding() noexcept : GraphTransformer("ConstantFolding", "Constant folding") {}
 
  private:
   /** Constant folding will not be applied to nodes whose op_type is included in this set.
@@ -25,17 +29,16 @@ class ConstantFolding : public RewriteRule {
   const std::unordered_set<std::string> excluded_op_types_ =
       {"RandomUniform", "RandomNormal", "RandomUniformLike", "RandomNormalLike", "Multinomial"};
 
-  bool SatisfyCondition(const Graph& graph, const Node& node) override;
-
-  bool OpTypeCondition(const Node& node) override;
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level) const override;
 
-  Status Apply(Graph& graph, Node& node, bool& modified, bool& deleted) override;
+  /** Returns true if the node can be folded given the names of the values that are known to be constant. */
+  bool CanFold(Graph& graph, Node& node, const std::unordered_set<std::string>& constant_values) const;
 
-  /** Create a TensorProto that has the same value as the given MLValue 
+  /** Create a TensorProto that has the same value as the given MLValue
   and the same type and dimensions as the given NodeArg. */
-  void BuildTensorProtoForInitializer(const MLValue& mlvalue,
-                                      const NodeArg& constant_node_arg,
-                                      ONNX_NAMESPACE::TensorProto& tensorproto);
+  static void BuildTensorProtoForInitializer(const MLValue& mlvalue,
+                                             const NodeArg& constant_node_arg,
+                                             ONNX_NAMESPACE::TensorProto& tensorproto);
 };
 
 }  // namespace onnxruntime
@@ -0,0 +1,321 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include "core/graph/graph_utils.h"
+#include "core/graph/graph_viewer.h"
+#include "core/optimizer/element_wise_fusion.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Upper bound on the number of operators fused into one node, which bounds the scratch space of the kernel.
+constexpr size_t kMaxChainLength = 32;
+
+struct FusableOperator {
+  const char* op_type;
+  ONNX_NAMESPACE::OperatorSetVersion version;
+  bool binary;
+};
+
+const FusableOperator* GetFusableOperator(const Node& node) {
+  static const FusableOperator operators[] = {
+      {"Add", 7, true},
+      {"Sub", 7, true},
+      {"Mul", 7, true},
+      {"Div", 7, true},
+      {"Pow", 7, true},
+      {"Max", 8, true},
+      {"Min", 8, true},
+      {"PRelu", 7, true},
+      {"PRelu", 9, true},
+      {"Neg", 6, false},
+      {"Abs", 6, false},
+      {"Reciprocal", 6, false},
+      {"Floor", 6, false},
+      {"Ceil", 6, false},
+      {"Sqrt", 6, false},
+      {"Exp", 6, false},
+      {"Log", 6, false},
+      {"Erf", 9, false},
+      {"Relu", 6, false},
+      {"LeakyRelu", 6, false},
+      {"Sigmoid", 6, false},
+      {"Tanh", 6, false},
+      {"Elu", 6, false},
+      {"Selu", 6, false},
+      {"HardSigmoid", 6, false},
+      {"Softsign", 1, false},
+      {"Softplus", 1, false},
+  };
+
+  for (const auto& op : operators) {
+    if (graph_utils::IsSupportedOptypeVersionAndDomain(node, op.op_type, op.version)) {
+      // Max and Min are variadic, only their two input form maps to a binary step.
+      if (node.InputDefs().size() != (op.binary ? 2u : 1u) || node.OutputDefs().size() != 1) {
+        return nullptr;
+      }
+      return &op;
+    }
+  }
+  return nullptr;
+}
+
+bool IsSupportedExecutionProvider(const Node& node) {
+  return node.GetExecutionProviderType().empty() || node.GetExecutionProviderType() == kCpuExecutionProvider;
+}
+
+bool IsFusable(const Node& node) {
+  if (GetFusableOperator(node) == nullptr || !IsSupportedExecutionProvider(node)) {
+    return false;
+  }
+  const NodeArg& output = *node.OutputDefs()[0];
+  const auto* type = output.TypeAsProto();
+  return type != nullptr && type->tensor_type().elem_type() == TensorProto_DataType_FLOAT && output.Shape() != nullptr;
+}
+
+// Returns true if both NodeArgs have the same shape, where a symbolic dimension matches the same symbol.
+bool HaveSameShape(const NodeArg& arg1, const NodeArg& arg2) {
+  const auto* shape1 = arg1.Shape();
+  const auto* shape2 = arg2.Shape();
+  if (shape1 == nullptr || shape2 == nullptr || shape1->dim_size() != shape2->dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape1->dim_size(); i++) {
+    const auto& dim1 = shape1->dim(i);
+    const auto& dim2 = shape2->dim(i);
+    if (dim1.has_dim_value() && dim2.has_dim_value()) {
+      if (dim1.dim_value() != dim2.dim_value()) {
+        return false;
+      }
+    } else if (!dim1.has_dim_param() || !dim2.has_dim_param() || dim1.dim_param().empty() ||
+               dim1.dim_param() != dim2.dim_param()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+float GetFloatAttribute(const Node& node, const std::string& name, float default_value) {
+  const auto& attributes = node.GetAttributes();
+  auto it = attributes.find(name);
+  return it != attributes.end() ? it->second.f() : default_value;
+}
+
+class ElementWiseFusionImpl {
+ public:
+  ElementWiseFusionImpl(Graph& graph, const std::vector<NodeIndex>& order) : graph_(graph) {
+    for (size_t i = 0; i < order.size(); i++) {
+      positions_[order[i]] = i;
+    }
+  }
+
+  // Returns the chain of fusable operators that starts at the seed node. The nodes of a chain of more than one
+  // node are not considered again by later chains.
+  std::vector<const Node*> BuildChain(const Node& seed);
+  void FuseChain(const std::vector<const Node*>& chain);
+
+  bool IsChained(const Node& node) const { return chained_nodes_.count(node.Index()) != 0; }
+
+ private:
+  Graph& graph_;
+  // Position of each node in the topological order.
+  std::unordered_map<NodeIndex, size_t> positions_;
+  std::unordered_set<NodeIndex> chained_nodes_;
+};
+
+std::vector<const Node*> ElementWiseFusionImpl::BuildChain(const Node& seed) {
+  const NodeArg& output_arg = *seed.OutputDefs()[0];
+  const size_t seed_position = positions_[seed.Index()];
+
+  std::vector<const Node*> chain{&seed};
+  std::unordered_set<NodeIndex> chain_nodes{seed.Index()};
+
+  // Consumers of the chain, visited in topological order so that the chain itself stays topologically sorted.
+  std::map<size_t, const Node*> candidates;
+  auto add_consumers = [this, &candidates](const Node& node) {
+    for (auto it = node.OutputNodesBegin(); it != node.OutputNodesEnd(); ++it) {
+      candidates.emplace(positions_[it->Index()], &*it);
+    }
+  };
+  add_consumers(seed);
+
+  while (!candidates.empty() && chain.size() < kMaxChainLength) {
+    const Node& candidate = *candidates.begin()->second;
+    candidates.erase(candidates.begin());
+
+    if (chain_nodes.count(candidate.Index()) != 0 || IsChained(candidate) || !IsFusable(candidate) ||
+        candidate.GetExecutionProviderType() != seed.GetExecutionProviderType() ||
+        !HaveSameShape(*candidate.OutputDefs()[0], output_arg)) {
+      continue;
+    }
+
+    // The inputs of the candidate that are not computed by the chain must be produced before the seed, otherwise
+    // they may depend on the chain and fusing would create a cycle.
+    bool preceded_by_seed = false;
+    for (auto it = candidate.InputNodesBegin(); it != candidate.InputNodesEnd(); ++it) {
+      if (chain_nodes.count(it->Index()) == 0 && positions_[it->Index()] > seed_position) {
+        preceded_by_seed = true;
+        break;
+      }
+    }
+    if (preceded_by_seed) {
+      continue;
+    }
+
+    chain.push_back(&candidate);
+    chain_nodes.insert(candidate.Index());
+    add_consumers(candidate);
+  }
+
+  // Only the last node of the chain may be consumed outside of the chain. Keep the longest prefix of the chain
+  // that satisfies this.
+  while (chain.size() > 1) {
+    std::unordered_set<NodeIndex> prefix_nodes;
+    for (const Node* node : chain) {
+      prefix_nodes.insert(node->Index());
+    }
+
+    bool is_closed = true;
+    for (size_t i = 0; is_closed && i + 1 < chain.size(); i++) {
+      const Node& node = *chain[i];
+      if (graph_.IsNodeOutputsInGraphOutputs(node)) {
+        is_closed = false;
+        break;
+      }
+      for (auto it = node.OutputNodesBegin(); it != node.OutputNodesEnd(); ++it) {
+        if (prefix_nodes.count(it->Index()) == 0) {
+          is_closed = false;
+          break;
+        }
+      }
+    }
+    if (is_closed) {
+      break;
+    }
+    chain.pop_back();
+  }
+
+  if (chain.size() > 1) {
+    for (const Node* node : chain) {
+      chained_nodes_.insert(node->Index());
+    }
+  }
+
+  return chain;
+}
+
+void ElementWiseFusionImpl::FuseChain(const std::vector<const Node*>& chain) {
+  // The inputs of the fused node are the values consumed by the chain that it does not compute itself.
+  std::unordered_map<const NodeArg*, size_t> results;
+  for (size_t i = 0; i < chain.size(); i++) {
+    results[chain[i]->OutputDefs()[0]] = i;
+  }
+  std::vector<NodeArg*> inputs;
+  std::unordered_map<const NodeArg*, int64_t> input_indices;
+  for (const Node* node : chain) {
+    for (NodeArg* input_def : const_cast<Node*>(node)->MutableInputDefs()) {
+      if (results.count(input_def) == 0 && input_indices.count(input_def) == 0) {
+        input_indices[input_def] = static_cast<int64_t>(inputs.size());
+        inputs.push_back(input_def);
+      }
+    }
+  }
+
+  const int64_t input_count = static_cast<int64_t>(inputs.size());
+  std::vector<std::string> ops;
+  std::vector<int64_t> operands;
+  std::vector<float> alphas;
+  std::vector<float> betas;
+  for (const Node* node : chain) {
+    const auto& op_type = node->OpType();
+    ops.push_back(op_type);
+
+    const auto& input_defs = node->InputDefs();
+    for (size_t i = 0; i < 2; i++) {
+      if (i >= input_defs.size()) {
+        operands.push_back(-1);
+        continue;
+      }
+      auto it = results.find(input_defs[i]);
+      operands.push_back(it != results.end() ? input_count + static_cast<int64_t>(it->second)
+                                             : input_indices[input_defs[i]]);
+    }
+
+    float alpha = 0.0f;
+    float beta = 0.0f;
+    if (op_type == "LeakyRelu") {
+      alpha = GetFloatAttribute(*node, "alpha", 0.01f);
+    } else if (op_type == "Elu") {
+      alpha = GetFloatAttribute(*node, "alpha", 1.0f);
+    } else if (op_type == "Selu") {
+      alpha = GetFloatAttribute(*node, "alpha", 1.67326319217681884765625f);
+      beta = GetFloatAttribute(*node, "gamma", 1.05070102214813232421875f);
+    } else if (op_type == "HardSigmoid") {
+      alpha = GetFloatAttribute(*node, "alpha", 0.2f);
+      beta = GetFloatAttribute(*node, "beta", 0.5f);
+    }
+    alphas.push_back(alpha);
+    betas.push_back(beta);
+  }
+
+  const Node& last_node = *chain.back();
+  NodeArg* output_def = const_cast<Node&>(last_node).MutableOutputDefs()[0];
+  const std::string name = graph_.GenerateNodeName("FusedElementWise_" + last_node.Name());
+  const std::string provider = last_node.GetExecutionProviderType();
+
+  for (const Node* node : chain) {
+    Node& mutable_node = *graph_.GetNode(node->Index());
+    graph_utils::RemoveNodeOutputEdges(graph_, mutable_node);
+    graph_.RemoveNode(node->Index());
+  }
+
+  Node& fused_node = graph_.AddNode(name, "FusedElementWise", "fused chain of element-wise operators",
+                                    inputs, {output_def}, nullptr, kMSDomain);
+  fused_node.AddAttribute("ops", ops);
+  fused_node.AddAttribute("operands", operands);
+  fused_node.AddAttribute("alphas", alphas);
+  fused_node.AddAttribute("betas", betas);
+  fused_node.SetExecutionProviderType(provider);
+}
+
+}  // namespace
+
+Status ElementWiseFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+  ElementWiseFusionImpl impl(graph, order);
+
+  // All chains are formed before the graph is modified, so that the topological positions remain valid.
+  std::vector<std::vector<const Node*>> chains;
+  for (auto index : order) {
+    auto& node = *graph.GetNode(index);
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level));
+
+    if (impl.IsChained(node) || !IsFusable(node)) {
+      continue;
+    }
+
+    auto chain = impl.BuildChain(node);
+    if (chain.size() > 1) {
+      chains.push_back(std::move(chain));
+    }
+  }
+
+  for (const auto& chain : chains) {
+    impl.FuseChain(chain);
+  }
+
+  if (!chains.empty()) {
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
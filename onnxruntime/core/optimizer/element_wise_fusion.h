@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class ElementWiseFusion
+
+Transformer that fuses chains of float element-wise operators, such as the Sigmoid and Mul of a gated activation
+or the Div, Mul and Add that normalize, scale and shift a tensor, into a single FusedElementWise node. The fused
+kernel evaluates the whole chain one cache sized tile at a time, so the intermediate values are never materialized
+as full size tensors. The inputs of a chain may broadcast, but every operator of the chain must produce the shape
+of the chain output and the intermediate values must only be consumed inside the chain.
+*/
+class ElementWiseFusion : public GraphTransformer {
+ public:
+  ElementWiseFusion() noexcept : GraphTransformer("ElementWiseFusion", "Fuse chains of element-wise operators") {}
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
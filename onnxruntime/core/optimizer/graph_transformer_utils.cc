@@ -6,11 +6,24 @@
 #include "core/optimizer/conv_bn_fusion.h"
 #include "core/optimizer/conv_add_fusion.h"
 #include "core/optimizer/unsqueeze_elimination.h"
+#include "core/optimizer/constant_folding.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/optimizer/element_wise_fusion.h"
 
 namespace onnxruntime {
 
 namespace transformer_utils {
 
+namespace {
+// Transformers that aren't on by default yet, until there are numbers for their cost and benefit on a range of
+// models, are only generated when they are named in transformers_to_enable.
+bool IsOptInTransformerEnabled(const std::string& name, const std::vector<std::string>* transformers_to_enable) {
+  return transformers_to_enable != nullptr &&
+         std::find(transformers_to_enable->begin(), transformers_to_enable->end(), name) !=
+             transformers_to_enable->end();
+}
+}  // namespace
+
 std::vector<std::unique_ptr<RewriteRule>> GenerateRewriteRules(const TransformerLevel& level, 
                                                                const std::vector<std::string>* rules_to_enable) {
   std::vector<std::unique_ptr<RewriteRule>> rules;
@@ -48,12 +61,24 @@ std::vector<TransformerProviderSet> GenerateTransformers(const TransformerLevel&
     case TransformerLevel::Level1: {
       std::vector<std::string> l1_execution_providers = {};
       transformers.emplace_back(std::make_unique<UnsqueezeElimination>(), l1_execution_providers);
+      // opt-in: it evaluates every constant subgraph of the model during Initialize
+      if (IsOptInTransformerEnabled("ConstantFolding", transformers_to_enable)) {
+        transformers.emplace_back(std::make_unique<ConstantFolding>(), l1_execution_providers);
+      }
     } break;
 
     case TransformerLevel::Level2: {
       std::vector<std::string> l2_execution_providers = {onnxruntime::kCpuExecutionProvider};
       transformers.emplace_back(std::make_unique<ConvAddFusion>(), l2_execution_providers);
       transformers.emplace_back(std::make_unique<ConvMulFusion>(), l2_execution_providers);
+      // opt-in: it changes the layout of the convolutions and pooling of the model
+      if (IsOptInTransformerEnabled("NchwcTransformer", transformers_to_enable)) {
+        transformers.emplace_back(std::make_unique<NchwcTransformer>(), l2_execution_providers);
+      }
+      // opt-in: it replaces the element-wise chains of the model with FusedElementWise nodes
+      if (IsOptInTransformerEnabled("ElementWiseFusion", transformers_to_enable)) {
+        transformers.emplace_back(std::make_unique<ElementWiseFusion>(), l2_execution_providers);
+      }
     } break;
 
     default:
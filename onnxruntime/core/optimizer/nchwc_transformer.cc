@@ -0,0 +1,432 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <unordered_map>
+#include <unordered_set>
+#include "core/graph/graph_utils.h"
+#include "core/graph/graph_viewer.h"
+#include "core/optimizer/initializer.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/mlas/inc/mlas.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+bool IsFusableActivation(const Node& node) {
+  return graph_utils::IsSupportedOptypeVersionAndDomain(node, "LeakyRelu", 6) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "Relu", 6) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sigmoid", 6) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "Tanh", 6);
+}
+
+bool IsSupportedPool(const Node& node) {
+  return (graph_utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 1) ||
+          (graph_utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 8) && node.OutputDefs().size() == 1)) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 7) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "GlobalMaxPool", 1) ||
+         graph_utils::IsSupportedOptypeVersionAndDomain(node, "GlobalAveragePool", 1);
+}
+
+bool IsSupportedExecutionProvider(const Node& node) {
+  return node.GetExecutionProviderType().empty() || node.GetExecutionProviderType() == kCpuExecutionProvider;
+}
+
+// Returns true if both NodeArgs have the same fully known shape.
+bool HaveSameKnownShape(const NodeArg& arg1, const NodeArg& arg2) {
+  const auto* shape1 = arg1.Shape();
+  const auto* shape2 = arg2.Shape();
+  if (shape1 == nullptr || shape2 == nullptr || shape1->dim_size() != shape2->dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape1->dim_size(); i++) {
+    const auto& dim1 = shape1->dim(i);
+    const auto& dim2 = shape2->dim(i);
+    if (!dim1.has_dim_value() || !dim2.has_dim_value() || dim1.dim_value() != dim2.dim_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class NchwcTransformerImpl {
+ public:
+  NchwcTransformerImpl(Graph& graph) noexcept
+      : graph_(graph), block_size_(static_cast<int64_t>(MlasNchwcGetBlockSize())) {}
+
+  void Transform(Node& node);
+  void Finalize(bool& modified);
+
+ private:
+  // Describes a NodeArg of the original graph whose value is now produced in the NCHWc layout.
+  struct NchwcArgument {
+    NodeArg* nchwc_arg_;
+    // Number of channels of the original NodeArg, before padding to the block size.
+    int64_t channels_;
+    // NCHWc convolution that produces the value and that can still absorb an activation.
+    Node* fusable_conv_;
+  };
+
+  int64_t RoundUpToBlockSize(int64_t channels) const {
+    return (channels + block_size_ - 1) & ~(block_size_ - 1);
+  }
+
+  NodeArg* CreateNchwcArgument(const NodeArg& original_arg);
+  NodeArg* AddFilterInitializer(const std::string& base_name, const std::vector<int64_t>& dims,
+                                const std::vector<float>& data);
+  NodeArg* GetReorderedInput(NodeArg* input_arg, const std::string& provider);
+  Node& AddNchwcNode(Node& node, const std::string& op_type, const std::string& domain,
+                     const std::vector<NodeArg*>& inputs);
+
+  void TransformConv(Node& node);
+  void TransformPool(Node& node);
+  void TransformActivation(Node& node);
+  void TransformAdd(Node& node);
+
+  Graph& graph_;
+  const int64_t block_size_;
+
+  // Original NodeArgs that are now produced in the NCHWc layout.
+  std::unordered_map<const NodeArg*, NchwcArgument> nchwc_args_;
+
+  // Original NodeArgs that have been reordered to the NCHWc layout by a ReorderInput node.
+  std::unordered_map<const NodeArg*, NodeArg*> reorder_inputs_;
+
+  // Initializers that may no longer be used once the graph has been transformed.
+  std::unordered_set<std::string> replaced_initializers_;
+
+  std::vector<NodeIndex> removed_nodes_;
+};
+
+NodeArg* NchwcTransformerImpl::CreateNchwcArgument(const NodeArg& original_arg) {
+  // The shape of the blocked tensor is left to shape inference as the channel count is padded.
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  return &graph_.GetOrCreateNodeArg(graph_.GenerateNodeArgName(original_arg.Name() + "_nchwc"), &type_proto);
+}
+
+NodeArg* NchwcTransformerImpl::AddFilterInitializer(const std::string& base_name,
+                                                    const std::vector<int64_t>& dims,
+                                                    const std::vector<float>& data) {
+  TensorProto tensor_proto;
+  tensor_proto.set_name(graph_.GenerateNodeArgName(base_name + "_nchwc"));
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    tensor_proto.add_dims(dim);
+  }
+  tensor_proto.set_raw_data(data.data(), data.size() * sizeof(float));
+  graph_.AddInitializedTensor(tensor_proto);
+
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto* shape = type_proto.mutable_tensor_type()->mutable_shape();
+  for (auto dim : dims) {
+    shape->add_dim()->set_dim_value(dim);
+  }
+  return &graph_.GetOrCreateNodeArg(tensor_proto.name(), &type_proto);
+}
+
+NodeArg* NchwcTransformerImpl::GetReorderedInput(NodeArg* input_arg, const std::string& provider) {
+  auto it = reorder_inputs_.find(input_arg);
+  if (it != reorder_inputs_.end()) {
+    return it->second;
+  }
+
+  NodeArg* nchwc_arg = CreateNchwcArgument(*input_arg);
+  Node& reorder_node = graph_.AddNode(graph_.GenerateNodeName("ReorderInput"), "ReorderInput",
+                                      "Reorder " + input_arg->Name() + " to the NCHWc layout",
+                                      std::vector<NodeArg*>{input_arg},
+                                      std::vector<NodeArg*>{nchwc_arg},
+                                      nullptr,
+                                      kMSNchwcDomain);
+  reorder_node.SetExecutionProviderType(provider);
+
+  reorder_inputs_.emplace(input_arg, nchwc_arg);
+  return nchwc_arg;
+}
+
+Node& NchwcTransformerImpl::AddNchwcNode(Node& node, const std::string& op_type, const std::string& domain,
+                                         const std::vector<NodeArg*>& inputs) {
+  NodeArg* output_arg = node.MutableOutputDefs()[0];
+  NodeArg* nchwc_output_arg = CreateNchwcArgument(*output_arg);
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"), op_type,
+                                    "NCHWc " + node.Name(),
+                                    inputs,
+                                    std::vector<NodeArg*>{nchwc_output_arg},
+                                    nullptr,
+                                    domain);
+  nchwc_node.SetExecutionProviderType(node.GetExecutionProviderType());
+
+  for (const auto& attr : node.GetAttributes()) {
+    // The NCHWc pooling operators do not produce the index tensor of MaxPool.
+    if (attr.first != "storage_order") {
+      nchwc_node.AddAttribute(attr.first, attr.second);
+    }
+  }
+
+  removed_nodes_.push_back(node.Index());
+  return nchwc_node;
+}
+
+void NchwcTransformerImpl::TransformConv(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+
+  // The filter and the optional bias must be constant so that they can be reordered here.
+  const TensorProto* conv_W_tensor_proto = nullptr;
+  if (!graph_.GetInitializedTensor(input_defs[1]->Name(), conv_W_tensor_proto) ||
+      graph_utils::HasGraphInput(graph_, input_defs[1]) ||
+      conv_W_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+      conv_W_tensor_proto->dims_size() != 4) {
+    return;
+  }
+
+  const TensorProto* conv_B_tensor_proto = nullptr;
+  if (input_defs.size() >= 3) {
+    if (!graph_.GetInitializedTensor(input_defs[2]->Name(), conv_B_tensor_proto) ||
+        graph_utils::HasGraphInput(graph_, input_defs[2]) ||
+        conv_B_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+        conv_B_tensor_proto->dims_size() != 1 ||
+        conv_B_tensor_proto->dims(0) != conv_W_tensor_proto->dims(0)) {
+      return;
+    }
+  }
+
+  const int64_t output_channels = conv_W_tensor_proto->dims(0);
+  const int64_t group_input_channels = conv_W_tensor_proto->dims(1);
+  const int64_t kernel_height = conv_W_tensor_proto->dims(2);
+  const int64_t kernel_width = conv_W_tensor_proto->dims(3);
+
+  const auto* group_attr = graph_utils::GetNodeAttribute(node, "group");
+  const int64_t group_count = (group_attr != nullptr) ? group_attr->i() : 1;
+  if (group_count <= 0 || output_channels % group_count != 0) {
+    return;
+  }
+  const int64_t input_channels = group_input_channels * group_count;
+  const int64_t group_output_channels = output_channels / group_count;
+
+  const bool is_depthwise = (group_count > 1) && (group_input_channels == 1) && (group_output_channels == 1);
+
+  // Grouped convolutions other than depthwise cannot pad the channels of each group.
+  if (group_count > 1 && !is_depthwise &&
+      (group_input_channels % block_size_ != 0 || group_output_channels % block_size_ != 0)) {
+    return;
+  }
+
+  NodeArg* nchwc_input_arg;
+  auto it = nchwc_args_.find(input_defs[0]);
+  if (it != nchwc_args_.end()) {
+    if (it->second.channels_ != input_channels) {
+      return;
+    }
+    nchwc_input_arg = it->second.nchwc_arg_;
+  } else {
+    // Inputs that are still in the NCHW layout are only reordered if no channel padding is needed. This keeps
+    // the first layer of a network (typically with three input channels) in the NCHW layout.
+    const auto* input_shape = input_defs[0]->Shape();
+    if (input_channels % block_size_ != 0 || input_shape == nullptr || input_shape->dim_size() != 4) {
+      return;
+    }
+    nchwc_input_arg = GetReorderedInput(input_defs[0], node.GetExecutionProviderType());
+  }
+
+  const int64_t nchwc_output_channels = RoundUpToBlockSize(output_channels);
+  const int64_t nchwc_input_channels = RoundUpToBlockSize(input_channels);
+
+  Initializer conv_W{conv_W_tensor_proto};
+  std::vector<int64_t> nchwc_W_dims;
+  std::vector<float> nchwc_W_data;
+  int64_t nchwc_group_count = group_count;
+
+  if (is_depthwise) {
+    nchwc_W_dims = {nchwc_output_channels, 1, kernel_height, kernel_width};
+    nchwc_W_data.resize(static_cast<size_t>(nchwc_output_channels * kernel_height * kernel_width));
+    MlasReorderFilterOIHWBo(conv_W.dims().data(), conv_W.data<float>(), nchwc_W_data.data());
+    nchwc_group_count = nchwc_output_channels;
+  } else {
+    const int64_t nchwc_group_input_channels =
+        (group_count == 1) ? nchwc_input_channels : group_input_channels;
+    nchwc_W_dims = {nchwc_output_channels, nchwc_group_input_channels, kernel_height, kernel_width};
+    nchwc_W_data.resize(static_cast<size_t>(nchwc_output_channels * nchwc_group_input_channels *
+                                            kernel_height * kernel_width));
+    MlasReorderFilterOIHWBiBo(conv_W.dims().data(), conv_W.data<float>(), nchwc_W_data.data());
+  }
+
+  std::vector<NodeArg*> nchwc_inputs{nchwc_input_arg,
+                                     AddFilterInitializer(input_defs[1]->Name(), nchwc_W_dims, nchwc_W_data)};
+  replaced_initializers_.insert(input_defs[1]->Name());
+
+  if (conv_B_tensor_proto != nullptr) {
+    Initializer conv_B{conv_B_tensor_proto};
+    std::vector<float> nchwc_B_data(static_cast<size_t>(nchwc_output_channels), 0.0f);
+    std::copy_n(conv_B.data<float>(), output_channels, nchwc_B_data.begin());
+    nchwc_inputs.push_back(AddFilterInitializer(input_defs[2]->Name(), {nchwc_output_channels}, nchwc_B_data));
+    replaced_initializers_.insert(input_defs[2]->Name());
+  }
+
+  Node& nchwc_node = AddNchwcNode(node, "Conv", kMSNchwcDomain, nchwc_inputs);
+  if (nchwc_group_count != group_count) {
+    nchwc_node.AddAttribute("group", nchwc_group_count);
+  }
+
+  // An activation can be fused if the convolution output has no other consumer.
+  Node* fusable_conv = nullptr;
+  if (node.GetOutputEdgesCount() == 1 && !graph_.IsNodeOutputsInGraphOutputs(node)) {
+    fusable_conv = &nchwc_node;
+  }
+
+  nchwc_args_[node.OutputDefs()[0]] = NchwcArgument{nchwc_node.MutableOutputDefs()[0], output_channels,
+                                                    fusable_conv};
+}
+
+void NchwcTransformerImpl::TransformPool(Node& node) {
+  auto it = nchwc_args_.find(node.InputDefs()[0]);
+  if (it == nchwc_args_.end()) {
+    return;
+  }
+
+  const int64_t channels = it->second.channels_;
+  Node& nchwc_node = AddNchwcNode(node, node.OpType(), kMSNchwcDomain, {it->second.nchwc_arg_});
+
+  nchwc_args_[node.OutputDefs()[0]] = NchwcArgument{nchwc_node.MutableOutputDefs()[0], channels, nullptr};
+}
+
+void NchwcTransformerImpl::TransformActivation(Node& node) {
+  auto it = nchwc_args_.find(node.InputDefs()[0]);
+  if (it == nchwc_args_.end()) {
+    return;
+  }
+  // Copy the entry as inserting the output below may invalidate the iterator.
+  const NchwcArgument input = it->second;
+
+  if (input.fusable_conv_ != nullptr) {
+    // Fuse the activation into the convolution that produces its input.
+    Node& nchwc_conv = *input.fusable_conv_;
+    nchwc_conv.AddAttribute("activation", node.OpType());
+    if (node.OpType() == "LeakyRelu") {
+      const auto* alpha_attr = graph_utils::GetNodeAttribute(node, "alpha");
+      nchwc_conv.AddAttribute("alpha", (alpha_attr != nullptr) ? alpha_attr->f() : 0.01f);
+    }
+    it->second.fusable_conv_ = nullptr;
+
+    removed_nodes_.push_back(node.Index());
+    nchwc_args_[node.OutputDefs()[0]] = NchwcArgument{input.nchwc_arg_, input.channels_, nullptr};
+    return;
+  }
+
+  // Element-wise operators are layout independent, so evaluate the activation on the blocked tensor.
+  Node& nchwc_node = AddNchwcNode(node, node.OpType(), node.Domain(), {input.nchwc_arg_});
+
+  nchwc_args_[node.OutputDefs()[0]] = NchwcArgument{nchwc_node.MutableOutputDefs()[0], input.channels_, nullptr};
+}
+
+void NchwcTransformerImpl::TransformAdd(Node& node) {
+  const auto& input_defs = node.InputDefs();
+  if (input_defs.size() != 2 || !HaveSameKnownShape(*input_defs[0], *input_defs[1])) {
+    return;
+  }
+
+  auto it0 = nchwc_args_.find(input_defs[0]);
+  auto it1 = nchwc_args_.find(input_defs[1]);
+  if (it0 == nchwc_args_.end() || it1 == nchwc_args_.end() ||
+      it0->second.channels_ != it1->second.channels_) {
+    return;
+  }
+
+  const int64_t channels = it0->second.channels_;
+  Node& nchwc_node = AddNchwcNode(node, node.OpType(), node.Domain(),
+                                  {it0->second.nchwc_arg_, it1->second.nchwc_arg_});
+
+  nchwc_args_[node.OutputDefs()[0]] = NchwcArgument{nchwc_node.MutableOutputDefs()[0], channels, nullptr};
+}
+
+void NchwcTransformerImpl::Transform(Node& node) {
+  if (!IsSupportedExecutionProvider(node)) {
+    return;
+  }
+
+  if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Conv", 1)) {
+    TransformConv(node);
+  } else if (IsSupportedPool(node)) {
+    TransformPool(node);
+  } else if (IsFusableActivation(node)) {
+    TransformActivation(node);
+  } else if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Add", 7) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sum", 6) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sum", 8)) {
+    TransformAdd(node);
+  }
+}
+
+void NchwcTransformerImpl::Finalize(bool& modified) {
+  if (removed_nodes_.empty() && reorder_inputs_.empty()) {
+    return;
+  }
+
+  for (auto index : removed_nodes_) {
+    Node* node = graph_.GetNode(index);
+    graph_utils::RemoveNodeOutputEdges(graph_, *node);
+    graph_.RemoveNode(index);
+  }
+
+  // Collect the NodeArgs that are still consumed in the NCHW layout.
+  std::unordered_set<const NodeArg*> consumed_args;
+  for (const auto& node : graph_.Nodes()) {
+    for (const auto* input_def : node.InputDefs()) {
+      consumed_args.insert(input_def);
+    }
+    for (const auto* input_def : node.ImplicitInputDefs()) {
+      consumed_args.insert(input_def);
+    }
+  }
+  for (const auto* output_def : graph_.GetOutputs()) {
+    consumed_args.insert(output_def);
+  }
+
+  // Reorder the blocked tensors back to NCHW for the remaining consumers of the original values.
+  for (auto& entry : nchwc_args_) {
+    const NodeArg* original_arg = entry.first;
+    if (consumed_args.count(original_arg) == 0) {
+      continue;
+    }
+
+    NodeArg* output_arg = graph_.GetNodeArg(original_arg->Name());
+    Node& reorder_node = graph_.AddNode(graph_.GenerateNodeName("ReorderOutput"), "ReorderOutput",
+                                        "Reorder " + original_arg->Name() + " to the NCHW layout",
+                                        std::vector<NodeArg*>{entry.second.nchwc_arg_},
+                                        std::vector<NodeArg*>{output_arg},
+                                        nullptr,
+                                        kMSNchwcDomain);
+    reorder_node.AddAttribute("channels", entry.second.channels_);
+    reorder_node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+
+  for (const auto& name : replaced_initializers_) {
+    const NodeArg* initializer_arg = graph_.GetNodeArg(name);
+    if (initializer_arg != nullptr && consumed_args.count(initializer_arg) == 0) {
+      graph_.RemoveInitializedTensor(name);
+    }
+  }
+
+  modified = true;
+}
+
+}  // namespace
+
+Status NchwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  NchwcTransformerImpl impl(graph);
+  GraphViewer graph_viewer(graph);
+
+  for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto& node = *graph.GetNode(index);
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level));
+    impl.Transform(node);
+  }
+
+  impl.Finalize(modified);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
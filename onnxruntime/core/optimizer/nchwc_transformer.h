@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class NchwcTransformer
+
+Transformer that converts 2D convolutions and the pooling operators that follow them to the NCHWc (channel
+blocked) layout of the MLAS NCHWc routines. The filters are reordered and the channel counts are padded to a
+multiple of the block size at transformation time. The blocked layout is propagated through activations and
+element-wise additions, and activations are fused into the convolution, so that tensors are only reordered
+back to NCHW where they are consumed by an operator that is not layout aware or are outputs of the graph.
+*/
+class NchwcTransformer : public GraphTransformer {
+ public:
+  NchwcTransformer() noexcept : GraphTransformer("NchwcTransformer", "Transform to the NCHWc blocked layout") {}
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
@@ -37,6 +37,7 @@ namespace onnxruntime {
 class Thread;
 
 struct ThreadOptions;
+struct MemoryRegionOptions;
 #ifdef _WIN32
 using PIDType = unsigned long;
 #else
@@ -97,6 +98,27 @@ class Env {
   virtual Thread* StartThread(const ThreadOptions& thread_options, const std::string& name,
                               std::function<void()> fn) const = 0;
 
+  /// \brief Restricts the calling thread to run on the given logical CPUs.
+  ///
+  /// Returns an error if the platform doesn't support it or a CPU doesn't exist.
+  virtual common::Status SetCurrentThreadAffinity(const std::vector<int>& cpus) const = 0;
+
+  /// \brief Gets the logical CPUs the calling thread may run on.
+  ///
+  /// Returns an error if the platform doesn't support it.
+  virtual common::Status GetCurrentThreadAffinity(std::vector<int>& cpus) const = 0;
+
+  /// \brief Allocates a page aligned region of memory directly from the operating
+  /// system, for large buffers like the regions of an arena.
+  ///
+  /// Returns nullptr if the memory can't be allocated. The region must be freed
+  /// with FreeMemoryRegion and the same size.
+  virtual void* AllocateMemoryRegion(size_t size, const MemoryRegionOptions& options) const = 0;
+  virtual void FreeMemoryRegion(void* p, size_t size) const = 0;
+
+  /// \brief Returns the NUMA node of a logical CPU, or -1 if it's unknown.
+  virtual int GetNumaNodeOfCpu(int cpu) const = 0;
+
 #ifndef _WIN32
   /**
    *
@@ -186,6 +208,20 @@ struct ThreadOptions {
   size_t stack_size = 0;  // 0: use system default value
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
+  /// Logical CPUs the thread may run on.
+  std::vector<int> affinity;  // empty: no affinity
+};
+
+/// \brief Options to allocate a memory region, see Env::AllocateMemoryRegion.
+///
+/// The options are hints, the region falls back to regular pages and the
+/// default NUMA policy of the process when they can't be honored.
+struct MemoryRegionOptions {
+  /// Back the region with huge pages, reserved ones if the size is a multiple
+  /// of the huge page size, transparent ones otherwise.
+  bool use_huge_pages = false;
+  /// Bind the pages of the region to a NUMA node.
+  int numa_node = -1;  // -1: use the NUMA policy of the process
 };
 
 }  // namespace onnxruntime
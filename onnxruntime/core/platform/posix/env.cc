@@ -27,6 +27,12 @@ limitations under the License.
 #include <thread>
 #include <vector>
 #include <assert.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
 #include "core/platform/env.h"
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -71,6 +77,44 @@ static void ORT_API_CALL UnmapFile(void* param) noexcept {
   delete p;
 }
 
+#ifdef __linux__
+// Size of the reserved huge pages, from /proc/meminfo. 0 if it's unknown.
+static size_t GetHugePageSize() {
+  static const size_t huge_page_size = []() -> size_t {
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (f == nullptr) return 0;
+    char line[256];
+    size_t size_kb = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+      if (sscanf(line, "Hugepagesize: %zu kB", &size_kb) == 1) break;
+    }
+    fclose(f);
+    return size_kb * 1024;
+  }();
+  return huge_page_size;
+}
+
+// Binds the pages of [p, p + size) to a NUMA node with mbind(MPOL_BIND), called through syscall so there is no
+// dependency on libnuma. Pages that were already touched stay where they are.
+static void BindToNumaNode(void* p, size_t size, int numa_node) {
+#ifdef SYS_mbind
+  constexpr int kMpolBind = 2;
+  constexpr size_t kBitsPerWord = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> node_mask(numa_node / kBitsPerWord + 1, 0);
+  node_mask[numa_node / kBitsPerWord] |= 1UL << (numa_node % kBitsPerWord);
+  // the kernel reads one bit less than maxnode
+  if (syscall(SYS_mbind, p, size, kMpolBind, node_mask.data(), node_mask.size() * kBitsPerWord + 1, 0) != 0) {
+    int err = errno;
+    LOGS_DEFAULT(WARNING) << "Failed to bind memory to NUMA node " << numa_node << ", error code:" << err;
+  }
+#else
+  ORT_UNUSED_PARAMETER(p);
+  ORT_UNUSED_PARAMETER(size);
+  ORT_UNUSED_PARAMETER(numa_node);
+#endif
+}
+#endif
+
 class PosixEnv : public Env {
  public:
   static PosixEnv& Instance() {
@@ -112,9 +156,121 @@ class PosixEnv : public Env {
     }
   }
 
-  Thread* StartThread(const ThreadOptions& /*thread_options*/, const std::string& /*name*/,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string& name,
                       std::function<void()> fn) const override {
-    return new StdThread(fn);
+    if (thread_options.affinity.empty()) {
+      return new StdThread(fn);
+    }
+    // the thread sets its own affinity before running fn
+    return new StdThread([this, affinity = thread_options.affinity, name, fn]() {
+      auto status = SetCurrentThreadAffinity(affinity);
+      if (!status.IsOK()) {
+        LOGS_DEFAULT(WARNING) << "Failed to set the affinity of thread " << name << ": " << status.ErrorMessage();
+      }
+      fn();
+    });
+  }
+
+  common::Status SetCurrentThreadAffinity(const std::vector<int>& cpus) const override {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid CPU index ", cpu);
+      }
+      CPU_SET(cpu, &cpu_set);
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "pthread_setaffinity_np failed, error code: ", ret);
+    }
+    return Status::OK();
+#else
+    // macOS only has affinity tags, which are hints shared by threads rather than CPU sets
+    ORT_UNUSED_PARAMETER(cpus);
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Thread affinity is not supported on this platform");
+#endif
+  }
+
+  common::Status GetCurrentThreadAffinity(std::vector<int>& cpus) const override {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    int ret = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "pthread_getaffinity_np failed, error code: ", ret);
+    }
+    cpus.clear();
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) {
+        cpus.push_back(cpu);
+      }
+    }
+    return Status::OK();
+#else
+    ORT_UNUSED_PARAMETER(cpus);
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Thread affinity is not supported on this platform");
+#endif
+  }
+
+  void* AllocateMemoryRegion(size_t size, const MemoryRegionOptions& options) const override {
+    void* p = MAP_FAILED;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    // fails if there aren't enough reserved huge pages, munmap needs a multiple of the huge page size
+    const size_t huge_page_size = options.use_huge_pages ? GetHugePageSize() : 0;
+    if (huge_page_size != 0 && size % huge_page_size == 0) {
+      p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (p == MAP_FAILED) {
+      p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED) {
+        return nullptr;
+      }
+#ifdef MADV_HUGEPAGE
+      if (options.use_huge_pages) {
+        (void)madvise(p, size, MADV_HUGEPAGE);
+      }
+#endif
+    }
+#ifdef __linux__
+    // the pages aren't touched yet, so they are all allocated on the node
+    if (options.numa_node >= 0) {
+      BindToNumaNode(p, size, options.numa_node);
+    }
+#endif
+    return p;
+  }
+
+  void FreeMemoryRegion(void* p, size_t size) const override {
+    if (p != nullptr && munmap(p, size) != 0) {
+      int err = errno;
+      LOGS_DEFAULT(WARNING) << "munmap failed. error code:" << err;
+    }
+  }
+
+  int GetNumaNodeOfCpu(int cpu) const override {
+#ifdef __linux__
+    // the directory of the CPU has a node<N> link to its NUMA node
+    const std::string cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(cpu_dir.c_str());
+    if (dir == nullptr) {
+      return -1;
+    }
+    int node = -1;
+    while (const dirent* entry = readdir(dir)) {
+      if (sscanf(entry->d_name, "node%d", &node) == 1) {
+        break;
+      }
+      node = -1;
+    }
+    closedir(dir);
+    return node;
+#else
+    ORT_UNUSED_PARAMETER(cpu);
+    return -1;
+#endif
   }
 
   PIDType GetSelfPid() const override {
@@ -46,9 +46,78 @@ class WindowsEnv : public Env {
  public:
   void SleepForMicroseconds(int64_t micros) const override { Sleep(static_cast<DWORD>(micros) / 1000); }
 
-  Thread* StartThread(const ThreadOptions&, const std::string&,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string& name,
                       std::function<void()> fn) const override {
-    return new StdThread(fn);
+    if (thread_options.affinity.empty()) {
+      return new StdThread(fn);
+    }
+    // the thread sets its own affinity before running fn
+    return new StdThread([this, affinity = thread_options.affinity, name, fn]() {
+      auto status = SetCurrentThreadAffinity(affinity);
+      if (!status.IsOK()) {
+        LOGS_DEFAULT(WARNING) << "Failed to set the affinity of thread " << name << ": " << status.ErrorMessage();
+      }
+      fn();
+    });
+  }
+
+  common::Status SetCurrentThreadAffinity(const std::vector<int>& cpus) const override {
+    // only the CPUs of the processor group of the thread can be set, which are the first 64 CPUs by default
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+      if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid CPU index ", cpu);
+      }
+      mask |= DWORD_PTR{1} << cpu;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "SetThreadAffinityMask failed, error code: ", GetLastError());
+    }
+    return Status::OK();
+  }
+
+  common::Status GetCurrentThreadAffinity(std::vector<int>& cpus) const override {
+    GROUP_AFFINITY affinity;
+    if (!GetThreadGroupAffinity(GetCurrentThread(), &affinity)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "GetThreadGroupAffinity failed, error code: ", GetLastError());
+    }
+    cpus.clear();
+    for (int cpu = 0; cpu < static_cast<int>(sizeof(KAFFINITY) * 8); ++cpu) {
+      if (affinity.Mask & (KAFFINITY{1} << cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+    return Status::OK();
+  }
+
+  void* AllocateMemoryRegion(size_t size, const MemoryRegionOptions& options) const override {
+    const DWORD node = options.numa_node >= 0 ? static_cast<DWORD>(options.numa_node) : NUMA_NO_PREFERRED_NODE;
+    void* p = nullptr;
+    // large pages need the SeLockMemoryPrivilege, use regular pages without it
+    const SIZE_T large_page_size = options.use_huge_pages ? GetLargePageMinimum() : 0;
+    if (large_page_size != 0 && size % large_page_size == 0) {
+      p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                             PAGE_READWRITE, node);
+    }
+    if (p == nullptr) {
+      p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+    }
+    return p;
+  }
+
+  void FreeMemoryRegion(void* p, size_t /*size*/) const override {
+    if (p != nullptr && !VirtualFree(p, 0, MEM_RELEASE)) {
+      LOGS_DEFAULT(WARNING) << "VirtualFree failed. error code:" << GetLastError();
+    }
+  }
+
+  int GetNumaNodeOfCpu(int cpu) const override {
+    // CPUs are numbered within the processor group of the thread, like in SetCurrentThreadAffinity
+    UCHAR node;
+    if (cpu < 0 || cpu > UCHAR_MAX || !GetNumaProcessorNode(static_cast<UCHAR>(cpu), &node) || node == 0xff) {
+      return -1;
+    }
+    return node;
   }
 
   int GetNumCpuCores() const override {
@@ -9,6 +9,8 @@
 #pragma warning(disable : 4996)
 #endif
 
+#include <algorithm>
+
 #include "core/providers/cpu/controlflow/loop.h"
 #include "core/providers/cpu/controlflow/utils.h"
 
@@ -87,6 +89,242 @@ ONNX_CPU_OPERATOR_KERNEL(Loop,
                              .TypeConstraint("V", DataTypeImpl::AllTensorTypes()),
                          Loop);
 
+// Upper bound on the size of the scan output buffers that are sized for the maximum trip count upfront.
+// A loop with a larger or unknown trip count starts with kInitialLoopOutputCapacity iterations and doubles the
+// capacity of the buffer as needed.
+static constexpr size_t kMaxPresizedLoopOutputBytes = 64 * 1024 * 1024;
+static constexpr int64_t kInitialLoopOutputCapacity = 16;
+
+static MLValue ToMLValue(std::unique_ptr<Tensor> tensor) {
+  return MLValue{tensor.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc()};
+}
+
+static bool IsStringTensor(const Tensor& tensor) {
+  return tensor.DataType() == DataTypeImpl::GetType<std::string>();
+}
+
+// copy num_elements from src to dst, using assignment for string tensors.
+static void CopyElements(const Tensor& src, const void* src_data, void* dst_data, int64_t num_elements) {
+  if (IsStringTensor(src)) {
+    const auto* src_strings = static_cast<const std::string*>(src_data);
+    std::copy(src_strings, src_strings + num_elements, static_cast<std::string*>(dst_data));
+  } else {
+    memcpy(dst_data, src_data, num_elements * src.DataType()->Size());
+  }
+}
+
+/*
+Buffers for a loop carried variable. The subgraph output for the variable is written to one of two buffers,
+alternating between them in each iteration so the output never overwrites the input of the iteration.
+The buffers are reused while they are large enough, so the shape of the variable can change across iterations
+without a new allocation in every iteration.
+*/
+class LoopStateBuffers {
+ public:
+  explicit LoopStateBuffers(AllocatorPtr allocator) : allocator_{allocator} {}
+
+  // custom fetch allocator for the subgraph output. 'input' is the value of the variable in the current iteration,
+  // and 'feeds' are all the values fed to the subgraph in the current iteration, none of which can be overwritten.
+  Status AllocateSubgraphOutput(const MLValue& input, const std::vector<MLValue>& feeds,
+                                const TensorShape& shape, MLValue& mlvalue);
+
+ private:
+  struct Buffer {
+    BufferUniquePtr data;
+    size_t size_in_bytes = 0;
+  };
+
+  bool InUse(const Buffer& buffer, const std::vector<MLValue>& feeds) const {
+    return buffer.data && std::any_of(feeds.cbegin(), feeds.cend(), [&buffer](const MLValue& feed) {
+             return feed.IsTensor() && feed.Get<Tensor>().DataRaw() == buffer.data.get();
+           });
+  }
+
+  AllocatorPtr allocator_;
+  Buffer buffers_[2];
+  int next_ = 0;
+};
+
+Status LoopStateBuffers::AllocateSubgraphOutput(const MLValue& input, const std::vector<MLValue>& feeds,
+                                                const TensorShape& shape, MLValue& mlvalue) {
+  const auto& input_tensor = input.Get<Tensor>();
+  MLDataType data_type = input_tensor.DataType();
+
+  int64_t num_elements = shape.Size();
+  size_t size_in_bytes = 0;
+  if (num_elements < 0 ||
+      !IAllocator::CalcMemSizeForArray(static_cast<size_t>(num_elements), data_type->Size(), &size_in_bytes)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Invalid shape for loop carried variable: ", shape);
+  }
+
+  // string tensors need their elements constructed, so they are not placed in the reusable buffers.
+  Buffer* buffer = nullptr;
+  if (!IsStringTensor(input_tensor)) {
+    if (!InUse(buffers_[next_], feeds)) {
+      buffer = &buffers_[next_];
+    } else if (!InUse(buffers_[1 - next_], feeds)) {
+      buffer = &buffers_[1 - next_];
+    }
+  }
+
+  if (buffer == nullptr) {
+    // the subgraph passed a buffer through to another loop carried variable, or a string tensor. allocate a new
+    // tensor for this iteration.
+    auto tensor = std::make_unique<Tensor>(data_type, shape, allocator_);
+    mlvalue = ToMLValue(std::move(tensor));
+    return Status::OK();
+  }
+
+  if (buffer->size_in_bytes < size_in_bytes) {
+    // the variable may grow in each iteration, so leave room for it to grow without a reallocation each time.
+    size_t new_size = std::max(size_in_bytes, buffer->size_in_bytes * 2);
+    buffer->data = BufferUniquePtr(allocator_->Alloc(new_size), BufferDeleter(allocator_));
+    buffer->size_in_bytes = new_size;
+  }
+
+  next_ = buffer == &buffers_[0] ? 1 : 0;
+
+  auto tensor = std::make_unique<Tensor>(data_type, shape, buffer->data.get(), allocator_->Info());
+  mlvalue = ToMLValue(std::move(tensor));
+  return Status::OK();
+}
+
+/*
+Buffer that accumulates the value of a scan output from each iteration of the loop. The subgraph writes directly
+into the next free slot of the buffer, which is sized for the trip count if that is known, and doubles in capacity
+when it is full otherwise.
+*/
+class LoopOutputBuffer {
+ public:
+  LoopOutputBuffer(AllocatorPtr allocator, int64_t max_trip_count)
+      : allocator_{allocator}, max_trip_count_{max_trip_count} {}
+
+  // the subgraph can write to the buffer once the type and shape are known from the first iteration.
+  bool CanAllocateSubgraphOutput() const { return data_type_ != nullptr && !is_string_; }
+
+  // custom fetch allocator for the subgraph output, which returns the next free slot of the buffer.
+  Status AllocateSubgraphOutput(const TensorShape& shape, MLValue& mlvalue);
+
+  // add the subgraph output of an iteration. the value is only copied if it was not written to the buffer directly.
+  Status Append(const MLValue& value, int output_index);
+
+  int64_t NumIterations() const { return num_iterations_; }
+
+  // create the Loop output from the values of all the iterations
+  Status CopyToOutput(OpKernelContext& context, int output_index) const;
+
+ private:
+  Status Reserve();
+
+  void* Slot(int64_t iteration) {
+    return static_cast<gsl::byte*>(buffer_.GetMutable<Tensor>()->MutableDataRaw()) + iteration * bytes_per_iteration_;
+  }
+
+  AllocatorPtr allocator_;
+  const int64_t max_trip_count_;
+
+  MLDataType data_type_ = nullptr;
+  bool is_string_ = false;
+  TensorShape per_iteration_shape_;
+  int64_t bytes_per_iteration_ = 0;
+
+  int64_t capacity_ = 0;
+  int64_t num_iterations_ = 0;
+  MLValue buffer_;
+
+  // the buffer before it last grew. a value the subgraph wrote to it may be fed to the subgraph in the iteration
+  // the buffer grows in if the subgraph output is also a loop carried variable, so it's kept until that completes.
+  MLValue previous_buffer_;
+};
+
+Status LoopOutputBuffer::Reserve() {
+  if (num_iterations_ < capacity_) {
+    return Status::OK();
+  }
+
+  int64_t new_capacity;
+  if (capacity_ == 0) {
+    // size for the trip count if that is known and the buffer isn't excessively large.
+    const bool presize = max_trip_count_ != INT64_MAX && bytes_per_iteration_ > 0 &&
+                         max_trip_count_ <= static_cast<int64_t>(kMaxPresizedLoopOutputBytes) / bytes_per_iteration_;
+    new_capacity = presize ? max_trip_count_ : kInitialLoopOutputCapacity;
+  } else {
+    new_capacity = capacity_ * 2;
+  }
+  new_capacity = std::max<int64_t>(std::min(new_capacity, max_trip_count_), num_iterations_ + 1);
+
+  std::vector<int64_t> dims{new_capacity};
+  const auto& per_iteration_dims = per_iteration_shape_.GetDims();
+  dims.insert(dims.end(), per_iteration_dims.cbegin(), per_iteration_dims.cend());
+
+  auto tensor = std::make_unique<Tensor>(data_type_, TensorShape(dims), allocator_);
+  if (num_iterations_ > 0) {
+    const auto& current = buffer_.Get<Tensor>();
+    CopyElements(current, current.DataRaw(), tensor->MutableDataRaw(),
+                 num_iterations_ * per_iteration_shape_.Size());
+  }
+
+  previous_buffer_ = std::move(buffer_);
+  buffer_ = ToMLValue(std::move(tensor));
+  capacity_ = new_capacity;
+
+  return Status::OK();
+}
+
+Status LoopOutputBuffer::AllocateSubgraphOutput(const TensorShape& shape, MLValue& mlvalue) {
+  if (shape != per_iteration_shape_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Inconsistent shape in loop output. Expected:", per_iteration_shape_,
+                           " Got:", shape);
+  }
+
+  ORT_RETURN_IF_ERROR(Reserve());
+
+  auto tensor = std::make_unique<Tensor>(data_type_, shape, Slot(num_iterations_), allocator_->Info());
+  mlvalue = ToMLValue(std::move(tensor));
+  return Status::OK();
+}
+
+Status LoopOutputBuffer::Append(const MLValue& value, int output_index) {
+  const auto& tensor = value.Get<Tensor>();
+
+  if (data_type_ == nullptr) {
+    data_type_ = tensor.DataType();
+    is_string_ = IsStringTensor(tensor);
+    per_iteration_shape_ = tensor.Shape();
+    bytes_per_iteration_ = gsl::narrow<int64_t>(tensor.Size());
+  } else if (tensor.Shape() != per_iteration_shape_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Inconsistent shape in loop output for output ", output_index,
+                           " Expected:", per_iteration_shape_, " Got:", tensor.Shape());
+  }
+
+  // nothing to copy if the subgraph wrote the value directly to the buffer
+  if (num_iterations_ >= capacity_ || tensor.DataRaw() != Slot(num_iterations_) || bytes_per_iteration_ == 0) {
+    ORT_RETURN_IF_ERROR(Reserve());
+    CopyElements(tensor, tensor.DataRaw(), Slot(num_iterations_), per_iteration_shape_.Size());
+  }
+
+  ++num_iterations_;
+  previous_buffer_ = MLValue();
+
+  return Status::OK();
+}
+
+Status LoopOutputBuffer::CopyToOutput(OpKernelContext& context, int output_index) const {
+  std::vector<int64_t> dims{num_iterations_};
+  const auto& per_iteration_dims = per_iteration_shape_.GetDims();
+  dims.insert(dims.end(), per_iteration_dims.cbegin(), per_iteration_dims.cend());
+
+  Tensor* output = context.Output(output_index, TensorShape(dims));
+  if (!output) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to create output tensor for Loop output ", output_index);
+  }
+
+  const auto& buffer = buffer_.Get<Tensor>();
+  CopyElements(buffer, buffer.DataRaw(), output->MutableDataRaw(), num_iterations_ * per_iteration_shape_.Size());
+
+  return Status::OK();
+}
+
 class LoopImpl {
  public:
   LoopImpl(OpKernelContextInternal& context,
@@ -103,10 +341,7 @@ class LoopImpl {
 
  private:
   void CreateInitialFeeds(std::vector<MLValue>& feeds);
-  void SaveOutputsAndUpdateFeeds(const std::vector<MLValue>& last_outputs, std::vector<MLValue>& next_inputs);
-
-  // create the single Loop output from a collection of per-iteration outputs
-  Status ConcatenateLoopOutput(std::vector<MLValue>& per_iteration_output, int output_index);
+  Status SaveOutputsAndUpdateFeeds(const std::vector<MLValue>& last_outputs, std::vector<MLValue>& next_inputs);
 
   OpKernelContextInternal& context_;
   const SessionState& session_state_;
@@ -127,9 +362,12 @@ class LoopImpl {
   std::vector<std::string> subgraph_input_names_;
   std::vector<std::string> subgraph_output_names_;
 
-  // collection of MLValue outputs from each loop iteration for the loop outputs.
+  // reusable buffers for the loop carried variables
+  std::vector<LoopStateBuffers> loop_state_buffers_;
+
+  // buffers accumulating the values of the scan outputs from each loop iteration.
   // the order from the subgraph matches the order from the loop output
-  std::vector<std::vector<MLValue>> loop_output_tensors_;
+  std::vector<LoopOutputBuffer> loop_output_buffers_;
 };
 
 Status Loop::Compute(OpKernelContext* ctx) const {
@@ -216,7 +454,16 @@ Status LoopImpl::Initialize() {
   }
 
   subgraph_output_names_.reserve(num_subgraph_outputs);
-  loop_output_tensors_.resize(num_outputs_ - num_loop_carried_vars_);
+
+  loop_state_buffers_.reserve(num_loop_carried_vars_);
+  for (int i = 0; i < num_loop_carried_vars_; ++i) {
+    loop_state_buffers_.emplace_back(allocator);
+  }
+
+  loop_output_buffers_.reserve(num_outputs_ - num_loop_carried_vars_);
+  for (int i = num_loop_carried_vars_; i < num_outputs_; ++i) {
+    loop_output_buffers_.emplace_back(allocator, max_trip_count_);
+  }
 
   // save list of subgraph output names in their provided order to use when fetching the results
   // from each subgraph execution. the Loop outputs will match this order.
@@ -266,7 +513,8 @@ void LoopImpl::CreateInitialFeeds(std::vector<MLValue>& feeds) {
   }
 }
 
-void LoopImpl::SaveOutputsAndUpdateFeeds(const std::vector<MLValue>& last_outputs, std::vector<MLValue>& next_inputs) {
+Status LoopImpl::SaveOutputsAndUpdateFeeds(const std::vector<MLValue>& last_outputs,
+                                           std::vector<MLValue>& next_inputs) {
   // last_output: cond, loop vars..., loop output...
   // next_input: iter_num, cond, loop_vars. iter_num is re-used
 
@@ -275,45 +523,10 @@ void LoopImpl::SaveOutputsAndUpdateFeeds(const std::vector<MLValue>& last_output
     next_inputs[i] = last_outputs[i - 1];
   }
 
-  // save loop outputs as we have to concatenate at the end
+  // add the loop outputs to the buffers they are accumulated in
   for (int j = num_loop_carried_vars_; j < num_outputs_; ++j) {
-    loop_output_tensors_[j - num_loop_carried_vars_].push_back(last_outputs[j + 1]);  // skip 'cond' in output
-  }
-}
-
-Status LoopImpl::ConcatenateLoopOutput(std::vector<MLValue>& per_iteration_output, int output_index) {
-  const auto& first_output = per_iteration_output.front().Get<Tensor>();
-  size_t bytes_per_iteration = first_output.Size();
-  const auto& per_iteration_shape = first_output.Shape();
-  const auto& per_iteration_dims = per_iteration_shape.GetDims();
-
-  // prepend number of iterations to the dimensions
-  int64_t num_iterations = gsl::narrow_cast<int64_t>(per_iteration_output.size());
-  std::vector<int64_t> dims{num_iterations};
-  std::copy(per_iteration_dims.cbegin(), per_iteration_dims.cend(), std::back_inserter(dims));
-  TensorShape output_shape{dims};
-
-  Tensor* output = context_.Output(output_index, output_shape);
-
-  // we can't easily use a C++ template for the tensor element type,
-  // so use a span for some protection but work in bytes
-  gsl::span<gsl::byte> output_span = gsl::make_span<gsl::byte>(static_cast<gsl::byte*>(output->MutableDataRaw()),
-                                                               output->Size());
-
-  for (int64_t i = 0; i < num_iterations; ++i) {
-    auto& mlvalue = per_iteration_output[i];
-    auto& iteration_data = mlvalue.Get<Tensor>();
-
-    // sanity check
-    if (bytes_per_iteration != iteration_data.Size()) {
-      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Inconsistent shape in loop output for output ", output_index,
-                             " Expected:", per_iteration_shape, " Got:", iteration_data.Shape());
-    }
-
-    auto num_bytes = iteration_data.Size();
-    auto src = gsl::make_span<const gsl::byte>(static_cast<const gsl::byte*>(iteration_data.DataRaw()), num_bytes);
-    auto dst = output_span.subspan(i * bytes_per_iteration, bytes_per_iteration);
-    gsl::copy(src, dst);
+    ORT_RETURN_IF_ERROR(
+        loop_output_buffers_[j - num_loop_carried_vars_].Append(last_outputs[j + 1], j));  // skip 'cond' in output
   }
 
   return Status::OK();
@@ -324,26 +537,42 @@ Status LoopImpl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* ca
 
   std::vector<MLValue> feeds;
   std::vector<MLValue> fetches;
+  std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
 
   CreateInitialFeeds(feeds);
 
+  // loop carried variables can change shape across iterations, so the subgraph outputs for them alternate between
+  // two buffers that are reused while they are large enough. fetch index is offset by 1 to skip 'cond'.
+  for (int i = 0; i < num_loop_carried_vars_; ++i) {
+    fetch_allocators[i + 1] = [this, i, &feeds](const TensorShape& shape, MLValue& mlvalue) {
+      return loop_state_buffers_[i].AllocateSubgraphOutput(feeds[i + 2], feeds, shape, mlvalue);
+    };
+  }
+
   auto& iter_num_value = *iter_num_mlvalue_.GetMutable<Tensor>()->MutableData<int64_t>();
 
   while (iter_num_value < max_trip_count_ && *condition_mlvalue_.GetMutable<Tensor>()->MutableData<bool>()) {
-    if (iter_num_value != 0) {
-      SaveOutputsAndUpdateFeeds(fetches, feeds);
-      fetches.clear();
+    // the type and shape of the loop outputs are known after the first iteration, so from then on the subgraph
+    // can write them directly into the buffers they are accumulated in.
+    if (iter_num_value == 1) {
+      for (int i = num_loop_carried_vars_; i < num_outputs_; ++i) {
+        auto& output_buffer = loop_output_buffers_[i - num_loop_carried_vars_];
+        if (output_buffer.CanAllocateSubgraphOutput()) {
+          fetch_allocators[i + 1] = [&output_buffer](const TensorShape& shape, MLValue& mlvalue) {
+            return output_buffer.AllocateSubgraphOutput(shape, mlvalue);
+          };
+        }
+      }
     }
 
-    // loop carried variables can change shape across iterations, and we don't know how many iterations
-    // there will be to allocate loop outputs upfront. due to that we can't use a custom fetch allocator
-    // for any outputs
+    fetches.clear();
+
     if (cached_ffm) {
-      status = utils::ExecuteGraphWithCachedInfo(session_state_, *cached_ffm, feeds, fetches, {},
+      status = utils::ExecuteGraphWithCachedInfo(session_state_, *cached_ffm, feeds, fetches, fetch_allocators,
                                                  /*sequential_execution*/ true, context_.GetTerminateFlag(),
                                                  context_.Logger());
     } else {
-      status = utils::ExecuteGraph(session_state_, *ffm, feeds, fetches, {},
+      status = utils::ExecuteGraph(session_state_, *ffm, feeds, fetches, fetch_allocators,
                                    /*sequential_execution*/ true, context_.GetTerminateFlag(), context_.Logger(),
                                    /*cache_copy_info*/ true);
 
@@ -354,6 +583,7 @@ Status LoopImpl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* ca
     ORT_RETURN_IF_ERROR(status);
 
     condition_mlvalue_ = fetches[0];
+    ORT_RETURN_IF_ERROR(SaveOutputsAndUpdateFeeds(fetches, feeds));
 
     ++iter_num_value;
   }
@@ -363,32 +593,23 @@ Status LoopImpl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* ca
   auto copy_tensor_from_mlvalue_to_output = [this](const MLValue& input, int output_idx) {
     auto& data = input.Get<Tensor>();
     Tensor* output = context_.Output(output_idx, data.Shape());
-    auto src = gsl::make_span<const gsl::byte>(static_cast<const gsl::byte*>(data.DataRaw()), data.Size());
-    auto dst = gsl::make_span<gsl::byte>(static_cast<gsl::byte*>(output->MutableDataRaw()), output->Size());
-    gsl::copy(src, dst);
+    CopyElements(data, data.DataRaw(), output->MutableDataRaw(), data.Shape().Size());
   };
 
-  // copy to Loop output
-  if (iter_num_value != 0) {
-    for (int i = 0; i < num_loop_carried_vars_; ++i) {
-      // need to allocate Loop output and copy MLValue from fetches
-      copy_tensor_from_mlvalue_to_output(fetches[i + 1], i);  // skip cond
-    }
+  // copy to Loop output. the feeds contain the final value of the loop carried vars, or the initial value if there
+  // were no iterations.
+  for (int i = 0; i < num_loop_carried_vars_; ++i) {
+    copy_tensor_from_mlvalue_to_output(feeds[i + 2], i);  // skip iter# and cond
+  }
 
+  if (iter_num_value != 0) {
+    // the loop outputs are copied from the buffers in one go, as the Loop output may be allocated by a custom
+    // allocator of an outer control flow node so the buffer can't be returned directly.
     for (int i = num_loop_carried_vars_; i < num_outputs_; ++i) {
-      // add last output
-      auto& per_iteration_outputs = loop_output_tensors_[i - num_loop_carried_vars_];
-      per_iteration_outputs.push_back(fetches[i + 1]);  // skip cond
-
-      ORT_RETURN_IF_ERROR(ConcatenateLoopOutput(per_iteration_outputs, i));
+      ORT_RETURN_IF_ERROR(loop_output_buffers_[i - num_loop_carried_vars_].CopyToOutput(context_, i));
     }
   } else {
     // no iterations.
-    // copy input loop carried vars to output.
-    for (int i = 0; i < num_loop_carried_vars_; ++i) {
-      copy_tensor_from_mlvalue_to_output(feeds[i + 2], i);  // skip iter# and cond
-    }
-
     // create empty outputs for loop outputs
     TensorShape empty;
     for (int i = num_loop_carried_vars_; i < num_outputs_; ++i) {
@@ -12,8 +12,11 @@
 #include "core/providers/cpu/controlflow/scan_utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 
+#include <algorithm>
+
 #include "core/framework/framework_common.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/parallel_for.h"
 #include "core/framework/session_state.h"
 #include "core/framework/tensorprotoutils.h"
 
@@ -108,6 +111,18 @@ class Scan8Impl {
   Status AllocateOutputTensors();
   Status CreateLoopStateVariables(std::vector<std::vector<LoopStateVariable>>& loop_state_variables);
 
+  // iterate the sequence of a single batch entry, writing the scan outputs using output_iterators
+  Status ExecuteBatch(int64_t batch, std::vector<LoopStateVariable>& loop_state_variables,
+                      std::vector<std::unique_ptr<OutputIterator>>& output_iterators,
+                      FeedsFetchesManager* ffm, const FeedsFetchesManager* cached_ffm);
+
+  // the batch entries only share the Scan outputs, so once those are allocated the remaining batch entries
+  // can be executed concurrently on the session thread pool.
+  bool CanExecuteBatchesConcurrently(int64_t remaining_batches, const FeedsFetchesManager* cached_ffm) const;
+  Status ExecuteBatchesConcurrently(int64_t first_batch,
+                                    std::vector<std::vector<LoopStateVariable>>& batch_loop_state_variables,
+                                    const FeedsFetchesManager& cached_ffm);
+
   using ConstTensorSlicerIterators = std::vector<MLValueTensorSlicer<const MLValue>::Iterator>;
   using MutableTensorSlicerIterators = std::vector<MLValueTensorSlicer<MLValue>::Iterator>;
 
@@ -386,6 +401,78 @@ Status Scan8Impl::CreateFeedsFetchesManager(std::unique_ptr<FeedsFetchesManager>
                                                  ffm);
 }
 
+Status Scan8Impl::ExecuteBatch(int64_t batch, std::vector<LoopStateVariable>& loop_state_variables,
+                               std::vector<std::unique_ptr<OutputIterator>>& output_iterators,
+                               FeedsFetchesManager* ffm, const FeedsFetchesManager* cached_ffm) {
+  auto sequence_len = sequence_lens_[batch];
+
+  // Setup input MLValue streams
+  std::vector<MLValueTensorSlicer<const MLValue>::Iterator> scan_input_stream_iterators;
+  scan_input_stream_iterators.reserve(num_variadic_inputs_ - num_loop_state_variables_);
+
+  for (int i = num_loop_state_variables_, end = num_variadic_inputs_; i < end; ++i) {
+    const auto& mlvalue = GetSubgraphInputMLValue(context_, i);
+
+    // forward
+    if (directions_[i - num_loop_state_variables_] == static_cast<int64_t>(ScanDirection::kForward)) {
+      // the iterator is self contained, so we don't need to keep the MLValueTensorSlicer instance around
+      scan_input_stream_iterators.push_back(MLValueTensorSlicer<const MLValue>::Create(mlvalue, 1, batch).begin());
+    } else {  // reverse
+      scan_input_stream_iterators.push_back(MLValueTensorSlicer<const MLValue>::Create(mlvalue, 1, batch).rbegin());
+      // need to skip past the empty entries at the end of the input if sequence length is short
+      auto offset = max_sequence_len_ - sequence_len;
+      if (offset > 0) {
+        // reverse iterator so += moves backwards through the input
+        scan_input_stream_iterators.back() += offset;
+      }
+    }
+  }
+
+  // Call the subgraph for each item in the sequence
+  auto status = IterateSequence(context_, session_state_, loop_state_variables, scan_input_stream_iterators,
+                                sequence_len, num_loop_state_variables_, num_variadic_inputs_, num_variadic_outputs_,
+                                implicit_inputs_, output_iterators, ffm, cached_ffm);
+
+  // zero out any remaining values in the sequence
+  for (int64_t i = sequence_len; i < max_sequence_len_; ++i) {
+    for (int output = num_loop_state_variables_; output < num_variadic_outputs_; ++output) {
+      auto& iterator = *output_iterators[output];
+      iterator.ZeroOutCurrent();
+      ++iterator;
+    }
+  }
+
+  return status;
+}
+
+bool Scan8Impl::CanExecuteBatchesConcurrently(int64_t remaining_batches,
+                                              const FeedsFetchesManager* cached_ffm) const {
+  // outputs with a symbolic dimension are allocated by the first subgraph execution that produces them
+  return remaining_batches > 1 && cached_ffm != nullptr && session_state_.ScanBatchParallelismEnabled() &&
+         session_state_.GetThreadPool() != nullptr &&
+         std::all_of(output_iterators_.cbegin() + num_loop_state_variables_, output_iterators_.cend(),
+                     [](const std::unique_ptr<OutputIterator>& iterator) {
+                       return iterator->FinalOutputAllocated();
+                     });
+}
+
+Status Scan8Impl::ExecuteBatchesConcurrently(int64_t first_batch,
+                                             std::vector<std::vector<LoopStateVariable>>& batch_loop_state_variables,
+                                             const FeedsFetchesManager& cached_ffm) {
+  return ParallelFor(session_state_.GetThreadPool(), static_cast<size_t>(batch_size_ - first_batch), [&](size_t i) {
+    auto batch = first_batch + static_cast<int64_t>(i);
+
+    // each batch entry writes to its own slices of the Scan outputs. there are no iterators for the loop state
+    // variables, which are written directly by the LoopStateVariable instances of the batch entry.
+    std::vector<std::unique_ptr<OutputIterator>> output_iterators(num_variadic_outputs_);
+    for (int output = num_loop_state_variables_; output < num_variadic_outputs_; ++output) {
+      ORT_RETURN_IF_ERROR(output_iterators_[output]->CreateBatchIterator(batch, output_iterators[output]));
+    }
+
+    return ExecuteBatch(batch, batch_loop_state_variables[batch], output_iterators, nullptr, &cached_ffm);
+  });
+}
+
 Status Scan8Impl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* cached_ffm) {
   Status status = Status::OK();
 
@@ -395,34 +482,11 @@ Status Scan8Impl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* c
   ORT_RETURN_IF_ERROR(status);
 
   for (int64_t b = 0; b < batch_size_; ++b) {
-    auto sequence_len = sequence_lens_[b];
-
-    // Setup input MLValue streams
-    std::vector<MLValueTensorSlicer<const MLValue>::Iterator> scan_input_stream_iterators;
-    scan_input_stream_iterators.reserve(num_variadic_inputs_ - num_loop_state_variables_);
-
-    for (int i = num_loop_state_variables_, end = num_variadic_inputs_; i < end; ++i) {
-      const auto& mlvalue = GetSubgraphInputMLValue(context_, i);
-
-      // forward
-      if (directions_[i - num_loop_state_variables_] == static_cast<int64_t>(ScanDirection::kForward)) {
-        // the iterator is self contained, so we don't need to keep the MLValueTensorSlicer instance around
-        scan_input_stream_iterators.push_back(MLValueTensorSlicer<const MLValue>::Create(mlvalue, 1, b).begin());
-      } else {  // reverse
-        scan_input_stream_iterators.push_back(MLValueTensorSlicer<const MLValue>::Create(mlvalue, 1, b).rbegin());
-        // need to skip past the empty entries at the end of the input if sequence length is short
-        auto offset = max_sequence_len_ - sequence_len;
-        if (offset > 0) {
-          // reverse iterator so += moves backwards through the input
-          scan_input_stream_iterators.back() += offset;
-        }
-      }
+    if (CanExecuteBatchesConcurrently(batch_size_ - b, cached_ffm)) {
+      return ExecuteBatchesConcurrently(b, batch_loop_state_variables, *cached_ffm);
     }
 
-    // Call the subgraph for each item in the sequence
-    status = IterateSequence(context_, session_state_, batch_loop_state_variables[b], scan_input_stream_iterators,
-                             sequence_len, num_loop_state_variables_, num_variadic_inputs_, num_variadic_outputs_,
-                             implicit_inputs_, output_iterators_, ffm, cached_ffm);
+    status = ExecuteBatch(b, batch_loop_state_variables[b], output_iterators_, ffm, cached_ffm);
 
     // use the cached info from now on
     if (ffm) {
@@ -430,15 +494,6 @@ Status Scan8Impl::Execute(FeedsFetchesManager* ffm, const FeedsFetchesManager* c
       ffm = nullptr;
     }
 
-    // zero out any remaining values in the sequence
-    for (int64_t i = sequence_len; i < max_sequence_len_; ++i) {
-      for (int output = num_loop_state_variables_; output < num_variadic_outputs_; ++output) {
-        auto& iterator = *output_iterators_[output];
-        iterator.ZeroOutCurrent();
-        ++iterator;
-      }
-    }
-
     ORT_RETURN_IF_ERROR(status);
   }
 
@@ -156,6 +156,10 @@ Status IterateSequence(OpKernelContextInternal& context,
   feeds.resize(num_inputs);
   fetches.resize(num_variadic_outputs);
 
+  // the subgraph is executed with feeds of the same shape in each iteration, so use a single executor that reuses
+  // its ExecutionFrame rather than creating a new executor and frame for every item in the sequence.
+  SequentialExecutor executor(context.GetTerminateFlag(), /*reuse_frame*/ true);
+
   // add implicit inputs and pass in implicit inputs as feeds. we're going to pass in the explicit inputs
   // first in each iteration though so offset by num_variadic_inputs
   int i = 0;
@@ -211,7 +215,7 @@ Status IterateSequence(OpKernelContextInternal& context,
     if (cached_ffm) {
       status = utils::ExecuteGraphWithCachedInfo(session_state, *cached_ffm, feeds, fetches, fetch_allocators,
                                                  /*sequential_execution*/ true, context.GetTerminateFlag(),
-                                                 context.Logger());
+                                                 context.Logger(), &executor);
     } else {
       status = utils::ExecuteGraph(session_state, *ffm, feeds, fetches, fetch_allocators,
                                    /*sequential_execution*/ true, context.GetTerminateFlag(), context.Logger(),
@@ -486,6 +490,29 @@ Status OutputIterator::AllocateSubgraphOutput(const TensorShape& shape, MLValue&
   return Status::OK();
 }
 
+Status OutputIterator::CreateBatchIterator(int64_t batch, std::unique_ptr<OutputIterator>& iterator) const {
+  if (!is_v8_ || is_loop_state_var_ || !is_concrete_shape_ || batch < 0 || batch >= final_shape_[0]) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Can't create an iterator for batch ", batch, " of output #",
+                           output_index_);
+  }
+
+  iterator.reset(new OutputIterator(*this));
+
+  auto sequence_len = final_shape_[1];
+  iterator->slicer_iterators_.clear();
+  iterator->slicer_iterators_.push_back(
+      (direction_ == ScanDirection::kForward)
+          ? MLValueTensorSlicer<MLValue>::Create(*final_output_mlvalue_, 1, batch).begin()
+          : MLValueTensorSlicer<MLValue>::Create(*final_output_mlvalue_, 1, batch).rbegin());
+  iterator->cur_slicer_iterator_ = iterator->slicer_iterators_.begin();
+
+  // operator++ moves past the only slicer at the end of the batch entry, which is also the last iteration
+  iterator->cur_iteration_ = batch * sequence_len;
+  iterator->num_iterations_ = (batch + 1) * sequence_len;
+
+  return Status::OK();
+}
+
 MLValue& OutputIterator::operator*() {
   ORT_ENFORCE(cur_iteration_ < num_iterations_);
   ORT_ENFORCE(is_concrete_shape_,
@@ -111,6 +111,10 @@ class OutputIterator {
     return *final_output_mlvalue_;
   }
 
+  // create an iterator over the slices of a single batch entry of a v8 scan output, so batch entries can be
+  // processed concurrently. the final output must have been allocated.
+  Status CreateBatchIterator(int64_t batch, std::unique_ptr<OutputIterator>& iterator) const;
+
  private:
   OutputIterator(OpKernelContextInternal& context,
                  int output_index,
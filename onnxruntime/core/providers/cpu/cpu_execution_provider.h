@@ -4,6 +4,7 @@
 #pragma once
 
 #include "core/framework/allocatormgr.h"
+#include "core/framework/cpu_region_allocator.h"
 #include "core/framework/execution_provider.h"
 #include "core/graph/constants.h"
 
@@ -12,6 +13,12 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  // upper bound of the memory held by the arena, allocations past it fail. 0: unbounded
+  size_t arena_max_bytes{0};
+  // back the regions of the arena with huge pages
+  bool use_huge_pages{false};
+  // bind the regions of the arena to a NUMA node. -1: no binding
+  int numa_node{-1};
 
   explicit CPUExecutionProviderInfo(bool use_arena)
       : create_arena(use_arena) {}
@@ -27,11 +34,19 @@ class CPUExecutionProvider : public IExecutionProvider {
  public:
   explicit CPUExecutionProvider(const CPUExecutionProviderInfo& info)
       : IExecutionProvider{onnxruntime::kCpuExecutionProvider} {
-    DeviceAllocatorRegistrationInfo device_info{OrtMemTypeDefault,
-                                                [](int) { return std::make_unique<CPUAllocator>(); },
-                                                std::numeric_limits<size_t>::max()};
+    MemoryRegionOptions region_options;
+    region_options.use_huge_pages = info.use_huge_pages;
+    region_options.numa_node = info.numa_node;
+    const bool use_regions = info.use_huge_pages || info.numa_node >= 0;
+    DeviceAllocatorRegistrationInfo device_info{
+        OrtMemTypeDefault,
+        [use_regions, region_options](int) -> std::unique_ptr<IDeviceAllocator> {
+          if (use_regions)
+            return std::make_unique<CPURegionAllocator>(region_options);
+          return std::make_unique<CPUAllocator>();
+        },
+        info.arena_max_bytes != 0 ? info.arena_max_bytes : std::numeric_limits<size_t>::max()};
 #ifdef USE_JEMALLOC
-    ORT_UNUSED_PARAMETER(info);
     //JEMalloc already has memory pool, so just use device allocator.
     InsertAllocator(
         std::shared_ptr<IArenaAllocator>(
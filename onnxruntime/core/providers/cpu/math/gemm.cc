@@ -5,10 +5,81 @@
 
 namespace onnxruntime {
 
-ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
+ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
     Gemm,
     7,
     9,
+    float,
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
     Gemm<float, float, float, float>);
-}
\ No newline at end of file
+
+ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
+    Gemm,
+    7,
+    9,
+    MLFloat16,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<MLFloat16>()),
+    Gemm<MLFloat16, MLFloat16, MLFloat16, MLFloat16>);
+
+// The half precision gemm computes in float. X, the bias and the output are converted through temporary
+// buffers, while W is converted a panel at a time as the gemm packs it.
+template <>
+Status Gemm<MLFloat16, MLFloat16, MLFloat16, MLFloat16>::Compute(OpKernelContext* context) const {
+  const auto X = context->Input<Tensor>(0);
+  const auto W = context->Input<Tensor>(1);
+  const auto B = context->Input<Tensor>(2);
+  GemmHelper helper(X->Shape(), trans_A_ != CblasNoTrans, W->Shape(), trans_B_ != CblasNoTrans, B->Shape());
+
+  if (!helper.State().IsOK())
+    return helper.State();
+
+  int64_t M = helper.M();
+  int64_t N = helper.N();
+  int64_t K = helper.K();
+  auto Y = context->Output(0, TensorShape({M, N}));
+  // if input is emtpy tensor, return directly as nothing need to be calculated.
+  if (M == 0 || N == 0)
+    return Status::OK();
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  BufferUniquePtr x_buffer(alloc->Alloc(sizeof(float) * M * K), BufferDeleter(alloc));
+  float* x_data = static_cast<float*>(x_buffer.get());
+  math::halfToFloatBuffer(X->template Data<MLFloat16>(), x_data, M * K);
+
+  BufferUniquePtr y_buffer(alloc->Alloc(sizeof(float) * M * N), BufferDeleter(alloc));
+  float* y_data = static_cast<float*>(y_buffer.get());
+
+  if (beta_ != 0) {
+    const int64_t b_size = B->Shape().Size();
+    BufferUniquePtr b_buffer(alloc->Alloc(sizeof(float) * b_size), BufferDeleter(alloc));
+    float* b_data = static_cast<float*>(b_buffer.get());
+    math::halfToFloatBuffer(B->template Data<MLFloat16>(), b_data, b_size);
+    GemmBroadcastBias<float>(M, N, b_data, B->Shape(), y_data);
+  }
+
+  math::GemmExReducedB<MLFloat16, CPUMathUtil>(
+      trans_A_,
+      trans_B_,
+      static_cast<int>(M),
+      static_cast<int>(N),
+      static_cast<int>(K),
+      alpha_,
+      x_data,
+      static_cast<int>(trans_A_ == CblasNoTrans ? K : M),
+      W->template Data<MLFloat16>(),
+      static_cast<int>(trans_B_ == CblasNoTrans ? N : K),
+      beta_,
+      y_data,
+      static_cast<int>(N),
+      &CPUMathUtil::Instance());
+
+  FuseActivation<float>(activation_, y_data, M * N, leaky_relu_alpha_);
+
+  math::floatToHalfBuffer(y_data, Y->template MutableData<MLFloat16>(), M * N);
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -11,6 +11,39 @@
 
 namespace onnxruntime {
 
+// Initializes the M x N output with the bias, broadcast from the shape of B.
+template <typename T>
+void GemmBroadcastBias(int64_t M, int64_t N, const T* b_data, const TensorShape& b_shape, T* y_data) {
+  auto output_mat = EigenMatrixMapRowMajor<T>(y_data, M, N);
+  output_mat.setZero();
+
+  // if B is (), (1,) or (1, 1), add the scalar
+  if (b_shape.Size() == 1) {
+    output_mat.array() += *b_data;
+  }
+  // B is (N,)
+  else if (b_shape.NumDimensions() == 1) {
+    auto bias_vec = ConstEigenVectorMap<T>(b_data, N);
+    output_mat.rowwise() += bias_vec.transpose();
+  } else if (b_shape.NumDimensions() == 2) {
+    // B is (M, 1)
+    if (b_shape[1] == 1) {
+      auto bias_vec = ConstEigenVectorMap<T>(b_data, M);
+      output_mat.colwise() += bias_vec;
+    }
+    // B is (1, N)
+    else if (b_shape[0] == 1) {
+      auto bias_vec = ConstEigenVectorMap<T>(b_data, N);
+      output_mat.rowwise() += bias_vec.transpose();
+    }
+    // B is (M, N), no broadcast needed.
+    else {
+      auto bias_mat = ConstEigenMatrixMapRowMajor<T>(b_data, M, N);
+      output_mat += bias_mat;
+    }
+  }
+}
+
 template <typename T_X,
           typename T_W,
           typename T_B,
@@ -51,47 +84,7 @@ class Gemm : public OpKernel {
     // Todo: we might should move this part into math::gemm to let eigen
     // have better chance to further optimize it.
     if (beta_ != 0) {
-      auto output_mat = EigenMatrixMapRowMajor<T_Y>(
-          Y->template MutableData<T_Y>(),
-          M,
-          N);
-      output_mat.setZero();
-
-      auto& b_shape = B->Shape();
-      // if B is (), (1,) or (1, 1), add the scalar
-      if (b_shape.Size() == 1) {
-        output_mat.array() += *(B->template Data<T_B>());
-      }
-      // B is (N,)
-      else if (b_shape.NumDimensions() == 1) {
-        auto bias_vec = ConstEigenVectorMap<T_B>(
-            B->template Data<T_B>(),
-            N);
-        output_mat.rowwise() += bias_vec.transpose();
-      } else if (b_shape.NumDimensions() == 2) {
-        // B is (M, 1)
-        if (b_shape[1] == 1) {
-          auto bias_vec = ConstEigenVectorMap<T_B>(
-              B->template Data<T_B>(),
-              M);
-          output_mat.colwise() += bias_vec;
-        }
-        // B is (1, N)
-        else if (b_shape[0] == 1) {
-          auto bias_vec = ConstEigenVectorMap<T_B>(
-              B->template Data<T_B>(),
-              N);
-          output_mat.rowwise() += bias_vec.transpose();
-        }
-        // B is (M, N), no broadcast needed.
-        else {
-          auto bias_mat = ConstEigenMatrixMapRowMajor<T_B>(
-              B->template Data<T_B>(),
-              M,
-              N);
-          output_mat += bias_mat;
-        }
-      }
+      GemmBroadcastBias<T_Y>(M, N, B->template Data<T_B>(), B->Shape(), y_data);
     }
 
     // W * x
@@ -125,4 +118,7 @@ protected:
   float leaky_relu_alpha_;
 };
 
+template <>
+Status Gemm<MLFloat16, MLFloat16, MLFloat16, MLFloat16>::Compute(OpKernelContext* context) const;
+
 }  // namespace onnxruntime
@@ -23,6 +23,13 @@ ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<double>()),
     MatMul<double>);
 
+ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
+    MatMul,
+    1, 9,
+    MLFloat16,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<MLFloat16>()),
+    MatMul<MLFloat16>);
+
 ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
     MatMul,
     9, 9,
@@ -81,4 +88,54 @@ Status MatMul<T>::Compute(OpKernelContext* ctx) const {
   return Status::OK();
 }
 
+// The half precision matmul computes in float. The left matrix and the output are converted through
+// temporary buffers, while the right matrix, usually the weights, is converted as the gemm packs it.
+template <>
+Status MatMul<MLFloat16>::Compute(OpKernelContext* ctx) const {
+  const Tensor* left_X = ctx->Input<Tensor>(0);
+  const Tensor* right_X = ctx->Input<Tensor>(1);
+
+  MatMulComputeHelper helper;
+  ORT_RETURN_IF_ERROR(helper.Compute(left_X->Shape(), right_X->Shape()));
+
+  Tensor* Y = ctx->Output(0, helper.OutputShape());
+
+  const int64_t M = helper.M();
+  const int64_t N = helper.N();
+  const int64_t K = helper.K();
+  if (M == 0 || N == 0)
+    return Status::OK();
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
+
+  BufferUniquePtr a_buffer(alloc->Alloc(sizeof(float) * M * K), BufferDeleter(alloc));
+  float* a_data = static_cast<float*>(a_buffer.get());
+  BufferUniquePtr y_buffer(alloc->Alloc(sizeof(float) * M * N), BufferDeleter(alloc));
+  float* y_data = static_cast<float*>(y_buffer.get());
+
+  size_t max_len = helper.OutputOffsets().size();
+  for (size_t i = 0; i < max_len; i++) {
+    math::halfToFloatBuffer(left_X->template Data<MLFloat16>() + helper.LeftOffsets()[i], a_data, M * K);
+    math::GemmExReducedB<MLFloat16, CPUMathUtil>(
+        CblasNoTrans,
+        CblasNoTrans,
+        static_cast<int>(M),
+        static_cast<int>(N),
+        static_cast<int>(K),
+        /* alpha */ 1.0f,
+        a_data,
+        static_cast<int>(K),
+        right_X->template Data<MLFloat16>() + helper.RightOffsets()[i],
+        static_cast<int>(N),
+        /* beta */ 0.0f,
+        y_data,
+        static_cast<int>(N),
+        &CPUMathUtil::Instance());
+    math::floatToHalfBuffer(y_data, Y->template MutableData<MLFloat16>() + helper.OutputOffsets()[i], M * N);
+  }
+
+  return Status::OK();
+}
+
 }  // namespace onnxruntime
@@ -2,7 +2,9 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
@@ -16,24 +18,39 @@ class DictVectorizerOp final : public OpKernel {
     //In some stupid models, the vocabulary could have duplicated elements.
     //We must support that, otherwise some tests will be break.
     ORT_ENFORCE(info.GetAttrs(std::is_same<AttrType, std::string>::value ? "string_vocabulary" : "int64_vocabulary", vocabulary_).IsOK());
+    vocabulary_index_.reserve(vocabulary_.size());
+    for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
+      vocabulary_index_.emplace(vocabulary_[i], static_cast<int64_t>(i));
+    }
   }
   common::Status Compute(OpKernelContext* ctx) const override {
     auto map = ctx->Input<std::map<AttrType, TargetType> >(0);
     auto Y = ctx->Output(0, TensorShape({1, static_cast<int64_t>(vocabulary_.size())}));
     auto* y_data = Y->template MutableData<TargetType>();
-    for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
-      auto index = map->find(vocabulary_[i]);
-      if (index != map->end()) {
-        *y_data++ = index->second;
-      } else {
-        //Any keys not present in the input dictionary, will be zero in the output array
-        *y_data++ = TargetType();
+    //Any keys not present in the input dictionary, will be zero in the output array
+    std::fill_n(y_data, vocabulary_.size(), TargetType());
+    if (map->size() < vocabulary_.size()) {
+      // sparse input: look up each entry of the map in the vocabulary instead of searching the map per word
+      for (const auto& entry : *map) {
+        auto range = vocabulary_index_.equal_range(entry.first);
+        for (auto it = range.first; it != range.second; ++it) {
+          y_data[it->second] = entry.second;
+        }
+      }
+    } else {
+      for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
+        auto index = map->find(vocabulary_[i]);
+        if (index != map->end()) {
+          y_data[i] = index->second;
+        }
       }
     }
     return Status::OK();
   }
 
   std::vector<AttrType> vocabulary_;
+  // vocabulary entry to output position(s). a word can be repeated in the vocabulary.
+  std::unordered_multimap<AttrType, int64_t> vocabulary_index_;
 };
 
 }  // namespace ml
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+namespace ml {
+
+namespace flat_lookup_table_internal {
+
+// Mix the bits of a hash so the low bits used for the slot index depend on all of the input.
+// std::hash<int64_t> is the identity with most standard libraries, which would make strided keys
+// collide in a power of two sized table.
+inline uint64_t MixHash(uint64_t h) noexcept {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename TKey>
+inline bool KeyEquals(const TKey& lhs, const TKey& rhs) noexcept {
+  return lhs == rhs;
+}
+
+// compare the lengths first so mismatches are usually rejected without touching the characters,
+// and let memcmp (which is vectorized by the C runtime) compare the characters.
+template <>
+inline bool KeyEquals<std::string>(const std::string& lhs, const std::string& rhs) noexcept {
+  return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+}  // namespace flat_lookup_table_internal
+
+// Inputs with fewer elements are looked up on the calling thread, as starting the OpenMP threads costs more than
+// the lookups of a small batch.
+constexpr int64_t kMinElementsForParallelLookup = 1024;
+
+/**
+ * Read-only hash table for the vocabularies of the traditional ML operators.
+ * It is built once when the kernel is created and only looked up during Compute, so it uses
+ * open addressing with linear probing over a single array of slots. Each slot holds the full hash
+ * of its key so most probes are resolved by comparing integers, and the key itself is only compared
+ * on a hash match. Lookups do not allocate and are safe to run concurrently.
+ */
+template <typename TKey, typename TValue>
+class FlatLookupTable {
+ public:
+  FlatLookupTable() = default;
+
+  /**
+   * Add or replace an entry. Must not be called after the table is in use by Compute.
+   * If a key is added more than once the last value wins, matching std::unordered_map::operator[].
+   */
+  void Insert(const TKey& key, const TValue& value) {
+    if ((keys_.size() + 1) * 2 > slots_.size()) {
+      Rehash(slots_.empty() ? 16 : slots_.size() * 2);
+    }
+
+    const uint64_t hash = Hash(key);
+    size_t pos = static_cast<size_t>(hash) & mask_;
+    for (;; pos = (pos + 1) & mask_) {
+      Slot& slot = slots_[pos];
+      if (slot.index == kEmpty) {
+        slot.hash = hash;
+        slot.index = static_cast<uint32_t>(keys_.size());
+        keys_.push_back(key);
+        values_.push_back(value);
+        return;
+      }
+
+      if (slot.hash == hash && flat_lookup_table_internal::KeyEquals(keys_[slot.index], key)) {
+        values_[slot.index] = value;
+        return;
+      }
+    }
+  }
+
+  void Reserve(size_t num_entries) {
+    size_t capacity = 16;
+    while (capacity < num_entries * 2) {
+      capacity *= 2;
+    }
+
+    if (capacity > slots_.size()) {
+      Rehash(capacity);
+    }
+
+    keys_.reserve(num_entries);
+    values_.reserve(num_entries);
+  }
+
+  // Returns a pointer to the value for 'key', or nullptr if the key is not in the table.
+  const TValue* Find(const TKey& key) const noexcept {
+    if (keys_.empty()) {
+      return nullptr;
+    }
+
+    const uint64_t hash = Hash(key);
+    for (size_t pos = static_cast<size_t>(hash) & mask_;; pos = (pos + 1) & mask_) {
+      const Slot& slot = slots_[pos];
+      if (slot.index == kEmpty) {
+        return nullptr;
+      }
+
+      if (slot.hash == hash && flat_lookup_table_internal::KeyEquals(keys_[slot.index], key)) {
+        return &values_[slot.index];
+      }
+    }
+  }
+
+  // Returns the value for 'key', or 'default_value' if the key is not in the table.
+  const TValue& FindOrDefault(const TKey& key, const TValue& default_value) const noexcept {
+    const TValue* value = Find(key);
+    return value != nullptr ? *value : default_value;
+  }
+
+  size_t size() const noexcept { return keys_.size(); }
+  bool empty() const noexcept { return keys_.empty(); }
+
+ private:
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+  struct Slot {
+    uint64_t hash = 0;
+    uint32_t index = kEmpty;
+  };
+
+  static uint64_t Hash(const TKey& key) noexcept {
+    return flat_lookup_table_internal::MixHash(static_cast<uint64_t>(std::hash<TKey>{}(key)));
+  }
+
+  void Rehash(size_t capacity) {
+    ORT_ENFORCE(keys_.size() < kEmpty, "Too many entries for FlatLookupTable");
+
+    std::vector<Slot> slots(capacity);
+    const size_t mask = capacity - 1;
+
+    for (const Slot& slot : slots_) {
+      if (slot.index != kEmpty) {
+        size_t pos = static_cast<size_t>(slot.hash) & mask;
+        while (slots[pos].index != kEmpty) {
+          pos = (pos + 1) & mask;
+        }
+        slots[pos] = slot;
+      }
+    }
+
+    slots_.swap(slots);
+    mask_ = mask;
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+
+  // entries are stored densely in insertion order, and the slots refer to them by index
+  std::vector<TKey> keys_;
+  std::vector<TValue> values_;
+};
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -2,8 +2,6 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/label_encoder.h"
-#include <algorithm>
-#include <gsl/span>
 using namespace ::onnxruntime::common;
 
 namespace onnxruntime {
@@ -33,35 +31,33 @@ Status LabelEncoder::Compute(OpKernelContext* context) const {
     if (Y.DataType() != DataTypeImpl::GetType<int64_t>())
       return Status(ONNXRUNTIME, FAIL, "Input of tensor(string) must have output of tensor(int64)");
 
-    auto input = gsl::make_span(X.template Data<std::string>(), shape.Size());
-    auto output = gsl::make_span(Y.template MutableData<int64_t>(), shape.Size());
-    auto out = output.begin();
+    const std::string* input = X.template Data<std::string>();
+    int64_t* output = Y.template MutableData<int64_t>();
+    const int64_t num_elements = shape.Size();
 
-    // map isn't going to change so get end() once instead of calling inside the for_each loop
-    const auto map_end = string_to_int_map_.end();
-
-    std::for_each(input.cbegin(), input.cend(),
-                  [&out, &map_end, this](const std::string& value) {
-                    auto map_to = string_to_int_map_.find(value);
-                    *out = map_to == map_end ? default_int_ : map_to->second;
-                    ++out;
-                  });
+    // rows are independent and the table is read-only so the lookups can run in parallel
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_elements >= kMinElementsForParallelLookup)
+#endif
+    for (int64_t i = 0; i < num_elements; ++i) {
+      output[i] = string_to_int_map_.FindOrDefault(input[i], default_int_);
+    }
   } else {
     if (Y.DataType() != DataTypeImpl::GetType<std::string>())
       return Status(ONNXRUNTIME, FAIL, "Input of tensor(int64) must have output of tensor(string)");
 
-    auto input = gsl::make_span(X.template Data<int64_t>(), shape.Size());
-    auto output = gsl::make_span(Y.template MutableData<std::string>(), shape.Size());
-    auto out = output.begin();
-
-    const auto map_end = int_to_string_map_.end();
+    const int64_t* input = X.template Data<int64_t>();
+    std::string* output = Y.template MutableData<std::string>();
+    const int64_t num_elements = shape.Size();
+    const auto num_classes = static_cast<int64_t>(classes_.size());
 
-    std::for_each(input.cbegin(), input.cend(),
-                  [&out, &map_end, this](const int64_t& value) {
-                    auto map_to = int_to_string_map_.find(value);
-                    *out = map_to == map_end ? default_string_ : map_to->second;
-                    ++out;
-                  });
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_elements >= kMinElementsForParallelLookup)
+#endif
+    for (int64_t i = 0; i < num_elements; ++i) {
+      const int64_t value = input[i];
+      output[i] = value >= 0 && value < num_classes ? classes_[value] : default_string_;
+    }
   }
 
   return Status::OK();
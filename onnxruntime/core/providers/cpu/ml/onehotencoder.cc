@@ -55,18 +55,46 @@ OneHotEncoderOp<T>::OneHotEncoderOp(const OpKernelInfo& info) : OpKernel(info),
   ORT_ENFORCE(tmp_cats_int64s.empty() || tmp_cats_strings.empty());
   if (!tmp_cats_int64s.empty()) {
     num_categories_ = tmp_cats_int64s.size();
+    cats_int64s_.Reserve(tmp_cats_int64s.size());
     for (size_t idx = 0, end = tmp_cats_int64s.size(); idx < end; ++idx) {
-      cats_int64s_[tmp_cats_int64s[idx]] = idx;
+      cats_int64s_.Insert(tmp_cats_int64s[idx], idx);
     }
   } else {
     num_categories_ = tmp_cats_strings.size();
+    cats_strings_.Reserve(tmp_cats_strings.size());
     for (size_t idx = 0, end = tmp_cats_strings.size(); idx < end; ++idx) {
-      cats_strings_[tmp_cats_strings[idx]] = idx;
+      cats_strings_.Insert(tmp_cats_strings[idx], idx);
     }
   }
   ORT_ENFORCE(num_categories_ > 0);
 }
 
+template <typename T>
+template <typename TKey, typename TInput>
+common::Status OneHotEncoderOp<T>::Encode(const FlatLookupTable<TKey, size_t>& categories, const TInput* x_data,
+                                          int64_t num_elements, float* y_data) const {
+  // every input element writes to its own row of the output so the rows can be encoded in parallel.
+  // an unknown category can't return from inside the omp loop so it is recorded and reported afterwards.
+  bool found_unknown = false;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(|| : found_unknown) if (num_elements >= kMinElementsForParallelLookup)
+#endif
+  for (int64_t i = 0; i < num_elements; ++i) {
+    // binding to a const reference avoids copying string inputs and converts numeric inputs to int64
+    const size_t* idx = categories.Find(static_cast<const TKey&>(x_data[i]));
+    if (idx != nullptr)
+      y_data[i * num_categories_ + *idx] = 1.0f;
+    else if (!zeros_)
+      found_unknown = true;
+  }
+
+  if (found_unknown)
+    return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
+
+  return Status::OK();
+}
+
 template <typename T>
 common::Status OneHotEncoderOp<T>::Compute(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
@@ -80,16 +108,7 @@ common::Status OneHotEncoderOp<T>::Compute(OpKernelContext* context) const {
   auto y_data = Y->template MutableData<float>();
   std::fill_n(y_data, Y->Shape().Size(), 0.0f);
 
-  auto x_data = X->template Data<T>();
-  std::unordered_map<int64_t, size_t>::const_iterator idx;
-  for (int64_t i = 0; i < input_shape.Size(); ++i) {
-    auto int_idx = cats_int64s_.find(static_cast<int64_t>(x_data[i]));
-    if (int_idx != cats_int64s_.cend())
-      y_data[i * num_categories_ + int_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
-  return Status::OK();
+  return Encode(cats_int64s_, X->template Data<T>(), input_shape.Size(), y_data);
 }
 
 template <>
@@ -105,15 +124,7 @@ common::Status OneHotEncoderOp<std::string>::Compute(OpKernelContext* context) c
   auto y_data = Y->template MutableData<float>();
   std::fill_n(y_data, Y->Shape().Size(), 0.0f);
 
-  auto x_data = X->template Data<std::string>();
-  for (int64_t i = 0; i < input_shape.Size(); ++i) {
-    auto str_idx = cats_strings_.find(x_data[i]);
-    if (str_idx != cats_strings_.cend())
-      y_data[i * num_categories_ + str_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
-  return Status::OK();
+  return Encode(cats_strings_, X->template Data<std::string>(), input_shape.Size(), y_data);
 }
 
 }  // namespace ml
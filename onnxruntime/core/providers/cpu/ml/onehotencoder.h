@@ -4,6 +4,7 @@
 #pragma once
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/ml/flat_lookup_table.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -14,8 +15,12 @@ class OneHotEncoderOp final : public OpKernel {
   common::Status Compute(OpKernelContext* context) const override;
 
  private:
-  std::unordered_map<int64_t, size_t> cats_int64s_;
-  std::unordered_map<std::string, size_t> cats_strings_;
+  template <typename TKey, typename TInput>
+  common::Status Encode(const FlatLookupTable<TKey, size_t>& categories, const TInput* x_data,
+                        int64_t num_elements, float* y_data) const;
+
+  FlatLookupTable<int64_t, size_t> cats_int64s_;
+  FlatLookupTable<std::string, size_t> cats_strings_;
   int64_t zeros_;
   int64_t num_categories_;
 };
@@ -3,6 +3,9 @@
 
 #include "core/providers/cpu/ml/zipmap.h"
 #include "core/util/math_cpuonly.h"
+
+#include <algorithm>
+#include <numeric>
 /**
 https://github.com/onnx/onnx/blob/master/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(ZipMap)
@@ -35,13 +38,76 @@ ONNX_CPU_OPERATOR_ML_KERNEL(
                                             DataTypeImpl::GetType<std::vector<std::map<std::int64_t, float>>>()}),
     ZipMapOp);
 
+template <typename TKey>
+static std::vector<size_t> GetSortedLabelIndices(const std::vector<TKey>& labels) {
+  std::vector<size_t> indices(labels.size());
+  std::iota(indices.begin(), indices.end(), size_t{0});
+  std::stable_sort(indices.begin(), indices.end(),
+                   [&labels](size_t lhs, size_t rhs) { return labels[lhs] < labels[rhs]; });
+
+  // a repeated label keeps the value of its last occurrence, as when assigning the entries in order
+  std::vector<size_t> unique_indices;
+  unique_indices.reserve(indices.size());
+  for (size_t i = 0, end = indices.size(); i < end; ++i) {
+    if (i + 1 < end && !(labels[indices[i]] < labels[indices[i + 1]])) {
+      continue;
+    }
+    unique_indices.push_back(indices[i]);
+  }
+
+  return unique_indices;
+}
+
 ZipMapOp::ZipMapOp(const OpKernelInfo& info)
     : OpKernel(info),
-      classlabels_int64s_(info.GetAttrsOrDefault<int64_t>("classlabels_int64s")),
-      classlabels_strings_(info.GetAttrsOrDefault<std::string>("classlabels_strings")) {
-  ORT_ENFORCE(classlabels_strings_.empty() ^ classlabels_int64s_.empty(),
+      classlabels_int64s_(std::make_shared<const std::vector<int64_t>>(
+          info.GetAttrsOrDefault<int64_t>("classlabels_int64s"))),
+      classlabels_strings_(std::make_shared<const std::vector<std::string>>(
+          info.GetAttrsOrDefault<std::string>("classlabels_strings"))) {
+  ORT_ENFORCE(classlabels_strings_->empty() ^ classlabels_int64s_->empty(),
               "Must provide classlabels_strings or classlabels_int64s but not both.");
-  using_strings_ = !classlabels_strings_.empty();
+  using_strings_ = !classlabels_strings_->empty();
+  sorted_label_indices_ = using_strings_ ? GetSortedLabelIndices(*classlabels_strings_)
+                                         : GetSortedLabelIndices(*classlabels_int64s_);
+}
+
+template <typename TKey>
+common::Status ZipMapOp::ComputeImpl(OpKernelContext* context,
+                                     const std::shared_ptr<const std::vector<TKey>>& classlabels,
+                                     const std::vector<size_t>& sorted_label_indices,
+                                     const float* x_data, int64_t batch_size, int64_t features_per_batch) const {
+  if (features_per_batch != static_cast<int64_t>(classlabels->size())) {
+    return Status(ONNXRUNTIME,
+                  INVALID_ARGUMENT,
+                  "Input features_per_batch[" + std::to_string(features_per_batch) +
+                      "] != number of classlabels[" + std::to_string(classlabels->size()) + "]");
+  }
+
+  // The execution plan selects the columnar representation when the session enables it and nothing else in the
+  // graph consumes the output. The labels are shared and the probabilities are copied in a single block.
+  auto* y_columnar = context->TryOutput<ColumnarMapSequence<TKey, float>>(0);
+  if (y_columnar != nullptr) {
+    y_columnar->Assign(classlabels, x_data, static_cast<size_t>(batch_size));
+    return common::Status::OK();
+  }
+
+  auto* y_data = context->Output<std::vector<std::map<TKey, float>>>(0);
+  if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
+
+  const std::vector<TKey>& labels = *classlabels;
+  y_data->resize(batch_size);
+  int64_t current_weight_0 = 0;
+  for (int64_t n = 0; n < batch_size; n++) {
+    std::map<TKey, float>& map = (*y_data)[n];
+    map.clear();
+    // the labels are visited in key order so each insert can use the end of the map as the hint
+    for (size_t j : sorted_label_indices) {
+      map.emplace_hint(map.end(), labels[j], x_data[current_weight_0 + j]);
+    }
+    current_weight_0 += features_per_batch;
+  }
+
+  return common::Status::OK();
 }
 
 common::Status ZipMapOp::Compute(OpKernelContext* context) const {
@@ -49,7 +115,7 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
   if (tensor_pointer == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
   const Tensor& X = *tensor_pointer;
   const TensorShape& x_shape = X.Shape();
-  const vector<int64_t> x_dims = x_shape.GetDims();
+  const vector<int64_t>& x_dims = x_shape.GetDims();
 
   if (x_dims.empty()) {
     return Status(ONNXRUNTIME,
@@ -69,48 +135,10 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
   const float* x_data = X.template Data<float>();
 
   if (using_strings_) {
-    if (features_per_batch != static_cast<int64_t>(classlabels_strings_.size())) {
-      return Status(ONNXRUNTIME,
-                    INVALID_ARGUMENT,
-                    "Input features_per_batch[" + std::to_string(features_per_batch) +
-                        "] != number of classlabels[" + std::to_string(classlabels_strings_.size()) + "]");
-    }
-    auto* y_data = context->Output<std::vector<std::map<std::string, float>>>(0);
-    if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
-
-    //auto* y_data = Y->template MutableData<std::vector<std::map<std::string, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int n = 0; n < batch_size; n++) {
-      std::map<std::string, float> map1;
-      for (int j = 0; j < features_per_batch; j++) {
-        map1[classlabels_strings_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map1);
-    }
-  } else {
-    if (features_per_batch != static_cast<int64_t>(classlabels_int64s_.size())) {
-      return Status(ONNXRUNTIME,
-                    INVALID_ARGUMENT,
-                    "Input features_per_batch[" + std::to_string(features_per_batch) +
-                        "] != number of classlabels[" + std::to_string(classlabels_int64s_.size()) + "]");
-    }
-    auto* y_data = context->Output<std::vector<std::map<std::int64_t, float>>>(0);
-    if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
-    //auto* y_data = Y->template MutableData<std::vector<std::map<int64_t, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int n = 0; n < batch_size; n++) {
-      std::map<int64_t, float> map2;
-      for (int j = 0; j < features_per_batch; j++) {
-        map2[classlabels_int64s_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map2);
-    }
+    return ComputeImpl(context, classlabels_strings_, sorted_label_indices_, x_data, batch_size, features_per_batch);
   }
-  return common::Status::OK();
+
+  return ComputeImpl(context, classlabels_int64s_, sorted_label_indices_, x_data, batch_size, features_per_batch);
 }
 }  // namespace ml
 }  // namespace onnxruntime
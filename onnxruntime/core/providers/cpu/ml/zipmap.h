@@ -3,6 +3,7 @@
 
 #pragma once
 #include "core/common/common.h"
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/op_kernel.h"
 namespace onnxruntime {
 namespace ml {
@@ -13,9 +14,18 @@ class ZipMapOp final : public OpKernel {
   common::Status Compute(OpKernelContext* context) const override;
 
  private:
+  template <typename TKey>
+  common::Status ComputeImpl(OpKernelContext* context, const std::shared_ptr<const std::vector<TKey>>& classlabels,
+                             const std::vector<size_t>& sorted_label_indices,
+                             const float* x_data, int64_t batch_size, int64_t features_per_batch) const;
+
   bool using_strings_;
-  std::vector<int64_t> classlabels_int64s_;
-  std::vector<std::string> classlabels_strings_;
+  // shared with any columnar outputs so the labels are not copied per run
+  std::shared_ptr<const std::vector<int64_t>> classlabels_int64s_;
+  std::shared_ptr<const std::vector<std::string>> classlabels_strings_;
+  // indices of the labels in key order, keeping only the last occurrence of a repeated label.
+  // used to build each output map with O(1) hinted inserts.
+  std::vector<size_t> sorted_label_indices_;
 };
 
 }  // namespace ml
@@ -82,6 +82,16 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     &Activation,
                     &WorkingBufferSize);
 
+    // A constant filter is transformed once for the Winograd algorithm and then shared by every run.
+    if (Parameters.Algorithm == MlasConvAlgorithmWinograd && filter_is_constant_) {
+      std::call_once(transformed_filter_once_, [&]() {
+        transformed_filter_.resize(Parameters.u.Winograd.FilterSize);
+        MlasConvTransformFilter(&Parameters, W->template Data<float>(), transformed_filter_.data());
+      });
+      Parameters.u.Winograd.TransformedFilter = transformed_filter_.data();
+      WorkingBufferSize -= Parameters.u.Winograd.FilterSize;
+    }
+
     auto working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * WorkingBufferSize) : nullptr;
     BufferUniquePtr working_buffer(working_data, BufferDeleter(alloc));
 
@@ -155,9 +165,140 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
-ONNX_CPU_OPERATOR_KERNEL(
+// The half precision convolution computes in float. Each image is converted to float and expanded with im2col,
+// and the gemm is arranged so that the filter is its B operand and is converted as the gemm packs it.
+template <>
+Status Conv<MLFloat16>::Compute(OpKernelContext* context) const {
+  size_t num_inputs = OpKernel::Node().InputDefs().size();
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* B = num_inputs == 3 ? context->Input<Tensor>(2) : nullptr;
+  const int64_t N = X->Shape()[0];
+  const int64_t C = X->Shape()[1];
+  const int64_t M = W->Shape()[0];
+  ORT_RETURN_IF_ERROR(ValidateInputShape(X, W));
+
+  std::vector<int64_t> kernel_shape;
+  ORT_RETURN_IF_ERROR(ComputeKernelShape(W->Shape(), kernel_shape));
+
+  std::vector<int64_t> pads(pads_);
+  if (pads.empty()) {
+    pads.resize(kernel_shape.size() * 2, 0);
+  }
+  std::vector<int64_t> dilations(dilations_);
+  if (dilations.empty()) {
+    dilations.resize(kernel_shape.size(), 1);
+  }
+  std::vector<int64_t> strides(strides_);
+  if (strides.empty()) {
+    strides.resize(kernel_shape.size(), 1);
+  }
+
+  std::vector<int64_t> Y_dims;
+  Y_dims.insert(Y_dims.begin(), {N, M});
+  TensorShape input_shape = X->Shape().Slice(2);
+  ORT_RETURN_IF_ERROR(InferOutputShape(input_shape, kernel_shape, strides, dilations, &pads, &Y_dims));
+  Tensor* Y = context->Output(0, TensorShape(Y_dims));
+  TensorShape output_shape = Y->Shape().Slice(2);
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  const int64_t input_image_size = input_shape.Size();
+  const int64_t output_image_size = output_shape.Size();
+  const int64_t kernel_size = TensorShape(kernel_shape).Size();
+  const int64_t X_offset = C / group_ * input_image_size;
+  const int64_t W_offset = W->Shape().Size() / group_;
+  const int64_t kernel_dim = C / group_ * kernel_size;
+  const int64_t col_buffer_size = kernel_dim * output_image_size;
+
+  BufferUniquePtr x_buffer(alloc->Alloc(sizeof(float) * C * input_image_size), BufferDeleter(alloc));
+  float* x_data = static_cast<float*>(x_buffer.get());
+  BufferUniquePtr col_buffer(alloc->Alloc(sizeof(float) * col_buffer_size), BufferDeleter(alloc));
+  float* col_buffer_data = static_cast<float*>(col_buffer.get());
+  // The gemm produces the transposed output image, with a row of M channels for each output position.
+  BufferUniquePtr gemm_buffer(alloc->Alloc(sizeof(float) * output_image_size * M), BufferDeleter(alloc));
+  float* gemm_data = static_cast<float*>(gemm_buffer.get());
+  BufferUniquePtr y_buffer(alloc->Alloc(sizeof(float) * M * output_image_size), BufferDeleter(alloc));
+  float* y_data = static_cast<float*>(y_buffer.get());
+
+  std::vector<float> bias;
+  if (B != nullptr) {
+    bias.resize(M);
+    math::halfToFloatBuffer(B->template Data<MLFloat16>(), bias.data(), M);
+  }
+
+  const MLFloat16* Xdata = X->template Data<MLFloat16>();
+  MLFloat16* Ydata = Y->template MutableData<MLFloat16>();
+
+  TensorShape image_shape = X->Shape().Slice(1);
+  std::vector<int64_t> col_buffer_shape{kernel_dim};
+  col_buffer_shape.insert(col_buffer_shape.end(), output_shape.GetDims().begin(),
+                          output_shape.GetDims().end());
+
+  for (int image_id = 0; image_id < N; ++image_id) {
+    math::halfToFloatBuffer(Xdata, x_data, C * input_image_size);
+
+    for (int group_id = 0; group_id < group_; ++group_id) {
+      math::Im2colNd<float, CPUMathUtil, StorageOrder::NCHW>()(
+          x_data + group_id * X_offset,
+          image_shape.GetDims().data(),
+          col_buffer_shape.data(),
+          C * input_image_size,
+          col_buffer_size,
+          kernel_shape.data(),
+          strides.data(),
+          dilations.data(),
+          pads.data(),
+          static_cast<int>(kernel_shape.size()),
+          col_buffer_data,
+          &CPUMathUtil::Instance());
+      math::GemmExReducedB<MLFloat16, CPUMathUtil>(
+          CblasTrans,
+          CblasTrans,
+          static_cast<int>(output_image_size),
+          static_cast<int>(M / group_),
+          static_cast<int>(kernel_dim),
+          1,
+          col_buffer_data,
+          static_cast<int>(output_image_size),
+          W->template Data<MLFloat16>() + group_id * W_offset,
+          static_cast<int>(kernel_dim),
+          0,
+          gemm_data + group_id * (M / group_),
+          static_cast<int>(M),
+          &CPUMathUtil::Instance());
+    }
+
+    auto Ymatrix = EigenMatrixMap<float>(y_data, output_image_size, M);
+    Ymatrix = ConstEigenMatrixMap<float>(gemm_data, M, output_image_size).transpose();
+    if (B != nullptr) {
+      auto Bvec = ConstEigenVectorMap<float>(bias.data(), M);
+      Ymatrix.rowwise() += Bvec.transpose();
+    }
+
+    FuseActivation(activation_, y_data, M * output_image_size, alpha_);
+
+    math::floatToHalfBuffer(y_data, Ydata, M * output_image_size);
+
+    Xdata += X_offset * group_;
+    Ydata += M * output_image_size;
+  }
+
+  return Status::OK();
+}
+
+ONNX_CPU_OPERATOR_TYPED_KERNEL(
     Conv,
     1,
+    float,
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
     Conv<float>);
+
+ONNX_CPU_OPERATOR_TYPED_KERNEL(
+    Conv,
+    1,
+    MLFloat16,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<MLFloat16>()),
+    Conv<MLFloat16>);
 }  // namespace onnxruntime
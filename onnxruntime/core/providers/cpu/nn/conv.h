@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <vector>
 #include "core/providers/cpu/nn/conv_base.h"
 
 namespace onnxruntime {
@@ -25,9 +27,17 @@ template <typename T>
 class Conv : public OpKernel, public ConvBase {
  public:
   Conv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
+    const Tensor* W;
+    filter_is_constant_ = info.TryGetConstantInput(1, &W);
   }
 
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // The filter transformed for the MLAS Winograd algorithm, computed on first use if the filter is constant.
+  bool filter_is_constant_{false};
+  mutable std::once_flag transformed_filter_once_;
+  mutable std::vector<float> transformed_filter_;
 };
 
 }  // namespace onnxruntime
@@ -150,4 +150,7 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
 template <>
 Status Conv<float>::Compute(OpKernelContext* context) const;
 
+template <>
+Status Conv<MLFloat16>::Compute(OpKernelContext* context) const;
+
 }  // namespace onnxruntime
@@ -5,14 +5,15 @@
 #include "onnx/defs/schema.h"
 #include "core/common/common.h"
 #include "core/framework/tensor.h"
+#include "core/common/utf8_util.h"
 
 #ifdef _MSC_VER
 #include <locale.h>
 #endif
 
-#include <codecvt>
+#include <cstring>
+#include <limits>
 #include <locale>
-#include <functional>
 #include <unordered_set>
 
 namespace onnxruntime {
@@ -25,8 +26,10 @@ ONNX_CPU_OPERATOR_KERNEL(
     StringNormalizer);
 
 namespace string_normalizer {
-const std::string conv_error("Conversion Error");
-const std::wstring wconv_error(L"Conversion Error");
+
+// Inputs with fewer strings are processed on the calling thread, as starting the OpenMP threads costs more than
+// normalizing the handful of strings StringNormalizer usually gets.
+constexpr int64_t kMinStringsForParallelism = 1024;
 
 // We need to specialize for MS as there is
 // a std::locale creation bug that affects different
@@ -52,16 +55,9 @@ class Locale {
 
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Locale);
 
-  void ChangeCase(StringNormalizer::CaseAction caseaction,
-                  std::wstring& wstr) const {
+  wchar_t ChangeCase(StringNormalizer::CaseAction caseaction, wchar_t ch) const {
     assert(caseaction != StringNormalizer::NONE);
-    if (caseaction == StringNormalizer::LOWER) {
-      std::transform(wstr.begin(), wstr.end(), wstr.begin(),
-                     [this](wchar_t ch) { return ::_towlower_l(ch, loc_); });
-    } else {
-      std::transform(wstr.begin(), wstr.end(), wstr.begin(),
-                     [this](wchar_t ch) { return ::_towupper_l(ch, loc_); });
-    }
+    return (caseaction == StringNormalizer::LOWER) ? ::_towlower_l(ch, loc_) : ::_towupper_l(ch, loc_);
   }
 
  private:
@@ -73,7 +69,8 @@ const std::string default_locale("en-US");
 #else
 class Locale {
  public:
-  explicit Locale(const std::string& name) try : loc_(name) {
+  explicit Locale(const std::string& name) try : loc_(name),
+                                                 ctype_(std::use_facet<std::ctype<wchar_t>>(loc_)) {
   } catch (const std::runtime_error& e) {
     ORT_THROW("Failed to construct locale with name:",
               name, ":", e.what(), ":Please, install necessary language-pack-XX and configure locales");
@@ -81,74 +78,134 @@ class Locale {
 
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Locale);
 
-  void ChangeCase(StringNormalizer::CaseAction caseaction,
-                  std::wstring& wstr) const {
+  wchar_t ChangeCase(StringNormalizer::CaseAction caseaction, wchar_t ch) const {
     assert(caseaction != StringNormalizer::NONE);
-    if (caseaction == StringNormalizer::LOWER) {
-      std::transform(wstr.begin(), wstr.end(), wstr.begin(),
-                     [this](wchar_t ch) { return std::tolower(ch, loc_); });
-    } else {
-      std::transform(wstr.begin(), wstr.end(), wstr.begin(),
-                     [this](wchar_t ch) { return std::toupper(ch, loc_); });
-    }
+    return (caseaction == StringNormalizer::LOWER) ? ctype_.tolower(ch) : ctype_.toupper(ch);
   }
 
  private:
   std::locale loc_;
+  // the facet is owned by loc_, looking it up once keeps it out of the per character path
+  const std::ctype<wchar_t>& ctype_;
 };
 
 const std::string default_locale("en_US.UTF-8");
 
 #endif
 
-template <class ForwardIter>
-Status CopyCaseAction(ForwardIter first, ForwardIter end, OpKernelContext* ctx,
-                      const Locale& loc,
-                      std::wstring_convert<std::codecvt_utf8<wchar_t>>& converter,
-                      size_t N, size_t C,
-                      StringNormalizer::CaseAction caseaction) {
-  std::vector<int64_t> output_dims;
-  if (N == 1) {
-    output_dims.push_back(1);
+// Flips the case of the bytes of 'w' that are in the [first, last] range.
+// All bytes must be ASCII, so adding to a byte never carries into the next one.
+inline uint64_t ChangeAsciiCase(uint64_t w, unsigned char first, unsigned char last) {
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t above_last = w + ones * (0x7Fu - last);
+  const uint64_t from_first = w + ones * (0x80u - first);
+  const uint64_t in_range = from_first & ~above_last & (ones * 0x80u);
+  return w ^ (in_range >> 2);  // 0x80 >> 2 is the 0x20 case bit
+}
+
+/**
+ * Changes the case of utf8 strings without converting them to wide strings.
+ * When the locale maps ASCII like the C locale, which is the case for all but a few locales
+ * such as the Turkish ones, ASCII is processed 8 bytes at a time. The code points of up to
+ * two utf8 bytes (Latin, Greek, Cyrillic, Hebrew, Arabic...) are mapped through a table that
+ * is filled from the locale at construction, and only the remaining ones query the locale.
+ * The mapping is read-only after construction so it can be used from several threads.
+ */
+class Utf8CaseMapper {
+ public:
+  Utf8CaseMapper(const std::string& locale_name, StringNormalizer::CaseAction caseaction)
+      : locale_(locale_name), caseaction_(caseaction), table_(kTableSize) {
+    assert(caseaction != StringNormalizer::NONE);
+    ascii_fast_path_ = true;
+    for (char32_t cp = 0; cp < kTableSize; ++cp) {
+      table_[cp] = MapWithLocale(cp);
+      if (cp < 0x80u) {
+        char32_t expected = cp;
+        if (caseaction == StringNormalizer::LOWER && cp >= 'A' && cp <= 'Z') {
+          expected = cp + ('a' - 'A');
+        } else if (caseaction == StringNormalizer::UPPER && cp >= 'a' && cp <= 'z') {
+          expected = cp - ('a' - 'A');
+        }
+        ascii_fast_path_ = ascii_fast_path_ && table_[cp] == expected;
+      }
+    }
   }
 
-  // Empty output case
-  if (C == 0) {
-    output_dims.push_back(1);
-    TensorShape output_shape(output_dims);
-    // This will create one empty string
-    ctx->Output(0, output_shape);
-    return Status::OK();
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Utf8CaseMapper);
+
+  // Writes 's' with its case changed to 'out'. Returns false if 's' is not valid utf8.
+  bool ChangeCase(const std::string& s, std::string& out) const {
+    using namespace utf8_util;
+    const auto* const src = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t len = s.size();
+    const unsigned char first = (caseaction_ == StringNormalizer::LOWER) ? 'A' : 'a';
+    const unsigned char last = (caseaction_ == StringNormalizer::LOWER) ? 'Z' : 'z';
+
+    // The output has the length of the input unless a character maps to one of a different
+    // utf8 length, which is rare, so the output grows as needed and is trimmed at the end.
+    out.resize(len);
+    size_t out_idx = 0;
+    size_t idx = 0;
+    while (idx < len) {
+      uint64_t w;
+      if (ascii_fast_path_ && idx + sizeof(w) <= len) {
+        std::memcpy(&w, src + idx, sizeof(w));
+        if ((w & 0x8080808080808080ULL) == 0) {
+          if (out_idx + sizeof(w) > out.size()) {
+            out.resize(out.size() + len - idx + sizeof(w));
+          }
+          w = ChangeAsciiCase(w, first, last);
+          std::memcpy(&out[out_idx], &w, sizeof(w));
+          idx += sizeof(w);
+          out_idx += sizeof(w);
+          continue;
+        }
+      }
+
+      size_t char_len = 0;
+      size_t chars = 0;
+      if (!utf8_bytes(src[idx], char_len) || idx + char_len > len ||
+          !utf8_validate(src + idx, char_len, chars)) {
+        return false;
+      }
+      const char32_t cp = Map(utf8_decode(src + idx, char_len));
+      // at most 4 bytes per character
+      if (out_idx + 4 > out.size()) {
+        out.resize(out.size() + len - idx + 4);
+      }
+      out_idx += utf8_encode(cp, &out[out_idx]);
+      idx += char_len;
+    }
+    out.resize(out_idx);
+    return true;
   }
 
-  output_dims.push_back(C);
+ private:
+  static constexpr char32_t kTableSize = 0x800;
 
-  TensorShape output_shape(output_dims);
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->template MutableData<std::string>();
+  char32_t Map(char32_t cp) const {
+    return (cp < kTableSize) ? table_[cp] : MapWithLocale(cp);
+  }
 
-  size_t output_idx = 0;
-  while (first != end) {
-    auto& s = *first;
-    if (caseaction == StringNormalizer::LOWER || caseaction == StringNormalizer::UPPER) {
-      std::wstring wstr = converter.from_bytes(s);
-      if (wstr == wconv_error) {
-        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                      "Input contains invalid utf8 chars at: " + static_cast<const std::string&>(s));
-      }
-      // In place transform
-      loc.ChangeCase(caseaction, wstr);
-      *(output_data + output_idx) = converter.to_bytes(wstr);
-    } else {
-      assert(caseaction == StringNormalizer::NONE);
-      // Simple copy or move if the iterator points to a non-const string
-      *(output_data + output_idx) = std::move(s);
+  char32_t MapWithLocale(char32_t cp) const {
+    // wchar_t can only represent the basic multilingual plane on Windows
+    if (cp > static_cast<char32_t>(std::numeric_limits<wchar_t>::max())) {
+      return cp;
+    }
+    const char32_t mapped = static_cast<char32_t>(locale_.ChangeCase(caseaction_, static_cast<wchar_t>(cp)));
+    // keep the character if the locale maps it to something that can not be encoded
+    if (mapped > 0x10FFFFu || (mapped >= 0xD800u && mapped <= 0xDFFFu)) {
+      return cp;
     }
-    ++output_idx;
-    ++first;
+    return mapped;
   }
-  return Status::OK();
-}
+
+  Locale locale_;
+  StringNormalizer::CaseAction caseaction_;
+  bool ascii_fast_path_;
+  std::vector<char32_t> table_;
+};
+
 }  // namespace string_normalizer
 
 using namespace string_normalizer;
@@ -180,9 +237,16 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info),
     compare_caseaction_ = (case_change_action_ == UPPER) ? UPPER : LOWER;
   }
 
-  locale_name_ = info.GetAttrOrDefault("locale", default_locale);
-  Locale locale(locale_name_);
-  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter(conv_error, wconv_error);
+  // compare_caseaction_ is the same as case_change_action_ unless the output keeps the case,
+  // so a single mapper serves both
+  const std::string locale_name = info.GetAttrOrDefault("locale", default_locale);
+  const CaseAction mapper_caseaction = (case_change_action_ != NONE) ? case_change_action_ : compare_caseaction_;
+  if (mapper_caseaction != NONE) {
+    case_mapper_ = std::make_unique<Utf8CaseMapper>(locale_name, mapper_caseaction);
+  } else {
+    // still report an unavailable locale
+    Locale locale(locale_name);
+  }
 
   std::vector<std::string> swords = info.GetAttrsOrDefault<std::string>("stopwords");
   for (const auto& sw : swords) {
@@ -191,18 +255,30 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info),
       auto p = stopwords_.insert(sw);
       ORT_ENFORCE(p.second, "Duplicate stopwords not allowed");
     } else {
-      std::wstring wstr = converter.from_bytes(sw);
-      ORT_ENFORCE(wstr != wconv_error, "Stopword contains invalid utf8 chars");
-      locale.ChangeCase(compare_caseaction_, wstr);
-      auto p = wstopwords_.insert(wstr);
+      std::string cased;
+      ORT_ENFORCE(case_mapper_->ChangeCase(sw, cased), "Stopword contains invalid utf8 chars");
+      auto p = stopwords_.insert(std::move(cased));
       ORT_ENFORCE(p.second, "Duplicate stopwords not allowed");
     }
   }
 }
 
-Status StringNormalizer::Compute(OpKernelContext* ctx) const {
-  using namespace string_normalizer;
+StringNormalizer::~StringNormalizer() = default;
 
+// Returns the error for the first string that is not valid utf8
+static Status InvalidUtf8Error(const std::string* input_data, size_t C) {
+  for (size_t i = 0; i < C; ++i) {
+    size_t chars = 0;
+    const std::string& s = input_data[i];
+    if (!utf8_util::utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(), chars)) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                    "Input contains invalid utf8 chars at: " + s);
+    }
+  }
+  return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Input contains invalid utf8 chars");
+}
+
+Status StringNormalizer::Compute(OpKernelContext* ctx) const {
   auto X = ctx->Input<Tensor>(0);
   if (X == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
   auto& input_dims = X->Shape().GetDims();
@@ -227,70 +303,106 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
                   "Input dimensions are either[C > 0] or [1][C > 0] allowed");
   }
 
-  Status status;
-  Locale locale(locale_name_);
-  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter(conv_error, wconv_error);
   auto const input_data = X->template Data<std::string>();
-  using StrRef = std::reference_wrapper<const std::string>;
-  if (is_case_sensitive_) {
-    if (!stopwords_.empty()) {
-      std::vector<StrRef> filtered_strings;
-      filtered_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        if (0 == stopwords_.count(s)) {
-          filtered_strings.push_back(std::cref(s));
-        }
-        ++first;
-      }
-      status = CopyCaseAction(filtered_strings.cbegin(), filtered_strings.cend(), ctx, locale, converter,
-                              N, filtered_strings.size(), case_change_action_);
-    } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
+  const int64_t num_strings = static_cast<int64_t>(C);
+
+  // every string is filtered and case changed on its own, so the strings are processed in parallel.
+  // invalid utf8 can't return from inside the omp loops so it is recorded and reported afterwards.
+  bool invalid_utf8 = false;
+
+  // Strings in the case of compare_caseaction_, when the comparison is case-insensitive.
+  // These are also the output strings if the case changes.
+  std::vector<std::string> cased_strings;
+  // Indexes of the strings that are not stopwords
+  std::vector<size_t> kept;
+  if (stopwords_.empty()) {
+    kept.resize(C);
+    for (size_t i = 0; i < C; ++i) {
+      kept[i] = i;
     }
   } else {
-    if (!wstopwords_.empty()) {
-      // Filter input. When no case action is required
-      // we simply store original string references.
-      // Otherwise, we store converted strings.
-      std::vector<StrRef> filtered_orignal_strings;
-      std::vector<std::string> filtered_cased_strings;
-      filtered_orignal_strings.reserve(C);
-      filtered_cased_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        std::wstring wstr = converter.from_bytes(s);
-        if (wstr == wconv_error) {
-          return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                        "Input contains invalid utf8 chars at: " + s);
-        }
-        locale.ChangeCase(compare_caseaction_, wstr);
-        if (0 == wstopwords_.count(wstr)) {
-          if (case_change_action_ == NONE) {
-            filtered_orignal_strings.push_back(std::cref(s));
-          } else {
-            filtered_cased_strings.push_back(converter.to_bytes(wstr));
-          }
+    std::vector<uint8_t> is_stopword(C);
+    if (is_case_sensitive_) {
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_strings >= string_normalizer::kMinStringsForParallelism)
+#endif
+      for (int64_t i = 0; i < num_strings; ++i) {
+        is_stopword[i] = stopwords_.count(input_data[i]) != 0;
+      }
+    } else {
+      cased_strings.resize(C);
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_strings >= string_normalizer::kMinStringsForParallelism) reduction(|| : invalid_utf8)
+#endif
+      for (int64_t i = 0; i < num_strings; ++i) {
+        if (case_mapper_->ChangeCase(input_data[i], cased_strings[i])) {
+          is_stopword[i] = stopwords_.count(cased_strings[i]) != 0;
+        } else {
+          invalid_utf8 = true;
         }
-        ++first;
       }
-      if (case_change_action_ == NONE) {
-        status = CopyCaseAction(filtered_orignal_strings.cbegin(), filtered_orignal_strings.cend(), ctx, locale, converter,
-                                N, filtered_orignal_strings.size(), NONE);
-      } else {
-        status = CopyCaseAction(filtered_cased_strings.begin(), filtered_cased_strings.end(), ctx, locale, converter,
-                                N, filtered_cased_strings.size(), NONE);
+      if (invalid_utf8) {
+        return InvalidUtf8Error(input_data, C);
+      }
+    }
+
+    kept.reserve(C);
+    for (size_t i = 0; i < C; ++i) {
+      if (!is_stopword[i]) {
+        kept.push_back(i);
       }
-    } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
     }
   }
-  return status;
+
+  std::vector<int64_t> output_dims;
+  if (N == 1) {
+    output_dims.push_back(1);
+  }
+
+  // Empty output case
+  if (kept.empty()) {
+    output_dims.push_back(1);
+    TensorShape output_shape(output_dims);
+    // This will create one empty string
+    ctx->Output(0, output_shape);
+    return Status::OK();
+  }
+
+  output_dims.push_back(kept.size());
+
+  TensorShape output_shape(output_dims);
+  auto output_tensor = ctx->Output(0, output_shape);
+  auto const output_data = output_tensor->template MutableData<std::string>();
+  const int64_t num_kept = static_cast<int64_t>(kept.size());
+
+  if (case_change_action_ == NONE) {
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_kept >= string_normalizer::kMinStringsForParallelism)
+#endif
+    for (int64_t i = 0; i < num_kept; ++i) {
+      output_data[i] = input_data[kept[i]];
+    }
+  } else if (!cased_strings.empty()) {
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_kept >= string_normalizer::kMinStringsForParallelism)
+#endif
+    for (int64_t i = 0; i < num_kept; ++i) {
+      output_data[i] = std::move(cased_strings[kept[i]]);
+    }
+  } else {
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_kept >= string_normalizer::kMinStringsForParallelism) reduction(|| : invalid_utf8)
+#endif
+    for (int64_t i = 0; i < num_kept; ++i) {
+      if (!case_mapper_->ChangeCase(input_data[kept[i]], output_data[i])) {
+        invalid_utf8 = true;
+      }
+    }
+    if (invalid_utf8) {
+      return InvalidUtf8Error(input_data, C);
+    }
+  }
+
+  return Status::OK();
 }
 }  // namespace onnxruntime
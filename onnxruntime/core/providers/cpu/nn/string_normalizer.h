@@ -5,12 +5,16 @@
 
 #include "core/framework/op_kernel.h"
 
-#include <locale>
+#include <memory>
 #include <string>
 #include <unordered_set>
 
 namespace onnxruntime {
 
+namespace string_normalizer {
+class Utf8CaseMapper;
+}
+
 class StringNormalizer : public OpKernel {
  public:
   enum CaseAction {
@@ -20,7 +24,7 @@ class StringNormalizer : public OpKernel {
   };
 
   explicit StringNormalizer(const OpKernelInfo& info);
-  ~StringNormalizer() = default;
+  ~StringNormalizer();
 
   Status Compute(OpKernelContext* ctx) const override;
 
@@ -28,10 +32,11 @@ class StringNormalizer : public OpKernel {
   bool is_case_sensitive_;
   CaseAction case_change_action_;
   CaseAction compare_caseaction_;  // used for case-insensitive compare
-  std::string locale_name_;
-  // Either if these are populated but not both
+  // Changes the case of the strings for the output, or for the comparison
+  // if the output keeps the case. Not set if neither is needed.
+  std::unique_ptr<string_normalizer::Utf8CaseMapper> case_mapper_;
+  // Stopwords, in the case of compare_caseaction_ if the comparison is case-insensitive
   std::unordered_set<std::string> stopwords_;
-  std::unordered_set<std::wstring> wstopwords_;
 };
 
 }  // namespace onnxruntime
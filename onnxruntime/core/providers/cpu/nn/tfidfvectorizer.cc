@@ -5,11 +5,10 @@
 #include "onnx/defs/schema.h"
 #include "core/common/common.h"
 #include "core/framework/tensor.h"
+#include "core/providers/cpu/ml/flat_lookup_table.h"
 
-#include <functional>
-#include <unordered_set>
-#include <ostream>
-#include <iterator>
+#include <algorithm>
+#include <string>
 
 namespace onnxruntime {
 
@@ -42,129 +41,9 @@ ONNX_CPU_OPERATOR_TYPED_KERNEL(
 
 namespace ngram_details {
 
-class NgramEntryBase {
-  size_t id_;  // Id in the pool
- protected:
-  NgramEntryBase(size_t id) : id_(id) {}
-  ~NgramEntryBase() = default;
-
- public:
-  size_t Id() const { return id_; }
-};
-
-template <class T>
-class NgramEntry;
-
-template <>
-class NgramEntry<int64_t> : public NgramEntryBase {
-  std::vector<int64_t> items_;
-  size_t hash_ = 0;
-
-  void RunningHash(int64_t v) {
-    std::hash<int64_t> hf{};
-    hash_ ^= hf(v) + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
-  }
-
- public:
-  template <typename ForwardIter>
-  explicit NgramEntry(size_t id, ForwardIter first, ForwardIter last) : NgramEntryBase(id) {
-    while (first != last) {
-      RunningHash(*first);
-      items_.push_back(*first);
-      ++first;
-    }
-    assert(!items_.empty());
-  }
-  // For sampling
-  explicit NgramEntry() : NgramEntryBase(0) {}
-  void AddItem(int64_t v) {
-    items_.push_back(v);
-    RunningHash(v);
-  }
-  void DebugPrint() const {
-    std::copy(items_.cbegin(), items_.cend(), std::ostream_iterator<int64_t>(std::cout, ","));
-    std::cout << std::endl;
-  }
-  void Clear() {
-    items_.clear();
-    hash_ = 0;
-  }
-  bool operator==(const NgramEntry& o) const {
-    return items_ == o.items_;
-  }
-  size_t Hash() const {
-    return hash_;
-  }
-};
-
-template <>
-class NgramEntry<int32_t> : public NgramEntry<int64_t> {
- public:
-  template <typename ForwardIter>
-  explicit NgramEntry(size_t id, ForwardIter first, ForwardIter last) : NgramEntry<int64_t>(id, first, last) {}
-  explicit NgramEntry() = default;
-};
-
-template <>
-class NgramEntry<std::string> : public NgramEntryBase {
- private:
-  std::vector<std::reference_wrapper<const std::string>> items_;
-  size_t hash_ = 0;
-
-  void RunningHash(const std::string& s) {
-    std::hash<std::string> hf{};
-    hash_ ^= hf(s) + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
-  }
-
- public:
-  template <typename ForwardIter>
-  explicit NgramEntry(size_t id, ForwardIter first, ForwardIter last) : NgramEntryBase(id) {
-    while (first != last) {
-      RunningHash(*first);
-      items_.push_back(std::cref(*first));
-      ++first;
-    }
-    assert(!items_.empty());
-  }
-  explicit NgramEntry() : NgramEntryBase(0) {}
-  void AddItem(const std::string& s) {
-    items_.push_back(std::cref(s));
-    RunningHash(s);
-  }
-  void DebugPrint() const {
-    std::copy(items_.cbegin(), items_.cend(), std::ostream_iterator<std::string>(std::cout, ","));
-    std::cout << std::endl;
-  }
-  void Clear() {
-    items_.clear();
-    hash_ = 0;
-  }
-
-  bool operator==(const NgramEntry& o) const {
-    if (items_.size() == o.items_.size()) {
-      return std::equal(items_.cbegin(), items_.cend(),
-                        o.items_.cbegin(), o.items_.cend(),
-                        std::equal_to<std::string>());
-    }
-    return false;
-  }
-  size_t Hash() const {
-    return hash_;
-  }
-};
-
-using IntegerPoolSet = std::unordered_set<NgramEntry<int64_t>>;
-// Does not own strings, contains references to them. This helps
-// to search by string references that point to the current input.
-using StringPoolSet = std::unordered_set<NgramEntry<std::string>>;
-
-template <typename ForwardIter, typename Cont>
-inline void Emplace(ForwardIter first, size_t ngrams, size_t ngram_size, size_t& ngram_id, Cont& c) {
-  for (; ngrams > 0; --ngrams) {
-    c.emplace(ngram_id, first, first + ngram_size);
-    first += ngram_size;
-    ++ngram_id;
-  }
+// Key of the trie transition from 'node' on the item with id 'item'.
+inline int64_t TransitionKey(int32_t node, int32_t item) {
+  return static_cast<int64_t>((static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(item));
 }
 
 }  // namespace ngram_details
@@ -172,17 +51,6 @@ inline void Emplace(ForwardIter first, size_t ngrams, size_t ngram_size, size_t&
 
 using namespace onnxruntime::ngram_details;
 
-namespace std {
-template <typename T>
-struct hash<NgramEntry<T>> {
-  typedef NgramEntry<T> argument_type;
-  typedef size_t result_type;
-  result_type operator()(const argument_type& a) const {
-    return a.Hash();
-  }
-};
-}  // namespace std
-
 namespace onnxruntime {
 
 // The weighting criteria.
@@ -219,12 +87,16 @@ struct TfIdfVectorizer::Impl {
   std::vector<int64_t> ngram_indexes_;
   std::vector<float> weights_;
 
-  std::vector<std::string> pool_strings_;
-  // This set contains references to pool_string_ entries
-  // of pool_strings attribute
-  StringPoolSet str_set_;
-  // This set contains pool_int64s entries
-  IntegerPoolSet int64_set_;
+  // The n-grams of the pool in the [min_gram_length..max_gram_length] range are compiled into a trie.
+  // Each distinct item of those n-grams gets a dense id, so the input only needs to be hashed once per
+  // token, and the trie is then walked one item at a time with integer lookups while a candidate
+  // n-gram is extended. Nothing is copied or allocated per candidate.
+  ml::FlatLookupTable<std::string, int32_t> str_items_;
+  ml::FlatLookupTable<int64_t, int32_t> int64_items_;
+  // Children of the trie nodes keyed by TransitionKey(node, item). Node 0 is the root.
+  ml::FlatLookupTable<int64_t, int32_t> transitions_;
+  // Output index of the n-gram that ends at each node, or -1 if the node is only a prefix.
+  std::vector<int64_t> node_outputs_{-1};
   size_t output_size_ = 0;
 
   Impl() = default;
@@ -232,49 +104,53 @@ struct TfIdfVectorizer::Impl {
   Impl(const Impl&) = delete;
   Impl& operator=(const Impl&) = delete;
 
-  template <typename T>
-  auto PoolEnd() const;
+  // Adds 'ngrams' n-grams of 'ngram_size' items each, starting at 'first', to the trie.
+  template <typename ForwardIter, typename ItemTable>
+  void Insert(ForwardIter first, size_t ngrams, size_t ngram_size, size_t& ngram_id, ItemTable& items,
+              const char* pool_name);
 
-  template <typename T>
-  auto PoolFind(const ngram_details::NgramEntry<T>&) const;
+  // Returns the id of an input item, or -1 if it is not part of any n-gram of the pool.
+  int32_t ItemId(const std::string& s) const {
+    return str_items_.FindOrDefault(s, -1);
+  }
+  int32_t ItemId(int64_t v) const {
+    return int64_items_.FindOrDefault(v, -1);
+  }
 
-  void IncrementCount(size_t ngram_id, size_t row_num,
-                      std::vector<uint32_t>& frequencies) const {
-    assert(ngram_id < ngram_indexes_.size());
-    auto output_idx = row_num * output_size_ + ngram_indexes_[ngram_id];
-    assert(static_cast<size_t>(output_idx) < frequencies.size());
-    ++frequencies[output_idx];
+  // Returns the child of 'node' for the item, or -1 if no n-gram of the pool continues this way.
+  int32_t Child(int32_t node, int32_t item) const {
+    return transitions_.FindOrDefault(TransitionKey(node, item), -1);
   }
 };
 
-template <>
-inline auto TfIdfVectorizer::Impl::PoolEnd<int64_t>() const {
-  return int64_set_.cend();
-}
-
-template <>
-inline auto TfIdfVectorizer::Impl::PoolEnd<int32_t>() const {
-  return PoolEnd<int64_t>();
-}
-
-template <>
-inline auto TfIdfVectorizer::Impl::PoolEnd<std::string>() const {
-  return str_set_.cend();
-}
-
-template <>
-inline auto TfIdfVectorizer::Impl::PoolFind<int64_t>(const NgramEntry<int64_t>& i) const {
-  return int64_set_.find(i);
-}
-
-template <>
-inline auto TfIdfVectorizer::Impl::PoolFind<int32_t>(const NgramEntry<int32_t>& i) const {
-  return int64_set_.find(i);
-}
+template <typename ForwardIter, typename ItemTable>
+void TfIdfVectorizer::Impl::Insert(ForwardIter first, size_t ngrams, size_t ngram_size, size_t& ngram_id,
+                                   ItemTable& items, const char* pool_name) {
+  for (; ngrams > 0; --ngrams, ++ngram_id) {
+    ORT_ENFORCE(ngram_id < ngram_indexes_.size(), "ngram_indexes must have an entry for every n-gram of the pool");
+    int32_t node = 0;
+    for (size_t i = 0; i < ngram_size; ++i, ++first) {
+      int32_t item = static_cast<int32_t>(items.size());
+      const int32_t* existing_item = items.Find(*first);
+      if (existing_item != nullptr) {
+        item = *existing_item;
+      } else {
+        items.Insert(*first, item);
+      }
 
-template <>
-inline auto TfIdfVectorizer::Impl::PoolFind<std::string>(const NgramEntry<std::string>& i) const {
-  return str_set_.find(i);
+      const auto key = TransitionKey(node, item);
+      const int32_t* child = transitions_.Find(key);
+      if (child != nullptr) {
+        node = *child;
+      } else {
+        node = static_cast<int32_t>(node_outputs_.size());
+        transitions_.Insert(key, node);
+        node_outputs_.push_back(-1);
+      }
+    }
+    ORT_ENFORCE(node_outputs_[node] < 0, pool_name, " duplicate ", std::to_string(ngram_size), "-grams detected");
+    node_outputs_[node] = ngram_indexes_[ngram_id];
+  }
 }
 
 TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), impl_(new Impl) {
@@ -334,16 +210,17 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
   }
 
   std::vector<int64_t> pool_int64s;
-  status = info.GetAttrs("pool_strings", impl_->pool_strings_);
+  std::vector<std::string> pool_strings;
+  status = info.GetAttrs("pool_strings", pool_strings);
   if (status.IsOK()) {
-    ORT_ENFORCE(!impl_->pool_strings_.empty(), "pool_strings must not be empty if specified");
+    ORT_ENFORCE(!pool_strings.empty(), "pool_strings must not be empty if specified");
   } else {
     status = info.GetAttrs("pool_int64s", pool_int64s);
     ORT_ENFORCE(status.IsOK() && !pool_int64s.empty(), "non-empty pool_int64s is required if pool_strings not provided");
   }
 
   // Iterator via the pool. Insert 1 item for 1-grams, 2 items for 2-grams, etc.
-  const auto total_items = (impl_->pool_strings_.empty()) ? pool_int64s.size() : impl_->pool_strings_.size();
+  const auto total_items = (pool_strings.empty()) ? pool_int64s.size() : pool_strings.size();
   size_t ngram_id = 0;
   // Load into dictionary only required gram sizes
   const size_t min_gram_length = impl_->min_gram_length_;
@@ -361,14 +238,12 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       auto ngrams = items / ngram_size;
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
-        if (impl_->pool_strings_.empty()) {
-          auto before_insert = impl_->int64_set_.size();
-          Emplace(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_set_);
-          ORT_ENFORCE((before_insert + ngrams) == impl_->int64_set_.size(), "pool_int64s duplicate ", std::to_string(ngram_size), "-grams detected");
+        if (pool_strings.empty()) {
+          impl_->Insert(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_items_,
+                        "pool_int64s");
         } else {
-          auto before_insert = impl_->str_set_.size();
-          Emplace(impl_->pool_strings_.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_set_);
-          ORT_ENFORCE((before_insert + ngrams) == impl_->str_set_.size(), "poll_strings duplicate ", std::to_string(ngram_size), "-grams detected");
+          impl_->Insert(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_items_,
+                        "pool_strings");
         }
       } else {
         ngram_id += ngrams;
@@ -436,7 +311,6 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
 template <typename T>
 Status TfIdfVectorizer::ComputeImpl(OpKernelContext* ctx) const {
   const auto& impl = *impl_;
-  auto const set_end = impl.PoolEnd<T>();
 
   auto X = ctx->Input<Tensor>(0);
   auto& input_shape = X->Shape();
@@ -477,81 +351,81 @@ Status TfIdfVectorizer::ComputeImpl(OpKernelContext* ctx) const {
   std::vector<uint32_t> frequencies;
   frequencies.resize(b_dim * impl.output_size_, 0);
 
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
+  const int64_t num_rows = static_cast<int64_t>(b_dim);
+  const int64_t row_size = static_cast<int64_t>(C);
+  const int64_t max_gram_length = impl.max_gram_length_;
+  const int64_t max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
+  const int64_t min_gram_length = impl.min_gram_length_;
   auto const input_data = X->template Data<T>();
-  auto const end_data = input_data + total_items;
-  NgramEntry<T> sample;
-
-  // Treat 1-grams in a special way
-  if (start_ngram_size == 1) {
-    size_t row_num = 0;
-    auto ngram_start = input_data;
-    while (ngram_start < end_data) {
-      auto const ngram_row_end = ngram_start + C;
-      while (ngram_start < ngram_row_end) {
-        sample.Clear();
-        sample.AddItem(*ngram_start);
-        auto hit = impl.PoolFind<T>(sample);
-        if (hit != set_end) {
-          // record frequency
-          auto ngram_id = hit->Id();
-          impl.IncrementCount(ngram_id, row_num, frequencies);
+
+  // Look every input item up once. Items that are not in the pool can not be part of any n-gram.
+  std::vector<int32_t> items(total_items);
+  const int64_t num_items = static_cast<int64_t>(total_items);
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_items >= kMinElementsForParallelLookup)
+#endif
+  for (int64_t i = 0; i < num_items; ++i) {
+    items[i] = impl.ItemId(input_data[i]);
+  }
+
+  const auto& node_outputs = impl.node_outputs_;
+
+  // rows are independent and each one only updates its own frequencies.
+  // Small batches are counted on the calling thread.
+#ifdef USE_OPENMP
+#pragma omp parallel for if (num_rows > 1 && num_items >= kMinElementsForParallelLookup)
+#endif
+  for (int64_t row_num = 0; row_num < num_rows; ++row_num) {
+    const int32_t* const row_items = items.data() + row_num * row_size;
+    uint32_t* const row_frequencies = frequencies.data() + row_num * impl.output_size_;
+    auto start_ngram_size = min_gram_length;
+
+    // Treat 1-grams in a special way
+    if (start_ngram_size == 1) {
+      for (int64_t i = 0; i < row_size; ++i) {
+        if (row_items[i] >= 0) {
+          const int32_t node = impl.Child(0, row_items[i]);
+          if (node >= 0 && node_outputs[node] >= 0) {
+            ++row_frequencies[node_outputs[node]];
+          }
         }
-        ++ngram_start;
       }
-      ++row_num;
-      ngram_start = ngram_row_end;
+      ++start_ngram_size;
     }
-    if (++start_ngram_size > max_gram_length) {
-      OutputResult(ctx, B, frequencies);
-      return Status::OK();
-    }
-  }
 
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = input_data;
-    size_t row_num = 0;
-    while (ngram_start < end_data) {
-      assert((B == 0) || (row_num < B));
-      auto const ngram_row_end = ngram_start + C;
-      assert(ngram_row_end <= end_data);
-      while (ngram_start < ngram_row_end) {
+    for (int64_t skip_distance = 1;
+         start_ngram_size <= max_gram_length && skip_distance <= max_skip_distance;
+         ++skip_distance) {
+      for (int64_t ngram_start = 0; ngram_start < row_size; ++ngram_start) {
         // Check if any n-gram size in [start_ngram_size..max_gram_length] range
         // fit before the end of the row so we do not waste time adding [1..start_ngram_size)
         // At least items of start_ngram_size should fit
-        // last row should match end_data
-        auto at_least_this = ngram_start + skip_distance * (start_ngram_size - 1);
-        if (at_least_this >= ngram_row_end) {
+        if (ngram_start + skip_distance * (start_ngram_size - 1) >= row_size) {
           break;
         }
-        sample.Clear();
-        auto ngram_item = ngram_start;
-        for (auto ngram_size = 1;
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
+        // Extend the n-gram one item at a time while it is still the prefix of an n-gram of the pool
+        int32_t node = 0;
+        int64_t ngram_item = ngram_start;
+        for (int64_t ngram_size = 1;
+             ngram_size <= max_gram_length && ngram_item < row_size;
              ++ngram_size, ngram_item += skip_distance) {
-          sample.AddItem(*ngram_item);
-
+          if (row_items[ngram_item] < 0) {
+            break;
+          }
+          node = impl.Child(node, row_items[ngram_item]);
+          if (node < 0) {
+            break;
+          }
           // Do not test anything before start_ngram_size
-          if (ngram_size >= start_ngram_size) {
-            auto hit = impl.PoolFind<T>(sample);
-            if (hit != set_end) {
-              // record frequency
-              auto ngram_id = hit->Id();
-              impl.IncrementCount(ngram_id, row_num, frequencies);
-            }
+          if (ngram_size >= start_ngram_size && node_outputs[node] >= 0) {
+            // record frequency
+            ++row_frequencies[node_outputs[node]];
           }
         }
-        // Sliding window shift
-        ++ngram_start;
       }
-      // Next row
-      ngram_start = ngram_row_end;
-      ++row_num;
     }
   }
+
   OutputResult(ctx, B, frequencies);
   return Status::OK();
 }
@@ -1,11 +1,16 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <unordered_set>
+
 #include "mkldnn_execution_provider.h"
+#include "core/common/logging/logging.h"
 #include "core/framework/allocator.h"
 #include "core/framework/memcpy.h"
 #include "core/framework/kernel_registry.h"
+#include "core/framework/compute_capability.h"
 #include "mkldnn_fwd.h"
+#include "subgraph/mkldnn_subgraph.h"
 
 namespace onnxruntime {
 
@@ -105,4 +110,134 @@ std::shared_ptr<KernelRegistry> MKLDNNExecutionProvider::GetKernelRegistry() con
   static std::shared_ptr<KernelRegistry> kernel_registry = onnxruntime::mkl_dnn::GetMklDnnKernelRegistry();
   return kernel_registry;
 }
+
+std::vector<std::unique_ptr<ComputeCapability>>
+MKLDNNExecutionProvider::GetCapability(const onnxruntime::GraphViewer& graph,
+                                       const std::vector<const KernelRegistry*>& kernel_registries) const {
+  std::vector<std::unique_ptr<ComputeCapability>> result;
+
+  // Collect the runs of supported nodes that are contiguous in topological order. A run cannot have a path
+  // that leaves the run and comes back into it, so each run can be fused into a single node.
+  std::vector<std::vector<NodeIndex>> regions;
+  std::vector<NodeIndex> region;
+  for (auto index : graph.GetNodesInTopologicalOrder()) {
+    const Node* node = graph.GetNode(index);
+    const auto& provider_type = node->GetExecutionProviderType();
+    if ((provider_type.empty() || provider_type == Type()) && mkl_dnn::IsSubgraphNodeSupported(*node, graph)) {
+      region.push_back(index);
+      continue;
+    }
+    if (region.size() > 1) {
+      regions.push_back(std::move(region));
+    }
+    region.clear();
+  }
+  if (region.size() > 1) {
+    regions.push_back(std::move(region));
+  }
+
+  std::unordered_set<NodeIndex> fused_nodes;
+  std::unordered_set<const NodeArg*> graph_outputs(graph.GetOutputs().begin(), graph.GetOutputs().end());
+
+  for (const auto& nodes : regions) {
+    std::unordered_set<NodeIndex> node_set(nodes.begin(), nodes.end());
+    std::unordered_set<std::string> produced;
+    std::unordered_set<std::string> seen_inputs;
+    auto meta_def = std::make_unique<::onnxruntime::IndexedSubGraph::MetaDef>();
+
+    for (auto index : nodes) {
+      const Node* node = graph.GetNode(index);
+      for (const auto* input : node->InputDefs()) {
+        if (input->Exists() && produced.count(input->Name()) == 0 && seen_inputs.insert(input->Name()).second) {
+          meta_def->inputs.push_back(input->Name());
+        }
+      }
+
+      // An output leaves the region if it is a graph output or is consumed by a node outside the region.
+      std::vector<bool> external(node->OutputDefs().size(), false);
+      for (auto it = node->OutputEdgesBegin(); it != node->OutputEdgesEnd(); ++it) {
+        if (node_set.count(it->GetNode().Index()) == 0) {
+          external[it->GetSrcArgIndex()] = true;
+        }
+      }
+      for (size_t i = 0; i < node->OutputDefs().size(); i++) {
+        const auto* output = node->OutputDefs()[i];
+        if (!output->Exists()) {
+          continue;
+        }
+        produced.insert(output->Name());
+        if (external[i] || graph_outputs.count(output) != 0) {
+          meta_def->outputs.push_back(output->Name());
+        }
+      }
+    }
+
+    meta_def->name = "MklDnnSubgraph_" + std::to_string(subgraph_counter_++);
+    meta_def->domain = kMSDomain;
+    meta_def->since_version = 1;
+
+    std::unique_ptr<IndexedSubGraph> sub_graph = std::make_unique<IndexedSubGraph>();
+    sub_graph->nodes = nodes;
+    sub_graph->SetMetaDef(meta_def);
+    result.push_back(std::make_unique<ComputeCapability>(std::move(sub_graph)));
+    fused_nodes.insert(nodes.begin(), nodes.end());
+  }
+
+  // The remaining nodes run individually through the registered kernels.
+  for (auto& node : graph.Nodes()) {
+    if (fused_nodes.count(node.Index()) != 0) {
+      continue;
+    }
+    for (auto registry : kernel_registries) {
+      if (registry->TryFindKernel(node, Type()) != nullptr) {
+        std::unique_ptr<IndexedSubGraph> sub_graph = std::make_unique<IndexedSubGraph>();
+        sub_graph->nodes.push_back(node.Index());
+        result.push_back(std::make_unique<ComputeCapability>(std::move(sub_graph)));
+        break;
+      }
+    }
+  }
+
+  return result;
+}
+
+common::Status MKLDNNExecutionProvider::Compile(const std::vector<onnxruntime::Node*>& fused_nodes,
+                                                std::vector<NodeComputeInfo>& node_compute_funcs) {
+  for (const auto* fused_node : fused_nodes) {
+    if (fused_node->GetFunctionBody() == nullptr) {
+      return common::Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Function body is empty");
+    }
+
+    auto subgraph = std::make_shared<mkl_dnn::Subgraph>(*fused_node);
+    subgraphs_.push_back(subgraph);
+    mkl_dnn::Subgraph* subgraph_ptr = subgraph.get();
+
+    NodeComputeInfo compute_info;
+    compute_info.create_state_func = [subgraph_ptr](ComputeContext* context, FunctionState* state) {
+      *state = new mkl_dnn::SubgraphState{subgraph_ptr, context->allocate_func, context->allocator_handle};
+      return 0;
+    };
+
+    compute_info.release_state_func = [](FunctionState state) {
+      if (state)
+        delete static_cast<mkl_dnn::SubgraphState*>(state);
+    };
+
+    compute_info.compute_func = [](FunctionState state, ONNXRunTimeTensor* input_tensors, size_t num_inputs,
+                                   ONNXRunTimeTensor* output_tensors, size_t num_outputs) {
+      auto* subgraph_state = static_cast<mkl_dnn::SubgraphState*>(state);
+      Status status = subgraph_state->subgraph->Compute(input_tensors, num_inputs, output_tensors, num_outputs,
+                                                        subgraph_state->allocate_func, subgraph_state->allocator);
+      if (!status.IsOK()) {
+        LOGS_DEFAULT(ERROR) << "MKL-DNN subgraph compute failed: " << status.ErrorMessage();
+        return -1;
+      }
+      return 0;
+    };
+
+    node_compute_funcs.push_back(compute_info);
+  }
+
+  return Status::OK();
+}
 }  // namespace onnxruntime
@@ -19,6 +19,10 @@ struct memory;
 
 namespace onnxruntime {
 
+namespace mkl_dnn {
+class Subgraph;
+}
+
 // Information needed to construct MKL-DNN execution providers.
 struct MKLDNNExecutionProviderInfo {
   bool create_arena{true};
@@ -42,6 +46,13 @@ class MKLDNNExecutionProvider : public IExecutionProvider {
 
   virtual std::shared_ptr<KernelRegistry> GetKernelRegistry() const override;
 
+  std::vector<std::unique_ptr<ComputeCapability>>
+  GetCapability(const onnxruntime::GraphViewer& graph,
+                const std::vector<const KernelRegistry*>& kernel_registries) const override;
+
+  common::Status Compile(const std::vector<onnxruntime::Node*>& fused_nodes,
+                         std::vector<NodeComputeInfo>& node_compute_funcs) override;
+
   std::shared_ptr<mkldnn::memory> GetWeightsMemoryBuffer(const std::string& weight_key) {
     auto iter = weights_mem_map_.find(weight_key);
     if (iter != weights_mem_map_.end())
@@ -70,6 +81,10 @@ class MKLDNNExecutionProvider : public IExecutionProvider {
   // Save reordered memory buffers in list so that memory is not freed.
   std::vector<IAllocatorUniquePtr<void>> reordered_buffers_;
   OrtMutex mutex_;
+
+  // Compiled subgraphs of the fused nodes. The function states refer to these.
+  std::vector<std::shared_ptr<mkl_dnn::Subgraph>> subgraphs_;
+  mutable int subgraph_counter_{0};
 };
 
 }  // namespace onnxruntime
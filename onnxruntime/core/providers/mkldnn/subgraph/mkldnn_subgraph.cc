@@ -0,0 +1,662 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifdef _WIN32
+#pragma warning(disable : 4244)
+#endif
+
+#include "core/providers/mkldnn/subgraph/mkldnn_subgraph.h"
+
+#include <cstring>
+
+#include "core/providers/mkldnn/mkldnn_common.h"
+#include "core/graph/constants.h"
+#include "core/graph/function.h"
+
+namespace onnxruntime {
+namespace mkl_dnn {
+
+namespace {
+
+int64_t GetIntAttribute(const NodeAttributes& attributes, const std::string& name, int64_t default_value) {
+  auto iter = attributes.find(name);
+  return iter != attributes.end() ? iter->second.i() : default_value;
+}
+
+float GetFloatAttribute(const NodeAttributes& attributes, const std::string& name, float default_value) {
+  auto iter = attributes.find(name);
+  return iter != attributes.end() ? iter->second.f() : default_value;
+}
+
+std::string GetStringAttribute(const NodeAttributes& attributes, const std::string& name) {
+  auto iter = attributes.find(name);
+  return iter != attributes.end() ? iter->second.s() : std::string();
+}
+
+mkldnn::memory::dims GetIntsAttribute(const NodeAttributes& attributes, const std::string& name,
+                                      size_t size, int default_value) {
+  auto iter = attributes.find(name);
+  if (iter == attributes.end() || iter->second.ints_size() == 0) {
+    return mkldnn::memory::dims(size, default_value);
+  }
+  return mkldnn::memory::dims(iter->second.ints().begin(), iter->second.ints().end());
+}
+
+bool IsFloatTensor(const NodeArg* arg, int rank) {
+  if (arg == nullptr || !arg->Exists()) {
+    return false;
+  }
+  const auto* type = arg->TypeAsProto();
+  if (type == nullptr || !type->has_tensor_type() ||
+      type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+    return false;
+  }
+  const auto* shape = arg->Shape();
+  return shape != nullptr && shape->dim_size() == rank;
+}
+
+bool IsInitializer(const NodeArg* arg, const GraphViewer& graph_viewer) {
+  const ONNX_NAMESPACE::TensorProto* tensor = nullptr;
+  return arg->Exists() && graph_viewer.GetInitializedTensor(arg->Name(), tensor);
+}
+
+bool HasSameShape(const NodeArg* a, const NodeArg* b) {
+  const auto* shape_a = a->Shape();
+  const auto* shape_b = b->Shape();
+  if (shape_a == nullptr || shape_b == nullptr || shape_a->dim_size() != shape_b->dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape_a->dim_size(); i++) {
+    const auto& dim_a = shape_a->dim(i);
+    const auto& dim_b = shape_b->dim(i);
+    if (dim_a.has_dim_value() && dim_b.has_dim_value()) {
+      if (dim_a.dim_value() != dim_b.dim_value()) {
+        return false;
+      }
+    } else if (!dim_a.has_dim_param() || !dim_b.has_dim_param() || dim_a.dim_param() != dim_b.dim_param()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HasSingleOutput(const Node& node) {
+  const auto& outputs = node.OutputDefs();
+  for (size_t i = 1; i < outputs.size(); i++) {
+    if (outputs[i]->Exists()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int ComputeOutputSize(int input_size, int kernel, int stride, int dilation, int pad_head, int pad_tail) {
+  return (input_size + pad_head + pad_tail - ((kernel - 1) * dilation + 1)) / stride + 1;
+}
+
+}  // namespace
+
+bool IsSubgraphNodeSupported(const Node& node, const GraphViewer& graph_viewer) {
+  if (node.Domain() != kOnnxDomain && node.Domain() != kOnnxDomainAlias) {
+    return false;
+  }
+
+  const auto& op_type = node.OpType();
+  const auto& inputs = node.InputDefs();
+  const auto& attributes = node.GetAttributes();
+
+  if (inputs.empty() || !IsFloatTensor(inputs[0], 4) || !HasSingleOutput(node)) {
+    return false;
+  }
+
+  if (op_type == "Conv") {
+    auto auto_pad = GetStringAttribute(attributes, "auto_pad");
+    return inputs.size() >= 2 && IsFloatTensor(inputs[1], 4) && IsInitializer(inputs[1], graph_viewer) &&
+           (inputs.size() < 3 || IsInitializer(inputs[2], graph_viewer)) &&
+           (auto_pad.empty() || auto_pad == "NOTSET");
+  }
+
+  if (op_type == "Relu" || op_type == "LRN" || op_type == "GlobalAveragePool" || op_type == "GlobalMaxPool") {
+    return true;
+  }
+
+  if (op_type == "MaxPool" || op_type == "AveragePool") {
+    auto auto_pad = GetStringAttribute(attributes, "auto_pad");
+    return (auto_pad.empty() || auto_pad == "NOTSET") &&
+           GetIntAttribute(attributes, "ceil_mode", 0) == 0 &&
+           GetIntAttribute(attributes, "storage_order", 0) == 0 &&
+           attributes.find("dilations") == attributes.end();
+  }
+
+  if (op_type == "BatchNormalization") {
+    if (inputs.size() != 5 || GetIntAttribute(attributes, "spatial", 1) != 1) {
+      return false;
+    }
+    for (size_t i = 1; i < inputs.size(); i++) {
+      if (!IsFloatTensor(inputs[i], 1) || !IsInitializer(inputs[i], graph_viewer)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (op_type == "Sum") {
+    // The inputs must have identical shapes as the MKL-DNN sum primitive does not broadcast.
+    if (inputs.size() < 2) {
+      return false;
+    }
+    for (size_t i = 1; i < inputs.size(); i++) {
+      if (!IsFloatTensor(inputs[i], 4) || !HasSameShape(inputs[0], inputs[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+// The primitive chain of a subgraph for one set of input shapes.
+class SubgraphPrimitive {
+ public:
+  SubgraphPrimitive(Subgraph& subgraph, const ONNXRunTimeTensor* input_tensors)
+      : subgraph_(subgraph), cpu_engine_(GetEngine()) {
+    Initialize(input_tensors);
+  }
+
+  void Compute(const ONNXRunTimeTensor* input_tensors, ONNXRunTimeTensor* output_tensors,
+               AllocateFunc allocate_func, AllocatorHandle allocator) {
+    const auto& input_values = subgraph_.InputValues();
+    for (size_t i = 0; i < input_values.size(); i++) {
+      if (input_memory_[i] != nullptr) {
+        input_memory_[i]->set_data_handle(input_tensors[i].data);
+      }
+    }
+
+    const auto& output_values = subgraph_.OutputValues();
+    for (size_t i = 0; i < output_values.size(); i++) {
+      const auto& dims = dims_[output_values[i]];
+      size_t size = 1;
+      for (auto dim : dims) {
+        size *= static_cast<size_t>(dim);
+      }
+      output_tensors[i].dtype = TFloat32;
+      output_tensors[i].ndim = dims.size();
+      output_tensors[i].shape = new int64_t[dims.size()];
+      std::copy(dims.begin(), dims.end(), output_tensors[i].shape);
+      output_tensors[i].data = (*allocate_func)(allocator, 64, sizeof(float) * size);
+      output_memory_[i]->set_data_handle(output_tensors[i].data);
+    }
+
+    mkldnn::stream(mkldnn::stream::kind::eager).submit(net_).wait();
+
+    for (auto& memory : input_memory_) {
+      if (memory != nullptr) {
+        memory->set_data_handle(nullptr);
+      }
+    }
+    for (auto& memory : output_memory_) {
+      memory->set_data_handle(nullptr);
+    }
+  }
+
+ private:
+  void Initialize(const ONNXRunTimeTensor* input_tensors) {
+    const size_t value_count = subgraph_.ValueCount();
+    dims_.resize(value_count);
+    memory_.resize(value_count);
+    weights_data_.resize(value_count, nullptr);
+
+    // The activation inputs of the subgraph are bound to the caller's NCHW buffers on each run. The weights are
+    // only read while the chain is built, to reorder them to the formats requested by the primitives.
+    const auto& input_values = subgraph_.InputValues();
+    input_memory_.resize(input_values.size());
+    for (size_t i = 0; i < input_values.size(); i++) {
+      const int value = input_values[i];
+      dims_[value].assign(input_tensors[i].shape, input_tensors[i].shape + input_tensors[i].ndim);
+      if (subgraph_.IsWeight(value)) {
+        weights_data_[value] = input_tensors[i].data;
+      } else {
+        memory_[value] = std::make_shared<mkldnn::memory>(
+            mkldnn::memory::primitive_desc({dims_[value], MklDnnType<float>(), mkldnn::memory::format::nchw},
+                                           cpu_engine_),
+            nullptr);
+        input_memory_[i] = memory_[value];
+      }
+    }
+
+    for (const auto& node : subgraph_.Nodes()) {
+      if (node.op_type == "Conv") {
+        AddConv(node);
+      } else if (node.op_type == "Relu") {
+        AddRelu(node);
+      } else if (node.op_type == "BatchNormalization") {
+        AddBatchNorm(node);
+      } else if (node.op_type == "LRN") {
+        AddLRN(node);
+      } else if (node.op_type == "Sum") {
+        AddSum(node);
+      } else {
+        AddPool(node);
+      }
+    }
+
+    // Reorder the outputs of the subgraph back to NCHW.
+    const auto& output_values = subgraph_.OutputValues();
+    for (int value : output_values) {
+      auto output_memory = std::make_shared<mkldnn::memory>(
+          mkldnn::memory::primitive_desc({dims_[value], MklDnnType<float>(), mkldnn::memory::format::nchw},
+                                         cpu_engine_),
+          nullptr);
+      net_.push_back(mkldnn::reorder(*memory_[value], *output_memory));
+      output_memory_.push_back(output_memory);
+    }
+
+    weights_data_.clear();
+  }
+
+  // Returns the memory of the value in the format requested by a primitive, adding a reorder to the chain if
+  // the value was produced in a different format.
+  mkldnn::memory& GetSourceMemory(int value, const mkldnn::memory::primitive_desc& pd) {
+    if (memory_[value]->get_primitive_desc() == pd) {
+      return *memory_[value];
+    }
+    auto reordered = std::make_shared<mkldnn::memory>(pd);
+    net_.push_back(mkldnn::reorder(*memory_[value], *reordered));
+    intermediate_memory_.push_back(reordered);
+    return *reordered;
+  }
+
+  std::shared_ptr<mkldnn::memory> GetWeightsMemory(int value, const mkldnn::memory::dims& dims,
+                                                   mkldnn::memory::format format,
+                                                   const mkldnn::memory::primitive_desc& pd) {
+    mkldnn::memory src(mkldnn::memory::primitive_desc({dims, MklDnnType<float>(), format}, cpu_engine_),
+                       const_cast<void*>(weights_data_[value]));
+    return subgraph_.GetReorderedWeights(value, src, pd);
+  }
+
+  void SetOutput(int value, const mkldnn::memory::dims& dims, std::shared_ptr<mkldnn::memory> memory) {
+    dims_[value] = dims;
+    memory_[value] = std::move(memory);
+  }
+
+  void AddConv(const SubgraphNode& node) {
+    const int x = node.inputs[0];
+    const int w = node.inputs[1];
+    const int b = node.inputs.size() > 2 ? node.inputs[2] : -1;
+
+    const auto& x_dims = dims_[x];
+    const auto& w_dims = dims_[w];
+    const int group = static_cast<int>(GetIntAttribute(node.attributes, "group", 1));
+
+    mkldnn::memory::dims kernel(w_dims.begin() + 2, w_dims.end());
+    mkldnn::memory::dims strides = GetIntsAttribute(node.attributes, "strides", 2, 1);
+    mkldnn::memory::dims dilations = GetIntsAttribute(node.attributes, "dilations", 2, 1);
+    mkldnn::memory::dims pads = GetIntsAttribute(node.attributes, "pads", 4, 0);
+
+    mkldnn::memory::dims y_dims{x_dims[0], w_dims[0],
+                                ComputeOutputSize(x_dims[2], kernel[0], strides[0], dilations[0], pads[0], pads[2]),
+                                ComputeOutputSize(x_dims[3], kernel[1], strides[1], dilations[1], pads[1], pads[3])};
+
+    mkldnn::memory::dims filter_dims = w_dims;
+    mkldnn::memory::format filter_format = mkldnn::memory::format::oihw;
+    if (group != 1) {
+      filter_dims = {group, w_dims[0] / group, w_dims[1], w_dims[2], w_dims[3]};
+      filter_format = mkldnn::memory::format::goihw;
+    }
+
+    // mkldnn dilations start from 0 so we need to subtract 1 from each dim.
+    for (auto& dilation : dilations) {
+      dilation -= 1;
+    }
+    mkldnn::memory::dims padding_left{pads[0], pads[1]};
+    mkldnn::memory::dims padding_right{pads[2], pads[3]};
+
+    // Let MKL-DNN choose the blocked formats of the source, filter and destination.
+    mkldnn::memory::desc src_md(x_dims, MklDnnType<float>(), mkldnn::memory::format::any);
+    mkldnn::memory::desc filter_md(filter_dims, MklDnnType<float>(), mkldnn::memory::format::any);
+    mkldnn::memory::desc dst_md(y_dims, MklDnnType<float>(), mkldnn::memory::format::any);
+
+    std::unique_ptr<mkldnn::convolution_forward::desc> fwd_desc;
+    if (b >= 0) {
+      mkldnn::memory::desc bias_md({w_dims[0]}, MklDnnType<float>(), mkldnn::memory::format::any);
+      fwd_desc.reset(new mkldnn::convolution_forward::desc(
+          mkldnn::prop_kind::forward_inference, mkldnn::convolution_direct, src_md, filter_md, bias_md, dst_md,
+          strides, dilations, padding_left, padding_right, mkldnn::padding_kind::zero));
+    } else {
+      fwd_desc.reset(new mkldnn::convolution_forward::desc(
+          mkldnn::prop_kind::forward_inference, mkldnn::convolution_direct, src_md, filter_md, dst_md,
+          strides, dilations, padding_left, padding_right, mkldnn::padding_kind::zero));
+    }
+
+    // A Relu that consumed the output of the convolution is applied as a post-op.
+    mkldnn::primitive_attr attr;
+    if (node.fused_relu) {
+      mkldnn::post_ops ops;
+      ops.append_eltwise(1.0f, mkldnn::algorithm::eltwise_relu, 0.0f, 0.0f);
+      attr.set_post_ops(ops);
+    }
+
+    mkldnn::convolution_forward::primitive_desc conv_pd(*fwd_desc, attr, cpu_engine_);
+
+    auto& src_mem = GetSourceMemory(x, conv_pd.src_primitive_desc());
+    auto filter_mem = GetWeightsMemory(w, filter_dims, filter_format, conv_pd.weights_primitive_desc());
+    auto dst_mem = std::make_shared<mkldnn::memory>(conv_pd.dst_primitive_desc());
+    weights_memory_.push_back(filter_mem);
+
+    if (b >= 0) {
+      auto bias_mem = GetWeightsMemory(b, {w_dims[0]}, mkldnn::memory::format::x, conv_pd.bias_primitive_desc());
+      weights_memory_.push_back(bias_mem);
+      net_.push_back(mkldnn::convolution_forward(conv_pd, src_mem, *filter_mem, *bias_mem, *dst_mem));
+    } else {
+      net_.push_back(mkldnn::convolution_forward(conv_pd, src_mem, *filter_mem, *dst_mem));
+    }
+
+    SetOutput(node.outputs[0], y_dims, dst_mem);
+  }
+
+  void AddRelu(const SubgraphNode& node) {
+    const int x = node.inputs[0];
+    auto& src_mem = *memory_[x];
+
+    // Element-wise operations run in the format of their input.
+    mkldnn::eltwise_forward::desc fwd_desc(mkldnn::prop_kind::forward_inference, mkldnn::algorithm::eltwise_relu,
+                                           src_mem.get_primitive_desc().desc(), 0.0f);
+    mkldnn::eltwise_forward::primitive_desc relu_pd(fwd_desc, cpu_engine_);
+
+    auto dst_mem = std::make_shared<mkldnn::memory>(relu_pd.dst_primitive_desc());
+    net_.push_back(mkldnn::eltwise_forward(relu_pd, src_mem, *dst_mem));
+
+    SetOutput(node.outputs[0], dims_[x], dst_mem);
+  }
+
+  void AddBatchNorm(const SubgraphNode& node) {
+    const int x = node.inputs[0];
+    auto& src_mem = *memory_[x];
+    const int channels = dims_[x][1];
+
+    mkldnn::batch_normalization_forward::desc fwd_desc(
+        mkldnn::prop_kind::forward_inference, src_mem.get_primitive_desc().desc(),
+        GetFloatAttribute(node.attributes, "epsilon", 1e-5f),
+        mkldnn::batch_normalization_flag::use_scale_shift | mkldnn::batch_normalization_flag::use_global_stats);
+    mkldnn::batch_normalization_forward::primitive_desc bn_pd(fwd_desc, cpu_engine_);
+
+    // The scale and shift are packed into a single 2xC memory.
+    auto scale_shift_mem = std::make_shared<mkldnn::memory>(bn_pd.weights_primitive_desc());
+    auto mean_mem = std::make_shared<mkldnn::memory>(bn_pd.mean_primitive_desc());
+    auto var_mem = std::make_shared<mkldnn::memory>(bn_pd.variance_primitive_desc());
+
+    const size_t bytes = sizeof(float) * channels;
+    float* scale_shift = static_cast<float*>(scale_shift_mem->get_data_handle());
+    memcpy(scale_shift, weights_data_[node.inputs[1]], bytes);
+    memcpy(scale_shift + channels, weights_data_[node.inputs[2]], bytes);
+    memcpy(mean_mem->get_data_handle(), weights_data_[node.inputs[3]], bytes);
+    memcpy(var_mem->get_data_handle(), weights_data_[node.inputs[4]], bytes);
+
+    weights_memory_.push_back(scale_shift_mem);
+    weights_memory_.push_back(mean_mem);
+    weights_memory_.push_back(var_mem);
+
+    auto dst_mem = std::make_shared<mkldnn::memory>(bn_pd.dst_primitive_desc());
+    net_.push_back(mkldnn::batch_normalization_forward(
+        bn_pd, (const mkldnn::primitive::at)src_mem, (const mkldnn::primitive::at)*mean_mem,
+        (const mkldnn::primitive::at)*var_mem, (const mkldnn::memory)*scale_shift_mem, *dst_mem));
+
+    SetOutput(node.outputs[0], dims_[x], dst_mem);
+  }
+
+  void AddLRN(const SubgraphNode& node) {
+    const int x = node.inputs[0];
+    auto& src_mem = *memory_[x];
+
+    mkldnn::lrn_forward::desc fwd_desc(
+        mkldnn::prop_kind::forward_scoring, mkldnn::algorithm::lrn_across_channels,
+        src_mem.get_primitive_desc().desc(),
+        static_cast<int>(GetIntAttribute(node.attributes, "size", 1)),
+        GetFloatAttribute(node.attributes, "alpha", 0.0001f),
+        GetFloatAttribute(node.attributes, "beta", 0.75f),
+        GetFloatAttribute(node.attributes, "bias", 1.0f));
+    mkldnn::lrn_forward::primitive_desc lrn_pd(fwd_desc, cpu_engine_);
+
+    auto dst_mem = std::make_shared<mkldnn::memory>(lrn_pd.dst_primitive_desc());
+    net_.push_back(mkldnn::lrn_forward(lrn_pd, src_mem, *dst_mem));
+
+    SetOutput(node.outputs[0], dims_[x], dst_mem);
+  }
+
+  void AddPool(const SubgraphNode& node) {
+    const int x = node.inputs[0];
+    auto& src_mem = *memory_[x];
+    const auto& x_dims = dims_[x];
+
+    const bool global = node.op_type == "GlobalAveragePool" || node.op_type == "GlobalMaxPool";
+    const bool max = node.op_type == "MaxPool" || node.op_type == "GlobalMaxPool";
+
+    mkldnn::memory::dims kernel;
+    mkldnn::memory::dims strides;
+    mkldnn::memory::dims pads;
+    if (global) {
+      kernel = {x_dims[2], x_dims[3]};
+      strides = {1, 1};
+      pads = {0, 0, 0, 0};
+    } else {
+      kernel = GetIntsAttribute(node.attributes, "kernel_shape", 2, 1);
+      strides = GetIntsAttribute(node.attributes, "strides", 2, 1);
+      pads = GetIntsAttribute(node.attributes, "pads", 4, 0);
+    }
+
+    mkldnn::memory::dims y_dims{x_dims[0], x_dims[1],
+                                ComputeOutputSize(x_dims[2], kernel[0], strides[0], 1, pads[0], pads[2]),
+                                ComputeOutputSize(x_dims[3], kernel[1], strides[1], 1, pads[1], pads[3])};
+    mkldnn::memory::dims padding_left{pads[0], pads[1]};
+    mkldnn::memory::dims padding_right{pads[2], pads[3]};
+
+    mkldnn::algorithm algo = mkldnn::algorithm::pooling_max;
+    if (!max) {
+      algo = GetIntAttribute(node.attributes, "count_include_pad", 0) != 0
+                 ? mkldnn::algorithm::pooling_avg_include_padding
+                 : mkldnn::algorithm::pooling_avg_exclude_padding;
+    }
+
+    mkldnn::memory::desc dst_md(y_dims, MklDnnType<float>(), mkldnn::memory::format::any);
+    mkldnn::pooling_forward::desc fwd_desc(mkldnn::prop_kind::forward_inference, algo,
+                                           src_mem.get_primitive_desc().desc(), dst_md,
+                                           strides, kernel, padding_left, padding_right,
+                                           mkldnn::padding_kind::zero);
+    mkldnn::pooling_forward::primitive_desc pool_pd(fwd_desc, cpu_engine_);
+
+    auto dst_mem = std::make_shared<mkldnn::memory>(pool_pd.dst_primitive_desc());
+    net_.push_back(mkldnn::pooling_forward(pool_pd, src_mem, *dst_mem));
+
+    SetOutput(node.outputs[0], y_dims, dst_mem);
+  }
+
+  void AddSum(const SubgraphNode& node) {
+    std::vector<mkldnn::memory::primitive_desc> srcs_pd;
+    std::vector<mkldnn::primitive::at> inputs;
+    std::vector<float> scales;
+    for (int input : node.inputs) {
+      srcs_pd.push_back(memory_[input]->get_primitive_desc());
+      inputs.push_back(*memory_[input]);
+      scales.push_back(1.0f);
+    }
+
+    const auto& dims = dims_[node.inputs[0]];
+    mkldnn::memory::desc dst_md(dims, MklDnnType<float>(), mkldnn::memory::format::any);
+    mkldnn::sum::primitive_desc sum_pd(dst_md, scales, srcs_pd);
+
+    auto dst_mem = std::make_shared<mkldnn::memory>(sum_pd.dst_primitive_desc());
+    net_.push_back(mkldnn::sum(sum_pd, inputs, *dst_mem));
+
+    SetOutput(node.outputs[0], dims, dst_mem);
+  }
+
+  Subgraph& subgraph_;
+  mkldnn::engine& cpu_engine_;
+
+  // Dimensions and current memory of each value of the subgraph.
+  std::vector<mkldnn::memory::dims> dims_;
+  std::vector<std::shared_ptr<mkldnn::memory>> memory_;
+
+  // Weights data of the current build, indexed by value.
+  std::vector<const void*> weights_data_;
+
+  std::vector<std::shared_ptr<mkldnn::memory>> input_memory_;
+  std::vector<std::shared_ptr<mkldnn::memory>> output_memory_;
+  std::vector<std::shared_ptr<mkldnn::memory>> intermediate_memory_;
+  std::vector<std::shared_ptr<mkldnn::memory>> weights_memory_;
+
+  std::vector<mkldnn::primitive> net_;
+};
+
+Subgraph::Subgraph(const Node& fused_node) {
+  const Graph& graph_body = fused_node.GetFunctionBody()->Body();
+
+  std::unordered_map<std::string, int> value_map;
+  auto get_value = [&value_map](const NodeArg* arg) {
+    if (!arg->Exists()) {
+      return -1;
+    }
+    auto iter = value_map.find(arg->Name());
+    if (iter != value_map.end()) {
+      return iter->second;
+    }
+    int value = static_cast<int>(value_map.size());
+    value_map.emplace(arg->Name(), value);
+    return value;
+  };
+
+  for (const auto* input : fused_node.InputDefs()) {
+    input_values_.push_back(get_value(input));
+  }
+
+  GraphViewer graph_viewer(graph_body);
+  for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
+    const Node* node = graph_viewer.GetNode(index);
+    SubgraphNode subgraph_node;
+    subgraph_node.op_type = node->OpType();
+    subgraph_node.attributes = node->GetAttributes();
+    for (const auto* input : node->InputDefs()) {
+      subgraph_node.inputs.push_back(get_value(input));
+    }
+    for (const auto* output : node->OutputDefs()) {
+      subgraph_node.outputs.push_back(get_value(output));
+    }
+    nodes_.push_back(std::move(subgraph_node));
+  }
+
+  for (const auto* output : fused_node.OutputDefs()) {
+    output_values_.push_back(get_value(output));
+  }
+
+  value_count_ = value_map.size();
+  is_weight_.assign(value_count_, false);
+  for (const auto& initializer : graph_body.GetAllInitializedTensors()) {
+    auto iter = value_map.find(initializer.first);
+    if (iter != value_map.end()) {
+      is_weight_[iter->second] = true;
+    }
+  }
+
+  // Fold a Relu into the Conv that produces its input if nothing else consumes the output of the Conv.
+  std::vector<int> consumers(value_count_, 0);
+  std::vector<int> producers(value_count_, -1);
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    for (int input : nodes_[i].inputs) {
+      if (input >= 0) {
+        consumers[input]++;
+      }
+    }
+    producers[nodes_[i].outputs[0]] = static_cast<int>(i);
+  }
+  for (int output : output_values_) {
+    consumers[output]++;
+  }
+
+  std::vector<SubgraphNode> folded_nodes;
+  for (auto& node : nodes_) {
+    if (node.op_type == "Relu") {
+      const int producer = producers[node.inputs[0]];
+      if (producer >= 0 && consumers[node.inputs[0]] == 1) {
+        auto& conv = nodes_[producer];
+        if (conv.op_type == "Conv" && !conv.fused_relu) {
+          conv.fused_relu = true;
+          conv.outputs[0] = node.outputs[0];
+          continue;
+        }
+      }
+    }
+    folded_nodes.push_back(std::move(node));
+  }
+  nodes_ = std::move(folded_nodes);
+}
+
+Subgraph::~Subgraph() = default;
+
+std::shared_ptr<mkldnn::memory> Subgraph::GetReorderedWeights(int value, const mkldnn::memory& src,
+                                                              const mkldnn::memory::primitive_desc& dst_pd) {
+  std::string key = std::to_string(value);
+  key.append(1, '_');
+  key.append(std::to_string(dst_pd.desc().data.format));
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto iter = reordered_weights_.find(key);
+  if (iter != reordered_weights_.end()) {
+    return iter->second;
+  }
+
+  auto dst = std::make_shared<mkldnn::memory>(dst_pd);
+  MemoryReorderParams params(src, *dst);
+  DoReorder<float>(params);
+  reordered_weights_.emplace(key, dst);
+  return dst;
+}
+
+std::unique_ptr<SubgraphPrimitive> Subgraph::AcquirePrimitive(const std::string& key) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto iter = idle_primitives_.find(key);
+  if (iter == idle_primitives_.end() || iter->second.empty()) {
+    return nullptr;
+  }
+  auto primitive = std::move(iter->second.back());
+  iter->second.pop_back();
+  return primitive;
+}
+
+void Subgraph::ReleasePrimitive(const std::string& key, std::unique_ptr<SubgraphPrimitive> primitive) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  idle_primitives_[key].push_back(std::move(primitive));
+}
+
+Status Subgraph::Compute(const ONNXRunTimeTensor* input_tensors, size_t num_inputs,
+                         ONNXRunTimeTensor* output_tensors, size_t num_outputs,
+                         AllocateFunc allocate_func, AllocatorHandle allocator) {
+  ORT_RETURN_IF_NOT(num_inputs == input_values_.size() && num_outputs == output_values_.size(),
+                    "MKL-DNN subgraph input or output count mismatch");
+
+  // The primitive chain depends on the shapes of the activation inputs only.
+  std::string key;
+  key.reserve(64);
+  for (size_t i = 0; i < num_inputs; i++) {
+    if (!is_weight_[input_values_[i]]) {
+      mkldnn::memory::dims dims(input_tensors[i].shape, input_tensors[i].shape + input_tensors[i].ndim);
+      AddDimsToKey(key, dims);
+    }
+  }
+
+  try {
+    auto primitive = AcquirePrimitive(key);
+    if (primitive == nullptr) {
+      primitive = std::make_unique<SubgraphPrimitive>(*this, input_tensors);
+    }
+    primitive->Compute(input_tensors, output_tensors, allocate_func, allocator);
+    ReleasePrimitive(key, std::move(primitive));
+  } catch (const mkldnn::error& e) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Status: ", e.status, ", message: ", e.message.c_str());
+  }
+
+  return Status::OK();
+}
+
+}  // namespace mkl_dnn
+}  // namespace onnxruntime
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mkldnn.hpp"
+#include "core/platform/ort_mutex.h"
+#include "core/framework/func_api.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace mkl_dnn {
+
+class SubgraphPrimitive;
+
+// Returns true if the node can be executed as part of a fused MKL-DNN subgraph.
+bool IsSubgraphNodeSupported(const Node& node, const GraphViewer& graph_viewer);
+
+// Operator of a fused MKL-DNN subgraph. The inputs and outputs are indexes into the values of the subgraph.
+struct SubgraphNode {
+  std::string op_type;
+  NodeAttributes attributes;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+  // Set for a Conv node that has absorbed the Relu that consumed its output.
+  bool fused_relu{false};
+};
+
+/**
+A contiguous region of MKL-DNN supported operators compiled into a single function.
+
+Activations stay in the blocked formats chosen by MKL-DNN from the first operator of the region to the last, and
+are only reordered to the plain NCHW layout for the outputs of the region. The primitive chain for the region is
+built once per set of input shapes and reused by subsequent runs with the same shapes.
+*/
+class Subgraph {
+ public:
+  explicit Subgraph(const Node& fused_node);
+  ~Subgraph();
+
+  Status Compute(const ONNXRunTimeTensor* input_tensors, size_t num_inputs,
+                 ONNXRunTimeTensor* output_tensors, size_t num_outputs,
+                 AllocateFunc allocate_func, AllocatorHandle allocator);
+
+  const std::vector<SubgraphNode>& Nodes() const { return nodes_; }
+  size_t ValueCount() const { return value_count_; }
+  const std::vector<int>& InputValues() const { return input_values_; }
+  const std::vector<int>& OutputValues() const { return output_values_; }
+  bool IsWeight(int value) const { return is_weight_[value]; }
+
+  // Returns the weight or bias memory reordered to the format requested by a primitive. The reorder is
+  // performed once for each weight and format and is shared by every primitive chain of the subgraph.
+  std::shared_ptr<mkldnn::memory> GetReorderedWeights(int value, const mkldnn::memory& src,
+                                                      const mkldnn::memory::primitive_desc& dst_pd);
+
+ private:
+  std::unique_ptr<SubgraphPrimitive> AcquirePrimitive(const std::string& key);
+  void ReleasePrimitive(const std::string& key, std::unique_ptr<SubgraphPrimitive> primitive);
+
+  std::vector<SubgraphNode> nodes_;
+  size_t value_count_{0};
+  std::vector<int> input_values_;
+  std::vector<int> output_values_;
+  std::vector<bool> is_weight_;
+
+  // Idle primitive chains keyed by the input shapes. A chain holds the intermediate activations of a run, so
+  // concurrent runs check out separate chains.
+  std::unordered_map<std::string, std::vector<std::unique_ptr<SubgraphPrimitive>>> idle_primitives_;
+  std::unordered_map<std::string, std::shared_ptr<mkldnn::memory>> reordered_weights_;
+  OrtMutex mutex_;
+};
+
+// Function state of a fused MKL-DNN subgraph. The subgraph itself is owned by the execution provider.
+struct SubgraphState {
+  Subgraph* subgraph;
+  AllocateFunc allocate_func;
+  AllocatorHandle allocator;
+};
+
+}  // namespace mkl_dnn
+}  // namespace onnxruntime
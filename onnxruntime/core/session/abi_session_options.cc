@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/session/onnxruntime_c_api.h"
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include "core/session/inference_session.h"
@@ -65,6 +66,55 @@ ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options) {
   options->value.enable_cpu_mem_arena = false;
 }
 
+ORT_API(void, OrtSetCpuMemArenaOptions, _In_ OrtSessionOptions* options, size_t max_bytes, int use_huge_pages,
+        int numa_node) {
+  options->value.cpu_mem_arena_max_bytes = max_bytes;
+  options->value.enable_cpu_mem_arena_huge_pages = use_huge_pages != 0;
+  options->value.cpu_mem_arena_numa_node = numa_node;
+}
+
+ORT_API(void, OrtEnableColumnarMapOutputs, _In_ OrtSessionOptions* options) {
+  options->value.enable_columnar_map_outputs = true;
+}
+
+ORT_API(void, OrtDisableColumnarMapOutputs, _In_ OrtSessionOptions* options) {
+  options->value.enable_columnar_map_outputs = false;
+}
+
+ORT_API(void, OrtEnableParallelInitialization, _In_ OrtSessionOptions* options) {
+  options->value.enable_parallel_initialization = true;
+}
+
+ORT_API(void, OrtDisableParallelInitialization, _In_ OrtSessionOptions* options) {
+  options->value.enable_parallel_initialization = false;
+}
+
+ORT_API(void, OrtEnableScanBatchParallelism, _In_ OrtSessionOptions* options) {
+  options->value.enable_scan_batch_parallelism = true;
+}
+
+ORT_API(void, OrtDisableScanBatchParallelism, _In_ OrtSessionOptions* options) {
+  options->value.enable_scan_batch_parallelism = false;
+}
+
+ORT_API(void, OrtEnableOpStatistics, _In_ OrtSessionOptions* options) {
+  options->value.enable_op_statistics = true;
+}
+
+ORT_API(void, OrtDisableOpStatistics, _In_ OrtSessionOptions* options) {
+  options->value.enable_op_statistics = false;
+}
+
+ORT_API(void, OrtEnableSharedInitializers, _In_ OrtSessionOptions* options, _In_opt_ const char* key) {
+  options->value.enable_shared_initializers = true;
+  options->value.shared_initializers_key = key != nullptr ? key : "";
+}
+
+ORT_API(void, OrtDisableSharedInitializers, _In_ OrtSessionOptions* options) {
+  options->value.enable_shared_initializers = false;
+  options->value.shared_initializers_key.clear();
+}
+
 ///< logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid) {
   options->value.session_logid = logid;
@@ -92,3 +142,26 @@ ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int s
   options->value.session_thread_pool_size = session_thread_pool_size;
   return 0;
 }
+
+static int AddThreadAffinity(std::vector<std::vector<int>>& affinity, const int* cpus, size_t num_cpus) {
+  if (cpus == nullptr || num_cpus == 0 || std::any_of(cpus, cpus + num_cpus, [](int cpu) { return cpu < 0; }))
+    return -1;
+  affinity.emplace_back(cpus, cpus + num_cpus);
+  return 0;
+}
+
+ORT_API(int, OrtAddSessionInterOpThreadAffinity, _In_ OrtSessionOptions* options, _In_ const int* cpus,
+        size_t num_cpus) {
+  return AddThreadAffinity(options->value.inter_op_thread_affinity, cpus, num_cpus);
+}
+
+ORT_API(int, OrtAddSessionIntraOpThreadAffinity, _In_ OrtSessionOptions* options, _In_ const int* cpus,
+        size_t num_cpus) {
+  return AddThreadAffinity(options->value.intra_op_thread_affinity, cpus, num_cpus);
+}
+
+ORT_API(int, OrtSetSessionThreadPoolSpinCount, _In_ OrtSessionOptions* options, int spin_count) {
+  if (spin_count < 0) return -1;
+  options->value.session_thread_pool_spin_count = spin_count;
+  return 0;
+}
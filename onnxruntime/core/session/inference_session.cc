@@ -7,6 +7,8 @@
 
 #include "core/session/inference_session.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <unordered_set>
@@ -14,6 +16,7 @@
 
 #include "core/common/logging/logging.h"
 #include "core/common/task_thread_pool.h"
+#include "core/platform/env.h"
 #include "core/platform/notification.h"
 #include "core/platform/ort_mutex.h"
 #include "core/graph/graph_viewer.h"
@@ -34,6 +37,7 @@
 #include "core/framework/sequential_executor.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/parallel_executor.h"
+#include "core/framework/parallel_for.h"
 #include "core/framework/path_lib.h"
 #include "core/framework/session_state.h"
 #include "core/framework/session_state_initializer.h"
@@ -54,6 +58,9 @@
 #ifdef USE_EIGEN_THREADPOOL
 #include <unsupported/Eigen/CXX11/ThreadPool>
 #endif
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 using namespace ONNX_NAMESPACE;
 
@@ -73,6 +80,51 @@ ORT_API_STATUS_IMPL(OrtKernelInfoGetAttribute_int64, _In_ OrtKernelInfo* info, _
   return onnxruntime::ToOrtStatus(status);
 }
 
+// Exposes the temp space allocator of a kernel through the C API.
+struct OrtScratchAllocator : OrtAllocator {
+  explicit OrtScratchAllocator(onnxruntime::AllocatorPtr allocator) : allocator_(std::move(allocator)) {
+    OrtAllocator::version = ORT_API_VERSION;
+    OrtAllocator::Alloc = [](OrtAllocator* this_, size_t size) { return static_cast<OrtScratchAllocator*>(this_)->allocator_->Alloc(size); };
+    OrtAllocator::Free = [](OrtAllocator* this_, void* p) { static_cast<OrtScratchAllocator*>(this_)->allocator_->Free(p); };
+    OrtAllocator::Info = [](const OrtAllocator* this_) { return &static_cast<const OrtScratchAllocator*>(this_)->allocator_->Info(); };
+  }
+
+ private:
+  onnxruntime::AllocatorPtr allocator_;
+};
+
+// Passed to KernelComputeWithContext, lives for the duration of the call.
+struct OrtKernelContext {
+  explicit OrtKernelContext(onnxruntime::OpKernelContextInternal& context) : context_(context) {}
+
+  onnxruntime::OpKernelContextInternal& context_;
+  std::unique_ptr<OrtScratchAllocator> scratch_allocator_;  // created on first use
+};
+
+ORT_API_STATUS_IMPL(OrtKernelContextGetScratchAllocator, _In_ OrtKernelContext* context, _Out_ OrtAllocator** out) {
+  if (context->scratch_allocator_ == nullptr) {
+    onnxruntime::AllocatorPtr allocator;
+    auto status = context->context_.GetTempSpaceAllocator(&allocator);
+    if (!status.IsOK())
+      return onnxruntime::ToOrtStatus(status);
+    context->scratch_allocator_ = std::make_unique<OrtScratchAllocator>(std::move(allocator));
+  }
+  *out = context->scratch_allocator_.get();
+  return nullptr;
+}
+
+ORT_API_STATUS_IMPL(OrtKernelContextParallelFor, _In_ OrtKernelContext* context, size_t count,
+                    _In_ void(ORT_API_CALL* fn)(_In_opt_ void* user_data, size_t index), _In_opt_ void* user_data) {
+  auto status = onnxruntime::ParallelFor(context->context_.GetSessionState().GetThreadPool(), count,
+                                         [fn, user_data](size_t i) {
+                                           fn(user_data, i);
+                                           return onnxruntime::Status::OK();
+                                         });
+  if (status.IsOK())
+    return nullptr;
+  return onnxruntime::ToOrtStatus(status);
+}
+
 namespace onnxruntime {
 namespace {
 template <typename T>
@@ -107,10 +159,230 @@ inline std::basic_string<T> GetCurrentTimeString() {
   OrtStrftime<T>(time_str, sizeof(time_str), GetDateFormatString<T>(), &local_tm);
   return std::basic_string<T>(time_str);
 }
+
+#if defined(USE_EIGEN_THREADPOOL) || defined(USE_OPENMP)
+// Calls fn on every thread of the session thread pool. The pool creates its threads itself, so fn runs from a task.
+// The tasks wait for each other before calling fn, which makes every thread of the pool run exactly one of them.
+void RunOnEachThreadPoolThread(SessionThreadPool& pool, const std::function<void()>& fn) {
+  const int num_threads = static_cast<int>(pool.NumThreads());
+  OrtMutex mutex;
+  OrtCondVar cv;
+  int started = 0;
+  int finished = 0;
+  auto run_fn = [&]() {
+    std::unique_lock<OrtMutex> lock(mutex);
+    if (++started == num_threads) {
+      cv.notify_all();
+    }
+    cv.wait(lock, [&]() { return started == num_threads; });
+    lock.unlock();
+
+    fn();
+
+    lock.lock();
+    if (++finished == num_threads) {
+      cv.notify_all();
+    }
+  };
+  for (int i = 0; i < num_threads; ++i) {
+#ifdef USE_EIGEN_THREADPOOL
+    pool.Schedule(run_fn);
+#else
+    std::packaged_task<void()> task{run_fn};
+    pool.RunTask(std::move(task));
+#endif
+  }
+  std::unique_lock<OrtMutex> lock(mutex);
+  cv.wait(lock, [&]() { return finished == num_threads; });
+}
+#endif
+
+#ifdef USE_EIGEN_THREADPOOL
+void SetThreadPoolAffinity(Eigen::NonBlockingThreadPool& pool, const std::vector<std::vector<int>>& affinity,
+                           const logging::Logger& logger) {
+  RunOnEachThreadPoolThread(pool, [&]() {
+    const auto& cpus = affinity[static_cast<size_t>(pool.CurrentThreadId()) % affinity.size()];
+    auto status = Env::Default().SetCurrentThreadAffinity(cpus);
+    if (!status.IsOK()) {
+      LOGS(logger, WARNING) << "Failed to set the affinity of a session thread: " << status.ErrorMessage();
+    }
+  });
+}
+#endif
+
+#ifdef USE_OPENMP
+// Runtimes like libgomp give each thread that starts a parallel region its own team of OpenMP threads. The team is
+// created by the runtime, so each of its threads sets its own affinity from a parallel region. Thread 0 of the region
+// is the calling thread, which is left alone. Returns the CPUs the other threads ran on before, in the same form.
+std::vector<std::vector<int>> SetOpenMPThreadAffinity(const std::vector<std::vector<int>>& affinity,
+                                                      const logging::Logger& logger) {
+  std::vector<std::vector<int>> previous_affinity(static_cast<size_t>(std::max(omp_get_max_threads() - 1, 0)));
+  if (affinity.empty()) {
+    return previous_affinity;
+  }
+#pragma omp parallel
+  {
+    const auto index = static_cast<size_t>(omp_get_thread_num()) - 1;
+    if (omp_get_thread_num() != 0 && index < previous_affinity.size()) {
+      auto status = Env::Default().GetCurrentThreadAffinity(previous_affinity[index]);
+      if (!status.IsOK()) {
+        previous_affinity[index].clear();
+      }
+      const auto& cpus = affinity[index % affinity.size()];
+      if (!cpus.empty()) {
+        status = Env::Default().SetCurrentThreadAffinity(cpus);
+        if (!status.IsOK()) {
+          LOGS(logger, WARNING) << "Failed to set the affinity of an OpenMP thread: " << status.ErrorMessage();
+        }
+      }
+    }
+  }
+  return previous_affinity;
+}
+
+// intra_op_thread_affinity is a process-wide setting. All the live sessions that set it must set the same one, as
+// the OpenMP threads started from a thread are shared by all the sessions that thread runs.
+// The OpenMP threads of the session thread pool are pinned when the session is initialized. Those of a thread calling
+// Run are pinned on its first run, and get back the affinity they had before on its first run after the last session
+// using the affinity is released, or right away for the thread releasing it.
+class OpenMPThreadAffinity {
+ public:
+  static Status Acquire(const std::vector<std::vector<int>>& affinity, const logging::Logger& logger,
+                        std::unique_ptr<OpenMPThreadAffinity>& handle) {
+    State& state = GetState();
+    std::lock_guard<OrtMutex> lock(state.mutex);
+    if (state.num_users == 0) {
+      state.affinity = affinity;
+    } else if (affinity != state.affinity) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "intra_op_thread_affinity differs from the one of another session. The affinity of "
+                             "the OpenMP threads is process-wide, so all the sessions must use the same one.");
+    }
+    ++state.num_users;
+    handle.reset(new OpenMPThreadAffinity(affinity, logger));
+    return Status::OK();
+  }
+
+  ~OpenMPThreadAffinity() {
+    {
+      State& state = GetState();
+      std::lock_guard<OrtMutex> lock(state.mutex);
+      if (--state.num_users == 0) {
+        state.affinity.clear();
+        ++state.generation;
+      }
+    }
+    RestoreCurrentThread(logger_);
+  }
+
+  // Pins the OpenMP threads of the calling thread, unless this was already done for the current affinity.
+  void ApplyToCurrentThread() const {
+    ThreadState& thread_state = GetThreadState();
+    const uint64_t generation = GetState().generation;
+    if (thread_state.generation == generation) {
+      return;
+    }
+    auto previous_affinity = SetOpenMPThreadAffinity(affinity_, logger_);
+    // keep the affinity from before the first pinning if the threads were pinned for an affinity since released
+    if (thread_state.generation == 0) {
+      thread_state.previous_affinity = std::move(previous_affinity);
+    }
+    thread_state.generation = generation;
+  }
+
+  // Gives the OpenMP threads of the calling thread their affinity back if they were pinned for an affinity that was
+  // released since.
+  static void RestoreCurrentThread(const logging::Logger& logger) {
+    ThreadState& thread_state = GetThreadState();
+    if (thread_state.generation == 0 || thread_state.generation == GetState().generation) {
+      return;
+    }
+    SetOpenMPThreadAffinity(thread_state.previous_affinity, logger);
+    thread_state.previous_affinity.clear();
+    thread_state.generation = 0;
+  }
+
+ private:
+  struct State {
+    OrtMutex mutex;
+    std::vector<std::vector<int>> affinity;  // GUARDED_BY(mutex)
+    int num_users = 0;                       // GUARDED_BY(mutex)
+    // incremented when the last user is released, so the threads pinned before can tell
+    std::atomic<uint64_t> generation{1};
+  };
+
+  // generation 0: the OpenMP threads of the thread weren't pinned
+  struct ThreadState {
+    uint64_t generation = 0;
+    std::vector<std::vector<int>> previous_affinity;
+  };
+
+  static State& GetState() {
+    static State state;
+    return state;
+  }
+
+  static ThreadState& GetThreadState() {
+    static thread_local ThreadState thread_state;
+    return thread_state;
+  }
+
+  OpenMPThreadAffinity(const std::vector<std::vector<int>>& affinity, const logging::Logger& logger)
+      : affinity_(affinity), logger_(logger) {}
+
+  const std::vector<std::vector<int>> affinity_;
+  const logging::Logger& logger_;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(OpenMPThreadAffinity);
+};
+#endif
+
+// The index returned by GetMayInplaceInput/GetAliasInput of a custom op must be -1 or a valid input index.
+Status ValidateCustomOpInputIndex(OrtCustomOp* op, int input_index, size_t input_count, size_t output_index,
+                                  const char* callback) {
+  if (input_index < -1 || (input_index >= 0 && static_cast<size_t>(input_index) >= input_count)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Custom op ", op->GetName(op), " returned input index ",
+                           input_index, " from ", callback, " for output ", output_index, " but it has ",
+                           input_count, " inputs");
+  }
+  return Status::OK();
+}
+
+// Returns the NUMA node of the CPUs the session threads are pinned to, or -1 if they aren't pinned, the CPUs are on
+// several nodes or the node of a CPU is unknown.
+int GetNumaNodeOfSessionThreads(const SessionOptions& session_options) {
+  int numa_node = -1;
+  const auto& inter_op = session_options.inter_op_thread_affinity;
+  const auto& intra_op = session_options.intra_op_thread_affinity;
+  for (const auto* affinity : {&inter_op, &intra_op}) {
+    for (const auto& cpus : *affinity) {
+      for (int cpu : cpus) {
+        const int cpu_node = Env::Default().GetNumaNodeOfCpu(cpu);
+        if (cpu_node < 0 || (numa_node >= 0 && cpu_node != numa_node)) {
+          return -1;
+        }
+        numa_node = cpu_node;
+      }
+    }
+  }
+  return numa_node;
+}
 }  // namespace
 struct CustomOpKernel : OpKernel {
   CustomOpKernel(const OpKernelInfo& info, OrtCustomOp& op) : OpKernel(info), op_(op) {
     op_.CreateKernel(&op_, reinterpret_cast<OrtKernelInfo*>(const_cast<OpKernelInfo*>(&info)), &op_kernel_);
+
+    if (op_.version >= ORT_CUSTOM_OP_VERSION_2 && op_.KernelPrePackConstantInput != nullptr) {
+      for (int i = 0, end = static_cast<int>(info.GetInputCount()); i < end; i++) {
+        const Tensor* tensor = nullptr;
+        if (!info.TryGetConstantInput(i, &tensor))
+          continue;
+        // the initializer is owned by the session state, so the value doesn't delete it
+        MLValue value;
+        value.Init(const_cast<Tensor*>(tensor), DataTypeImpl::GetType<Tensor>(), [](void*) {});
+        op_.KernelPrePackConstantInput(op_kernel_, i, reinterpret_cast<const OrtValue*>(&value));
+      }
+    }
   }
 
   ~CustomOpKernel() {
@@ -129,10 +401,16 @@ struct CustomOpKernel : OpKernel {
     for (int i = 0; i < output_count; i++) {
       OrtTensorTypeAndShapeInfo info;
       op_.KernelGetOutputShape(op_kernel_, input_tensors.data(), input_tensors.size(), i, &info);
-      output_tensors.emplace_back(reinterpret_cast<OrtValue*>(ictx->OutputMLValue(0, info.shape)));
+      output_tensors.emplace_back(reinterpret_cast<OrtValue*>(ictx->OutputMLValue(i, info.shape)));
     }
 
-    op_.KernelCompute(op_kernel_, input_tensors.data(), input_tensors.size(), output_tensors.data(), output_tensors.size());
+    if (op_.version >= ORT_CUSTOM_OP_VERSION_2 && op_.KernelComputeWithContext != nullptr) {
+      OrtKernelContext context(*ictx);
+      op_.KernelComputeWithContext(op_kernel_, &context, input_tensors.data(), input_tensors.size(),
+                                   output_tensors.data(), output_tensors.size());
+    } else {
+      op_.KernelCompute(op_kernel_, input_tensors.data(), input_tensors.size(), output_tensors.data(), output_tensors.size());
+    }
     return Status::OK();
   }
 
@@ -156,23 +434,32 @@ class InferenceSession::Impl {
 
     InitLogger(logging_manager);
 
-    // currently the threadpool is used by the parallel executor only and hence
-    // there is no point creating it when only sequential execution is enabled.
-    if (!session_options.enable_sequential_execution) {
+    // the threadpool is used by the parallel executor, by parallel initialization and by Scan batch parallelism,
+    // and hence there is no point creating it when none of them is enabled.
+    if (!session_options.enable_sequential_execution || session_options.enable_parallel_initialization ||
+        session_options.enable_scan_batch_parallelism) {
       int pool_size = session_options_.session_thread_pool_size == 0
                           ? std::thread::hardware_concurrency() / 2
                           : session_options_.session_thread_pool_size;
 
 #ifdef USE_EIGEN_THREADPOOL
       thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(pool_size);
+      if (!session_options_.inter_op_thread_affinity.empty()) {
+        SetThreadPoolAffinity(*thread_pool_, session_options_.inter_op_thread_affinity, *session_logger_);
+      }
 #else
-      thread_pool_ = std::make_unique<TaskThreadPool>(pool_size);
+      thread_pool_ = std::make_unique<TaskThreadPool>(pool_size, session_options_.inter_op_thread_affinity,
+                                                      session_options_.session_thread_pool_spin_count);
 #endif
     }
 
     session_state_.SetThreadPool(thread_pool_.get());
+    session_state_.SetScanBatchParallelismFlag(session_options.enable_scan_batch_parallelism);
     session_profiler_.Initialize(session_logger_);
     session_state_.SetProfiler(session_profiler_);
+    if (session_options.enable_op_statistics) {
+      session_profiler_.EnableOpStatistics();
+    }
     if (session_options.enable_profiling) {
       StartProfiling(session_options.profile_file_prefix);
     }
@@ -245,6 +532,22 @@ class InferenceSession::Impl {
             .SetDomain(onnxruntime::kOnnxDomain)
             .SinceVersion(1)
             .Provider(onnxruntime::kCpuExecutionProvider);
+        if (op->version >= ORT_CUSTOM_OP_VERSION_2) {
+          for (size_t i = 0; i < output_count; i++) {
+            if (op->GetMayInplaceInput != nullptr) {
+              int input_index = op->GetMayInplaceInput(op, i);
+              ORT_RETURN_IF_ERROR(ValidateCustomOpInputIndex(op, input_index, input_count, i, "GetMayInplaceInput"));
+              if (input_index >= 0)
+                def_builder.MayInplace(input_index, static_cast<int>(i));
+            }
+            if (op->GetAliasInput != nullptr) {
+              int input_index = op->GetAliasInput(op, i);
+              ORT_RETURN_IF_ERROR(ValidateCustomOpInputIndex(op, input_index, input_count, i, "GetAliasInput"));
+              if (input_index >= 0)
+                def_builder.Alias(input_index, static_cast<int>(i));
+            }
+          }
+        }
         KernelCreateFn kernel_create_fn = [&op](const OpKernelInfo& info) -> OpKernel* { return new CustomOpKernel(info, *op); };
         KernelCreateInfo create_info(def_builder.Build(), kernel_create_fn);
 
@@ -441,8 +744,11 @@ class InferenceSession::Impl {
   /// iterate nodes in graph looking for ones with graph attribute/s
   /// @param graph The graph to iterate
   /// @param session_state The SessionState instance for 'graph'.
+  /// @param shared_initializers_key The SessionOptions::shared_initializers_key of 'graph'. The subgraphs use keys
+  ///        derived from it.
   /// @remarks We pass in graph and session_state so we can handled nested subgraphs in the future
-  common::Status InitializeSubgraphSessions(Graph& graph, SessionState& session_state) {
+  common::Status InitializeSubgraphSessions(Graph& graph, SessionState& session_state,
+                                            const std::string& shared_initializers_key) {
     for (auto& node : graph.Nodes()) {
       for (const auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
         auto& name = entry.first;
@@ -451,20 +757,33 @@ class InferenceSession::Impl {
         SessionState* subgraph_session_state = session_state.GetMutableSubgraphSessionState(node.Index(), name);
         ORT_ENFORCE(subgraph_session_state, "CreateSubgraphSessionState should have created an entry earlier.");
 
+        // the thread pool is used to initialize the subgraph in parallel, and by control flow operators such as
+        // Scan that can execute independent iterations of the subgraph concurrently.
+        subgraph_session_state->SetThreadPool(session_state.GetThreadPool());
+        subgraph_session_state->SetScanBatchParallelismFlag(session_state.ScanBatchParallelismEnabled());
+
         // setup everything required to execute the subgraph and save it in subgraph_session_state
         SessionStateInitializer initializer{model_location_, subgraph, *subgraph_session_state, execution_providers_,
                                             kernel_registry_manager_};
 
         ORT_RETURN_IF_ERROR(initializer.CreatePlan(&node, node.ImplicitInputDefs(),
                                                    session_options_.enable_sequential_execution));
+        // initializer names are only unique within a graph
+        const std::string subgraph_shared_initializers_key =
+            shared_initializers_key.empty() ? "" : shared_initializers_key + "/" + node.Name() + "/" + name;
+        if (session_options_.enable_shared_initializers) {
+          initializer.EnableSharedInitializers(subgraph_shared_initializers_key);
+        }
 
-        ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(&node.ImplicitInputDefs()));
+        ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(&node.ImplicitInputDefs(),
+                                                          session_options_.enable_parallel_initialization));
 
         // LOGS(*session_logger_, VERBOSE) << std::make_pair(subgraph_info.session_state->GetExecutionPlan(),
         //                                                   &*subgraph_info.session_state);
 
         // recurse
-        ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(subgraph, *subgraph_session_state));
+        ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(subgraph, *subgraph_session_state,
+                                                       subgraph_shared_initializers_key));
       }
     }
 
@@ -488,10 +807,28 @@ class InferenceSession::Impl {
         return common::Status::OK();
       }
 
+#ifdef USE_OPENMP
+      if (!session_options_.intra_op_thread_affinity.empty() && !intra_op_thread_affinity_) {
+        ORT_RETURN_IF_ERROR(OpenMPThreadAffinity::Acquire(session_options_.intra_op_thread_affinity,
+                                                          *session_logger_, intra_op_thread_affinity_));
+        if (thread_pool_) {
+          RunOnEachThreadPoolThread(*thread_pool_, [this]() { intra_op_thread_affinity_->ApplyToCurrentThread(); });
+        }
+      }
+#endif
+
       // Register default CPUExecutionProvider if user didn't provide it through the Register() calls
       if (!execution_providers_.Get(onnxruntime::kCpuExecutionProvider)) {
         LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
         CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+        epi.arena_max_bytes = session_options_.cpu_mem_arena_max_bytes;
+        epi.use_huge_pages = session_options_.enable_cpu_mem_arena_huge_pages;
+        epi.numa_node = session_options_.cpu_mem_arena_numa_node >= 0 ? session_options_.cpu_mem_arena_numa_node
+                                                                      : GetNumaNodeOfSessionThreads(session_options_);
+        if (epi.numa_node != session_options_.cpu_mem_arena_numa_node) {
+          LOGS(*session_logger_, INFO) << "Binding the CPU memory arena to NUMA node " << epi.numa_node
+                                       << ", the node of the CPUs the session threads are pinned to.";
+        }
         ORT_RETURN_IF_ERROR(execution_providers_.Add(onnxruntime::kCpuExecutionProvider,
                                                      std::make_unique<CPUExecutionProvider>(epi)));
       }
@@ -526,11 +863,17 @@ class InferenceSession::Impl {
       // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
       ORT_RETURN_IF_ERROR(graph.Resolve());
 
-      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan(nullptr, {}, session_options_.enable_sequential_execution));
-      ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(nullptr));
+      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan(nullptr, {}, session_options_.enable_sequential_execution,
+                                                         session_options_.enable_columnar_map_outputs));
+      if (session_options_.enable_shared_initializers) {
+        session_initializer.EnableSharedInitializers(session_options_.shared_initializers_key);
+      }
+      ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(nullptr,
+                                                                session_options_.enable_parallel_initialization));
 
       // handle any subgraphs
-      ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(graph, session_state_));
+      ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(graph, session_state_,
+                                                     session_options_.shared_initializers_key));
 
       session_state_.CalculateNodeIndexInfo();
 
@@ -697,6 +1040,14 @@ class InferenceSession::Impl {
         }
       }
 
+#ifdef USE_OPENMP
+      if (intra_op_thread_affinity_) {
+        intra_op_thread_affinity_->ApplyToCurrentThread();
+      } else {
+        OpenMPThreadAffinity::RestoreCurrentThread(*session_logger_);
+      }
+#endif
+
       ORT_RETURN_IF_ERROR(ValidateInputs(feed_names, feeds));
 
       // if the output vector is non-empty, ensure that its the same size as the output_names
@@ -833,6 +1184,29 @@ class InferenceSession::Impl {
     return std::string();
   }
 
+  std::string GetOpStatistics(bool reset) {
+    if (!session_profiler_.FOpStatisticsEnabled()) {
+      LOGS(*session_logger_, WARNING) << "Op statistics are not enabled in the session options.";
+    }
+    return session_profiler_.GetOpStatistics(reset).ToJson();
+  }
+
+  common::Status UpdateNodePrioritiesFromOpStatistics() {
+    {
+      std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+      if (!is_inited_) {
+        LOGS(*session_logger_, ERROR) << "Session was not initialized";
+        return common::Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+      }
+    }
+
+    if (!session_profiler_.FOpStatisticsEnabled()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Op statistics are not enabled in the session options.");
+    }
+    session_state_.UpdateNodePriorities(session_profiler_.GetOpStatistics());
+    return Status::OK();
+  }
+
  private:
   bool HasLocalSchema() const {
     return !custom_schema_registries_.empty();
@@ -1055,6 +1429,10 @@ class InferenceSession::Impl {
 #else
   std::unique_ptr<TaskThreadPool> thread_pool_;
 #endif
+#ifdef USE_OPENMP
+  // Pins the OpenMP threads as long as the session is alive
+  std::unique_ptr<OpenMPThreadAffinity> intra_op_thread_affinity_;
+#endif
 
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_;
@@ -1158,6 +1536,14 @@ std::string InferenceSession::EndProfiling() {
   return impl_->EndProfiling();
 }
 
+std::string InferenceSession::GetOpStatistics(bool reset) {
+  return impl_->GetOpStatistics(reset);
+}
+
+common::Status InferenceSession::UpdateNodePrioritiesFromOpStatistics() {
+  return impl_->UpdateNodePrioritiesFromOpStatistics();
+}
+
 common::Status InferenceSession::RegisterExecutionProvider(std::unique_ptr<IExecutionProvider> p_exec_provider) {
   return impl_->RegisterExecutionProvider(std::move(p_exec_provider));
 }
@@ -51,6 +51,16 @@ struct SessionOptions {
   // set this option to false if you don't want it.
   bool enable_cpu_mem_arena = true;
 
+  // Options of the CPU memory arena, see CPUExecutionProviderInfo.
+  // Upper bound of the memory held by the arena. Run fails with an out of memory error past it. 0: unbounded
+  size_t cpu_mem_arena_max_bytes = 0;
+  // Back the arena with huge pages, which reduces the TLB misses on large activations.
+  bool enable_cpu_mem_arena_huge_pages = false;
+  // Bind the arena to the memory of a NUMA node, e.g. the node of the cores the session runs on.
+  // -1: the node of the CPUs in inter_op_thread_affinity and intra_op_thread_affinity if they are all on one node,
+  // no binding otherwise.
+  int cpu_mem_arena_numa_node = -1;
+
   // the prefix of the profile file. The current time will be appended to the file name.
   std::basic_string<ORTCHAR_T> profile_file_prefix = ORT_TSTR("onnxruntime_profile_");
 
@@ -63,7 +73,58 @@ struct SessionOptions {
   TransformerLevel graph_optimization_level = TransformerLevel::Default;
 
   // How many threads in the session thread pool.
+  // The thread pool is also used by opset 8 Scan nodes to execute the batch entries of their subgraph concurrently.
   int session_thread_pool_size = 0;
+
+  // CPU sets the threads of the session thread pool (inter-op) run on, thread i runs on the CPUs of
+  // inter_op_thread_affinity[i % inter_op_thread_affinity.size()]. Give one set to confine all the threads to it,
+  // or one set per thread to pin each thread. Empty: no affinity.
+  std::vector<std::vector<int>> inter_op_thread_affinity;
+
+  // CPU sets of the threads that run the kernels in parallel (intra-op), in the same form as
+  // inter_op_thread_affinity. These are the OpenMP threads. Runtimes like libgomp give each thread its own OpenMP
+  // threads, so the ones of the session thread pool are pinned by Initialize and the ones of a thread calling Run
+  // on its first run. The thread calling Run itself isn't pinned. A thread's OpenMP threads serve every session it
+  // runs, so the affinity is process-wide: Initialize fails if another live session set a different one. Once the
+  // last session that set it is released, a thread's OpenMP threads get their previous affinity back on its next
+  // Run. Only applied in builds with OpenMP.
+  std::vector<std::vector<int>> intra_op_thread_affinity;
+
+  // Number of times an idle thread of the session thread pool checks for work before blocking. Spinning
+  // lowers the latency of the nodes that become ready just after a thread went idle, at the cost of CPU time.
+  // The Eigen thread pool spins by itself and ignores it.
+  int session_thread_pool_spin_count = 0;
+
+  // Return the seq(map) graph outputs produced by ZipMap as ColumnarMapSequence instances that share the
+  // label array and keep the values dense, instead of a std::vector of std::map.
+  // Individual maps are only built when requested, e.g. through OrtGetValue.
+  bool enable_columnar_map_outputs = false;
+
+  // Use the session thread pool to deserialize initializers and create kernels in parallel during Initialize.
+  // Control flow subgraphs use the pool for their own initializers and kernels, but the subgraph sessions are
+  // initialized one after the other. The thread pool is created for this even if enable_sequential_execution
+  // is true. Kernel constructors must be thread-safe (see OpKernel); kernels of custom registries are always
+  // constructed on the calling thread.
+  bool enable_parallel_initialization = false;
+
+  // Let Scan (opset 8) run the entries of a batch concurrently on the session thread pool once the first entry has
+  // allocated the outputs. The thread pool is created for this even if enable_sequential_execution is true.
+  bool enable_scan_batch_parallelism = false;
+
+  // Aggregate the kernel latencies by op type and by node. This is cheap enough to leave on in production,
+  // and unlike enable_profiling it doesn't write a file. See InferenceSession::GetOpStatistics.
+  bool enable_op_statistics = false;
+
+  // Share the CPU initializers with the other sessions of the process that have the same initializers, instead of
+  // each session holding its own copy, e.g. for several replicas of a model or variants sharing a backbone.
+  // Initializers are matched by type, shape and content, see SharedInitializerStore.
+  bool enable_shared_initializers = false;
+
+  // If not empty, shared initializers are matched by this key and their name instead of by content, which avoids
+  // deserializing and hashing them again in every session. Sessions that use the same key should have the same
+  // initializers under the same names. The type, shape and content are still compared, and an initializer that
+  // differs from the stored one is not shared: the session uses its own copy and logs a warning.
+  std::string shared_initializers_key;
 };
 
 /**
@@ -269,6 +330,22 @@ class InferenceSession {
     */
   std::string EndProfiling();
 
+  /**
+    * Get the kernel latencies aggregated since the session was created or since the last reset, as a JSON string.
+    * Requires SessionOptions::enable_op_statistics. This doesn't affect the profiling started by StartProfiling.
+    *@param reset Clear the statistics, so the next call only covers the runs that follow.
+    *@return the statistics in the format of profiling::OpStatistics::ToJson.
+    */
+  std::string GetOpStatistics(bool reset = false);
+
+  /**
+    * Use the kernel latencies aggregated so far as the node costs when the parallel executor picks the next node
+    * to run, so the nodes on the slowest path through the graph are started first. Without this every node has
+    * the same cost. Requires SessionOptions::enable_op_statistics and an initialized session. Can be called
+    * periodically while other threads are running the session.
+    */
+  common::Status UpdateNodePrioritiesFromOpStatistics();
+
  protected:
   /**
     * Load an ONNX model.
@@ -14,6 +14,7 @@
 #include "core/common/status.h"
 #include "core/graph/graph.h"
 #include "core/framework/allocator.h"
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/tensor.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/environment.h"
@@ -22,6 +23,7 @@
 #include "core/framework/onnxruntime_typeinfo.h"
 #include "core/session/inference_session.h"
 #include "core/framework/data_types.h"
+#include "core/framework/shared_initializer_store.h"
 #include "abi_session_options_impl.h"
 
 using namespace onnxruntime::logging;
@@ -163,6 +165,30 @@ ORT_API_STATUS_IMPL(OrtFillStringTensor, _In_ OrtValue* value, _In_ const char*
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtFillStringTensorContent, _In_ OrtValue* value, _In_ const void* s, size_t s_len,
+                    _In_ const size_t* offsets, size_t offsets_len) {
+  TENSOR_READWRITE_API_BEGIN
+  auto* dst = tensor->MutableData<std::string>();
+  auto len = static_cast<size_t>(tensor->Shape().Size());
+  if (offsets_len != len) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "offsets_len must match the number of elements in the tensor");
+  }
+  for (size_t i = 0; i != len; ++i) {
+    size_t end = i + 1 != len ? offsets[i + 1] : s_len;
+    if (offsets[i] > end || end > s_len) {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "offsets must be increasing and not exceed s_len");
+    }
+  }
+  const char* chars = static_cast<const char*>(s);
+  for (size_t i = 0; i != len; ++i) {
+    size_t end = i + 1 != len ? offsets[i + 1] : s_len;
+    // assign rather than construct, so the string reuses its existing capacity
+    dst[i].assign(chars + offsets[i], end - offsets[i]);
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 template <typename T>
 OrtStatus* CreateTensorImpl(const size_t* shape, size_t shape_len, OrtAllocator* allocator,
                             std::unique_ptr<Tensor>* out) {
@@ -482,7 +508,7 @@ ORT_API_STATUS_IMPL(OrtGetStringTensorContent, _In_ const OrtValue* value,
   }
   size_t f = 0;
   char* p = static_cast<char*>(s);
-  for (size_t i = 0; i != offsets_len; ++i, ++offsets) {
+  for (size_t i = 0; i != len; ++i, ++offsets) {
     memcpy(p, input[i].data(), input[i].size());
     p += input[i].size();
     *offsets = f;
@@ -664,6 +690,24 @@ ORT_API_STATUS_IMPL(OrtSessionGetOutputName, _In_ const OrtSession* sess, size_t
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtSessionGetOpStatistics, _In_ OrtSession* sess, int reset,
+                    _Inout_ OrtAllocator* allocator, _Out_ char** output) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  *output = StrDup(session->GetOpStatistics(reset != 0), allocator);
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtGetSharedInitializerStatistics, _Out_ size_t* bytes, _Out_ size_t* bytes_saved) {
+  API_IMPL_BEGIN
+  auto statistics = ::onnxruntime::SharedInitializerStore::Instance().GetStatistics();
+  *bytes = statistics.bytes;
+  *bytes_saved = statistics.bytes_saved;
+  return nullptr;
+  API_IMPL_END
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // Code to handle non-tensor types
 // OrtGetValueCount
@@ -702,6 +746,10 @@ static OrtStatus* OrtGetValueCountImpl(const OrtValue* value, size_t* out) {
       return OrtGetNumSequenceElements<VectorMapStringToFloat>(v, out);
     } else if (type == DataTypeImpl::GetType<VectorMapInt64ToFloat>()) {
       return OrtGetNumSequenceElements<VectorMapInt64ToFloat>(v, out);
+    } else if (type == DataTypeImpl::GetType<ColumnarMapStringToFloat>()) {
+      return OrtGetNumSequenceElements<ColumnarMapStringToFloat>(v, out);
+    } else if (type == DataTypeImpl::GetType<ColumnarMapInt64ToFloat>()) {
+      return OrtGetNumSequenceElements<ColumnarMapInt64ToFloat>(v, out);
     } else {
       return OrtCreateStatus(ORT_FAIL, "Input is not of one of the supported sequence types.");
     }
@@ -735,6 +783,23 @@ static OrtStatus* OrtGetValueImplSeqOfMap(const MLValue* p_ml_value, int index,
   return nullptr;
 }
 
+// Returns a map that shares the storage of the columnar sequence instead of building a std::map
+template <typename T>
+static OrtStatus* OrtGetValueImplColumnarSeqOfMap(const MLValue* p_ml_value, int index, OrtValue** out) {
+  using ViewType = ColumnarMapView<typename T::key_type, typename T::mapped_type>;
+  auto& data = p_ml_value->Get<T>();
+  if (index < 0 || static_cast<size_t>(index) >= data.size()) {
+    return OrtCreateStatus(ORT_FAIL, "Invalid index requested for sequence type.");
+  }
+  auto view = std::make_unique<ViewType>(data, static_cast<size_t>(index));
+  std::unique_ptr<MLValue> value = std::make_unique<MLValue>();
+  value->Init(view.release(),
+              DataTypeImpl::GetType<ViewType>(),
+              DataTypeImpl::GetType<ViewType>()->GetDeleteFunc());
+  *out = reinterpret_cast<OrtValue*>(value.release());
+  return nullptr;
+}
+
 template <typename T>
 ONNXTensorElementDataType GetONNXTensorElementDataType() {
   return ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
@@ -816,17 +881,20 @@ static OrtStatus* OrtGetValueImplSeq(const OrtValue* value, int index, OrtAlloca
     return OrtGetValueImplSeqOfMap<VectorMapStringToFloat>(p_ml_value, index, out);
   } else if (type == DataTypeImpl::GetType<VectorMapInt64ToFloat>()) {
     return OrtGetValueImplSeqOfMap<VectorMapInt64ToFloat>(p_ml_value, index, out);
+  } else if (type == DataTypeImpl::GetType<ColumnarMapStringToFloat>()) {
+    return OrtGetValueImplColumnarSeqOfMap<ColumnarMapStringToFloat>(p_ml_value, index, out);
+  } else if (type == DataTypeImpl::GetType<ColumnarMapInt64ToFloat>()) {
+    return OrtGetValueImplColumnarSeqOfMap<ColumnarMapInt64ToFloat>(p_ml_value, index, out);
   } else {
     return OrtCreateStatus(ORT_FAIL, "Input is not of one of the supported sequence types.");
   }
 }
 
 template <typename T>
-static OrtStatus* OrtGetValueImplMapHelper(const MLValue* p_ml_value, int index, OrtAllocator* allocator,
-                                           OrtValue** out) {
+static OrtStatus* OrtGetValueImplMapDataHelper(const T& data, int index, OrtAllocator* allocator,
+                                               OrtValue** out) {
   using TKey = typename T::key_type;
   using TVal = typename T::mapped_type;
-  auto& data = p_ml_value->Get<T>();
   size_t num_kv_pairs = data.size();
   switch (index) {
     case 0: {  // user is requesting keys
@@ -856,6 +924,23 @@ static OrtStatus* OrtGetValueImplMapHelper(const MLValue* p_ml_value, int index,
   }
 }
 
+template <typename T>
+static OrtStatus* OrtGetValueImplMapHelper(const MLValue* p_ml_value, int index, OrtAllocator* allocator,
+                                           OrtValue** out) {
+  return OrtGetValueImplMapDataHelper(p_ml_value->Get<T>(), index, allocator, out);
+}
+
+// The keys and values of a map of a columnar sequence are copied with 'allocator' like those of a std::map, and in
+// the same order, so the caller owns them and they outlive the sequence.
+template <typename T>
+static OrtStatus* OrtGetValueImplColumnarMapView(const MLValue* p_ml_value, int index, OrtAllocator* allocator,
+                                                 OrtValue** out) {
+  if (index != 0 && index != 1) {
+    return OrtCreateStatus(ORT_FAIL, "Invalid index requested for map type.");
+  }
+  return OrtGetValueImplMapDataHelper(p_ml_value->Get<T>().ToMap(), index, allocator, out);
+}
+
 static OrtStatus* OrtGetValueImplMap(const OrtValue* value, int index, OrtAllocator* allocator,
                                      OrtValue** out) {
   auto p_ml_value = reinterpret_cast<const MLValue*>(value);
@@ -877,6 +962,10 @@ static OrtStatus* OrtGetValueImplMap(const OrtValue* value, int index, OrtAlloca
     return OrtGetValueImplMapHelper<MapInt64ToFloat>(p_ml_value, index, allocator, out);
   } else if (type == DataTypeImpl::GetType<MapInt64ToDouble>()) {
     return OrtGetValueImplMapHelper<MapInt64ToDouble>(p_ml_value, index, allocator, out);
+  } else if (type == DataTypeImpl::GetType<ColumnarMapViewStringToFloat>()) {
+    return OrtGetValueImplColumnarMapView<ColumnarMapViewStringToFloat>(p_ml_value, index, allocator, out);
+  } else if (type == DataTypeImpl::GetType<ColumnarMapViewInt64ToFloat>()) {
+    return OrtGetValueImplColumnarMapView<ColumnarMapViewInt64ToFloat>(p_ml_value, index, allocator, out);
   } else {
     return OrtCreateStatus(ORT_FAIL, "Input is not of one of the supported map types.");
   }
@@ -213,6 +213,26 @@ void GemmEx(
     int ldc,
     Provider* provider);
 
+// Gemm with a float matrix A and a half precision or bfloat16 matrix B. B is
+// converted to float a panel at a time as the gemm packs it, so the reduced
+// precision weights are never expanded to a full float copy.
+template <typename TB, class Provider>
+void GemmExReducedB(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    int M,
+    int N,
+    int K,
+    float alpha,
+    const float* A,
+    int lda,
+    const TB* B,
+    int ldb,
+    float beta,
+    float* C,
+    int ldc,
+    Provider* provider);
+
 // GemmBatched provides a simple abstraction into library routines
 template <typename T, class Provider>
 void GemmBatched(
@@ -565,5 +585,9 @@ uint16_t floatToHalf(float f);
 
 float halfToFloat(uint16_t h);
 
+void halfToFloatBuffer(const MLFloat16* src, float* dst, size_t count);
+
+void floatToHalfBuffer(const float* src, MLFloat16* dst, size_t count);
+
 }  // namespace math
 }  // namespace onnxruntime
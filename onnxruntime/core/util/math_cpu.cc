@@ -33,6 +33,7 @@
 #include <chrono>
 #include <random>
 #include <unordered_set>
+#include <vector>
 #include "core/platform/env.h"
 #include "core/common/logging/logging.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
@@ -1462,6 +1463,63 @@ uint32_t randomNumberSeed() {
          kPrime2 * tv_sec + kPrime3 * tv_usec;
 }
 
+template <>
+void GemmExReducedB<MLFloat16, CPUMathUtil>(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const float alpha,
+    const float* A,
+    const int lda,
+    const MLFloat16* B,
+    const int ldb,
+    const float beta,
+    float* C,
+    const int ldc,
+    CPUMathUtil* provider) {
+#if defined(USE_MLAS)
+  // MLAS converts B while packing, regardless of the BLAS library used for float gemm.
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, reinterpret_cast<const MLAS_FP16*>(B), ldb, beta, C, ldc);
+  ORT_UNUSED_PARAMETER(provider);
+#else
+  const size_t B_size = static_cast<size_t>(TransB == CblasNoTrans ? K : N) * ldb;
+  std::vector<float> B_float(B_size);
+  halfToFloatBuffer(B, B_float.data(), B_size);
+  GemmEx<float, CPUMathUtil>(TransA, TransB, M, N, K, alpha, A, lda, B_float.data(), ldb, beta, C, ldc, provider);
+#endif
+}
+
+template <>
+void GemmExReducedB<BFloat16, CPUMathUtil>(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const float alpha,
+    const float* A,
+    const int lda,
+    const BFloat16* B,
+    const int ldb,
+    const float beta,
+    float* C,
+    const int ldc,
+    CPUMathUtil* provider) {
+#if defined(USE_MLAS)
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, reinterpret_cast<const MLAS_BF16*>(B), ldb, beta, C, ldc);
+  ORT_UNUSED_PARAMETER(provider);
+#else
+  const size_t B_size = static_cast<size_t>(TransB == CblasNoTrans ? K : N) * ldb;
+  std::vector<float> B_float(B_size);
+  for (size_t i = 0; i < B_size; i++) {
+    B_float[i] = B[i].ToFloat();
+  }
+  GemmEx<float, CPUMathUtil>(TransA, TransB, M, N, K, alpha, A, lda, B_float.data(), ldb, beta, C, ldc, provider);
+#endif
+}
+
 uint16_t floatToHalf(float f) {
   return Eigen::half_impl::float_to_half_rtne(f).x;
 }
@@ -1470,5 +1528,19 @@ float halfToFloat(uint16_t h) {
   return Eigen::half_impl::half_to_float(Eigen::half_impl::raw_uint16_to_half(h));
 }
 
+void halfToFloatBuffer(const MLFloat16* src, float* dst, size_t count) {
+#if defined(USE_MLAS)
+  MlasConvertHalfToFloatBuffer(&src->val, dst, count);
+#else
+  auto src_vector = ConstEigenVectorMap<Eigen::half>(reinterpret_cast<const Eigen::half*>(src), count);
+  EigenVectorMap<float>(dst, count) = src_vector.template cast<float>();
+#endif
+}
+
+void floatToHalfBuffer(const float* src, MLFloat16* dst, size_t count) {
+  auto src_vector = ConstEigenVectorMap<float>(src, count);
+  EigenVectorMap<Eigen::half>(reinterpret_cast<Eigen::half*>(dst), count) = src_vector.template cast<Eigen::half>();
+}
+
 }  // namespace math
 }  // namespace onnxruntime
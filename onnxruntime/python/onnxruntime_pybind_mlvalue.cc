@@ -76,7 +76,42 @@ bool PyObjectCheck_Array(PyObject* o) {
   return PyObject_HasAttrString(o, "__array_finalize__");
 }
 
+static std::vector<int64_t> GetArrayShape(PyArrayObject* pyObject) {
+  // numpy requires long int as its dims.
+  int ndim = PyArray_NDIM(pyObject);
+  npy_intp* npy_dims = PyArray_DIMS(pyObject);
+  std::vector<int64_t> dims(ndim);
+  for (int i = 0; i < ndim; ++i) {
+    dims[i] = npy_dims[i];
+  }
+  return dims;
+}
+
+// Numeric arrays which are C-contiguous, aligned and in native byte order
+// have the same layout as a Tensor so the Tensor can use the numpy buffer directly.
+static bool CanUseNumpyBuffer(PyArrayObject* pyObject) {
+  const int npy_type = PyArray_TYPE(pyObject);
+  if (npy_type == NPY_UNICODE || npy_type == NPY_STRING || npy_type == NPY_VOID || npy_type == NPY_OBJECT) {
+    return false;
+  }
+
+  return PyArray_ISCARRAY_RO(pyObject) && PyArray_ISNOTSWAPPED(pyObject) &&
+         static_cast<size_t>(PyArray_ITEMSIZE(pyObject)) == NumpyToOnnxRuntimeTensorType(npy_type)->Size();
+}
+
 void CreateTensorMLValue(AllocatorPtr alloc, const std::string& name_input, PyArrayObject* pyObject, MLValue* p_mlvalue) {
+  if (CanUseNumpyBuffer(pyObject)) {
+    // The tensor does not own the buffer. The caller keeps the array alive while the MLValue is in use.
+    TensorShape shape(GetArrayShape(pyObject));
+    auto element_type = NumpyToOnnxRuntimeTensorType(PyArray_TYPE(pyObject));
+    std::unique_ptr<Tensor> p_tensor = std::make_unique<Tensor>(element_type, shape, PyArray_DATA(pyObject),
+                                                                alloc->Info());
+    p_mlvalue->Init(p_tensor.release(),
+                    DataTypeImpl::GetType<Tensor>(),
+                    DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    return;
+  }
+
   PyArrayObject* darray = PyArray_GETCONTIGUOUS(pyObject);
   if (darray == NULL) {
     throw std::runtime_error(std::string("The object must be a contiguous array for input '") + name_input + std::string("'."));
@@ -85,15 +120,7 @@ void CreateTensorMLValue(AllocatorPtr alloc, const std::string& name_input, PyAr
   try {
     const int npy_type = PyArray_TYPE(darray);
 
-    // numpy requires long int as its dims.
-    int ndim = PyArray_NDIM(darray);
-    npy_intp* npy_dims = PyArray_DIMS(darray);
-    std::vector<int64_t> dims(ndim);
-    for (int i = 0; i < ndim; ++i) {
-      dims[i] = npy_dims[i];
-    }
-
-    TensorShape shape(dims);
+    TensorShape shape(GetArrayShape(darray));
     auto element_type = NumpyToOnnxRuntimeTensorType(npy_type);
     std::unique_ptr<Tensor> p_tensor = std::make_unique<Tensor>(element_type, shape, alloc);
     if (npy_type == NPY_UNICODE) {
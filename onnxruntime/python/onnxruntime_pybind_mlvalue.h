@@ -24,6 +24,8 @@ namespace py = pybind11;
 
 int OnnxRuntimeTensorToNumpyType(const DataTypeImpl* tensor_type);
 
+// Numeric numpy arrays which are C-contiguous are not copied: the MLValue refers to the numpy buffer,
+// so 'value' must be kept alive for as long as the MLValue is used.
 void CreateGenericMLValue(AllocatorPtr alloc, const std::string& name_input, py::object& value, MLValue* p_mlvalue);
 
 }  // namespace python
@@ -8,6 +8,7 @@
 #include <numpy/arrayobject.h>
 
 #include "core/graph/graph_viewer.h"
+#include "core/framework/columnar_map_sequence.h"
 
 #if USE_CUDA
 #define BACKEND_PROC "GPU"
@@ -130,6 +131,10 @@ void AddNonTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs)
     AddNonTensor<VectorMapStringToFloat>(val, pyobjs);
   } else if (val.Type() == DataTypeImpl::GetType<VectorMapInt64ToFloat>()) {
     AddNonTensor<VectorMapInt64ToFloat>(val, pyobjs);
+  } else if (val.Type() == DataTypeImpl::GetType<ColumnarMapStringToFloat>()) {
+    pyobjs.push_back(py::cast(val.Get<ColumnarMapStringToFloat>().ToMaps()));
+  } else if (val.Type() == DataTypeImpl::GetType<ColumnarMapInt64ToFloat>()) {
+    pyobjs.push_back(py::cast(val.Get<ColumnarMapInt64ToFloat>().ToMaps()));
   } else {
     throw std::runtime_error("Output is a non-tensor type which is not supported.");
   }
@@ -146,6 +151,27 @@ void AddTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
 
   MLDataType dtype = rtensor.DataType();
   const int numpy_type = OnnxRuntimeTensorToNumpyType(dtype);
+
+  if (numpy_type != NPY_OBJECT && rtensor.OwnsBuffer() && shape.Size() > 0) {
+    // Give the buffer to numpy without copying it. The base object of the array holds a copy of the MLValue
+    // so the buffer is released when the array and all views of it are gone.
+    py::capsule owner(new MLValue(val), [](void* p) { delete static_cast<MLValue*>(p); });
+    py::object obj = py::reinterpret_steal<py::object>(PyArray_SimpleNewFromData(
+        shape.NumDimensions(), npy_dims.data(), numpy_type, const_cast<void*>(rtensor.DataRaw(dtype))));
+    if (!obj) {
+      throw py::error_already_set();
+    }
+
+    // PyArray_SetBaseObject steals the reference even when it fails
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(obj.ptr()), owner.release().ptr()) != 0) {
+      throw py::error_already_set();
+    }
+
+    pyobjs.push_back(obj);
+    return;
+  }
+
+  // The tensor refers to memory owned by someone else, e.g. an input fed without a copy, so copy it.
   py::object obj = py::reinterpret_steal<py::object>(PyArray_SimpleNew(
       shape.NumDimensions(), npy_dims.data(), numpy_type));
 
@@ -254,7 +280,20 @@ Set this option to false if you don't want it. Default is True.)pbdoc")
                      R"pbdoc(Applies to session load, initialization, etc. Default is 0.)pbdoc")
       .def_readwrite("session_thread_pool_size", &SessionOptions::session_thread_pool_size,
                      R"pbdoc(How many threads in the session thread pool. Default is 0 to let onnxruntime choose.
-This parameter is unused unless *enable_sequential_execution* is false.)pbdoc");
+This parameter is unused unless *enable_sequential_execution* is false
+or *enable_parallel_initialization* or *enable_scan_batch_parallelism* is true.)pbdoc")
+      .def_readwrite("enable_columnar_map_outputs", &SessionOptions::enable_columnar_map_outputs,
+                     R"pbdoc(Keeps the sequence of maps produced by ZipMap in a columnar form until it is returned.
+Default is false.)pbdoc")
+      .def_readwrite("enable_parallel_initialization", &SessionOptions::enable_parallel_initialization,
+                     R"pbdoc(Deserializes initializers and creates kernels in parallel when the session is initialized.
+Default is false.)pbdoc")
+      .def_readwrite("enable_scan_batch_parallelism", &SessionOptions::enable_scan_batch_parallelism,
+                     R"pbdoc(Lets Scan run the entries of a batch concurrently on the session thread pool.
+Default is false.)pbdoc")
+      .def_readwrite("enable_op_statistics", &SessionOptions::enable_op_statistics,
+                     R"pbdoc(Aggregates the kernel latencies by op type and by node, see
+:meth:`onnxruntime.InferenceSession.get_op_statistics`. Default is false.)pbdoc");
 
   py::class_<RunOptions>(m, "RunOptions", R"pbdoc(Configuration information for a single Run.)pbdoc")
       .def(py::init())
@@ -378,10 +417,16 @@ including arg name, arg type (contains both type and shape).)pbdoc")
         std::vector<MLValue> fetches;
         common::Status status;
 
-        if (run_options != nullptr) {
-          status = sess->Run(*run_options, feeds, output_names, &fetches);
-        } else {
-          status = sess->Run(feeds, output_names, &fetches);
+        {
+          // Inputs and outputs are converted while holding the GIL. The feeds do not reference any
+          // Python object other than the numpy buffers kept alive by pyfeeds, so other Python threads
+          // can run during the inference.
+          py::gil_scoped_release release;
+          if (run_options != nullptr) {
+            status = sess->Run(*run_options, feeds, output_names, &fetches);
+          } else {
+            status = sess->Run(feeds, output_names, &fetches);
+          }
         }
 
         if (!status.IsOK()) {
@@ -403,6 +448,9 @@ including arg name, arg type (contains both type and shape).)pbdoc")
       .def("end_profiling", [](InferenceSession* sess) -> std::string {
         return sess->EndProfiling();
       })
+      .def("get_op_statistics", [](InferenceSession* sess, bool reset) -> std::string {
+        return sess->GetOpStatistics(reset);
+      }, py::arg("reset") = false)
       .def_property_readonly("inputs_meta", [](const InferenceSession* sess) -> const std::vector<const onnxruntime::NodeArg*>& {
         auto res = sess->GetModelInputs();
         if (!res.first.IsOK()) {
@@ -79,3 +79,12 @@ class InferenceSession:
         :meth:`onnxruntime.SessionOptions.enable_profiling`.
         """
         return self._sess.end_profiling()
+
+    def get_op_statistics(self, reset=False):
+        """
+        Return the kernel latencies aggregated by op type and by node as a JSON string.
+
+        Requires the option :meth:`onnxruntime.SessionOptions.enable_op_statistics`.
+        If *reset* is True the statistics are cleared, so the next call only covers the runs that follow.
+        """
+        return self._sess.get_op_statistics(reset)
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(FusedElementWiseTest, GatedActivation) {
+  OpTester test("FusedElementWise", 1, onnxruntime::kMSDomain);
+  // LeakyRelu(X * Sigmoid(X + B))
+  test.AddAttribute("ops", std::vector<std::string>{"Add", "Sigmoid", "Mul", "LeakyRelu"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, 2, -1, 0, 3, 4, -1});
+  test.AddAttribute("alphas", std::vector<float>{0.0f, 0.0f, 0.0f, 0.1f});
+  test.AddAttribute("betas", std::vector<float>{0.0f, 0.0f, 0.0f, 0.0f});
+
+  test.AddInput<float>("X", {2, 3}, {0.0f, 1.0f, 2.0f, -1.0f, -2.0f, -3.0f});
+  test.AddInput<float>("B", {3}, {1.0f, 0.0f, -1.0f});
+  test.AddOutput<float>("Y", {2, 3}, {0.0f, 0.7310586f, 1.462117f, -0.05f, -0.02384058f, -0.005395863f});
+  test.Run();
+}
+
+TEST(FusedElementWiseTest, BroadcastRows) {
+  OpTester test("FusedElementWise", 1, onnxruntime::kMSDomain);
+  // -Pow(X - C, E)
+  test.AddAttribute("ops", std::vector<std::string>{"Sub", "Pow", "Neg"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, 3, 2, 4, -1});
+
+  test.AddInput<float>("X", {2, 2, 2}, {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f});
+  test.AddInput<float>("C", {2, 1, 1}, {1.0f, 5.0f});
+  test.AddInput<float>("E", {1}, {2.0f});
+  test.AddOutput<float>("Y", {2, 2, 2}, {-1.0f, 0.0f, -1.0f, -4.0f, -1.0f, 0.0f, -1.0f, -4.0f});
+  test.Run();
+}
+
+TEST(FusedElementWiseTest, BroadcastStep) {
+  OpTester test("FusedElementWise", 1, onnxruntime::kMSDomain);
+  // Exp(X) + Y, where the Exp step is evaluated once for the broadcast input.
+  test.AddAttribute("ops", std::vector<std::string>{"Exp", "Add"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, -1, 2, 1});
+
+  test.AddInput<float>("X", {1}, {0.0f});
+  test.AddInput<float>("Y", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f});
+  test.AddOutput<float>("Z", {2, 2}, {2.0f, 3.0f, 4.0f, 5.0f});
+  test.Run();
+}
+
+TEST(FusedElementWiseTest, InvalidBroadcast) {
+  OpTester test("FusedElementWise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Add"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1});
+
+  test.AddInput<float>("X", {2, 3}, {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f});
+  test.AddInput<float>("Y", {2}, {1.0f, 2.0f});
+  test.AddOutput<float>("Z", {2, 3}, {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "cannot be broadcast");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
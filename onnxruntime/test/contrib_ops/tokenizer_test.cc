@@ -353,6 +353,34 @@ TEST(ContribOpTest, TokenizerWithSeparators_MixCharsWithMarkersC) {
   }  // namespace test
 }
 
+TEST(ContribOpTest, TokenizerWithSeparators_MincharnumCountsCharsC) {
+  // mincharnum is compared with the number of characters
+  // of a token, not with its utf8 bytes. This includes characters
+  // outside of the basic multilingual plane.
+  // [C] dimensions
+  // Output [C][D]
+  {
+    std::vector<std::string> separators = {u8" "};
+
+    OpTester test("Tokenizer", opset_ver, domain);
+    InitTestAttr(test, false, separators, 2);
+
+    std::vector<int64_t> dims{2};
+    std::vector<std::string> input{u8"я ab 中文 ", u8"ж 𝔸𝔹 "};
+    test.AddInput<std::string>("T", dims, input);
+
+    std::vector<int64_t> output_dims(dims);
+    output_dims.push_back(int64_t(2));
+    std::vector<std::string> output{
+        u8"ab", u8"中文",
+        u8"𝔸𝔹", padval};
+
+    test.AddOutput<std::string>("Y", output_dims, output);
+
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+}
+
 TEST(ContribOpTest, TokenizerWithSeparators_MixCharsWithMarkersCompleteMatchEmptyOutputC) {
   // Test entire separators match so we get nothing
   // in the output
@@ -2,8 +2,10 @@
 // Licensed under the MIT License.
 
 #include "core/framework/bfc_arena.h"
+#include "core/framework/cpu_region_allocator.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
 
 namespace onnxruntime {
 namespace test {
@@ -72,8 +74,7 @@ TEST(BFCArenaTest, AllocationsAndDeallocations) {
 
   // Ensure out of memory errors work and do not prevent future allocations from
   // working.
-  void* out_of_memory_ptr = a.Alloc((1 << 30) + 1);
-  EXPECT_EQ(out_of_memory_ptr, nullptr);
+  EXPECT_THROW(a.Alloc((1 << 30) + 1), OnnxRuntimeException);
 
   // Allocate a lot of raw pointers
   for (int s = 1; s < 256; s++) {
@@ -156,10 +157,9 @@ TEST(BFCArenaTest, TestCustomMemoryLimit) {
   BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 20);
 
   void* first_ptr = a.Alloc(sizeof(float) * (1 << 6));
-  void* second_ptr = a.Alloc(sizeof(float) * (1 << 20));
 
   EXPECT_NE(nullptr, first_ptr);
-  EXPECT_EQ(nullptr, second_ptr);
+  EXPECT_THROW(a.Alloc(sizeof(float) * (1 << 20)), OnnxRuntimeException);
   a.Free(first_ptr);
 }
 
@@ -234,5 +234,34 @@ TEST(BFCArenaTest, TestReserve) {
   a.GetStats(&stats);
   EXPECT_EQ(stats.total_allocated_bytes, 1048576);
 }
+
+TEST(BFCArenaTest, RegionAllocatorWithMemoryLimit) {
+  // the options are hints, the allocations succeed without huge pages or NUMA support
+  MemoryRegionOptions options;
+  options.use_huge_pages = true;
+  options.numa_node = 0;
+  BFCArena a(std::make_unique<CPURegionAllocator>(options), 8 << 20);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 6; i++) {
+    void* p = a.Alloc(1 << 20);
+    ASSERT_NE(nullptr, p);
+    memset(p, i, 1 << 20);
+    ptrs.push_back(p);
+  }
+  EXPECT_THROW(a.Alloc(4 << 20), OnnxRuntimeException);
+  EXPECT_THROW(a.Reserve(16 << 20), OnnxRuntimeException);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_LE(stats.total_allocated_bytes, 8 << 20);
+
+  for (void* p : ptrs) {
+    a.Free(p);
+  }
+  void* p = a.Alloc(4 << 20);
+  EXPECT_NE(nullptr, p);
+  a.Free(p);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -4,6 +4,7 @@
 #include <typeinfo>
 #include <math.h> //for fabs
 
+#include "core/framework/columnar_map_sequence.h"
 #include "core/framework/data_types.h"
 #include "core/graph/onnx_protobuf.h"
 #include "gtest/gtest.h"
@@ -352,6 +353,40 @@ TEST_F(DataTypeTest, VectorMapInt64ToFloatTest) {
   EXPECT_FALSE(DataTypeImpl::GetType<VectorMapInt64ToFloat>()->IsCompatible(tensor_type));
 }
 
+TEST_F(DataTypeTest, ColumnarMapSequenceTest) {
+  TypeProto type_proto;
+  type_proto.mutable_sequence_type()->mutable_elem_type()->mutable_map_type()->set_key_type(TensorProto_DataType_STRING);
+  type_proto.mutable_sequence_type()->mutable_elem_type()->mutable_map_type()->mutable_value_type()->mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  // compatible with seq(map(string, float)) but never selected for it from a TypeProto
+  EXPECT_TRUE(DataTypeImpl::GetType<ColumnarMapStringToFloat>()->IsCompatible(type_proto));
+  EXPECT_FALSE(DataTypeImpl::GetType<ColumnarMapInt64ToFloat>()->IsCompatible(type_proto));
+  EXPECT_EQ(DataTypeImpl::TypeFromProto(type_proto), DataTypeImpl::GetType<VectorMapStringToFloat>());
+
+  auto keys = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{"b", "a", "b"});
+  const std::vector<float> values{1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  ColumnarMapStringToFloat sequence;
+  sequence.Assign(keys, values.data(), 2);
+
+  EXPECT_EQ(sequence.size(), 2u);
+  EXPECT_EQ(sequence.NumKeys(), 3u);
+  EXPECT_EQ(&sequence.Keys(), keys.get());
+  EXPECT_EQ(sequence.Values(1)[0], 4.f);
+
+  // repeated keys keep the last value
+  const auto maps = sequence.ToMaps();
+  ASSERT_EQ(maps.size(), 2u);
+  EXPECT_EQ(maps[0], (MapStringToFloat{{"a", 2.f}, {"b", 3.f}}));
+  EXPECT_EQ(maps[1], (MapStringToFloat{{"a", 5.f}, {"b", 6.f}}));
+
+  // a view stays valid after the sequence is re-assigned
+  ColumnarMapViewStringToFloat view(sequence, 1);
+  sequence.Assign(keys, values.data(), 1);
+  EXPECT_EQ(view.size(), 3u);
+  EXPECT_EQ(view.Keys()[1], "a");
+  EXPECT_EQ(view.Values()[2], 6.f);
+}
+
 TEST_F(DataTypeTest, BFloat16Test) {
   // Test data type
   {
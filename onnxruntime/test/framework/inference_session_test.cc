@@ -14,15 +14,18 @@
 #include "core/common/logging/logging.h"
 #include "core/common/profiler.h"
 #include "core/framework/compute_capability.h"
+#include "core/framework/customregistry.h"
 #include "core/framework/execution_provider.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
 #include "core/graph/op.h"
 #include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include "core/session/IOBinding.h"
@@ -34,6 +37,10 @@
 
 #include "gtest/gtest.h"
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace ONNX_NAMESPACE;
 using namespace onnxruntime::logging;
@@ -335,6 +342,22 @@ TEST(InferenceSessionTests, DisableCPUArena) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, ParallelInitialization) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.ParallelInitialization";
+  so.enable_parallel_initialization = true;
+  so.session_thread_pool_size = 2;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "one session/one tag";
+  RunModel(session_object, run_options);
+}
+
 #ifdef ORT_RUN_EXTERNAL_ONNX_TESTS
 static bool Compare(const InputDefList& f_arg, const InputDefList& s_arg) {
   if (f_arg.size() != s_arg.size()) {
@@ -538,6 +561,345 @@ TEST(InferenceSessionTests, CheckRunProfilerWithStartProfile) {
   }
 }
 
+TEST(InferenceSessionTests, CheckRunOpStatistics) {
+  SessionOptions so;
+
+  so.session_logid = "CheckRunOpStatistics";
+  so.enable_op_statistics = true;
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "RunTag";
+
+  RunModel(session_object, run_options);
+  RunModel(session_object, run_options);
+
+  std::string statistics = session_object.GetOpStatistics(true);
+  ASSERT_TRUE(statistics.find("\"op_types\" : {\"Mul\" : {\"count\" : 2,") != string::npos) << statistics;
+  ASSERT_TRUE(statistics.find("\"nodes\" : {\"mul_1\" : {\"count\" : 2,") != string::npos) << statistics;
+
+  // the statistics were reset by the previous call
+  ASSERT_EQ(session_object.GetOpStatistics(), "{\"op_types\" : {}, \"nodes\" : {}}");
+
+  // op statistics don't end the profiling
+  RunModel(session_object, run_options);
+  statistics = session_object.GetOpStatistics();
+  ASSERT_TRUE(statistics.find("\"nodes\" : {\"mul_1\" : {\"count\" : 1,") != string::npos) << statistics;
+
+  // the buffers of the threads that exited are dropped, but not their records
+  for (int i = 0; i < 4; ++i) {
+    std::thread run_thread([&]() { RunModel(session_object, run_options); });
+    run_thread.join();
+    statistics = session_object.GetOpStatistics();
+  }
+  ASSERT_TRUE(statistics.find("\"nodes\" : {\"mul_1\" : {\"count\" : 5,") != string::npos) << statistics;
+}
+
+TEST(InferenceSessionTests, ParallelExecutionWithMeasuredNodePriorities) {
+  SessionOptions so;
+
+  so.session_logid = "ParallelExecutionWithMeasuredNodePriorities";
+  so.enable_sequential_execution = false;
+  so.enable_op_statistics = true;
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_FALSE(session_object.UpdateNodePrioritiesFromOpStatistics().IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "RunTag";
+
+  RunModel(session_object, run_options);
+  ASSERT_TRUE(session_object.UpdateNodePrioritiesFromOpStatistics().IsOK());
+  RunModel(session_object, run_options);
+}
+
+// Copies its input and records the order in which the nodes ran. Nodes named "fail*" return an error instead.
+class RecordingKernel : public OpKernel {
+ public:
+  RecordingKernel(const OpKernelInfo& info, std::vector<std::string>& order, OrtMutex& mutex)
+      : OpKernel(info), order_(order), mutex_(mutex) {}
+
+  Status Compute(OpKernelContext* context) const override {
+    {
+      std::lock_guard<OrtMutex> lock(mutex_);
+      order_.push_back(Node().Name());
+    }
+    if (Node().Name().compare(0, 4, "fail") == 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failing on purpose");
+    }
+
+    const auto* X = context->Input<Tensor>(0);
+    auto* Y = context->Output(0, X->Shape());
+    const float* x_data = X->Data<float>();
+    std::copy(x_data, x_data + X->Shape().Size(), Y->MutableData<float>());
+    return Status::OK();
+  }
+
+ private:
+  std::vector<std::string>& order_;
+  OrtMutex& mutex_;
+};
+
+// X -> short -> S
+// X -> long_1 -> long_2 -> long_3 -> L
+//             -> side_node_name -> SIDE
+// The nodes are added with the short branches first, so running them in the order they were added (or the order
+// they became ready) does not follow the critical path.
+static ONNX_NAMESPACE::ModelProto CreateModelForParallelScheduling(const std::string& side_node_name) {
+  Model model("ModelForParallelScheduling");
+  auto& graph = model.MainGraph();
+
+  TypeProto single_float;
+  single_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  single_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &single_float);
+  auto& s = graph.GetOrCreateNodeArg("S", &single_float);
+  auto& l1 = graph.GetOrCreateNodeArg("L1", &single_float);
+  auto& l2 = graph.GetOrCreateNodeArg("L2", &single_float);
+  auto& l = graph.GetOrCreateNodeArg("L", &single_float);
+  auto& side = graph.GetOrCreateNodeArg("SIDE", &single_float);
+
+  graph.AddNode("short", "Relu", "short branch", {&x}, {&s});
+  graph.AddNode("long_1", "Relu", "critical path", {&x}, {&l1});
+  graph.AddNode(side_node_name, "Relu", "short branch of the critical path", {&l1}, {&side});
+  graph.AddNode("long_2", "Relu", "critical path", {&l1}, {&l2});
+  graph.AddNode("long_3", "Relu", "critical path", {&l2}, {&l});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return model.ToProto();
+}
+
+static common::Status RunParallelSchedulingModel(const std::string& side_node_name,
+                                                 std::vector<std::string>& order) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ParallelScheduling";
+  so.enable_sequential_execution = false;
+  // a single thread runs the nodes, so the order only depends on the priorities
+  so.session_thread_pool_size = 1;
+
+  OrtMutex mutex;
+  std::shared_ptr<CustomRegistry> registry = std::make_shared<CustomRegistry>();
+  KernelDefBuilder def;
+  def.SetName("Relu")
+      .SetDomain(onnxruntime::kOnnxDomain)
+      .SinceVersion(6)
+      .Provider(onnxruntime::kCpuExecutionProvider)
+      .TypeConstraint("T", DataTypeImpl::GetTensorType<float>());
+  EXPECT_TRUE(registry->RegisterCustomKernel(def, [&order, &mutex](const OpKernelInfo& info) -> OpKernel* {
+                        return new RecordingKernel(info, order, mutex);
+                      })
+                  .IsOK());
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  EXPECT_TRUE(session_object.RegisterCustomRegistry(registry).IsOK());
+
+  std::stringstream model_stream;
+  CreateModelForParallelScheduling(side_node_name).SerializeToOstream(&model_stream);
+  auto status = session_object.Load(model_stream);
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session_object.Initialize();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {1}, {1.f}, &ml_value);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value));
+
+  std::vector<MLValue> fetches;
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  return session_object.Run(run_options, feeds, {"S", "L", "SIDE"}, &fetches);
+}
+
+TEST(InferenceSessionTests, ParallelExecutionRunsCriticalPathFirst) {
+  std::vector<std::string> order;
+  auto status = RunParallelSchedulingModel("side", order);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // the root on the critical path starts first, and each node of the critical path runs before the short
+  // branches that became ready at the same time
+  ASSERT_EQ(order.size(), 5u);
+  std::vector<std::string> critical_path(order.begin(), order.begin() + 3);
+  ASSERT_EQ(critical_path, (std::vector<std::string>{"long_1", "long_2", "long_3"}));
+  ASSERT_NE(std::find(order.begin(), order.end(), "short"), order.end());
+  ASSERT_NE(std::find(order.begin(), order.end(), "side"), order.end());
+}
+
+TEST(InferenceSessionTests, ParallelExecutionReturnsNodeFailure) {
+  std::vector<std::string> order;
+  auto status = RunParallelSchedulingModel("fail_side", order);
+  ASSERT_FALSE(status.IsOK());
+  ASSERT_TRUE(status.ErrorMessage().find("Compute failed for node: fail_side") != std::string::npos)
+      << status.ErrorMessage();
+  ASSERT_TRUE(status.ErrorMessage().find("Failing on purpose") != std::string::npos) << status.ErrorMessage();
+}
+
+#ifdef USE_OPENMP
+// Returns the CPUs each thread but the first of the OpenMP team of the calling thread may run on.
+static std::vector<std::vector<int>> GetOpenMPThreadAffinities() {
+  std::vector<std::vector<int>> affinities(static_cast<size_t>(omp_get_max_threads()));
+#pragma omp parallel
+  {
+    const int thread_num = omp_get_thread_num();
+    if (thread_num != 0) {
+      EXPECT_TRUE(Env::Default().GetCurrentThreadAffinity(affinities[thread_num]).IsOK());
+    }
+  }
+  affinities.erase(affinities.begin());
+  affinities.erase(std::remove_if(affinities.begin(), affinities.end(),
+                                  [](const std::vector<int>& cpus) { return cpus.empty(); }),
+                   affinities.end());
+  return affinities;
+}
+#endif
+
+// Copies its input and records the CPUs the thread running it may run on, followed by those of its OpenMP threads.
+class AffinityRecordingKernel : public OpKernel {
+ public:
+  AffinityRecordingKernel(const OpKernelInfo& info, std::vector<std::vector<int>>& affinities, OrtMutex& mutex)
+      : OpKernel(info), affinities_(affinities), mutex_(mutex) {}
+
+  Status Compute(OpKernelContext* context) const override {
+    std::vector<int> cpus;
+    ORT_RETURN_IF_ERROR(Env::Default().GetCurrentThreadAffinity(cpus));
+    std::vector<std::vector<int>> affinities{cpus};
+#ifdef USE_OPENMP
+    for (auto& omp_cpus : GetOpenMPThreadAffinities()) {
+      affinities.push_back(std::move(omp_cpus));
+    }
+#endif
+    {
+      std::lock_guard<OrtMutex> lock(mutex_);
+      affinities_.insert(affinities_.end(), affinities.begin(), affinities.end());
+    }
+
+    const auto* X = context->Input<Tensor>(0);
+    auto* Y = context->Output(0, X->Shape());
+    const float* x_data = X->Data<float>();
+    std::copy(x_data, x_data + X->Shape().Size(), Y->MutableData<float>());
+    return Status::OK();
+  }
+
+ private:
+  std::vector<std::vector<int>>& affinities_;
+  OrtMutex& mutex_;
+};
+
+TEST(InferenceSessionTests, ThreadAffinityAndSpinning) {
+  std::vector<int> process_cpus;
+  auto status = Env::Default().GetCurrentThreadAffinity(process_cpus);
+  if (!status.IsOK()) {
+    std::cout << "Skipping the test as thread affinity is not supported: " << status.ErrorMessage() << std::endl;
+    return;
+  }
+  ASSERT_FALSE(process_cpus.empty());
+  // a CPU the process may run on, CPU 0 may be outside the cpuset of a container
+  const int cpu = process_cpus.back();
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ThreadAffinityAndSpinning";
+  so.enable_sequential_execution = false;
+  so.session_thread_pool_size = 2;
+  so.inter_op_thread_affinity = {{cpu}};
+  so.intra_op_thread_affinity = {{cpu}};
+  so.session_thread_pool_spin_count = 1000;
+
+  std::vector<std::vector<int>> affinities;
+  OrtMutex mutex;
+  std::shared_ptr<CustomRegistry> registry = std::make_shared<CustomRegistry>();
+  KernelDefBuilder def;
+  def.SetName("Relu")
+      .SetDomain(onnxruntime::kOnnxDomain)
+      .SinceVersion(6)
+      .Provider(onnxruntime::kCpuExecutionProvider)
+      .TypeConstraint("T", DataTypeImpl::GetTensorType<float>());
+  ASSERT_TRUE(registry->RegisterCustomKernel(def, [&affinities, &mutex](const OpKernelInfo& info) -> OpKernel* {
+                        return new AffinityRecordingKernel(info, affinities, mutex);
+                      })
+                  .IsOK());
+
+  auto run_model = [&so](InferenceSession& session_object) {
+    MLValue ml_value;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {1}, {1.f}, &ml_value);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value));
+    std::vector<MLValue> fetches;
+    RunOptions run_options;
+    run_options.run_tag = so.session_logid;
+    return session_object.Run(run_options, feeds, {"S", "L", "SIDE"}, &fetches);
+  };
+
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.RegisterCustomRegistry(registry).IsOK());
+
+    std::stringstream model_stream;
+    CreateModelForParallelScheduling("side").SerializeToOstream(&model_stream);
+    ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+    status = session_object.Initialize();
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+    // run from another thread than the one that initialized the session, as a server does
+    Status run_status;
+    std::vector<std::vector<int>> run_thread_omp_affinities;
+    std::thread run_thread([&]() {
+      run_status = run_model(session_object);
+#ifdef USE_OPENMP
+      run_thread_omp_affinities = GetOpenMPThreadAffinities();
+#endif
+    });
+    run_thread.join();
+    ASSERT_TRUE(run_status.IsOK()) << run_status.ErrorMessage();
+
+    // every node ran on a pool thread pinned to the CPU, with its OpenMP threads pinned to the CPU too
+    ASSERT_GE(affinities.size(), 5u);
+    for (const auto& cpus : affinities) {
+      ASSERT_EQ(cpus, std::vector<int>{cpu});
+    }
+
+#ifdef USE_OPENMP
+    // the OpenMP threads of the thread that called Run are pinned as well
+    for (const auto& cpus : run_thread_omp_affinities) {
+      ASSERT_EQ(cpus, std::vector<int>{cpu});
+    }
+
+    status = run_model(session_object);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    for (const auto& cpus : GetOpenMPThreadAffinities()) {
+      ASSERT_EQ(cpus, std::vector<int>{cpu});
+    }
+
+    // the OpenMP threads serve every session, so a different affinity is rejected
+    if (process_cpus.size() > 1) {
+      SessionOptions other_so = so;
+      other_so.intra_op_thread_affinity = {{process_cpus.front()}};
+      InferenceSession other_session{other_so, &DefaultLoggingManager()};
+      ASSERT_TRUE(other_session.Load(MODEL_URI).IsOK());
+      status = other_session.Initialize();
+      ASSERT_FALSE(status.IsOK());
+      ASSERT_TRUE(status.ErrorMessage().find("intra_op_thread_affinity") != std::string::npos)
+          << status.ErrorMessage();
+    }
+#endif
+  }
+
+#ifdef USE_OPENMP
+  // the thread releasing the session gets the affinity of its OpenMP threads back right away, so later tests can
+  // use all the CPUs
+  for (const auto& cpus : GetOpenMPThreadAffinities()) {
+    ASSERT_EQ(cpus, process_cpus);
+  }
+#endif
+}
+
 TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   SessionOptions session_options;
 
@@ -950,6 +1312,222 @@ TEST(InferenceSessionTests, TestOptionalInputs) {
   EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("Missing required input:"));
 }
 
+// Y = X + W, where W is an initializer with the values offset, offset + 1, ... stored as raw data if raw_data is true
+static ONNX_NAMESPACE::ModelProto CreateModelWithLargeInitializer(int64_t size, float offset, bool raw_data = false) {
+  Model model("ModelWithLargeInitializer");
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TensorProto tensor_proto;
+  tensor_proto.add_dims(size);
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  std::vector<float> values(size);
+  for (int64_t i = 0; i < size; ++i) {
+    values[i] = offset + static_cast<float>(i);
+  }
+  if (raw_data) {
+    tensor_proto.set_raw_data(values.data(), values.size() * sizeof(float));
+  } else {
+    for (float value : values) {
+      tensor_proto.add_float_data(value);
+    }
+  }
+  tensor_proto.set_name("W");
+  graph.AddInitializedTensor(tensor_proto);
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(size);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& w = graph.GetOrCreateNodeArg("W", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("add", "Add", "Add the initializer", {&x, &w}, {&y});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+  return model.ToProto();
+}
+
+TEST(InferenceSessionTests, SharedInitializers) {
+  const int64_t size = 512;
+  const size_t bytes = size * sizeof(float);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedInitializers";
+  so.enable_shared_initializers = true;
+
+  const auto before = SharedInitializerStore::Instance().GetStatistics();
+  {
+    // the first two sessions have the same initializer, the third has a different one
+    const std::vector<float> offsets{0.f, 0.f, 1.f};
+    std::vector<std::unique_ptr<InferenceSession>> sessions;
+    for (float offset : offsets) {
+      sessions.push_back(std::make_unique<InferenceSession>(so, &DefaultLoggingManager()));
+      std::stringstream model_stream;
+      CreateModelWithLargeInitializer(size, offset).SerializeToOstream(&model_stream);
+      auto status = sessions.back()->Load(model_stream);
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+      status = sessions.back()->Initialize();
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    }
+
+    const auto statistics = SharedInitializerStore::Instance().GetStatistics();
+    EXPECT_EQ(statistics.tensors, before.tensors + 2);
+    EXPECT_EQ(statistics.bytes, before.bytes + 2 * bytes);
+    EXPECT_EQ(statistics.bytes_saved, before.bytes_saved + bytes);
+
+    MLValue x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {size},
+                         std::vector<float>(size, 1.f), &x);
+    NameMLValMap feeds{{"X", x}};
+    for (size_t i = 0; i < sessions.size(); ++i) {
+      std::vector<MLValue> fetches;
+      auto status = sessions[i]->Run(feeds, {"Y"}, &fetches);
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+      const float* y = fetches[0].Get<Tensor>().Data<float>();
+      for (int64_t j = 0; j < size; ++j) {
+        ASSERT_EQ(y[j], 1.f + offsets[i] + static_cast<float>(j));
+      }
+    }
+  }
+
+  // the tensors are released with the sessions
+  const auto after = SharedInitializerStore::Instance().GetStatistics();
+  EXPECT_EQ(after.tensors, before.tensors);
+  EXPECT_EQ(after.bytes_saved, before.bytes_saved);
+}
+
+TEST(InferenceSessionTests, SharedInitializersByKey) {
+  const int64_t size = 512;
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedInitializersByKey";
+  so.enable_shared_initializers = true;
+  so.shared_initializers_key = "InferenceSessionTests.SharedInitializersByKey";
+
+  std::stringstream model_stream;
+  CreateModelWithLargeInitializer(size, 0.f).SerializeToOstream(&model_stream);
+  InferenceSession session1{so, &DefaultLoggingManager()};
+  auto status = session1.Load(model_stream);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session1.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // a session with the same key and a different shape for the initializer uses its own copy, as for different
+  // content
+  const auto before = SharedInitializerStore::Instance().GetStatistics();
+  std::stringstream other_model_stream;
+  CreateModelWithLargeInitializer(2 * size, 0.f).SerializeToOstream(&other_model_stream);
+  InferenceSession session2{so, &DefaultLoggingManager()};
+  status = session2.Load(other_model_stream);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session2.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  const auto after = SharedInitializerStore::Instance().GetStatistics();
+  EXPECT_EQ(after.tensors, before.tensors);
+  EXPECT_EQ(after.bytes_saved, before.bytes_saved);
+
+  MLValue x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {2 * size},
+                       std::vector<float>(2 * size, 1.f), &x);
+  NameMLValMap feeds{{"X", x}};
+  std::vector<MLValue> fetches;
+  status = session2.Run(feeds, {"Y"}, &fetches);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  const float* y = fetches[0].Get<Tensor>().Data<float>();
+  for (int64_t j = 0; j < 2 * size; ++j) {
+    ASSERT_EQ(y[j], 1.f + static_cast<float>(j));
+  }
+}
+
+TEST(InferenceSessionTests, SharedInitializersByKeyWithDifferentContent) {
+  const int64_t size = 512;
+  const size_t bytes = size * sizeof(float);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedInitializersByKeyWithDifferentContent";
+  so.enable_shared_initializers = true;
+  so.shared_initializers_key = "InferenceSessionTests.SharedInitializersByKeyWithDifferentContent";
+
+  const auto before = SharedInitializerStore::Instance().GetStatistics();
+  {
+    // all the sessions use the same key. the initializer of the second and third sessions has the same shape but
+    // different values, so they must use their own copy. the fourth has the values of the first one as raw data.
+    const std::vector<float> offsets{0.f, 1.f, 1.f, 0.f};
+    const std::vector<bool> raw_data{false, false, true, true};
+    std::vector<std::unique_ptr<InferenceSession>> sessions;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      sessions.push_back(std::make_unique<InferenceSession>(so, &DefaultLoggingManager()));
+      std::stringstream model_stream;
+      CreateModelWithLargeInitializer(size, offsets[i], raw_data[i]).SerializeToOstream(&model_stream);
+      auto status = sessions.back()->Load(model_stream);
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+      status = sessions.back()->Initialize();
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    }
+
+    // only the initializer of the first session is stored, and the fourth session shares it
+    const auto statistics = SharedInitializerStore::Instance().GetStatistics();
+    EXPECT_EQ(statistics.tensors, before.tensors + 1);
+    EXPECT_EQ(statistics.bytes_saved, before.bytes_saved + bytes);
+
+    MLValue x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {size},
+                         std::vector<float>(size, 1.f), &x);
+    NameMLValMap feeds{{"X", x}};
+    for (size_t i = 0; i < sessions.size(); ++i) {
+      std::vector<MLValue> fetches;
+      auto status = sessions[i]->Run(feeds, {"Y"}, &fetches);
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+      const float* y = fetches[0].Get<Tensor>().Data<float>();
+      for (int64_t j = 0; j < size; ++j) {
+        ASSERT_EQ(y[j], 1.f + offsets[i] + static_cast<float>(j));
+      }
+    }
+  }
+}
+
+TEST(InferenceSessionTests, CpuMemArenaLimitFailsRun) {
+  // Y = Relu(Relu(X)), the output of each node is larger than the limit of the arena
+  const int64_t size = 1 << 20;
+  Model model("CpuMemArenaLimitFailsRun");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(size);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& t = graph.GetOrCreateNodeArg("T", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("relu_1", "Relu", "Relu 1", {&x}, {&t});
+  graph.AddNode("relu_2", "Relu", "Relu 2", {&t}, {&y});
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.CpuMemArenaLimitFailsRun";
+  so.cpu_mem_arena_max_bytes = 1 << 20;
+
+  InferenceSession session{so, &DefaultLoggingManager()};
+  std::stringstream model_stream;
+  model.ToProto().SerializeToOstream(&model_stream);
+  status = session.Load(model_stream);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  MLValue input;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {size},
+                       std::vector<float>(size, 1.f), &input);
+  NameMLValMap feeds{{"X", input}};
+  std::vector<MLValue> fetches;
+  status = session.Run(feeds, {"Y"}, &fetches);
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("Out of memory"));
+}
+
 TEST(ExecutionProviderTest, FunctionTest) {
   onnxruntime::Model model("graph_1");
   auto& graph = model.MainGraph();
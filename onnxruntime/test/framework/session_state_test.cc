@@ -70,5 +70,56 @@ TEST(SessionStateTest, AddGetKernelTest) {
   std::cout << "orig: " << orig_num_outputs << " new: " << test_kernel->Node().OutputDefs().size() << std::endl;
   EXPECT_EQ(orig_num_outputs, test_kernel->Node().OutputDefs().size());
 }
+
+TEST(SessionStateTest, NodeExecutionRecordsTest) {
+  ONNX_OPERATOR_SCHEMA(RecordVariable)
+      .SetDoc("Input variable.")
+      .Output(0, "output_1", "docstr for output_1.", "tensor(int32)");
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+
+  onnxruntime::Model model("graph_1");
+  auto& graph = model.MainGraph();
+  std::vector<onnxruntime::NodeArg*> inputs;
+  std::vector<onnxruntime::NodeArg*> outputs;
+  TypeProto output_type;
+  output_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  output_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  onnxruntime::NodeArg output_arg("node_1_out_1", &output_type);
+  outputs.push_back(&output_arg);
+  onnxruntime::Node& node = graph.AddNode("node_1", "RecordVariable", "node 1.", inputs, outputs);
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK());
+  KernelDef kernel_def;
+  CPUExecutionProvider execution_provider{CPUExecutionProviderInfo{"CPUExecutionProvider"}};
+
+  OpKernelInfo p_info(node,
+                      kernel_def,
+                      execution_provider,
+                      s.GetInitializedTensors(),
+                      s.GetMLValueNameIdxMap(),
+                      s.GetFuncMgr());
+  s.SetGraphViewer(std::make_unique<GraphViewer>(graph));
+  s.AddKernel(node.Index(), std::make_unique<TestOpKernel>(p_info));
+  s.GetMLValueNameIdxMap().Add("node_1_out_1");
+
+  auto p_seq_exec_plan = std::make_unique<SequentialExecutionPlan>();
+  p_seq_exec_plan->allocation_plan.resize(1);
+  p_seq_exec_plan->execution_plan.emplace_back(node.Index());
+  p_seq_exec_plan->execution_plan.back().free_from_index = 0;
+  p_seq_exec_plan->execution_plan.back().free_to_index = 0;
+  p_seq_exec_plan->to_be_freed.push_back(0);
+  s.SetExecutionPlan(std::move(p_seq_exec_plan));
+  s.CalculateNodeIndexInfo();
+
+  const auto& records = s.GetNodeExecutionRecords();
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(records[0].kernel, s.GetKernel(node.Index()));
+  EXPECT_EQ(records[0].node_index, node.Index());
+  EXPECT_EQ(records[0].queue_id, 0);
+  EXPECT_EQ(records[0].free_from_index, 0);
+  EXPECT_EQ(records[0].free_to_index, 0);
+  EXPECT_FALSE(s.ExecutionPlanUsesFences());
+}
 }  // namespace test
 }  // namespace onnxruntime
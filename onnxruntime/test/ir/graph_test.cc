@@ -740,6 +740,83 @@ TEST(ResolvingGraphTest, GraphConstruction_TypeInference) {
   EXPECT_EQ("node_4_out_1", graph_proto.output(0).name());
 }
 
+// Resolve only infers the nodes that changed since the last Resolve. Check that a refined shape of a graph input
+// still propagates through nodes that were not modified.
+TEST(ResolvingGraphTest, GraphConstruction_IncrementalTypeInference) {
+  Model model("graph_1");
+  auto& graph = model.MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& output_arg1 = graph.GetOrCreateNodeArg("A", nullptr);
+  auto& output_arg2 = graph.GetOrCreateNodeArg("B", nullptr);
+  graph.AddNode("node_1", "Identity", "node 1", {&input_arg}, {&output_arg1});
+  graph.AddNode("node_2", "Identity", "node 2", {&output_arg1}, {&output_arg2});
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  ASSERT_NE(nullptr, output_arg2.Shape());
+  EXPECT_EQ("N", output_arg2.Shape()->dim(0).dim_param());
+
+  TensorShapeProto shape;
+  shape.add_dim()->set_dim_value(4);
+  shape.add_dim()->set_dim_value(3);
+  input_arg.SetShape(shape);
+  graph.SetGraphResolveNeeded();
+  status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  EXPECT_EQ(4, output_arg1.Shape()->dim(0).dim_value());
+  EXPECT_EQ(4, output_arg2.Shape()->dim(0).dim_value());
+}
+
+// The consumers of a removed node are validated again by the next Resolve, so a dangling input is reported even
+// though the consumer itself was not modified.
+TEST(ResolvingGraphTest, GraphConstruction_RemovedProducerFailsResolve) {
+  Model model("graph_1");
+  auto& graph = model.MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& output_arg1 = graph.GetOrCreateNodeArg("A", &tensor_float);
+  auto& output_arg2 = graph.GetOrCreateNodeArg("B", &tensor_float);
+  graph.AddNode("node_1", "Identity", "node 1", {&input_arg}, {&output_arg1});
+  graph.AddNode("node_2", "Identity", "node 2", {&output_arg1}, {&output_arg2});
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // reload so the graph inputs are fixed and A can't silently become one
+  std::stringstream s1;
+  model.ToProto().SerializeToOstream(&s1);
+  ModelProto model_proto;
+  ASSERT_TRUE(model_proto.ParseFromIstream(&s1)) << "Failed to load model from serialized protobuf";
+
+  std::shared_ptr<onnxruntime::Model> p_tmp_model;
+  status = onnxruntime::Model::Load(model_proto, p_tmp_model, nullptr);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  auto& graph2 = p_tmp_model->MainGraph();
+  status = graph2.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  Node* node_1 = nullptr;
+  for (auto& node : graph2.Nodes()) {
+    if (node.Name() == "node_1") {
+      node_1 = &node;
+    }
+  }
+  ASSERT_NE(nullptr, node_1);
+  ASSERT_TRUE(graph2.RemoveNode(node_1->Index()));
+
+  status = graph2.Resolve();
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_NE(std::string::npos, status.ErrorMessage().find("(A)")) << status.ErrorMessage();
+}
+
 TEST(TestAddAttribute, AddTensorAttribute) {
   OPERATOR_SCHEMA(__Constant)
       .SetDoc("Constant Op.")
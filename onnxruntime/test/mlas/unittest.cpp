@@ -16,8 +16,10 @@ Abstract:
 
 #include <stdio.h>
 #include <memory.h>
+#include <math.h>
 #include <algorithm>
 #include <limits>
+#include <vector>
 #include <mlas.h>
 
 #if defined(_WIN32)
@@ -367,6 +369,131 @@ ExecuteSgemmTests(
     }
 }
 
+unsigned short
+ConvertIntegerFloatToHalf(
+    float Value
+    )
+{
+    //
+    // The fill values are small integers, so the conversion is exact and only
+    // needs to handle zero and normal numbers.
+    //
+
+    union {
+        float f;
+        uint32_t u;
+    } Bits;
+
+    Bits.f = Value;
+
+    if ((Bits.u & 0x7FFFFFFF) == 0) {
+        return (unsigned short)(Bits.u >> 16);
+    }
+
+    uint32_t Sign = (Bits.u >> 16) & 0x8000;
+    uint32_t Exponent = ((Bits.u >> 23) & 0xFF) - 127 + 15;
+    uint32_t Mantissa = (Bits.u >> 13) & 0x3FF;
+
+    return (unsigned short)(Sign | (Exponent << 10) | Mantissa);
+}
+
+void
+TrialSgemmReducedB(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    MatrixGuardBuffer& BufferA,
+    MatrixGuardBuffer& BufferB,
+    float beta,
+    MatrixGuardBuffer& BufferC,
+    MatrixGuardBuffer& BufferCReference
+    )
+{
+    const float* A = BufferA.GetBuffer(K * M);
+    const float* B = BufferB.GetBuffer(N * K);
+    float* C = BufferC.GetBuffer(N * M);
+    float* CReference = BufferCReference.GetBuffer(N * M);
+
+    std::vector<MLAS_FP16> BHalf(N * K);
+    std::vector<MLAS_BF16> BBFloat16(N * K);
+
+    for (size_t i = 0; i < N * K; i++) {
+
+        union {
+            float f;
+            uint32_t u;
+        } Bits;
+
+        Bits.f = B[i];
+
+        BHalf[i].Value = ConvertIntegerFloatToHalf(B[i]);
+        BBFloat16[i].Value = (unsigned short)(Bits.u >> 16);
+    }
+
+    static const CBLAS_TRANSPOSE Transposes[] = { CblasNoTrans, CblasTrans };
+
+    for (size_t ta = 0; ta < _countof(Transposes); ta++) {
+        for (size_t tb = 0; tb < _countof(Transposes); tb++) {
+
+            CBLAS_TRANSPOSE TransA = Transposes[ta];
+            CBLAS_TRANSPOSE TransB = Transposes[tb];
+            size_t lda = (TransA == CblasNoTrans) ? K : M;
+            size_t ldb = (TransB == CblasNoTrans) ? N : K;
+
+            for (size_t type = 0; type < 2; type++) {
+
+                for (size_t f = 0; f < M * N; f++) {
+                    C[f] = -0.5f;
+                    CReference[f] = -0.5f;
+                }
+
+                if (type == 0) {
+                    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, BHalf.data(), ldb, beta, C, N);
+                } else {
+                    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, BBFloat16.data(), ldb, beta, C, N);
+                }
+
+                ReferenceSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, CReference, N);
+
+                for (size_t f = 0; f < M * N; f++) {
+                    if (C[f] != CReference[f]) {
+                        printf("mismatch reduced B type=%zd TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n",
+                            type, TransA, TransB, M, N, K, alpha, beta);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+ExecuteSgemmReducedBTests(
+    void
+    )
+{
+    constexpr size_t MaximumDimension = 320;
+
+    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension, false);
+
+    static const size_t ms[] = { 1, 2, 7, 16, 33 };
+    static const size_t ns[] = { 1, 3, 15, 16, 17, 63, 128, 129, 300 };
+    static const size_t ks[] = { 1, 2, 5, 16, 31, 127, 128, 129, 257 };
+
+    for (size_t m = 0; m < _countof(ms); m++) {
+        for (size_t n = 0; n < _countof(ns); n++) {
+            for (size_t k = 0; k < _countof(ks); k++) {
+                TrialSgemmReducedB(ms[m], ns[n], ks[k], 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+                TrialSgemmReducedB(ms[m], ns[n], ks[k], -0.5f, BufferA, BufferB, 1.0f, BufferC, BufferCReference);
+            }
+        }
+    }
+}
+
 void
 ReferenceConv2D(
     size_t BatchCount,
@@ -601,6 +728,25 @@ ExecuteConvTests(
         TrialConv2D(b, 1, 64, 11, 11, 128, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
     }
 
+    //
+    // Depthwise convolutions.
+    //
+
+    for (unsigned k = 3; k <= 5; k += 2) {
+        for (unsigned ih = 0; ih < _countof(is); ih++) {
+            for (unsigned iw = 0; iw < _countof(is); iw++) {
+                for (unsigned p = 0; p <= k / 2; p++) {
+                    for (unsigned d = 1; d <= 2; d++) {
+                        for (unsigned s = 1; s <= 2; s++) {
+                            TrialConv2D(2, 24, 1, is[ih], is[iw], 1, k, k, p, p, p, p, d, d, s, s);
+                            TrialConv2D(1, 3, 1, is[ih], is[iw] + 8, 1, k, k, p, p, 0, 1, d, d, s, s);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     for (unsigned ic = 0; ic < _countof(cs); ic++) {
         for (unsigned ih = 0; ih < _countof(is); ih++) {
             for (unsigned iw = 0; iw < _countof(is); iw++) {
@@ -635,6 +781,153 @@ ExecuteConvTests(
     }
 }
 
+void
+TrialWinogradConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t Padding
+    )
+{
+    const size_t OutputHeight = InputHeight + 2 * Padding - 2;
+    const size_t OutputWidth = InputWidth + 2 * Padding - 2;
+
+    int64_t InputShape[] = { int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { 3, 3 };
+    int64_t DilationShape[] = { 1, 1 };
+    int64_t PaddingShape[] = { int64_t(Padding), int64_t(Padding), int64_t(Padding), int64_t(Padding) };
+    int64_t StrideShape[] = { 1, 1 };
+    int64_t OutputShape[] = { int64_t(OutputHeight), int64_t(OutputWidth) };
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters,
+                    2,
+                    BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputShape,
+                    KernelShape,
+                    DilationShape,
+                    PaddingShape,
+                    StrideShape,
+                    OutputShape,
+                    FilterCount,
+                    &Activation,
+                    &WorkingBufferSize);
+
+    if (Parameters.Algorithm != MlasConvAlgorithmWinograd) {
+        printf("winograd not selected: group=%zd,input(%zd,%zd,%zd),filter=%zd!!!\n",
+            GroupCount, InputChannels, InputHeight, InputWidth, FilterCount);
+        return;
+    }
+
+    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputHeight * InputWidth;
+    size_t FilterBufferElements = GroupCount * FilterCount * InputChannels * 9;
+    size_t BiasBufferElements = GroupCount * FilterCount;
+    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputHeight * OutputWidth;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, false);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, false);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+    MatrixGuardBuffer BufferTransformedFilter(Parameters.u.Winograd.FilterSize, false);
+
+    float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+    float* WorkingBuffer = BufferWorking.GetBuffer(WorkingBufferSize);
+    float* TransformedFilter = BufferTransformedFilter.GetBuffer(Parameters.u.Winograd.FilterSize);
+
+    //
+    // Use fractional values so that the transforms are not exact.
+    //
+
+    for (size_t i = 0; i < InputBufferElements; i++) {
+        Input[i] = float((i * 7) % 31) / 10.0f - 1.5f;
+    }
+
+    for (size_t i = 0; i < FilterBufferElements; i++) {
+        Filter[i] = float((i * 11) % 17) / 13.0f - 0.6f;
+    }
+
+    ReferenceConv2D(BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputHeight, InputWidth,
+                    FilterCount,
+                    3, 3,
+                    Padding, Padding,
+                    1, 1,
+                    1, 1,
+                    OutputHeight, OutputWidth,
+                    Input,
+                    Filter,
+                    Bias,
+                    OutputReference);
+
+    //
+    // Test with the filter transformed by the convolution and with a filter
+    // transformed ahead of time.
+    //
+
+    for (unsigned pass = 0; pass < 2; pass++) {
+
+        if (pass == 1) {
+            MlasConvTransformFilter(&Parameters, Filter, TransformedFilter);
+            Parameters.u.Winograd.TransformedFilter = TransformedFilter;
+        }
+
+        MlasConv(&Parameters, Input, Filter, Bias, WorkingBuffer, Output);
+
+        for (size_t i = 0; i < OutputBufferElements; i++) {
+            float Difference = fabsf(Output[i] - OutputReference[i]);
+            if (Difference > 1e-4f * (std::max)(1.0f, fabsf(OutputReference[i]))) {
+                printf("mismatch: winograd pass=%u,batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,index=%zd, %f != %f!!!\n",
+                    pass, BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                    i, Output[i], OutputReference[i]);
+                break;
+            }
+        }
+    }
+}
+
+void
+ExecuteWinogradTests(
+    void
+    )
+{
+    static const unsigned cs[] = { 16, 17, 64 };
+    static const unsigned is[] = { 2, 3, 4, 7, 16, 33 };
+
+    for (unsigned ic = 0; ic < _countof(cs); ic++) {
+        for (unsigned fc = 0; fc < _countof(cs); fc++) {
+            for (unsigned ih = 0; ih < _countof(is); ih++) {
+                for (unsigned iw = 0; iw < _countof(is); iw++) {
+                    for (unsigned p = 0; p <= 1; p++) {
+                        if (is[ih] + 2 * p < 4 || is[iw] + 2 * p < 4) continue;
+                        TrialWinogradConv2D(1, 1, cs[ic], is[ih], is[iw], cs[fc], p);
+                    }
+                }
+            }
+        }
+    }
+
+    TrialWinogradConv2D(3, 2, 32, 28, 28, 48, 1);
+    TrialWinogradConv2D(1, 1, 256, 56, 56, 128, 1);
+}
+
 void
 ReferenceMaximumPool2D(
     const int64_t* InputShape,
@@ -1152,6 +1445,353 @@ ExecutePool3DTests(
     }
 }
 
+void
+ReferenceSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    for (size_t n = 0; n < N; n++) {
+
+        double Maximum = Input[0];
+
+        for (size_t d = 1; d < D; d++) {
+            Maximum = (std::max)(Maximum, double(Input[d]));
+        }
+
+        double Sum = 0.0;
+
+        for (size_t d = 0; d < D; d++) {
+            Sum += exp(double(Input[d]) - Maximum);
+        }
+
+        for (size_t d = 0; d < D; d++) {
+            if (LogSoftmax) {
+                Output[d] = float(double(Input[d]) - Maximum - log(Sum));
+            } else {
+                Output[d] = float(exp(double(Input[d]) - Maximum) / Sum);
+            }
+        }
+
+        Input += D;
+        Output += D;
+    }
+}
+
+void
+TrialSoftmax(
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    const size_t BufferElements = N * D;
+
+    MatrixGuardBuffer BufferInput(BufferElements, true);
+    MatrixGuardBuffer BufferOutput(BufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(BufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(BufferElements);
+    float* Output = BufferOutput.GetBuffer(BufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(BufferElements);
+
+    MlasComputeSoftmax(Input, Output, N, D, LogSoftmax);
+    ReferenceSoftmax(Input, OutputReference, N, D, LogSoftmax);
+
+    for (size_t i = 0; i < BufferElements; i++) {
+        float Difference = fabsf(Output[i] - OutputReference[i]);
+        if (Difference > 1e-5f * (std::max)(1.0f, fabsf(OutputReference[i]))) {
+            printf("mismatch: %s N=%zd, D=%zd, index=%zd, %f != %f!!!\n",
+                LogSoftmax ? "logsoftmax" : "softmax", N, D, i, Output[i], OutputReference[i]);
+            break;
+        }
+    }
+}
+
+void
+ExecuteSoftmaxTests(
+    void
+    )
+{
+    static const size_t ds[] = { 1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 64, 1000, 4097 };
+
+    for (size_t n = 1; n < 128; n += 9) {
+        for (unsigned id = 0; id < _countof(ds); id++) {
+            TrialSoftmax(n, ds[id], false);
+            TrialSoftmax(n, ds[id], true);
+        }
+    }
+}
+
+void
+TrialNchwcConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t OutputHeight64 =
+        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
+        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
+    int64_t OutputWidth64 =
+        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
+        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    //
+    // The depthwise convolution has a single input and output channel per
+    // group. Otherwise, grouped convolutions require the channels of each
+    // group to be a multiple of the block size, while the channels of a
+    // single group are padded.
+    //
+
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+    const bool Depthwise = (GroupCount > 1 && InputChannels == 1 && FilterCount == 1);
+
+    size_t NchwcGroupCount = GroupCount;
+    size_t NchwcInputChannels = GroupCount * InputChannels;
+    size_t NchwcFilterCount = GroupCount * FilterCount;
+
+    if (Depthwise || GroupCount == 1) {
+        NchwcInputChannels = (NchwcInputChannels + BlockSize - 1) & ~(BlockSize - 1);
+        NchwcFilterCount = (NchwcFilterCount + BlockSize - 1) & ~(BlockSize - 1);
+        if (Depthwise) {
+            NchwcGroupCount = NchwcInputChannels;
+        }
+    } else if ((InputChannels % BlockSize) != 0 || (FilterCount % BlockSize) != 0) {
+        return;
+    }
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    size_t InputSize = InputHeight * InputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+
+    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputSize;
+    size_t FilterBufferElements = GroupCount * FilterCount * InputChannels * KernelSize;
+    size_t BiasBufferElements = GroupCount * FilterCount;
+    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputSize;
+
+    size_t NchwcInputBufferElements = BatchCount * NchwcInputChannels * InputSize;
+    size_t NchwcFilterBufferElements = NchwcFilterCount * (NchwcInputChannels / NchwcGroupCount) * KernelSize;
+    size_t NchwcOutputBufferElements = BatchCount * NchwcFilterCount * OutputSize;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcInput(NchwcInputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcFilter(NchwcFilterBufferElements, false);
+    MatrixGuardBuffer BufferNchwcBias(NchwcFilterCount, false);
+    MatrixGuardBuffer BufferNchwcOutput(NchwcOutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+    float* NchwcInput = BufferNchwcInput.GetBuffer(NchwcInputBufferElements);
+    float* NchwcFilter = BufferNchwcFilter.GetBuffer(NchwcFilterBufferElements);
+    float* NchwcBias = BufferNchwcBias.GetBuffer(NchwcFilterCount);
+    float* NchwcOutput = BufferNchwcOutput.GetBuffer(NchwcOutputBufferElements);
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(GroupCount * InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t FilterShape[] = { int64_t(GroupCount * FilterCount), int64_t(InputChannels), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(GroupCount * FilterCount), OutputHeight64, OutputWidth64 };
+    int64_t NchwcInputShape[] = { int64_t(BatchCount), int64_t(NchwcInputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t NchwcOutputShape[] = { int64_t(BatchCount), int64_t(NchwcFilterCount), OutputHeight64, OutputWidth64 };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+
+    MlasReorderInput(InputShape, Input, NchwcInput);
+
+    if (Depthwise) {
+        MlasReorderFilterOIHWBo(FilterShape, Filter, NchwcFilter);
+    } else {
+        MlasReorderFilterOIHWBiBo(FilterShape, Filter, NchwcFilter);
+    }
+
+    std::fill_n(NchwcBias, NchwcFilterCount, 0.0f);
+    std::copy_n(Bias, BiasBufferElements, NchwcBias);
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MlasNchwcConv(NchwcInputShape,
+                  KernelShape,
+                  DilationShape,
+                  Padding,
+                  StrideShape,
+                  NchwcOutputShape,
+                  NchwcGroupCount,
+                  NchwcInput,
+                  NchwcFilter,
+                  NchwcBias,
+                  NchwcOutput,
+                  &Activation);
+
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+
+    ReferenceConv2D(BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputHeight, InputWidth,
+                    FilterCount,
+                    KernelHeight, KernelWidth,
+                    PaddingLeftHeight, PaddingLeftWidth,
+                    DilationHeight, DilationWidth,
+                    StrideHeight, StrideWidth,
+                    OutputHeight, OutputWidth,
+                    Input,
+                    Filter,
+                    Bias,
+                    OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth);
+    }
+}
+
+void
+TrialNchwcPool2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+    const size_t NchwcInputChannels = (InputChannels + BlockSize - 1) & ~(BlockSize - 1);
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+
+    int64_t NchwcInputShape[] = { InputShape[0], int64_t(NchwcInputChannels), InputShape[2], InputShape[3] };
+    int64_t NchwcOutputShape[] = { OutputShape[0], int64_t(NchwcInputChannels), OutputShape[2], OutputShape[3] };
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+    size_t NchwcInputBufferElements = size_t(NchwcInputShape[0] * NchwcInputShape[1] * NchwcInputShape[2] * NchwcInputShape[3]);
+    size_t NchwcOutputBufferElements = size_t(NchwcOutputShape[0] * NchwcOutputShape[1] * NchwcOutputShape[2] * NchwcOutputShape[3]);
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcInput(NchwcInputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcOutput(NchwcOutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+    float* NchwcInput = BufferNchwcInput.GetBuffer(NchwcInputBufferElements);
+    float* NchwcOutput = BufferNchwcOutput.GetBuffer(NchwcOutputBufferElements);
+
+    MlasReorderInput(InputShape, Input, NchwcInput);
+
+    MlasNchwcPool(MlasMaximumPooling, NchwcInputShape, KernelShape, Padding, StrideShape, NchwcOutputShape, NchwcInput, NchwcOutput);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceMaximumPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc maximum input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasNchwcPool(MlasAveragePoolingExcludePad, NchwcInputShape, KernelShape, Padding, StrideShape, NchwcOutputShape, NchwcInput, NchwcOutput);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, false);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc averageexcpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasNchwcPool(MlasAveragePoolingIncludePad, NchwcInputShape, KernelShape, Padding, StrideShape, NchwcOutputShape, NchwcInput, NchwcOutput);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, true);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc averageincpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteNchwcTests(
+    void
+    )
+{
+    static const unsigned cs[] = { 3, 8, 16, 20 };
+    static const unsigned is[] = { 23, 11, 5, 1 };
+
+    for (unsigned ic = 0; ic < _countof(cs); ic++) {
+        for (unsigned ih = 0; ih < _countof(is); ih++) {
+            for (unsigned iw = 0; iw < _countof(is); iw++) {
+                fprintf(stderr, "Handling nchwc %dx%dx%d\n", cs[ic], is[ih], is[iw]);
+                for (unsigned kh = 1; kh <= 5; kh += 2) {
+                    for (unsigned kw = 1; kw <= 5; kw += 2) {
+                        for (unsigned p = 0; p < 2; p++) {
+                            for (unsigned d = 1; d <= 2; d++) {
+                                for (unsigned s = 1; s <= 2; s++) {
+                                    TrialNchwcConv2D(1, 1, cs[ic], is[ih], is[iw], 16, kh, kw, p, p, p, p, d, d, s, s);
+                                    TrialNchwcConv2D(2, 1, cs[ic], is[ih], is[iw], cs[ic], kh, kw, p, 0, 0, p, d, d, s, s);
+                                    TrialNchwcConv2D(1, cs[ic], 1, is[ih], is[iw], 1, kh, kw, p, p, p, p, d, d, s, s);
+                                    TrialNchwcConv2D(1, 2, cs[ic], is[ih], is[iw], 8, kh, kw, p, p, p, p, d, d, s, s);
+                                }
+                            }
+                        }
+                        if (kh <= is[ih] && kw <= is[iw]) {
+                            TrialNchwcPool2D(2, cs[ic], is[ih], is[iw], kh, kw, 0, 0, 0, 0, 1, 1);
+                            TrialNchwcPool2D(1, cs[ic], is[ih], is[iw], kh, kw, kh / 2, kw / 2, kh / 2, kw / 2, 2, 2);
+                        }
+                    }
+                }
+                TrialNchwcPool2D(1, cs[ic], is[ih], is[iw], is[ih], is[iw], 0, 0, 0, 0, 1, 1);
+            }
+        }
+    }
+}
+
 #if 0
 #if defined(_WIN32)
 
@@ -1239,9 +1879,13 @@ main(
     )
 {
 //    ExecuteSgemmTests();
+    ExecuteSgemmReducedBTests();
     ExecuteConvTests();
+    ExecuteWinogradTests();
 //    ExecutePool2DTests();
 //    ExecutePool3DTests();
+    ExecuteSoftmaxTests();
+    ExecuteNchwcTests();
 //    EvaluateThreadingPerformance();
 
     return 0;
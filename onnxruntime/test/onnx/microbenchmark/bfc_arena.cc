@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/framework/bfc_arena.h>
+#include <core/framework/cpu_region_allocator.h>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace onnxruntime;
+
+namespace {
+
+// The argument selects the device allocator of the arena: 0 CPUAllocator, 1 regions with huge pages,
+// 2 regions with huge pages bound to NUMA node 0.
+std::unique_ptr<IDeviceAllocator> CreateDeviceAllocator(int64_t kind) {
+  if (kind == 0) {
+    return std::make_unique<CPUAllocator>();
+  }
+  MemoryRegionOptions options;
+  options.use_huge_pages = true;
+  options.numa_node = kind == 2 ? 0 : -1;
+  return std::make_unique<CPURegionAllocator>(options);
+}
+
+}  // namespace
+
+// Grows a new arena to 256MB with allocations of 1MB, each extend allocates a region and touches its pages.
+static void BM_BFCArena_Extend(benchmark::State& state) {
+  const size_t allocation_size = 1 << 20;
+  const size_t num_allocations = 256;
+  for (auto _ : state) {
+    BFCArena arena(CreateDeviceAllocator(state.range(0)), std::numeric_limits<size_t>::max());
+    for (size_t i = 0; i < num_allocations; ++i) {
+      void* p = arena.Alloc(allocation_size);
+      if (p == nullptr) {
+        state.SkipWithError("Alloc failed");
+        return;
+      }
+      memset(p, 0, allocation_size);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * num_allocations * allocation_size);
+}
+
+BENCHMARK(BM_BFCArena_Extend)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// Allocates and frees buffers of random sizes between 256 bytes and 4MB from an arena that already holds the
+// memory, like the activations of a session run after the first one. The buffers are touched, so the TLB misses
+// are part of the measure.
+static void BM_BFCArena_SteadyState(benchmark::State& state) {
+  BFCArena arena(CreateDeviceAllocator(state.range(0)), std::numeric_limits<size_t>::max());
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<int> log_size(8, 22);
+  std::vector<size_t> sizes(1024);
+  for (auto& size : sizes) {
+    size = size_t{1} << log_size(engine);
+  }
+
+  std::vector<void*> live(64, nullptr);
+  size_t next = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < live.size(); ++i) {
+      arena.Free(live[i]);
+      const size_t size = sizes[next++ % sizes.size()];
+      live[i] = arena.Alloc(size);
+      if (live[i] == nullptr) {
+        state.SkipWithError("Alloc failed");
+        return;
+      }
+      // one write per 4KB page
+      for (size_t offset = 0; offset < size; offset += 4096) {
+        static_cast<char*>(live[i])[offset] = 1;
+      }
+    }
+  }
+  for (void* p : live) {
+    arena.Free(p);
+  }
+  state.SetItemsProcessed(state.iterations() * live.size());
+}
+
+BENCHMARK(BM_BFCArena_SteadyState)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
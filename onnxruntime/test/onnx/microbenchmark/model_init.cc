@@ -220,3 +220,52 @@ static void BM_PartitionModel_inception_v4(benchmark::State& state) {
 }
 
 BENCHMARK(BM_PartitionModel_inception_v4);
+
+// Builds a model with a chain of <num_nodes> LeakyRelu nodes, which is the shape of the graphs produced by
+// converters for very deep models.
+static std::unique_ptr<Model> CreateChainModel(int64_t num_nodes) {
+  auto model = std::make_unique<Model>("chain");
+  auto& graph = model->MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(16);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(16);
+
+  NodeArg* input = &graph.GetOrCreateNodeArg("X", &float_tensor);
+  for (int64_t i = 0; i < num_nodes; ++i) {
+    NodeArg* output = &graph.GetOrCreateNodeArg("Y" + std::to_string(i), nullptr);
+    graph.AddNode("node" + std::to_string(i), "LeakyRelu", "", {input}, {output});
+    input = output;
+  }
+  return model;
+}
+
+static void BM_ResolveGraph_Chain(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<Model> model = CreateChainModel(state.range(0));
+    state.ResumeTiming();
+    BM_BREAK_IF_ERROR(model->MainGraph().Resolve());
+  }
+}
+
+BENCHMARK(BM_ResolveGraph_Chain)->Arg(1000)->Arg(10000);
+
+// Resolve after an optimizer style edit of a single node, where only the modified node is inferred again.
+static void BM_ResolveGraph_Chain_AfterEdit(benchmark::State& state) {
+  std::unique_ptr<Model> model = CreateChainModel(state.range(0));
+  auto& graph = model->MainGraph();
+  BM_BREAK_IF_ERROR(graph.Resolve());
+  Node& node = *graph.GetNode(graph.MaxNodeIndex() / 2);
+  float alpha = 0.01f;
+  for (auto _ : state) {
+    state.PauseTiming();
+    alpha += 0.01f;
+    node.AddAttribute("alpha", alpha);
+    state.ResumeTiming();
+    BM_BREAK_IF_ERROR(graph.Resolve());
+  }
+}
+
+BENCHMARK(BM_ResolveGraph_Chain_AfterEdit)->Arg(1000)->Arg(10000);
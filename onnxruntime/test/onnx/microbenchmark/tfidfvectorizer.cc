@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/framework/allocator.h>
+#include <core/framework/ml_value.h>
+#include <core/framework/tensor.h>
+#include <core/graph/model.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/session/inference_session.h>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace onnxruntime;
+
+#define BM_BREAK_IF_ERROR(expr)                                                 \
+  do {                                                                          \
+    auto _status = (expr);                                                      \
+    if ((!_status.IsOK())) state.SkipWithError(_status.ErrorMessage().c_str()); \
+  } while (0)
+
+namespace {
+
+// Words are drawn from a vocabulary twice the size of the 1-grams of the pool, so about half of
+// the input tokens are not in the pool, as is usual for text.
+std::string Word(size_t i) {
+  return "word" + std::to_string(i);
+}
+
+// Builds a TfIdfVectorizer model over a pool of <num_ngrams> string 1-grams and as many 2-grams.
+Status CreateTfIdfModel(int64_t num_ngrams, int64_t max_skip_count, std::string& serialized_model) {
+  Model model("tfidf");
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto string_tensor;
+  string_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_STRING);
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+  std::vector<std::string> pool_strings;
+  for (int64_t i = 0; i < num_ngrams; ++i) {
+    pool_strings.push_back(Word(i));
+  }
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<int64_t> word(0, num_ngrams - 1);
+  for (int64_t i = 0; i < num_ngrams; ++i) {
+    // the 2-grams must be distinct
+    pool_strings.push_back(Word(i));
+    pool_strings.push_back(Word(word(engine)));
+  }
+  std::vector<int64_t> ngram_indexes(2 * num_ngrams);
+  for (int64_t i = 0; i < 2 * num_ngrams; ++i) {
+    ngram_indexes[i] = i;
+  }
+
+  auto& node = graph.AddNode("tfidf", "TfIdfVectorizer", "",
+                             {&graph.GetOrCreateNodeArg("X", &string_tensor)},
+                             {&graph.GetOrCreateNodeArg("Y", &float_tensor)});
+  node.AddAttribute("mode", std::string("TF"));
+  node.AddAttribute("min_gram_length", int64_t{1});
+  node.AddAttribute("max_gram_length", int64_t{2});
+  node.AddAttribute("max_skip_count", max_skip_count);
+  node.AddAttribute("ngram_counts", std::vector<int64_t>{0, num_ngrams});
+  node.AddAttribute("ngram_indexes", ngram_indexes);
+  node.AddAttribute("pool_strings", pool_strings);
+
+  ORT_RETURN_IF_ERROR(graph.Resolve());
+  if (!model.ToProto().SerializeToString(&serialized_model)) {
+    return Status(common::ONNXRUNTIME, common::FAIL, "Failed to serialize the model");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+// Arguments are the number of 1-grams (and 2-grams) in the pool and max_skip_count. The input is a
+// batch of 16 rows of 1024 tokens.
+static void BM_TfIdfVectorizer_Strings(benchmark::State& state) {
+  const int64_t num_ngrams = state.range(0);
+  const int64_t max_skip_count = state.range(1);
+  const int64_t batch_size = 16;
+  const int64_t row_size = 1024;
+
+  std::string serialized_model;
+  BM_BREAK_IF_ERROR(CreateTfIdfModel(num_ngrams, max_skip_count, serialized_model));
+
+  SessionOptions so;
+  InferenceSession session(so);
+  std::istringstream model_stream(serialized_model);
+  BM_BREAK_IF_ERROR(session.Load(model_stream));
+  BM_BREAK_IF_ERROR(session.Initialize());
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  auto input = std::make_unique<Tensor>(DataTypeImpl::GetType<std::string>(),
+                                        TensorShape({batch_size, row_size}), allocator);
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<int64_t> word(0, 2 * num_ngrams - 1);
+  std::string* input_data = input->MutableData<std::string>();
+  for (int64_t i = 0; i < batch_size * row_size; ++i) {
+    input_data[i] = Word(word(engine));
+  }
+
+  MLValue input_value;
+  input_value.Init(input.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+  NameMLValMap feeds{{"X", input_value}};
+  std::vector<std::string> output_names{"Y"};
+
+  for (auto _ : state) {
+    std::vector<MLValue> fetches;
+    BM_BREAK_IF_ERROR(session.Run(feeds, output_names, &fetches));
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * row_size);
+}
+
+BENCHMARK(BM_TfIdfVectorizer_Strings)
+    ->Args({10000, 0})
+    ->Args({100000, 0})
+    ->Args({100000, 2})
+    ->Unit(benchmark::kMicrosecond);
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <sstream>
 #include "core/session/inference_session.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -25,6 +26,8 @@
 #include "gtest/gtest.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
 #include "core/optimizer/constant_folding.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/optimizer/element_wise_fusion.h"
 
 using namespace std;
 using namespace ONNX_NAMESPACE;
@@ -90,19 +93,80 @@ TEST(GraphTransformationTests, ConstantFolding1) {
   std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
   ASSERT_TRUE(op_to_count["Unsqueeze"] == 2);
 
-  std::unique_ptr<TopDownRuleBasedTransformer> rule_transformer =
-      std::make_unique<TopDownRuleBasedTransformer>("RuleTransformer1", "First rule transformer");
-
-  rule_transformer->Register(std::make_unique<ConstantFolding>());
   onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
-
-  graph_transformation_mgr.Register(std::move(rule_transformer), TransformerLevel::Level1, {});
+  graph_transformation_mgr.Register(std::make_unique<ConstantFolding>(), TransformerLevel::Level1, {});
   ASSERT_TRUE(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1).IsOK());
 
   op_to_count = CountOpsInGraph(graph);
   ASSERT_TRUE(op_to_count["Unsqueeze"] == 0);
 }
 
+TEST(GraphTransformationTests, ConstantFoldingSubgraph) {
+  // W -> Transpose -> Neg -> Add(X, .) -> Y
+  // Transpose and Neg only depend on the initializer W so they are folded together,
+  // and only the output of Neg becomes an initializer.
+  // W is not a graph input, otherwise it could be overridden at runtime and would not be constant.
+  ModelProto model_proto;
+  model_proto.set_ir_version(ONNX_NAMESPACE::Version::IR_VERSION);
+  model_proto.add_opset_import()->set_version(9);
+  GraphProto& graph_proto = *model_proto.mutable_graph();
+  graph_proto.set_name("ConstantFoldingSubgraph");
+
+  auto set_float_2x2 = [](ValueInfoProto& value_info, const std::string& name) {
+    value_info.set_name(name);
+    auto* tensor_type = value_info.mutable_type()->mutable_tensor_type();
+    tensor_type->set_elem_type(TensorProto_DataType_FLOAT);
+    tensor_type->mutable_shape()->add_dim()->set_dim_value(2);
+    tensor_type->mutable_shape()->add_dim()->set_dim_value(2);
+  };
+  set_float_2x2(*graph_proto.add_input(), "X");
+  set_float_2x2(*graph_proto.add_output(), "Y");
+
+  TensorProto& w_initializer = *graph_proto.add_initializer();
+  w_initializer.set_name("W");
+  w_initializer.set_data_type(TensorProto_DataType_FLOAT);
+  w_initializer.add_dims(2);
+  w_initializer.add_dims(2);
+  for (float value : {1.f, 2.f, 3.f, 4.f}) {
+    w_initializer.add_float_data(value);
+  }
+
+  auto add_node = [&graph_proto](const std::string& op_type, const std::vector<std::string>& inputs,
+                                 const std::string& output) {
+    NodeProto& node = *graph_proto.add_node();
+    node.set_op_type(op_type);
+    for (const auto& input : inputs) {
+      node.add_input(input);
+    }
+    node.add_output(output);
+  };
+  add_node("Transpose", {"W"}, "W_transposed");
+  add_node("Neg", {"W_transposed"}, "W_negated");
+  add_node("Add", {"X", "W_negated"}, "Y");
+
+  Model model(model_proto);
+  Graph& graph = model.MainGraph();
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<ConstantFolding>(), TransformerLevel::Level1, {});
+  ASSERT_TRUE(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1).IsOK());
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  ASSERT_EQ(op_to_count["Transpose"], 0);
+  ASSERT_EQ(op_to_count["Neg"], 0);
+  ASSERT_EQ(op_to_count["Add"], 1);
+
+  const TensorProto* folded = nullptr;
+  ASSERT_FALSE(graph.GetInitializedTensor("W_transposed", folded));
+  ASSERT_TRUE(graph.GetInitializedTensor("W_negated", folded));
+  ASSERT_EQ(folded->raw_data().size(), 4 * sizeof(float));
+
+  std::vector<float> values(4);
+  memcpy(values.data(), folded->raw_data().data(), folded->raw_data().size());
+  ASSERT_EQ(values, (std::vector<float>{-1.f, -3.f, -2.f, -4.f}));
+}
+
 TEST(GraphTransformationTests, FuseConvBNMulAddUnsqueeze) {
   string model_uri = MODEL_FOLDER + "fusion/fuse-conv-bn-mul-add-unsqueeze.onnx";
 
@@ -361,5 +425,246 @@ TEST(GraphTransformationTests, FuseConvBnAddMulFloat16) {
   ASSERT_EQ(expected_values_prod, found);
 }
 
+
+// X -> Conv -> Relu -> Conv (depthwise) -> MaxPool -> Y
+static void BuildNchwcTestModel(ModelProto& model_proto) {
+  model_proto.set_ir_version(ONNX_NAMESPACE::Version::IR_VERSION);
+  model_proto.add_opset_import()->set_version(9);
+  GraphProto& graph_proto = *model_proto.mutable_graph();
+  graph_proto.set_name("NchwcTransformer");
+
+  auto set_float_nchw = [](ValueInfoProto& value_info, const std::string& name, std::vector<int64_t> dims) {
+    value_info.set_name(name);
+    auto* tensor_type = value_info.mutable_type()->mutable_tensor_type();
+    tensor_type->set_elem_type(TensorProto_DataType_FLOAT);
+    for (auto dim : dims) {
+      tensor_type->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+  };
+  set_float_nchw(*graph_proto.add_input(), "X", {1, 8, 6, 6});
+  set_float_nchw(*graph_proto.add_output(), "Y", {1, 16, 3, 3});
+
+  auto add_initializer = [&graph_proto](const std::string& name, std::vector<int64_t> dims) {
+    TensorProto& initializer = *graph_proto.add_initializer();
+    initializer.set_name(name);
+    initializer.set_data_type(TensorProto_DataType_FLOAT);
+    int64_t size = 1;
+    for (auto dim : dims) {
+      initializer.add_dims(dim);
+      size *= dim;
+    }
+    for (int64_t i = 0; i < size; i++) {
+      initializer.add_float_data(static_cast<float>((i * 7) % 13) / 13.f - 0.5f);
+    }
+  };
+  add_initializer("W1", {16, 8, 3, 3});
+  add_initializer("B1", {16});
+  add_initializer("W2", {16, 1, 3, 3});
+
+  auto add_node = [&graph_proto](const std::string& op_type, const std::vector<std::string>& inputs,
+                                 const std::string& output) -> NodeProto& {
+    NodeProto& node = *graph_proto.add_node();
+    node.set_op_type(op_type);
+    for (const auto& input : inputs) {
+      node.add_input(input);
+    }
+    node.add_output(output);
+    return node;
+  };
+  auto add_ints_attribute = [](NodeProto& node, const std::string& name, std::vector<int64_t> values) {
+    AttributeProto& attr = *node.add_attribute();
+    attr.set_name(name);
+    attr.set_type(AttributeProto_AttributeType_INTS);
+    for (auto value : values) {
+      attr.add_ints(value);
+    }
+  };
+
+  NodeProto& conv1 = add_node("Conv", {"X", "W1", "B1"}, "conv1");
+  add_ints_attribute(conv1, "pads", {1, 1, 1, 1});
+  add_node("Relu", {"conv1"}, "relu1");
+  NodeProto& conv2 = add_node("Conv", {"relu1", "W2"}, "conv2");
+  add_ints_attribute(conv2, "pads", {1, 1, 1, 1});
+  AttributeProto& group = *conv2.add_attribute();
+  group.set_name("group");
+  group.set_type(AttributeProto_AttributeType_INT);
+  group.set_i(16);
+  NodeProto& pool = add_node("MaxPool", {"conv2"}, "Y");
+  add_ints_attribute(pool, "kernel_shape", {2, 2});
+  add_ints_attribute(pool, "strides", {2, 2});
+}
+
+TEST(GraphTransformationTests, NchwcTransformer) {
+  ModelProto model_proto;
+  BuildNchwcTestModel(model_proto);
+
+  Model model(model_proto);
+  Graph& graph = model.MainGraph();
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<NchwcTransformer>(), TransformerLevel::Level2, {});
+  ASSERT_TRUE(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2).IsOK());
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  ASSERT_EQ(op_to_count["ReorderInput"], 1);
+  ASSERT_EQ(op_to_count["ReorderOutput"], 1);
+  ASSERT_EQ(op_to_count["Conv"], 2);
+  ASSERT_EQ(op_to_count["MaxPool"], 1);
+  ASSERT_EQ(op_to_count["Relu"], 0);
+  for (auto& node : graph.Nodes()) {
+    ASSERT_EQ(node.Domain(), kMSNchwcDomain);
+  }
+
+  // The transformed graph must compute the same result as the original graph.
+  std::string model_data;
+  model_proto.SerializeToString(&model_data);
+
+  std::vector<int64_t> dims_x = {1, 8, 6, 6};
+  std::vector<float> values_x(288);
+  for (size_t i = 0; i < values_x.size(); i++) {
+    values_x[i] = static_cast<float>((i * 5) % 17) / 17.f - 0.25f;
+  }
+
+  auto run_model = [&](bool enable_nchwc, std::vector<float>& values_y) {
+    SessionOptions so;
+    so.session_logid = "GraphTransformationTests.NchwcTransformer";
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    // the transformer is opt-in
+    if (enable_nchwc) {
+      ASSERT_TRUE(session_object.AddCustomTransformerList({"NchwcTransformer"}).IsOK());
+    }
+    std::istringstream model_istream(model_data);
+    ASSERT_TRUE(session_object.Load(model_istream).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    MLValue ml_value_x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x,
+                         &ml_value_x);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value_x));
+    std::vector<MLValue> fetches;
+    RunOptions run_options;
+    ASSERT_TRUE(session_object.Run(run_options, feeds, {"Y"}, &fetches).IsOK());
+
+    const Tensor& y = fetches[0].Get<Tensor>();
+    ASSERT_EQ(y.Shape(), TensorShape({1, 16, 3, 3}));
+    values_y.assign(y.Data<float>(), y.Data<float>() + y.Shape().Size());
+  };
+
+  std::vector<float> expected_y;
+  std::vector<float> nchwc_y;
+  run_model(false, expected_y);
+  run_model(true, nchwc_y);
+  ASSERT_EQ(expected_y.size(), nchwc_y.size());
+  for (size_t i = 0; i < expected_y.size(); i++) {
+    ASSERT_NEAR(expected_y[i], nchwc_y[i], 1e-5f);
+  }
+}
+
+// X -> Add(B) -> Sigmoid -> Mul -> Y, where the Mul also consumes the output of the Add.
+static void BuildElementWiseFusionTestModel(ModelProto& model_proto) {
+  model_proto.set_ir_version(ONNX_NAMESPACE::Version::IR_VERSION);
+  model_proto.add_opset_import()->set_version(9);
+  GraphProto& graph_proto = *model_proto.mutable_graph();
+  graph_proto.set_name("ElementWiseFusion");
+
+  auto set_float_tensor = [](ValueInfoProto& value_info, const std::string& name, std::vector<int64_t> dims) {
+    value_info.set_name(name);
+    auto* tensor_type = value_info.mutable_type()->mutable_tensor_type();
+    tensor_type->set_elem_type(TensorProto_DataType_FLOAT);
+    for (auto dim : dims) {
+      tensor_type->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+  };
+  set_float_tensor(*graph_proto.add_input(), "X", {4, 8});
+  set_float_tensor(*graph_proto.add_output(), "Y", {4, 8});
+
+  TensorProto& bias = *graph_proto.add_initializer();
+  bias.set_name("B");
+  bias.set_data_type(TensorProto_DataType_FLOAT);
+  bias.add_dims(8);
+  for (int i = 0; i < 8; i++) {
+    bias.add_float_data(static_cast<float>(i) / 8.f - 0.5f);
+  }
+
+  auto add_node = [&graph_proto](const std::string& op_type, const std::vector<std::string>& inputs,
+                                 const std::string& output) {
+    NodeProto& node = *graph_proto.add_node();
+    node.set_op_type(op_type);
+    for (const auto& input : inputs) {
+      node.add_input(input);
+    }
+    node.add_output(output);
+  };
+  add_node("Add", {"X", "B"}, "add");
+  add_node("Sigmoid", {"add"}, "sigmoid");
+  add_node("Mul", {"add", "sigmoid"}, "Y");
+}
+
+TEST(GraphTransformationTests, ElementWiseFusion) {
+  ModelProto model_proto;
+  BuildElementWiseFusionTestModel(model_proto);
+
+  Model model(model_proto);
+  Graph& graph = model.MainGraph();
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<ElementWiseFusion>(), TransformerLevel::Level2, {});
+  ASSERT_TRUE(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2).IsOK());
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  ASSERT_EQ(op_to_count["FusedElementWise"], 1);
+  ASSERT_EQ(op_to_count["Add"], 0);
+  ASSERT_EQ(op_to_count["Sigmoid"], 0);
+  ASSERT_EQ(op_to_count["Mul"], 0);
+
+  // The transformed graph must compute the same result as the original graph.
+  std::string model_data;
+  model_proto.SerializeToString(&model_data);
+
+  std::vector<int64_t> dims_x = {4, 8};
+  std::vector<float> values_x(32);
+  for (size_t i = 0; i < values_x.size(); i++) {
+    values_x[i] = static_cast<float>((i * 5) % 17) / 4.f - 2.f;
+  }
+
+  auto run_model = [&](bool enable_fusion, std::vector<float>& values_y) {
+    SessionOptions so;
+    so.session_logid = "GraphTransformationTests.ElementWiseFusion";
+    so.graph_optimization_level = TransformerLevel::Level2;
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    // the transformer is opt-in
+    if (enable_fusion) {
+      ASSERT_TRUE(session_object.AddCustomTransformerList({"ElementWiseFusion"}).IsOK());
+    }
+    std::istringstream model_istream(model_data);
+    ASSERT_TRUE(session_object.Load(model_istream).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    MLValue ml_value_x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x,
+                         &ml_value_x);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value_x));
+    std::vector<MLValue> fetches;
+    RunOptions run_options;
+    ASSERT_TRUE(session_object.Run(run_options, feeds, {"Y"}, &fetches).IsOK());
+
+    const Tensor& y = fetches[0].Get<Tensor>();
+    ASSERT_EQ(y.Shape(), TensorShape({4, 8}));
+    values_y.assign(y.Data<float>(), y.Data<float>() + y.Shape().Size());
+  };
+
+  std::vector<float> expected_y;
+  std::vector<float> fused_y;
+  run_model(false, expected_y);
+  run_model(true, fused_y);
+  ASSERT_EQ(expected_y.size(), fused_y.size());
+  for (size_t i = 0; i < expected_y.size(); i++) {
+    ASSERT_NEAR(expected_y[i], fused_y[i], 1e-5f);
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -52,5 +52,33 @@ TEST(GraphTransformerUtilsTests, TestGenerateGraphTransformers) {
   ASSERT_TRUE(transformers.size() == 0);
 }
 
+TEST(GraphTransformerUtilsTests, TestOptInGraphTransformers) {
+  auto has_transformer = [](const std::vector<transformer_utils::TransformerProviderSet>& transformers,
+                            const std::string& name) {
+    return std::any_of(transformers.begin(), transformers.end(),
+                       [&name](const transformer_utils::TransformerProviderSet& item) {
+                         return item.first->Name() == name;
+                       });
+  };
+
+  // ConstantFolding is only generated when it's requested
+  auto transformers = transformer_utils::GenerateTransformers(TransformerLevel::Level1);
+  ASSERT_FALSE(has_transformer(transformers, "ConstantFolding"));
+
+  std::vector<std::string> custom_list = {"ConstantFolding"};
+  transformers = transformer_utils::GenerateTransformers(TransformerLevel::Level1, &custom_list);
+  ASSERT_EQ(transformers.size(), 1u);
+  ASSERT_TRUE(has_transformer(transformers, "ConstantFolding"));
+
+  // and so is NchwcTransformer
+  transformers = transformer_utils::GenerateTransformers(TransformerLevel::Level2);
+  ASSERT_FALSE(has_transformer(transformers, "NchwcTransformer"));
+
+  custom_list = {"NchwcTransformer"};
+  transformers = transformer_utils::GenerateTransformers(TransformerLevel::Level2, &custom_list);
+  ASSERT_EQ(transformers.size(), 1u);
+  ASSERT_TRUE(has_transformer(transformers, "NchwcTransformer"));
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -487,6 +487,341 @@ TEST(Loop, InfiniteLoopTermination) {
   terminator_thread.join();
 }
 
+// run enough iterations without a maximum trip count for the buffer accumulating the loop output to grow,
+// and for the buffers of the loop carried variable to be reused
+TEST(Loop, ManyIterationsWithoutTripCount) {
+  const int64_t num_iterations = 40;
+
+  auto create_subgraph = [num_iterations](const RunOptions&) {
+    Model model("Many iterations subgraph");
+    auto& graph = model.MainGraph();
+
+    /* Add outer_scope_0 to the loop carried var until it reaches num_iterations * kOuterNodeAddValue.
+       The sum is the loop carried var and the loop output.
+
+         iter_num_in    cond_in    loop_var_0_in  [outer_scope_0]
+           (unused)    (unused)          \           /
+                                           [Add]----/         [Constant]
+                                             |                    |
+                                           sum_0 --------------[Less]
+                                           /   \                 |
+                                   [Identity]  [Identity]       cond_out
+                                       |           |
+                              loop_var_0_out   loop_out_0
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_scalar;
+    float_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& loop_var_0_in = graph.GetOrCreateNodeArg("loop_var_0_in", &float_scalar);
+
+    auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+    graph.AddOuterScopeNodeArg("outer_scope_0");
+
+    auto& sum_0 = graph.GetOrCreateNodeArg("sum_0", &float_scalar);
+    auto& max_value_out = graph.GetOrCreateNodeArg("max_value_out", &float_scalar);
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_scalar);
+    auto& loop_out_0 = graph.GetOrCreateNodeArg("loop_out_0", &float_scalar);
+
+    graph.AddNode("add", "Add", "Add outer_scope_0 to the loop carried var", {&outer_scope_0, &loop_var_0_in},
+                  {&sum_0});
+
+    auto& constant = graph.AddNode("constant_max_value", "Constant", "Constant with the final sum",
+                                   {}, {&max_value_out});
+    TensorProto value_tensor;
+    value_tensor.add_dims(1);
+    value_tensor.add_float_data(kOuterNodeAddValue * num_iterations);
+    value_tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    constant.AddAttribute("value", value_tensor);
+
+    graph.AddNode("sum_less_than_max", "Less", "Check sum < max", {&sum_0, &max_value_out}, {&cond_out});
+    graph.AddNode("loop_var_out", "Identity", "Output sum as loop_var_0_out", {&sum_0}, {&loop_var_0_out});
+    graph.AddNode("loop_out", "Identity", "Output sum as loop_out_0", {&sum_0}, {&loop_out_0});
+
+    graph.SetInputOrder({&iter_num_in, &cond_in, &loop_var_0_in});
+    graph.SetOutputOrder({&cond_out, &loop_var_0_out, &loop_out_0});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  LoopOpTester test{{}, create_subgraph};
+
+  test.AddMissingOptionalInput<int64_t>();
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {1}, {0.f});
+
+  std::vector<float> loop_out_0_final;
+  for (int64_t i = 1; i <= num_iterations; ++i) {
+    loop_out_0_final.push_back(kOuterNodeAddValue * i);
+  }
+
+  test.AddOutput<float>("loop_var_0_final", {1}, {kOuterNodeAddValue * num_iterations});
+  test.AddOutput<float>("loop_out_0_final", {num_iterations, 1}, loop_out_0_final);
+
+  test.Run();
+}
+
+// the loop carried variable grows by one element in each iteration, so its buffers are either grown or reused
+// for a shape that is different from the one they were last used for
+TEST(Loop, LoopCarriedVarChangesShape) {
+  const int64_t num_iterations = 5;
+
+  auto create_subgraph = [](const RunOptions&) {
+    Model model("Loop carried var changes shape subgraph");
+    auto& graph = model.MainGraph();
+
+    /* Append outer_scope_0 to the loop carried var in each iteration.
+
+         iter_num_in    cond_in    loop_var_0_in  [outer_scope_0]
+           (unused)        |             \           /
+                       [Identity]         [Concat]--/
+                           |                  |
+                        cond_out        loop_var_0_out
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_vector;
+    float_vector.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_vector.mutable_tensor_type()->mutable_shape()->add_dim();
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& loop_var_0_in = graph.GetOrCreateNodeArg("loop_var_0_in", &float_vector);
+
+    auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+    graph.AddOuterScopeNodeArg("outer_scope_0");
+
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_vector);
+
+    graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", {&cond_in}, {&cond_out});
+    auto& concat = graph.AddNode("concat", "Concat", "Append outer_scope_0 to the loop carried var",
+                                 {&loop_var_0_in, &outer_scope_0}, {&loop_var_0_out});
+    concat.AddAttribute("axis", int64_t{0});
+
+    graph.SetInputOrder({&iter_num_in, &cond_in, &loop_var_0_in});
+    graph.SetOutputOrder({&cond_out, &loop_var_0_out});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  LoopOpTester test{{}, create_subgraph};
+
+  test.AddInput<int64_t>("M", {1}, {num_iterations});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {1}, {0.f});
+
+  std::vector<float> loop_var_0_final(num_iterations + 1, kOuterNodeAddValue);
+  loop_var_0_final[0] = 0.f;
+  test.AddOutput<float>("loop_var_0_final", {num_iterations + 1}, loop_var_0_final);
+
+  test.Run();
+}
+
+// the subgraph passes the feed of a loop carried variable through Identity, which aliases it, to another loop
+// carried variable and to a loop output. the buffer holding the feed must not be handed out for an output.
+TEST(Loop, PassThroughLoopCarriedVarAliasesFeed) {
+  auto create_subgraph = [](const RunOptions&) {
+    Model model("Pass through loop carried var subgraph");
+    auto& graph = model.MainGraph();
+
+    /* Swap the loop carried vars, adding outer_scope_0 to one of them. Output the value of loop_var_0 that was fed.
+
+         iter_num_in    cond_in    loop_var_0_in          loop_var_1_in   [outer_scope_0]
+           (unused)        |        |        \                 |                |
+                       [Identity]  [Add]-----|-----------------|----------------/
+                           |        |      [Identity]      [Identity]
+                        cond_out  loop_var_1_out  |             |
+                                              loop_out_0   loop_var_0_out
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_scalar;
+    float_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& loop_var_0_in = graph.GetOrCreateNodeArg("loop_var_0_in", &float_scalar);
+    auto& loop_var_1_in = graph.GetOrCreateNodeArg("loop_var_1_in", &float_scalar);
+
+    auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+    graph.AddOuterScopeNodeArg("outer_scope_0");
+
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_scalar);
+    auto& loop_var_1_out = graph.GetOrCreateNodeArg("loop_var_1_out", &float_scalar);
+    auto& loop_out_0 = graph.GetOrCreateNodeArg("loop_out_0", &float_scalar);
+
+    graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", {&cond_in}, {&cond_out});
+    graph.AddNode("loop_var_0_identity", "Identity", "Forward loop_var_1_in to loop_var_0_out",
+                  {&loop_var_1_in}, {&loop_var_0_out});
+    graph.AddNode("add", "Add", "Add outer_scope_0 to loop_var_0_in", {&loop_var_0_in, &outer_scope_0},
+                  {&loop_var_1_out});
+    graph.AddNode("loop_out_identity", "Identity", "Forward loop_var_0_in to loop_out_0",
+                  {&loop_var_0_in}, {&loop_out_0});
+
+    graph.SetInputOrder({&iter_num_in, &cond_in, &loop_var_0_in, &loop_var_1_in});
+    graph.SetOutputOrder({&cond_out, &loop_var_0_out, &loop_var_1_out, &loop_out_0});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  LoopOpTester test{{}, create_subgraph};
+
+  test.AddInput<int64_t>("M", {1}, {4});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {1}, {0.f});
+  test.AddInput<float>("loop_var_1_orig", {1}, {10.f});
+
+  // (loop_var_0, loop_var_1) goes (0, 10) -> (10, 3) -> (3, 13) -> (13, 6) -> (6, 16)
+  test.AddOutput<float>("loop_var_0_final", {1}, {6.f});
+  test.AddOutput<float>("loop_var_1_final", {1}, {16.f});
+  test.AddOutput<float>("loop_out_0_final", {4, 1}, {0.f, 10.f, 3.f, 13.f});
+
+  test.Run();
+}
+
+// string scan outputs are copied into the loop output buffer, which grows as there is no maximum trip count
+TEST(Loop, StringLoopOutputWithoutTripCount) {
+  const int64_t num_iterations = 20;
+
+  auto create_subgraph = [num_iterations](const RunOptions&) {
+    Model model("String loop output subgraph");
+    auto& graph = model.MainGraph();
+
+    /* Add outer_scope_0 to the loop carried var until it reaches num_iterations * kOuterNodeAddValue.
+       The sum is the loop carried var, and the loop output as a string.
+
+         iter_num_in    cond_in    loop_var_0_in  [outer_scope_0]
+           (unused)    (unused)          \           /
+                                           [Add]----/         [Constant]
+                                             |                    |
+                                           sum_0 --------------[Less]
+                                           /   \                 |
+                                   [Identity]  [Cast]         cond_out
+                                       |           |
+                              loop_var_0_out   loop_out_0
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_scalar;
+    float_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto string_scalar;
+    string_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_STRING);
+    string_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& loop_var_0_in = graph.GetOrCreateNodeArg("loop_var_0_in", &float_scalar);
+
+    auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+    graph.AddOuterScopeNodeArg("outer_scope_0");
+
+    auto& sum_0 = graph.GetOrCreateNodeArg("sum_0", &float_scalar);
+    auto& max_value_out = graph.GetOrCreateNodeArg("max_value_out", &float_scalar);
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_scalar);
+    auto& loop_out_0 = graph.GetOrCreateNodeArg("loop_out_0", &string_scalar);
+
+    graph.AddNode("add", "Add", "Add outer_scope_0 to the loop carried var", {&outer_scope_0, &loop_var_0_in},
+                  {&sum_0});
+
+    auto& constant = graph.AddNode("constant_max_value", "Constant", "Constant with the final sum",
+                                   {}, {&max_value_out});
+    TensorProto value_tensor;
+    value_tensor.add_dims(1);
+    value_tensor.add_float_data(kOuterNodeAddValue * num_iterations);
+    value_tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    constant.AddAttribute("value", value_tensor);
+
+    graph.AddNode("sum_less_than_max", "Less", "Check sum < max", {&sum_0, &max_value_out}, {&cond_out});
+    graph.AddNode("loop_var_out", "Identity", "Output sum as loop_var_0_out", {&sum_0}, {&loop_var_0_out});
+    auto& cast = graph.AddNode("loop_out", "Cast", "Output sum as a string", {&sum_0}, {&loop_out_0});
+    cast.AddAttribute("to", int64_t{TensorProto_DataType_STRING});
+
+    graph.SetInputOrder({&iter_num_in, &cond_in, &loop_var_0_in});
+    graph.SetOutputOrder({&cond_out, &loop_var_0_out, &loop_out_0});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  LoopOpTester test{{}, create_subgraph};
+
+  test.AddMissingOptionalInput<int64_t>();
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {1}, {0.f});
+
+  std::vector<std::string> loop_out_0_final;
+  for (int64_t i = 1; i <= num_iterations; ++i) {
+    loop_out_0_final.push_back(std::to_string(static_cast<int>(kOuterNodeAddValue * i)));
+  }
+
+  test.AddOutput<float>("loop_var_0_final", {1}, {kOuterNodeAddValue * num_iterations});
+  test.AddOutput<std::string>("loop_out_0_final", {num_iterations, 1}, loop_out_0_final);
+
+  test.Run();
+}
+
 #ifdef USE_CUDA
 // test that when part of the subgraph run on CUDA it executes successfully
 TEST(Loop, MixedExecutionProviders) {
@@ -24,6 +24,7 @@ struct RunOptions {
   bool scalar_loop_state_value = false;
   bool add_bad_shape = false;
   bool mixed_execution_providers = false;
+  bool scan_batch_parallelism = false;
 };
 
 static void CreateSubgraph(Graph& graph, RunOptions& options, const std::string& failure_message = "");
@@ -310,6 +311,7 @@ static void RunTest_v8(const std::string test_name, int64_t batch_size, int64_t
   test.AddOutput<float>("scan_output_2", output_shape, output_2);
   test.AddOutput<float>("scan_output_3", output_shape, output_3);
 
+  test.SetScanBatchParallelism(options.scan_batch_parallelism);
   test.Run(expect_result, failure_message);
 }
 
@@ -603,7 +605,7 @@ TEST(Scan8, ShortSequenceTwoInBatchOneLoopStateVar) {
              iteration_count_out, output_0, output_1, output_2, output_3);
 }
 
-TEST(Scan8, MixedSequenceLens) {
+static void MixedSequenceLens(const RunOptions& options) {
   const int64_t batch_size = 3;
   const int64_t max_sequence_len = 2;
   const int64_t input_size = 2;
@@ -647,7 +649,27 @@ TEST(Scan8, MixedSequenceLens) {
   RunTest_v8("MixedSequenceLens", batch_size, max_sequence_len, input_size,
              nullptr, &sequence_lens,
              iteration_count_in, input_0, input_1,
-             iteration_count_out, output_0, output_1, output_2, output_3);
+             iteration_count_out, output_0, output_1, output_2, output_3, options);
+}
+
+TEST(Scan8, MixedSequenceLens) {
+  MixedSequenceLens({});
+}
+
+// the batch entries after the first one are executed concurrently on the session thread pool
+TEST(Scan8, MixedSequenceLensParallelExecution) {
+  RunOptions options{};
+  options.scan_batch_parallelism = true;
+  MixedSequenceLens(options);
+}
+
+// the outputs of the subgraph have symbolic dimensions, so the Scan outputs are only allocated by the first batch
+// entry and the remaining ones write to slices of them concurrently
+TEST(Scan8, MixedSequenceLensParallelExecutionSymbolicDims) {
+  RunOptions options{};
+  options.scan_batch_parallelism = true;
+  options.include_dim_values_in_subgraph = false;
+  MixedSequenceLens(options);
 }
 
 TEST(Scan8, MixedSequenceLensReverse) {
@@ -26,8 +26,6 @@ TEST(GemmOpTest, GemmNoTrans) {
   test.Run();
 }
 
-// Only CUDA kernel has float 16 support
-#ifdef USE_CUDA
 TEST(GemmOpTest, GemmNoTrans_f16) {
   OpTester test("Gemm");
 
@@ -58,7 +56,41 @@ TEST(GemmOpTest, GemmNoTrans_f16) {
   test.AddOutput<MLFloat16>("Y", {2, 3}, f_Y);
   test.Run();
 }
-#endif
+
+TEST(GemmOpTest, GemmTransBroadcast_f16) {
+  OpTester test("Gemm");
+
+  test.AddAttribute("transA", (int64_t)1);
+  test.AddAttribute("transB", (int64_t)1);
+  test.AddAttribute("alpha", 2.0f);
+  test.AddAttribute("beta", 1.0f);
+
+  std::vector<float> A{1.0f, -1.0f,
+                       2.0f, -2.0f,
+                       3.0f, -3.0f,
+                       4.0f, -4.0f};
+  std::vector<float> B{1.0f, 1.0f, 1.0f, 1.0f,
+                       1.0f, 2.0f, 1.0f, 2.0f,
+                       0.5f, 0.5f, 0.5f, 0.5f};
+  std::vector<float> C{1.0f, 2.0f, 3.0f};
+  std::vector<float> Y{21.0f, 34.0f, 13.0f,
+                       -19.0f, -30.0f, -7.0f};
+
+  std::vector<MLFloat16> f_A(8);
+  std::vector<MLFloat16> f_B(12);
+  std::vector<MLFloat16> f_C(3);
+  std::vector<MLFloat16> f_Y(6);
+  ConvertFloatToMLFloat16(A.data(), f_A.data(), 8);
+  ConvertFloatToMLFloat16(B.data(), f_B.data(), 12);
+  ConvertFloatToMLFloat16(C.data(), f_C.data(), 3);
+  ConvertFloatToMLFloat16(Y.data(), f_Y.data(), 6);
+
+  test.AddInput<MLFloat16>("A", {4, 2}, f_A);
+  test.AddInput<MLFloat16>("B", {3, 4}, f_B);
+  test.AddInput<MLFloat16>("C", {3}, f_C);
+  test.AddOutput<MLFloat16>("Y", {2, 3}, f_Y);
+  test.Run();
+}
 
 TEST(GemmOpTest, GemmBroadcast) {
   OpTester test("Gemm");
@@ -108,6 +108,28 @@ TEST(MathOpTest, MatMulDoubleType) {
   RunMatMulTest<double>();
 }
 
+TEST(MathOpTest, MatMulFloat16Type) {
+  std::vector<float> common_input_vals{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  for (auto t : GenerateTestCases<float>()) {
+    OpTester test("MatMul");
+
+    int64_t size0 = TensorShape::ReinterpretBaseType(t.input0_dims).SizeHelper(0, t.input0_dims.size());
+    std::vector<MLFloat16> input0_vals(size0);
+    ConvertFloatToMLFloat16(common_input_vals.data(), input0_vals.data(), static_cast<int>(size0));
+    test.AddInput<MLFloat16>("A", t.input0_dims, input0_vals);
+
+    int64_t size1 = TensorShape::ReinterpretBaseType(t.input1_dims).SizeHelper(0, t.input1_dims.size());
+    std::vector<MLFloat16> input1_vals(size1);
+    ConvertFloatToMLFloat16(common_input_vals.data(), input1_vals.data(), static_cast<int>(size1));
+    test.AddInput<MLFloat16>("B", t.input1_dims, input1_vals);
+
+    std::vector<MLFloat16> expected_vals(t.expected_vals.size());
+    ConvertFloatToMLFloat16(t.expected_vals.data(), expected_vals.data(), static_cast<int>(expected_vals.size()));
+    test.AddOutput<MLFloat16>("Y", t.expected_dims, expected_vals);
+    test.Run();
+  }
+}
+
 TEST(MathOpTest, MatMulInt32Type) {
   RunMatMulTest<int32_t>(9);
 }
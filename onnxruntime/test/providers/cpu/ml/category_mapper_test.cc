@@ -43,5 +43,39 @@ TEST(CategoryMapper, IntToString) {
 
   RunTest(dims, input, output);
 }
+
+TEST(CategoryMapper, LargeVocabulary) {
+  // enough categories to grow the lookup tables several times, with sparse int64 keys
+  std::vector<std::string> categories;
+  std::vector<int64_t> indexes;
+  for (int64_t i = 0; i < 1000; ++i) {
+    categories.push_back("category_" + std::to_string(i));
+    indexes.push_back(i * 1024);
+  }
+
+  std::vector<std::string> string_input{"category_0", "category_999", "category_1000", "", "category_512"};
+  std::vector<int64_t> int_output{0, 999 * 1024, -1, -1, 512 * 1024};
+
+  OpTester string_to_int("CategoryMapper", 1, onnxruntime::kMLDomain);
+  string_to_int.AddAttribute("cats_strings", categories);
+  string_to_int.AddAttribute("cats_int64s", indexes);
+  string_to_int.AddAttribute("default_string", "default");
+  string_to_int.AddAttribute<int64_t>("default_int64", -1);
+  string_to_int.AddInput<std::string>("X", {5}, string_input);
+  string_to_int.AddOutput<int64_t>("Y", {5}, int_output);
+  string_to_int.Run();
+
+  std::vector<int64_t> int_input{1024, 1025, 0, 999 * 1024};
+  std::vector<std::string> string_output{"category_1", "default", "category_0", "category_999"};
+
+  OpTester int_to_string("CategoryMapper", 1, onnxruntime::kMLDomain);
+  int_to_string.AddAttribute("cats_strings", categories);
+  int_to_string.AddAttribute("cats_int64s", indexes);
+  int_to_string.AddAttribute("default_string", "default");
+  int_to_string.AddAttribute<int64_t>("default_int64", -1);
+  int_to_string.AddInput<int64_t>("X", {4}, int_input);
+  int_to_string.AddOutput<std::string>("Y", {4}, string_output);
+  int_to_string.Run();
+}
 }  // namespace test
 }  // namespace onnxruntime
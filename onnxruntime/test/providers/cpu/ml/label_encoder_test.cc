@@ -42,5 +42,26 @@ TEST(LabelEncoder, IntToString) {
   RunTest(dims, input, output);
 }
 
+// Large enough for the elements to be looked up in parallel.
+TEST(LabelEncoder, LargeBatch) {
+  static const std::vector<std::string> labels = {"Beer", "Wine", "Tequila"};
+  const int64_t batch_size = 4096;
+  std::vector<std::string> string_input;
+  std::vector<int64_t> int_output;
+  std::vector<int64_t> int_input;
+  std::vector<std::string> string_output;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    // every fourth element is unknown
+    const int64_t label = i % 4;
+    string_input.push_back(label < 3 ? labels[label] : "Burger");
+    int_output.push_back(label < 3 ? label : 99);
+    int_input.push_back(label < 3 ? label : -1);
+    string_output.push_back(label < 3 ? labels[label] : "Water");
+  }
+
+  RunTest<std::string, int64_t>({batch_size}, string_input, int_output);
+  RunTest<int64_t, std::string>({batch_size}, int_input, string_output);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
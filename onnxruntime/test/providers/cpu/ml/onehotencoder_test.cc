@@ -97,5 +97,42 @@ TEST(OneHotEncoderOpTest, String) {
   test_vector.Run(OpTester::ExpectResult::kExpectFailure);
 }
 
+// Large enough for the rows to be encoded in parallel.
+TEST(OneHotEncoderOpTest, LargeBatch) {
+  const int64_t batch_size = 4096;
+  std::vector<int64_t> categories{0, 1, 2, 3, 4, 5, 6, 7};
+  std::vector<std::string> string_categories{"0", "1", "2", "3", "4", "5", "6", "7"};
+  // 8 and 9 are unknown categories
+  vector<int64_t> input;
+  vector<std::string> string_input;
+  vector<float> expected_output(batch_size * categories.size(), 0.0f);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    input.push_back(i % 10);
+    string_input.push_back(std::to_string(i % 10));
+    if (i % 10 < 8)
+      expected_output[i * categories.size() + i % 10] = 1.0f;
+  }
+
+  OpTester test_int("OneHotEncoder", 1, onnxruntime::kMLDomain);
+  test_int.AddAttribute("cats_int64s", categories);
+  test_int.AddInput<int64_t>("X", {batch_size}, input);
+  test_int.AddOutput<float>("Y", {batch_size, 8}, expected_output);
+  test_int.AddAttribute("zeros", int64_t{1});
+  test_int.Run();
+
+  test_int.AddAttribute("zeros", int64_t{0});
+  test_int.Run(OpTester::ExpectResult::kExpectFailure, "Unknown Category");
+
+  OpTester test_string("OneHotEncoder", 1, onnxruntime::kMLDomain);
+  test_string.AddAttribute("cats_strings", string_categories);
+  test_string.AddInput<string>("X", {batch_size}, string_input);
+  test_string.AddOutput<float>("Y", {batch_size, 8}, expected_output);
+  test_string.AddAttribute("zeros", int64_t{1});
+  test_string.Run();
+
+  test_string.AddAttribute("zeros", int64_t{0});
+  test_string.Run(OpTester::ExpectResult::kExpectFailure, "Unknown Category");
+}
+
 }  // namespace test
 }  // namespace onnxruntime
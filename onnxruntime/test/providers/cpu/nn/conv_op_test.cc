@@ -542,5 +542,40 @@ TEST(ConvTest, Conv2D_group) {
   TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape);
 }
 
+TEST(ConvTest, Conv2D_Bias_f16) {
+  OpTester test("Conv");
+  test.AddAttribute("group", (int64_t)2);
+  test.AddAttribute("kernel_shape", vector<int64_t>{2, 2});
+  test.AddAttribute("pads", vector<int64_t>{1, 0, 0, 1});
+  test.AddAttribute("strides", vector<int64_t>{1, 1});
+
+  vector<float> X = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f,
+                     -1.0f, -2.0f, -3.0f, -4.0f, -5.0f, -6.0f, -7.0f, -8.0f, -9.0f};
+  vector<float> W = {1.0f, 0.0f, 0.0f, 1.0f,
+                     0.5f, 0.5f, 0.5f, 0.5f,
+                     1.0f, 1.0f, 1.0f, 1.0f,
+                     -1.0f, 0.0f, 0.0f, 0.0f};
+  vector<float> B = {1.0f, 2.0f, 3.0f, 4.0f};
+  vector<float> Y = {3.0f, 4.0f, 1.0f, 7.0f, 9.0f, 4.0f, 13.0f, 15.0f, 7.0f,
+                     3.5f, 4.5f, 3.5f, 8.0f, 10.0f, 6.5f, 14.0f, 16.0f, 9.5f,
+                     0.0f, -2.0f, 0.0f, -9.0f, -13.0f, -6.0f, -21.0f, -25.0f, -12.0f,
+                     4.0f, 4.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f};
+
+  vector<MLFloat16> f_X(X.size());
+  vector<MLFloat16> f_W(W.size());
+  vector<MLFloat16> f_B(B.size());
+  vector<MLFloat16> f_Y(Y.size());
+  ConvertFloatToMLFloat16(X.data(), f_X.data(), static_cast<int>(X.size()));
+  ConvertFloatToMLFloat16(W.data(), f_W.data(), static_cast<int>(W.size()));
+  ConvertFloatToMLFloat16(B.data(), f_B.data(), static_cast<int>(B.size()));
+  ConvertFloatToMLFloat16(Y.data(), f_Y.data(), static_cast<int>(Y.size()));
+
+  test.AddInput<MLFloat16>("X", {1, 2, 3, 3}, f_X);
+  test.AddInput<MLFloat16>("W", {4, 1, 2, 2}, f_W);
+  test.AddInput<MLFloat16>("B", {4}, f_B);
+  test.AddOutput<MLFloat16>("Y", {1, 4, 3, 3}, f_Y);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 ﻿// Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cctype>
 #include <codecvt>
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
@@ -167,6 +169,39 @@ TEST(ContribOpTest, StringNormalizerTest) {
     test.Run(OpTester::ExpectResult::kExpectSuccess);
   }
 
+  // - case-INSENSETIVE approach en_US locale
+  // - filter out a non ASCII stopword
+  // - LOWER with strings long enough to change the case of several
+  //   ASCII characters at a time, mixed with non ASCII characters
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "LOWER", false, {u8"ÉCOLE"}, test_locale);
+    std::vector<int64_t> dims{4};
+    std::vector<std::string> input = {std::string(u8"école"),
+                                      std::string(u8"MONDAY and TUESDAY [@`{]"),
+                                      std::string(u8"Понедельник"),
+                                      std::string(u8"ABCDEFGHÉCOLE")};
+    test.AddInput<std::string>("T", dims, input);
+
+    std::vector<std::string> output = {std::string(u8"monday and tuesday [@`{]"),
+                                       std::string(u8"понедельник"),
+                                       std::string(u8"abcdefghécole")};
+    test.AddOutput<std::string>("Y", {3}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+  // - invalid utf8 is reported when the case changes
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "UPPER", true, {}, test_locale);
+    std::vector<int64_t> dims{2};
+    std::vector<std::string> input = {std::string("monday"), std::string("tues\xC3")};
+    test.AddInput<std::string>("T", dims, input);
+
+    std::vector<std::string> output = {std::string("MONDAY"), std::string("TUES")};
+    test.AddOutput<std::string>("Y", dims, output);
+    test.Run(OpTester::ExpectResult::kExpectFailure, "Input contains invalid utf8 chars");
+  }
+
   // Empty output case
   // - casesensitive approach
   // - filter out monday
@@ -201,5 +236,30 @@ TEST(ContribOpTest, StringNormalizerTest) {
   }
 }
 
+// Enough strings for the filtering and the case change to run in parallel
+TEST(ContribOpTest, StringNormalizerLargeInput) {
+  const std::vector<std::string> days = {"Monday", "tuesday", "WEDNESDAY", "thursday"};
+  std::vector<std::string> input;
+  std::vector<std::string> output;
+  for (size_t i = 0; i < 2048; ++i) {
+    const auto& day = days[i % days.size()];
+    input.push_back(day);
+    if (i % days.size() != 0) {
+      std::string upper(day);
+      std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return static_cast<char>(::toupper(c)); });
+      output.push_back(upper);
+    }
+  }
+
+  // - caseinsensitive approach
+  // - filter out monday
+  // - UPPER
+  OpTester test("StringNormalizer", opset_ver, domain);
+  InitTestAttr(test, "UPPER", false, {"monday"}, test_locale);
+  test.AddInput<std::string>("T", {static_cast<int64_t>(input.size())}, input);
+  test.AddOutput<std::string>("Y", {static_cast<int64_t>(output.size())}, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
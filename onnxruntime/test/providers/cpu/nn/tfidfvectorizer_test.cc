@@ -555,5 +555,63 @@ TEST(TfIdfVectorizerTest, String_TFIDFWeights_onlyBigrams_Skip5) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+TEST(TfIdfVectorizerTest, Int64_TF_BigramsAndTrigrams_PrefixNotCounted) {
+  OpTester test("TfIdfVectorizer", opset_ver, domain);
+  // s=0, Min=2, Max=3, weights empty, int64
+  // [1, 2] is only the prefix of the [1, 2, 3] tri-gram and must not be counted
+  InitTestAttr(test, "TF", 2, 3, 0,
+               {0, 2, 4},
+               {0, 1, 2, 3},  //4 output indexes
+               {},
+               {1, 2,      //1-grams
+                3, 4,      //bi-grams
+                1, 2, 3},  //tri-grams
+               {});
+
+  std::vector<int64_t> dims{7};
+  std::vector<int64_t> input{1, 2, 3, 4, 1, 2, 5};
+  test.AddInput<int64_t>("T", dims, input);
+
+  std::vector<int64_t> out_dims{4};
+  std::vector<float> output = {0, 0, 1, 1};
+  test.AddOutput<float>("Y", out_dims, output);
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
+TEST(TfIdfVectorizerTest, Int32_TF_BigramsAndUnigrams_LargeBatch) {
+  OpTester test("TfIdfVectorizer", opset_ver, domain);
+  // s=0, Min=1, Max=2, weights empty, int32
+  // enough rows to take the parallel path
+  InitTestAttr(test, "TF", 1, 2, 0,
+               {0, 2},
+               {0, 1, 2},  //3 output indexes
+               {},
+               {2, 3,   //1-grams
+                2, 3},  //bi-grams
+               {});
+
+  const int64_t rows = 1024;
+  std::vector<int64_t> dims{rows, 4};
+  std::vector<int32_t> input;
+  std::vector<float> output;
+  for (int64_t row = 0; row < rows; ++row) {
+    // odd rows contain the [2, 3] bi-gram, even rows do not
+    if (row % 2) {
+      input.insert(input.end(), {2, 3, 3, 7});
+      output.insert(output.end(), {1, 2, 1});
+    } else {
+      input.insert(input.end(), {3, 7, 2, 2});
+      output.insert(output.end(), {2, 1, 0});
+    }
+  }
+  test.AddInput<int32_t>("T", dims, input);
+
+  std::vector<int64_t> out_dims{rows, 3};
+  test.AddOutput<float>("Y", out_dims, output);
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/inference_session.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/framework/test_utils.h"
+#include "test/util/include/default_providers.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::logging;
+
+namespace onnxruntime {
+
+namespace test {
+
+static TypeProto MakeFloatTensorType(const std::vector<int64_t>& dims) {
+  TypeProto type;
+  type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+  return type;
+}
+
+// Conv -> Relu -> MaxPool is fused into a single MKL-DNN subgraph with the Relu folded into the convolution.
+TEST(MklDnnExecutionProviderTest, SubgraphFunctionTest) {
+  onnxruntime::Model model("graph_1");
+  auto& graph = model.MainGraph();
+
+  TypeProto x_type = MakeFloatTensorType({1, 1, 4, 4});
+  TypeProto w_type = MakeFloatTensorType({2, 1, 1, 1});
+  TypeProto conv_type = MakeFloatTensorType({1, 2, 4, 4});
+  TypeProto y_type = MakeFloatTensorType({1, 2, 2, 2});
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &x_type);
+  auto& w_arg = graph.GetOrCreateNodeArg("W", &w_type);
+  auto& conv_arg = graph.GetOrCreateNodeArg("conv_out", &conv_type);
+  auto& relu_arg = graph.GetOrCreateNodeArg("relu_out", &conv_type);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &y_type);
+
+  TensorProto w_tensor;
+  w_tensor.set_name("W");
+  w_tensor.set_data_type(TensorProto_DataType_FLOAT);
+  for (auto dim : {2, 1, 1, 1}) {
+    w_tensor.add_dims(dim);
+  }
+  w_tensor.add_float_data(1.0f);
+  w_tensor.add_float_data(-1.0f);
+  graph.AddInitializedTensor(w_tensor);
+
+  graph.AddNode("conv", "Conv", "conv.", {&x_arg, &w_arg}, {&conv_arg});
+  graph.AddNode("relu", "Relu", "relu.", {&conv_arg}, {&relu_arg});
+  auto& pool = graph.AddNode("pool", "MaxPool", "pool.", {&relu_arg}, {&y_arg});
+  pool.AddAttribute("kernel_shape", std::vector<int64_t>{2, 2});
+  pool.AddAttribute("strides", std::vector<int64_t>{2, 2});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK());
+  std::string model_file_name = "mkldnn_execution_provider_test_graph.onnx";
+  status = onnxruntime::Model::Save(model, model_file_name);
+  ASSERT_TRUE(status.IsOK());
+
+  std::vector<int64_t> dims_x = {1, 1, 4, 4};
+  std::vector<float> values_x(16);
+  for (size_t i = 0; i < values_x.size(); i++) {
+    values_x[i] = static_cast<float>(i + 1);
+  }
+  MLValue ml_value_x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x, &ml_value_x);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value_x));
+
+  std::vector<std::string> output_names{"Y"};
+
+  // The first filter passes the input through and the second negates it, which the Relu clamps to zero.
+  std::vector<int64_t> expected_dims_y = {1, 2, 2, 2};
+  std::vector<float> expected_values_y = {6.0f, 8.0f, 14.0f, 16.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+  SessionOptions so;
+  so.session_logid = "MklDnnExecutionProviderTest.SubgraphFunctionTest";
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+
+  InferenceSession session_object{so};
+  session_object.RegisterExecutionProvider(DefaultMkldnnExecutionProvider());
+  status = session_object.Load(model_file_name);
+  ASSERT_TRUE(status.IsOK());
+  status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK());
+
+  // Run twice so the second run reuses the primitive chain built for the input shape.
+  for (int run = 0; run < 2; run++) {
+    std::vector<MLValue> fetches;
+    status = session_object.Run(run_options, feeds, output_names, &fetches);
+    ASSERT_TRUE(status.IsOK());
+
+    ASSERT_EQ(1, fetches.size());
+    auto& rtensor = fetches.front().Get<Tensor>();
+    ASSERT_EQ(TensorShape(expected_dims_y), rtensor.Shape());
+    const std::vector<float> found(rtensor.template Data<float>(),
+                                   rtensor.template Data<float>() + expected_values_y.size());
+    ASSERT_EQ(expected_values_y, found);
+  }
+}
+}  // namespace test
+}  // namespace onnxruntime
@@ -401,6 +401,7 @@ void OpTester::Run(ExpectResult expect_result,
     SessionOptions so;
     so.session_logid = op_;
     so.session_log_verbosity_level = 1;
+    so.enable_scan_batch_parallelism = scan_batch_parallelism_;
 
     static const std::string all_provider_types[] = {
         kCpuExecutionProvider,
@@ -164,6 +164,12 @@ class OpTester {
     return *this;
   }
 
+  // Let Scan run the entries of a batch concurrently. This also creates the session thread pool.
+  OpTester& SetScanBatchParallelism(bool scan_batch_parallelism) {
+    scan_batch_parallelism_ = scan_batch_parallelism;
+    return *this;
+  }
+
   // We have an initializer_list and vector version of the Add functions because std::vector is specialized for
   // bool and we can't get the raw data out. So those cases must use an initializer_list
   template <typename T>
@@ -322,6 +328,7 @@ class OpTester {
   int opset_version_;
   bool add_shape_to_tensor_data_ = true;
   int add_symbolic_dim_to_tensor_data_ = -1;
+  bool scan_batch_parallelism_ = false;
   std::vector<Data> input_data_;
   std::vector<Data> output_data_;
   std::vector<size_t> initializer_index_;
@@ -5,6 +5,7 @@
 import unittest
 import os
 import sys
+import threading
 import numpy as np
 import onnxruntime as onnxrt
 from onnxruntime.capi._pybind_state import onnxruntime_ostream_redirect
@@ -72,6 +73,44 @@ class TestInferenceSession(unittest.TestCase):
         output_expected = np.array([[5.0], [11.0], [17.0]], dtype=np.float32)
         np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
 
+    def testRunModelNonContiguousInput(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        # the transposed array is not C-contiguous so it is copied rather than used in place
+        x = np.array([[1.0, 3.0, 5.0], [2.0, 4.0, 6.0]], dtype=np.float32).T
+        res = sess.run(["Y"], {"X": x})
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+
+    def testRunModelOutputOutlivesSession(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        res = sess.run(["Y"], {"X": x})
+        del sess
+        x[:] = 0
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+
+    def testRunModelMultipleThreads(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        errors = []
+
+        def run():
+            try:
+                for i in range(20):
+                    x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+                    res = sess.run(["Y"], {"X": x})
+                    np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=run) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual([], errors)
+
     def testRunDevice(self):
         device = onnxrt.get_device()
         self.assertTrue('CPU' in device or 'GPU' in device)
@@ -296,6 +335,18 @@ class TestInferenceSession(unittest.TestCase):
         res = sess.run([output_name], {x_name: x})
         self.assertEqual(output_expected, res[0])
 
+    def testZipMapColumnarOutputs(self):
+        x = np.array([1.0, 0.0, 3.0, 44.0, 23.0, 11.0], dtype=np.float32).reshape((2,3))
+        for model in ["zipmap_stringfloat.pb", "zipmap_int64float.pb"]:
+            sess = onnxrt.InferenceSession(self.get_name(model))
+            expected = sess.run(None, {"X": x})
+
+            so = onnxrt.SessionOptions()
+            so.enable_columnar_map_outputs = True
+            sess = onnxrt.InferenceSession(self.get_name(model), sess_options=so)
+            res = sess.run(None, {"X": x})
+            self.assertEqual(expected[0], res[0])
+
     def testRaiseWrongNumInputs(self):
         with self.assertRaises(ValueError) as context:
             sess = onnxrt.InferenceSession(self.get_name("logicaland.pb"))
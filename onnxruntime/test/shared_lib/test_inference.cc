@@ -7,6 +7,7 @@
 #include <vector>
 #include <iostream>
 #include <atomic>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include "test_allocator.h"
 #include "test_fixture.h"
@@ -132,6 +133,8 @@ void TestInference(OrtEnv* env, T model_uri,
 
 static constexpr PATH_TYPE MODEL_URI = TSTR("testdata/mul_1.pb");
 static constexpr PATH_TYPE CUSTOM_OP_MODEL_URI = TSTR("testdata/foo_1.pb");
+// three chained Foo nodes, the output of the second one can reuse the buffer of its first input
+static constexpr PATH_TYPE CUSTOM_OP_CHAIN_MODEL_URI = TSTR("testdata/foo_3.pb");
 
 class CApiTestWithProvider : public CApiTest,
                              public ::testing::WithParamInterface<int> {
@@ -238,6 +241,181 @@ TEST_F(CApiTest, custom_op_handler) {
   OrtReleaseCustomOpDomain(custom_op_domain);
 }
 
+// Adds the inputs into a scratch buffer one element per parallel item, then copies the sum to the output.
+struct MyCustomKernelWithContext {
+  struct Items {
+    const float* X;
+    const float* Y;
+    float* sum;
+  };
+
+  void Compute(OrtKernelContext* context, OrtValue** inputs, OrtValue** outputs) {
+    Items items;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(inputs[0], reinterpret_cast<void**>(const_cast<float**>(&items.X))));
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(inputs[1], reinterpret_cast<void**>(const_cast<float**>(&items.Y))));
+    size_t size = static_cast<size_t>(OrtTensorDimensions(inputs[0]).ElementCount());
+
+    OrtAllocator* scratch;
+    ORT_THROW_ON_ERROR(OrtKernelContextGetScratchAllocator(context, &scratch));
+    items.sum = static_cast<float*>(OrtAllocatorAlloc(scratch, size * sizeof(float)));
+    ORT_THROW_ON_ERROR(OrtKernelContextParallelFor(
+        context, size, [](void* user_data, size_t i) {
+          auto* items = static_cast<Items*>(user_data);
+          items->sum[i] = items->X[i] + items->Y[i];
+        },
+        &items));
+
+    float* out;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(outputs[0], reinterpret_cast<void**>(&out)));
+    std::copy(items.sum, items.sum + size, out);
+    OrtAllocatorFree(scratch, items.sum);
+  }
+};
+
+// Opts in to the version 2 callbacks, which must then all be initialized.
+struct MyCustomOpV2 : MyCustomOp {
+  MyCustomOpV2() {
+    OrtCustomOp::version = ORT_CUSTOM_OP_VERSION_2;
+    OrtCustomOp::KernelComputeWithContext = nullptr;
+    OrtCustomOp::GetMayInplaceInput = nullptr;
+    OrtCustomOp::GetAliasInput = nullptr;
+    OrtCustomOp::KernelPrePackConstantInput = nullptr;
+  }
+};
+
+struct MyCustomOpWithContext : MyCustomOpV2 {
+  MyCustomOpWithContext() {
+    OrtCustomOp::CreateKernel = [](OrtCustomOp* /*this_*/, OrtKernelInfo* /*info*/, void** output) { *output = new MyCustomKernelWithContext(); };
+    OrtCustomOp::KernelComputeWithContext = [](void* op_kernel, OrtKernelContext* context, OrtValue** inputs, size_t /*input_count*/, OrtValue** outputs, size_t /*output_count*/) { static_cast<MyCustomKernelWithContext*>(op_kernel)->Compute(context, inputs, outputs); };
+    OrtCustomOp::KernelDestroy = [](void* op_kernel) { delete static_cast<MyCustomKernelWithContext*>(op_kernel); };
+  }
+};
+
+TEST_F(CApiTest, custom_op_with_context_handler) {
+  std::vector<size_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+
+  std::vector<int64_t> expected_dims_y = {3, 2};
+  std::vector<float> expected_values_y = {2.0f, 4.0f, 6.0f, 8.0f, 10.0f, 12.0f};
+
+  MyCustomOpWithContext custom_op;
+  OrtCustomOpDomain* custom_op_domain = OrtCreateCustomOpDomain("");
+  ORT_THROW_ON_ERROR(OrtCustomOpDomain_Add(custom_op_domain, &custom_op));
+
+  TestInference<PATH_TYPE>(env, CUSTOM_OP_MODEL_URI, dims_x, values_x, expected_dims_y, expected_values_y, 0, custom_op_domain);
+  OrtReleaseCustomOpDomain(custom_op_domain);
+}
+
+// Pre-packs the constant W input by doubling it, and adds the packed values to X.
+struct MyCustomKernelPrePacked {
+  void PrePack(size_t input_index, const OrtValue* value) {
+    prepacked_inputs.push_back(input_index);
+    const float* W;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(const_cast<OrtValue*>(value), reinterpret_cast<void**>(const_cast<float**>(&W))));
+    size_t size = static_cast<size_t>(OrtTensorDimensions(const_cast<OrtValue*>(value)).ElementCount());
+    packed_W.resize(size);
+    std::transform(W, W + size, packed_W.begin(), [](float w) { return 2 * w; });
+  }
+
+  void Compute(OrtValue** inputs, OrtValue** outputs) {
+    const float* X;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(inputs[0], reinterpret_cast<void**>(const_cast<float**>(&X))));
+    float* out;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(outputs[0], reinterpret_cast<void**>(&out)));
+    for (size_t i = 0; i < packed_W.size(); i++) {
+      out[i] = X[i] + packed_W[i];
+    }
+  }
+
+  std::vector<size_t> prepacked_inputs;
+  std::vector<float> packed_W;
+};
+
+struct MyCustomOpPrePacked : MyCustomOpV2 {
+  MyCustomOpPrePacked() {
+    OrtCustomOp::CreateKernel = [](OrtCustomOp* /*this_*/, OrtKernelInfo* /*info*/, void** output) { *output = new MyCustomKernelPrePacked(); };
+    OrtCustomOp::KernelPrePackConstantInput = [](void* op_kernel, size_t input_index, const OrtValue* value) { static_cast<MyCustomKernelPrePacked*>(op_kernel)->PrePack(input_index, value); };
+    OrtCustomOp::KernelCompute = [](void* op_kernel, OrtValue** inputs, size_t /*input_count*/, OrtValue** outputs, size_t /*output_count*/) {
+      auto* kernel = static_cast<MyCustomKernelPrePacked*>(op_kernel);
+      // only the W initializer is constant, and it is pre-packed once before the first compute
+      ASSERT_EQ(kernel->prepacked_inputs, std::vector<size_t>{1});
+      kernel->Compute(inputs, outputs);
+    };
+    OrtCustomOp::KernelDestroy = [](void* op_kernel) { delete static_cast<MyCustomKernelPrePacked*>(op_kernel); };
+  }
+};
+
+TEST_F(CApiTest, custom_op_prepack_constant_input) {
+  std::vector<size_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+
+  std::vector<int64_t> expected_dims_y = {3, 2};
+  std::vector<float> expected_values_y = {3.0f, 6.0f, 9.0f, 12.0f, 15.0f, 18.0f};
+
+  MyCustomOpPrePacked custom_op;
+  OrtCustomOpDomain* custom_op_domain = OrtCreateCustomOpDomain("");
+  ORT_THROW_ON_ERROR(OrtCustomOpDomain_Add(custom_op_domain, &custom_op));
+
+  TestInference<PATH_TYPE>(env, CUSTOM_OP_MODEL_URI, dims_x, values_x, expected_dims_y, expected_values_y, 0, custom_op_domain);
+  OrtReleaseCustomOpDomain(custom_op_domain);
+}
+
+// Declares that the output may reuse the X input, and counts the computes where it did.
+struct MyCustomOpInplace : MyCustomOpV2 {
+  MyCustomOpInplace() {
+    OrtCustomOp::GetMayInplaceInput = [](OrtCustomOp* /*this_*/, size_t /*output_index*/) { return 0; };
+    OrtCustomOp::KernelCompute = [](void* op_kernel, OrtValue** inputs, size_t input_count, OrtValue** outputs, size_t output_count) {
+      void* X;
+      void* out;
+      ORT_THROW_ON_ERROR(OrtGetTensorMutableData(inputs[0], &X));
+      ORT_THROW_ON_ERROR(OrtGetTensorMutableData(outputs[0], &out));
+      if (X == out)
+        ++inplace_computes;
+      static_cast<MyCustomKernel*>(op_kernel)->Compute(inputs, input_count, outputs, output_count);
+    };
+  }
+
+  static std::atomic<int> inplace_computes;
+};
+
+std::atomic<int> MyCustomOpInplace::inplace_computes{0};
+
+TEST_F(CApiTest, custom_op_may_inplace) {
+  std::vector<size_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+
+  std::vector<int64_t> expected_dims_y = {3, 2};
+  std::vector<float> expected_values_y = {4.0f, 8.0f, 12.0f, 16.0f, 20.0f, 24.0f};
+
+  MyCustomOpInplace custom_op;
+  OrtCustomOpDomain* custom_op_domain = OrtCreateCustomOpDomain("");
+  ORT_THROW_ON_ERROR(OrtCustomOpDomain_Add(custom_op_domain, &custom_op));
+
+  MyCustomOpInplace::inplace_computes = 0;
+  TestInference<PATH_TYPE>(env, CUSTOM_OP_CHAIN_MODEL_URI, dims_x, values_x, expected_dims_y, expected_values_y, 0, custom_op_domain);
+  OrtReleaseCustomOpDomain(custom_op_domain);
+
+  // X is a graph input and Y a graph output, so only the second node computes in place. The model is run 3 times.
+  ASSERT_EQ(MyCustomOpInplace::inplace_computes, 3);
+}
+
+TEST_F(CApiTest, custom_op_invalid_inplace_input) {
+  MyCustomOpV2 custom_op;
+  custom_op.GetMayInplaceInput = [](OrtCustomOp* /*this_*/, size_t /*output_index*/) { return 2; };
+  OrtCustomOpDomain* custom_op_domain = OrtCreateCustomOpDomain("");
+  ORT_THROW_ON_ERROR(OrtCustomOpDomain_Add(custom_op_domain, &custom_op));
+
+  std::unique_ptr<OrtSessionOptions> so(OrtCreateSessionOptions());
+  ORT_THROW_ON_ERROR(OrtAddCustomOpDomain(so.get(), custom_op_domain));
+  OrtSession* ret;
+  auto st = ::OrtCreateSession(env, CUSTOM_OP_MODEL_URI, so.get(), &ret);
+  ASSERT_NE(st, nullptr);
+  ASSERT_NE(std::string(OrtGetErrorMessage(st)).find("returned input index 2 from GetMayInplaceInput"), std::string::npos)
+      << OrtGetErrorMessage(st);
+  OrtReleaseStatus(st);
+  OrtReleaseCustomOpDomain(custom_op_domain);
+}
+
 #ifdef ORT_RUN_EXTERNAL_ONNX_TESTS
 TEST_F(CApiTest, create_session_without_session_option) {
   constexpr PATH_TYPE model_uri = TSTR("../models/opset8/test_squeezenet/model.onnx");
@@ -272,6 +450,21 @@ TEST_F(CApiTest, create_tensor) {
     std::vector<size_t> offsets(len);
     ORT_THROW_ON_ERROR(OrtGetStringTensorContent(tensor.get(), (void*)result.data(), data_len, offsets.data(),
                                                  offsets.size()));
+    ASSERT_EQ(result, "abckmp");
+    ASSERT_EQ(offsets, (std::vector<size_t>{0, 3}));
+
+    // fill a second tensor from the buffer and offsets
+    std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> copy(
+        OrtCreateTensorAsOrtValue(default_allocator.get(), {expected_len}, ONNX_TENSOR_ELEMENT_DATA_TYPE_STRING),
+        OrtReleaseValue);
+    ORT_THROW_ON_ERROR(OrtFillStringTensorContent(copy.get(), result.data(), data_len, offsets.data(),
+                                                  offsets.size()));
+    std::string copy_result(data_len, '\0');
+    std::vector<size_t> copy_offsets(len);
+    ORT_THROW_ON_ERROR(OrtGetStringTensorContent(copy.get(), (void*)copy_result.data(), data_len,
+                                                 copy_offsets.data(), copy_offsets.size()));
+    ASSERT_EQ(copy_result, result);
+    ASSERT_EQ(copy_offsets, offsets);
   }
 }
 
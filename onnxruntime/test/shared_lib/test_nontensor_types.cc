@@ -3,10 +3,12 @@
 
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test_fixture.h"
+#include <cstring>
 #include <functional>
 #include <set>
 #include "test_allocator.h"
 #include <iostream>
+#include <string>
 
 using namespace onnxruntime;
 
@@ -249,3 +251,90 @@ TEST_F(CApiTest, CreateGetVectorOfMapsStringFloat) {  // support zipmap output t
               std::set<float>(std::begin(values), std::end(values)));
   }
 }
+
+// Runs a ZipMap model with the columnar map outputs enabled and checks the output through the generic
+// OrtGetValue/OrtGetValueCount functions, which see the same sequence of maps as without the option.
+static void TestColumnarZipMapOutput(OrtEnv* env, PATH_TYPE model_uri,
+                                     const std::function<void(OrtValue* keys_ort)>& check_keys) {
+  SessionOptionsWrapper sf(env);
+  OrtEnableColumnarMapOutputs(sf);
+  std::unique_ptr<OrtSession, decltype(&OrtReleaseSession)> session(sf.OrtCreateSession(model_uri),
+                                                                     OrtReleaseSession);
+  std::unique_ptr<MockedOrtAllocator> default_allocator(std::make_unique<MockedOrtAllocator>());
+  RelAllocations<OrtValue> rel(&OrtReleaseValue);
+
+  const std::vector<float> x{1.0f, 0.0f, 3.0f, 44.0f, 23.0f, 11.0f};
+  OrtValue* input = OrtCreateTensorAsOrtValue(default_allocator.get(), {2, 3}, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT);
+  rel.add(input);
+  void* input_data;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(input, &input_data));
+  memcpy(input_data, x.data(), x.size() * sizeof(float));
+
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Z"};
+  OrtValue* output = nullptr;
+  ORT_THROW_ON_ERROR(OrtRun(session.get(), nullptr, input_names, &input, 1, output_names, 1, &output));
+  std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> output_holder(output, OrtReleaseValue);
+  ASSERT_EQ(OrtGetValueType(output), ONNX_TYPE_SEQUENCE);
+
+  size_t num_maps = 0;
+  ORT_THROW_ON_ERROR(OrtGetValueCount(output, &num_maps));
+  ASSERT_EQ(num_maps, 2u);
+
+  OrtValue* map_ort = nullptr;
+  OrtStatus* st = OrtGetValue(output, 2, default_allocator.get(), &map_ort);
+  ASSERT_NE(st, nullptr);
+  OrtReleaseStatus(st);
+
+  for (int i = 0; i < 2; ++i) {
+    map_ort = nullptr;
+    ORT_THROW_ON_ERROR(OrtGetValue(output, i, default_allocator.get(), &map_ort));
+    rel.add(map_ort);
+    ASSERT_EQ(OrtGetValueType(map_ort), ONNX_TYPE_MAP);
+
+    OrtValue* keys_ort = nullptr;
+    ORT_THROW_ON_ERROR(OrtGetValue(map_ort, 0, default_allocator.get(), &keys_ort));
+    rel.add(keys_ort);
+    check_keys(keys_ort);
+
+    OrtValue* values_ort = nullptr;
+    ORT_THROW_ON_ERROR(OrtGetValue(map_ort, 1, default_allocator.get(), &values_ort));
+    rel.add(values_ort);
+    float* values = nullptr;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(values_ort, reinterpret_cast<void**>(&values)));
+    ASSERT_EQ(std::vector<float>(values, values + 3), std::vector<float>(x.begin() + 3 * i, x.begin() + 3 * i + 3));
+  }
+
+  // the keys and values are owned by the caller, so they outlive the map and the sequence
+  map_ort = nullptr;
+  ORT_THROW_ON_ERROR(OrtGetValue(output, 1, default_allocator.get(), &map_ort));
+  OrtValue* values_ort = nullptr;
+  st = OrtGetValue(map_ort, 1, default_allocator.get(), &values_ort);
+  OrtReleaseValue(map_ort);
+  ORT_THROW_ON_ERROR(st);
+  rel.add(values_ort);
+  output_holder.reset();
+  float* values = nullptr;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(values_ort, reinterpret_cast<void**>(&values)));
+  ASSERT_EQ(std::vector<float>(values, values + 3), std::vector<float>(x.begin() + 3, x.end()));
+}
+
+TEST_F(CApiTest, ColumnarZipMapOutputInt64Float) {
+  TestColumnarZipMapOutput(env, TSTR("testdata/zipmap_int64float.pb"), [](OrtValue* keys_ort) {
+    int64_t* keys = nullptr;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(keys_ort, reinterpret_cast<void**>(&keys)));
+    ASSERT_EQ(std::vector<int64_t>(keys, keys + 3), std::vector<int64_t>({10, 20, 30}));
+  });
+}
+
+TEST_F(CApiTest, ColumnarZipMapOutputStringFloat) {
+  TestColumnarZipMapOutput(env, TSTR("testdata/zipmap_stringfloat.pb"), [](OrtValue* keys_ort) {
+    size_t data_len = 0;
+    ORT_THROW_ON_ERROR(OrtGetStringTensorDataLength(keys_ort, &data_len));
+    std::string data(data_len, '\0');
+    std::vector<size_t> offsets(3);
+    ORT_THROW_ON_ERROR(OrtGetStringTensorContent(keys_ort, &data[0], data_len, offsets.data(), offsets.size()));
+    ASSERT_EQ(data, "class1class2class3");
+    ASSERT_EQ(offsets, std::vector<size_t>({0, 6, 12}));
+  });
+}